@@ -213,6 +213,18 @@ index_opts_decode(struct index_opts *opts, const char *map,
 			  "'euclid' or 'manhattan'");
 		return -1;
 	}
+	if (opts->hash_func == key_hash_func_MAX) {
+		diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
+			 BOX_INDEX_FIELD_OPTS, "hash_func must be either "\
+			  "'murmur3' or 'wyhash'");
+		return -1;
+	}
+	if (opts->compaction_strategy == compaction_strategy_MAX) {
+		diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
+			 BOX_INDEX_FIELD_OPTS, "compaction_strategy must be "\
+			  "either 'tiered' or 'leveled'");
+		return -1;
+	}
 	if (opts->page_size <= 0 || (opts->range_size > 0 &&
 				     opts->page_size > opts->range_size)) {
 		diag_set(ClientError, ER_WRONG_INDEX_OPTIONS,
@@ -667,6 +679,11 @@ space_def_new_from_tuple(struct tuple *tuple, uint32_t errcode,
 			 "local space can't be synchronous");
 		return NULL;
 	}
+	if (opts.expire_field != UINT32_MAX && opts.is_view) {
+		diag_set(ClientError, errcode, tt_cstr(name, name_len),
+			 "view can't have expire_field");
+		return NULL;
+	}
 	struct space_def *def =
 		space_def_new(id, uid, exact_field_count, name, name_len,
 			      engine_name, engine_name_len, &opts, fields,
@@ -52,6 +52,7 @@
 #include "engine.h"
 #include "memtx_engine.h"
 #include "memtx_space.h"
+#include "memtx_tx.h"
 #include "sysview.h"
 #include "blackhole.h"
 #include "service_engine.h"
@@ -72,6 +73,8 @@
 #include "authentication.h"
 #include "path_lock.h"
 #include "gc.h"
+#include "expire.h"
+#include "read_pool.h"
 #include "sql.h"
 #include "systemd.h"
 #include "call.h"
@@ -500,6 +503,56 @@ box_check_election_timeout(void)
 	return d;
 }
 
+static int
+box_check_memtx_read_threads(void)
+{
+	int threads = cfg_geti("memtx_read_threads");
+	if (threads < 0 || threads > READ_POOL_THREADS_MAX) {
+		diag_set(ClientError, ER_CFG, "memtx_read_threads",
+			 tt_sprintf("must be >= 0 and <= %d",
+				    READ_POOL_THREADS_MAX));
+		return -1;
+	}
+	return threads;
+}
+
+static double
+box_check_memtx_read_view_refresh_interval(void)
+{
+	double d = cfg_getd("memtx_read_view_refresh_interval");
+	if (d <= 0) {
+		diag_set(ClientError, ER_CFG,
+			 "memtx_read_view_refresh_interval",
+			 "the value must be a positive number");
+		return -1;
+	}
+	return d;
+}
+
+static int
+box_check_memtx_tx_gc_batch_size(void)
+{
+	int size = cfg_geti("memtx_tx_gc_batch_size");
+	if (size <= 0) {
+		diag_set(ClientError, ER_CFG, "memtx_tx_gc_batch_size",
+			 "the value must be greater than 0");
+		return -1;
+	}
+	return size;
+}
+
+static int64_t
+box_check_memtx_tx_story_memory_limit(void)
+{
+	int64_t limit = cfg_geti64("memtx_tx_story_memory_limit");
+	if (limit < 0) {
+		diag_set(ClientError, ER_CFG, "memtx_tx_story_memory_limit",
+			 "the value must be >= 0");
+		return -1;
+	}
+	return limit;
+}
+
 static void
 box_check_replication(void)
 {
@@ -878,6 +931,14 @@ box_check_config(void)
 	if (box_check_memory_quota("memtx_memory") < 0)
 		diag_raise();
 	box_check_memtx_min_tuple_size(cfg_geti64("memtx_min_tuple_size"));
+	if (box_check_memtx_read_threads() < 0)
+		diag_raise();
+	if (box_check_memtx_read_view_refresh_interval() < 0)
+		diag_raise();
+	if (box_check_memtx_tx_gc_batch_size() < 0)
+		diag_raise();
+	if (box_check_memtx_tx_story_memory_limit() < 0)
+		diag_raise();
 	box_check_vinyl_options();
 	if (box_check_sql_cache_size(cfg_geti("sql_cache_size")) != 0)
 		diag_raise();
@@ -1371,6 +1432,36 @@ box_set_memtx_max_tuple_size(void)
 			cfg_geti("memtx_max_tuple_size"));
 }
 
+int
+box_set_memtx_read_view_refresh_interval(void)
+{
+	double d = box_check_memtx_read_view_refresh_interval();
+	if (d < 0)
+		return -1;
+	read_pool_set_refresh_interval(d);
+	return 0;
+}
+
+int
+box_set_memtx_tx_gc_batch_size(void)
+{
+	int size = box_check_memtx_tx_gc_batch_size();
+	if (size < 0)
+		return -1;
+	memtx_tx_set_gc_batch_size(size);
+	return 0;
+}
+
+int
+box_set_memtx_tx_story_memory_limit(void)
+{
+	int64_t limit = box_check_memtx_tx_story_memory_limit();
+	if (limit < 0)
+		return -1;
+	memtx_tx_set_story_memory_limit(limit);
+	return 0;
+}
+
 void
 box_set_too_long_threshold(void)
 {
@@ -1439,6 +1530,22 @@ box_set_vinyl_cache(void)
 	vinyl_engine_set_cache(vinyl, cfg_geti64("vinyl_cache"));
 }
 
+void
+box_set_vinyl_page_cache(void)
+{
+	struct engine *vinyl = engine_by_name("vinyl");
+	assert(vinyl != NULL);
+	vinyl_engine_set_page_cache(vinyl, cfg_geti64("vinyl_page_cache"));
+}
+
+void
+box_set_vinyl_value_cache(void)
+{
+	struct engine *vinyl = engine_by_name("vinyl");
+	assert(vinyl != NULL);
+	vinyl_engine_set_value_cache(vinyl, cfg_geti64("vinyl_value_cache"));
+}
+
 void
 box_set_vinyl_timeout(void)
 {
@@ -1618,6 +1725,15 @@ box_index_id_by_name(uint32_t space_id, const char *name, uint32_t len)
 int
 box_process1(struct request *request, box_tuple_t **result)
 {
+	/*
+	 * Let the MVCC garbage collector catch up before the first
+	 * statement of a transaction. Yields, so must be done before
+	 * the space lookup.
+	 */
+	struct txn *txn = in_txn();
+	if ((txn == NULL || stailq_empty(&txn->stmts)) &&
+	    memtx_tx_throttle() != 0)
+		return -1;
 	/* Allow to write to temporary spaces in read-only mode. */
 	struct space *space = space_cache_find(request->space_id);
 	if (space == NULL)
@@ -1688,8 +1804,9 @@ box_select(uint32_t space_id, uint32_t index_id,
 	if (txn_begin_ro_stmt(space, &txn, &svp) != 0)
 		return -1;
 
-	struct iterator *it = index_create_iterator(index, type,
-						    key, part_count);
+	struct iterator *it = index_create_iterator_with_offset(index, type,
+								key, part_count,
+								offset);
 	if (it == NULL) {
 		txn_rollback_stmt(txn);
 		return -1;
@@ -1703,10 +1820,6 @@ box_select(uint32_t space_id, uint32_t index_id,
 		rc = iterator_next(it, &tuple);
 		if (rc != 0 || tuple == NULL)
 			break;
-		if (offset > 0) {
-			offset--;
-			continue;
-		}
 		rc = port_c_add_tuple(port, tuple);
 		if (rc != 0)
 			break;
@@ -1766,6 +1879,24 @@ box_delete(uint32_t space_id, uint32_t index_id, const char *key,
 	return box_process1(&request, result);
 }
 
+int
+box_delete_range(uint32_t space_id, uint32_t index_id, const char *begin,
+		 const char *begin_end, const char *end, const char *end_end)
+{
+	mp_tuple_assert(begin, begin_end);
+	mp_tuple_assert(end, end_end);
+	struct request request;
+	memset(&request, 0, sizeof(request));
+	request.type = IPROTO_DELETE_RANGE;
+	request.space_id = space_id;
+	request.index_id = index_id;
+	request.key = begin;
+	request.key_end = begin_end;
+	request.tuple = end;
+	request.tuple_end = end_end;
+	return box_process1(&request, NULL);
+}
+
 API_EXPORT int
 box_update(uint32_t space_id, uint32_t index_id, const char *key,
 	   const char *key_end, const char *ops, const char *ops_end,
@@ -1851,6 +1982,130 @@ box_truncate(uint32_t space_id)
 	}
 }
 
+/** Max number of rows written to WAL in one bulk load transaction. */
+enum { BULK_LOAD_TXN_ROWS = 10000 };
+
+/**
+ * Write INSERT rows for tuples which are already in the space
+ * to WAL in one transaction.
+ */
+static int
+box_bulk_load_log(struct space *space, struct tuple **tuples, uint32_t count)
+{
+	struct txn *txn = txn_begin();
+	if (txn == NULL)
+		return -1;
+	for (uint32_t i = 0; i < count; i++) {
+		uint32_t size;
+		struct request request;
+		memset(&request, 0, sizeof(request));
+		request.type = IPROTO_INSERT;
+		request.space_id = space->def->id;
+		request.tuple = tuple_data_range(tuples[i], &size);
+		request.tuple_end = request.tuple + size;
+		/*
+		 * The statement doesn't go to the engine, but
+		 * is attributed to the space so that the row gets
+		 * the right replication group and the transaction
+		 * waits for quorum if the space is synchronous.
+		 */
+		if (txn_begin_stmt(txn, NULL) != 0)
+			goto rollback;
+		txn_current_stmt(txn)->space = space;
+		if (txn_commit_stmt(txn, &request) != 0)
+			goto rollback;
+	}
+	return txn_commit(txn);
+rollback:
+	txn_rollback(txn);
+	return -1;
+}
+
+/** Check if a space can be bulk loaded and start loading it. */
+static int
+box_space_begin_bulk_load(uint32_t space_id, struct tuple **tuples,
+			  uint32_t count, struct space **p_space)
+{
+	struct space *space = space_cache_find(space_id);
+	if (space == NULL)
+		return -1;
+	if (access_check_space(space, PRIV_W) != 0)
+		return -1;
+	if (!space_is_temporary(space) &&
+	    space_group_id(space) != GROUP_LOCAL &&
+	    box_check_writable() != 0)
+		return -1;
+	if (!space_is_memtx(space)) {
+		diag_set(ClientError, ER_UNSUPPORTED, space->engine->name,
+			 "bulk load");
+		return -1;
+	}
+	/*
+	 * Loaded tuples aren't tracked by the transaction manager
+	 * and don't advance the space sequence.
+	 */
+	if (memtx_tx_manager_use_mvcc_engine) {
+		diag_set(ClientError, ER_UNSUPPORTED, "Bulk load",
+			 "transaction manager");
+		return -1;
+	}
+	if (space->sequence != NULL) {
+		diag_set(ClientError, ER_UNSUPPORTED, "Bulk load",
+			 "spaces with a sequence");
+		return -1;
+	}
+	if (memtx_space_begin_bulk_load(space, tuples, count) != 0)
+		return -1;
+	*p_space = space;
+	return 0;
+}
+
+int
+box_space_bulk_load(uint32_t space_id, struct tuple **tuples, uint32_t count)
+{
+	if (in_txn() != NULL) {
+		diag_set(ClientError, ER_ACTIVE_TRANSACTION);
+		return -1;
+	}
+	/*
+	 * The tuples are added to the space before they are
+	 * written to WAL, so a checkpoint made while the space
+	 * is being loaded could include tuples that aren't in
+	 * WAL yet. Don't allow checkpointing until the load is
+	 * over. Note, this may yield so the space is looked up
+	 * after it.
+	 */
+	if (gc_block_checkpoint() != 0)
+		return -1;
+	struct space *space;
+	if (box_space_begin_bulk_load(space_id, tuples, count,
+				      &space) != 0) {
+		gc_unblock_checkpoint();
+		return -1;
+	}
+	/*
+	 * The tuples are visible right away, like changes of
+	 * memtx transactions waiting for WAL. The space can't be
+	 * changed until all of them are written.
+	 */
+	uint32_t logged_count = count;
+	if (!space_is_temporary(space)) {
+		for (logged_count = 0; logged_count < count; ) {
+			uint32_t batch = MIN(count - logged_count,
+					     (uint32_t)BULK_LOAD_TXN_ROWS);
+			int rc = box_bulk_load_log(space, tuples + logged_count,
+						   batch);
+			fiber_gc();
+			if (rc != 0)
+				break;
+			logged_count += batch;
+		}
+	}
+	memtx_space_end_bulk_load(space, tuples, count, logged_count);
+	gc_unblock_checkpoint();
+	return logged_count == count ? 0 : -1;
+}
+
 /** Update a record in _sequence_data space. */
 static int
 sequence_data_update(uint32_t seq_id, int64_t value)
@@ -2517,9 +2772,11 @@ box_free(void)
 		port_free();
 #endif
 		box_raft_free();
+		read_pool_free();
 		iproto_free();
 		replication_free();
 		sequence_free();
+		expire_free();
 		gc_free();
 		engine_shutdown();
 		wal_free();
@@ -2563,6 +2820,8 @@ engine_init()
 	engine_register((struct engine *)vinyl);
 	box_set_vinyl_max_tuple_size();
 	box_set_vinyl_cache();
+	box_set_vinyl_page_cache();
+	box_set_vinyl_value_cache();
 	box_set_vinyl_timeout();
 }
 
@@ -3047,6 +3306,9 @@ box_cfg_xc(void)
 
 	fiber_gc();
 	is_box_configured = true;
+	expire_init();
+	read_pool_init(cfg_geti("memtx_read_threads"),
+		       cfg_getd("memtx_read_view_refresh_interval"));
 	/*
 	 * Fill in leader election parameters after bootstrap. Before it is not
 	 * possible - there may be relevant data to recover from WAL and
@@ -241,9 +241,14 @@ void box_set_checkpoint_interval(void);
 void box_set_checkpoint_wal_threshold(void);
 void box_set_memtx_memory(void);
 void box_set_memtx_max_tuple_size(void);
+int box_set_memtx_read_view_refresh_interval(void);
+int box_set_memtx_tx_gc_batch_size(void);
+int box_set_memtx_tx_story_memory_limit(void);
 void box_set_vinyl_memory(void);
 void box_set_vinyl_max_tuple_size(void);
 void box_set_vinyl_cache(void);
+void box_set_vinyl_page_cache(void);
+void box_set_vinyl_value_cache(void);
 void box_set_vinyl_timeout(void);
 int box_set_election_mode(void);
 int box_set_election_timeout(void);
@@ -519,6 +524,40 @@ box_session_push(const char *data, const char *data_end);
 int
 box_process1(struct request *request, box_tuple_t **result);
 
+/**
+ * Load tuples into an empty memtx space. All indexes are built
+ * at once from the tuples, which are then written to WAL in big
+ * transactions. Triggers are not run. If a WAL write fails, the
+ * tuples written so far stay in the space, the rest are removed.
+ *
+ * \param space_id space identifier
+ * \param tuples tuples created with the space format
+ * \param count number of tuples
+ * \retval 0 success
+ * \retval -1 error, check box_error_last()
+ */
+int
+box_space_bulk_load(uint32_t space_id, struct tuple **tuples, uint32_t count);
+
+/**
+ * Delete all tuples whose keys fall in the range [begin, end).
+ * An empty key stands for infinity. Only supported by the primary
+ * index of a vinyl space. Triggers are not run.
+ *
+ * \param space_id space identifier
+ * \param index_id index identifier
+ * \param begin encoded start key in MsgPack Array format
+ * \param begin_end the end of encoded \a begin
+ * \param end encoded end key in MsgPack Array format
+ * \param end_end the end of encoded \a end
+ * \retval 0 success
+ * \retval -1 error, check box_error_last()
+ * \sa \code box.space[space_id].index[index_id]:delete_range(begin, end) \endcode
+ */
+int
+box_delete_range(uint32_t space_id, uint32_t index_id, const char *begin,
+		 const char *begin_end, const char *end, const char *end_end);
+
 /**
  * Execute request on given space.
  *
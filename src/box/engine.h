@@ -62,6 +62,8 @@ struct engine_memory_stat {
 	size_t cache;
 	/** Size of memory used by active transactions. */
 	size_t tx;
+	/** Size of memory pinned by open read views. */
+	size_t read_view;
 };
 
 typedef int
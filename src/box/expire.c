@@ -0,0 +1,273 @@
+/*
+ * Copyright 2010-2021, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "expire.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "box.h"
+#include "diag.h"
+#include "fiber.h"
+#include "index.h"
+#include "msgpuck.h"
+#include "schema.h"
+#include "say.h"
+#include "space.h"
+#include "trivia/util.h"
+#include "tuple.h"
+#include "txn.h"
+
+enum {
+	/** Max number of tuples deleted in one transaction. */
+	EXPIRE_BATCH_SIZE = 1000,
+};
+
+/** How often to look for expired tuples, in seconds. */
+static const double EXPIRE_PERIOD = 1.0;
+
+static struct {
+	/** Background fiber deleting expired tuples. */
+	struct fiber *fiber;
+	/** Ids of spaces to expire on the current pass. */
+	uint32_t *space_ids;
+	/** Number of entries in @space_ids. */
+	uint32_t space_count;
+	/** Allocated size of @space_ids. */
+	uint32_t space_capacity;
+} expire;
+
+/**
+ * Find a TREE index over the expire field of a space.
+ * Return NULL if there's no such index.
+ */
+static struct index *
+expire_find_index(struct space *space)
+{
+	uint32_t fieldno = space->def->opts.expire_field;
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		struct index *index = space->index[i];
+		struct key_def *key_def = index->def->key_def;
+		struct key_part *part = &key_def->parts[0];
+		if (index->def->type != TREE || key_def->is_multikey ||
+		    part->fieldno != fieldno || part->path != NULL)
+			continue;
+		switch (part->type) {
+		case FIELD_TYPE_UNSIGNED:
+		case FIELD_TYPE_INTEGER:
+		case FIELD_TYPE_NUMBER:
+		case FIELD_TYPE_DOUBLE:
+			return index;
+		default:
+			break;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Encode the current time as a key of the expire index. Integer
+ * fields are compared with the number of whole seconds.
+ */
+static char *
+expire_encode_key(char *data, struct index *index, double now)
+{
+	data = mp_encode_array(data, 1);
+	switch (index->def->key_def->parts[0].type) {
+	case FIELD_TYPE_UNSIGNED:
+	case FIELD_TYPE_INTEGER:
+		return mp_encode_uint(data, (uint64_t)floor(now));
+	default:
+		return mp_encode_double(data, now);
+	}
+}
+
+/**
+ * Delete up to EXPIRE_BATCH_SIZE tuples of a space that have
+ * expired by @a now in one transaction.
+ * Return the number of deleted tuples or -1 on error.
+ */
+static int
+expire_space_batch(uint32_t space_id, double now)
+{
+	struct space *space = space_by_id(space_id);
+	if (space == NULL || space->def->opts.expire_field == UINT32_MAX)
+		return 0;
+	struct index *pk = space_index(space, 0);
+	struct index *index = expire_find_index(space);
+	if (pk == NULL || index == NULL)
+		return 0;
+
+	char key[16];
+	char *key_end = expire_encode_key(key, index, now);
+	assert(key_end <= key + sizeof(key));
+	(void)key_end;
+
+	/*
+	 * Collect primary keys of expired tuples first and delete
+	 * them after, so as not to modify the index under the
+	 * iterator. Nothing yields in between.
+	 */
+	struct region *region = &fiber()->gc;
+	size_t size;
+	const char **keys = region_alloc_array(region, typeof(keys[0]),
+					       EXPIRE_BATCH_SIZE, &size);
+	if (keys == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "keys");
+		return -1;
+	}
+	if (box_txn_begin() != 0)
+		return -1;
+	struct iterator *it = index_create_iterator(index, ITER_LE, key, 1);
+	if (it == NULL)
+		goto fail;
+	uint32_t fieldno = space->def->opts.expire_field;
+	int count = 0;
+	while (count < EXPIRE_BATCH_SIZE) {
+		struct tuple *tuple;
+		if (iterator_next(it, &tuple) != 0) {
+			iterator_delete(it);
+			goto fail;
+		}
+		if (tuple == NULL)
+			break;
+		/* Nulls go first, so no more expired tuples. */
+		const char *field = tuple_field(tuple, fieldno);
+		if (field == NULL || mp_typeof(*field) == MP_NIL)
+			break;
+		uint32_t key_size;
+		keys[count] = tuple_extract_key(tuple, pk->def->key_def,
+						MULTIKEY_NONE, &key_size);
+		if (keys[count] == NULL) {
+			iterator_delete(it);
+			goto fail;
+		}
+		count++;
+	}
+	iterator_delete(it);
+	for (int i = 0; i < count; i++) {
+		const char *end = keys[i];
+		mp_next(&end);
+		if (box_delete(space_id, 0, keys[i], end, NULL) != 0)
+			goto fail;
+	}
+	if (box_txn_commit() != 0)
+		return -1;
+	return count;
+fail:
+	box_txn_rollback();
+	return -1;
+}
+
+static int
+expire_add_space_cb(struct space *space, void *arg)
+{
+	(void)arg;
+	if (space->def->opts.expire_field == UINT32_MAX ||
+	    !space_is_memtx(space))
+		return 0;
+	if (expire.space_count == expire.space_capacity) {
+		uint32_t capacity = MAX(expire.space_capacity * 2, 16);
+		uint32_t *ids = realloc(expire.space_ids,
+					capacity * sizeof(*ids));
+		if (ids == NULL) {
+			diag_set(OutOfMemory, capacity * sizeof(*ids),
+				 "realloc", "space_ids");
+			return -1;
+		}
+		expire.space_ids = ids;
+		expire.space_capacity = capacity;
+	}
+	expire.space_ids[expire.space_count++] = space->def->id;
+	return 0;
+}
+
+/** Delete all tuples that have expired by now. */
+static void
+expire_run(void)
+{
+	/*
+	 * Deleting tuples yields, so spaces may be altered or
+	 * dropped meanwhile. Remember space ids and look them up
+	 * before every batch.
+	 */
+	expire.space_count = 0;
+	if (space_foreach(expire_add_space_cb, NULL) != 0) {
+		diag_log();
+		return;
+	}
+	double now = fiber_time();
+	for (uint32_t i = 0; i < expire.space_count; i++) {
+		int rc;
+		do {
+			if (fiber_is_cancelled() || box_is_ro())
+				return;
+			rc = expire_space_batch(expire.space_ids[i], now);
+			if (rc < 0)
+				diag_log();
+			fiber_gc();
+		} while (rc == EXPIRE_BATCH_SIZE);
+	}
+}
+
+static int
+expire_fiber_f(va_list ap)
+{
+	(void)ap;
+	while (!fiber_is_cancelled()) {
+		fiber_sleep(EXPIRE_PERIOD);
+		if (box_is_ro())
+			continue;
+		expire_run();
+	}
+	return 0;
+}
+
+void
+expire_init(void)
+{
+	expire.fiber = fiber_new("expire", expire_fiber_f);
+	if (expire.fiber == NULL)
+		panic("failed to start expiration fiber");
+	fiber_start(expire.fiber);
+}
+
+void
+expire_free(void)
+{
+	/*
+	 * The fiber isn't cancelled as the event loop isn't running
+	 * when this function is called.
+	 */
+	free(expire.space_ids);
+	expire.space_ids = NULL;
+	expire.space_count = 0;
+	expire.space_capacity = 0;
+}
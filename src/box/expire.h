@@ -0,0 +1,80 @@
+#ifndef TARANTOOL_BOX_EXPIRE_H_INCLUDED
+#define TARANTOOL_BOX_EXPIRE_H_INCLUDED
+/*
+ * Copyright 2010-2021, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/**
+ * Expiration of tuples of memtx spaces.
+ *
+ * A space may name a field that stores the time, in seconds
+ * since the Epoch, when a tuple expires (the space expire_field
+ * option). Expired tuples are deleted by a background fiber in
+ * small batches with ordinary DELETE requests, which are written
+ * to WAL and replicated as usual.
+ *
+ * The fiber looks expired tuples up in a TREE index whose first
+ * part is the expire field, starting from the current time down,
+ * so the expiration cost is proportional to the number of expired
+ * tuples rather than to the space size. A space without such an
+ * index is not expired. Tuples with the expire field set to null
+ * never expire.
+ *
+ * Expiration only runs on a writable instance. Read-only replicas
+ * receive the deletes from the master.
+ *
+ * Vinyl spaces are not handled by the fiber. Instead expired
+ * tuples are dropped by dump and compaction of the primary index
+ * without writing DELETE statements (see vy_task_set_expire_filter
+ * in vy_scheduler.c) so they remain visible until then, and each
+ * instance expires its data on its own.
+ */
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/**
+ * Start the expiration fiber. Must be called after recovery.
+ */
+void
+expire_init(void);
+
+/**
+ * Free the expiration state.
+ */
+void
+expire_free(void);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_BOX_EXPIRE_H_INCLUDED */
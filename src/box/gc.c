@@ -111,6 +111,7 @@ gc_init(void)
 	rlist_create(&gc.checkpoints);
 	gc_tree_new(&gc.consumers);
 	fiber_cond_create(&gc.cleanup_cond);
+	fiber_cond_create(&gc.checkpoint_cond);
 	checkpoint_schedule_cfg(&gc.checkpoint_schedule, 0, 0);
 	engine_collect_garbage(&gc.vclock);
 
@@ -386,6 +387,15 @@ gc_do_checkpoint(bool is_scheduled)
 	assert(!gc.checkpoint_is_in_progress);
 	gc.checkpoint_is_in_progress = true;
 
+	/* Wait until all checkpoint blocks are released. */
+	while (gc.checkpoint_block_count > 0) {
+		if (fiber_cond_wait(&gc.checkpoint_cond) != 0) {
+			gc.checkpoint_is_in_progress = false;
+			fiber_cond_broadcast(&gc.checkpoint_cond);
+			return -1;
+		}
+	}
+
 	/*
 	 * Rotate WAL and call engine callbacks to create a checkpoint
 	 * on disk for each registered engine.
@@ -429,6 +439,7 @@ out:
 		engine_abort_checkpoint();
 
 	gc.checkpoint_is_in_progress = false;
+	fiber_cond_broadcast(&gc.checkpoint_cond);
 	return rc;
 }
 
@@ -470,6 +481,25 @@ gc_checkpoint(void)
 	return 0;
 }
 
+int
+gc_block_checkpoint(void)
+{
+	while (gc.checkpoint_is_in_progress) {
+		if (fiber_cond_wait(&gc.checkpoint_cond) != 0)
+			return -1;
+	}
+	gc.checkpoint_block_count++;
+	return 0;
+}
+
+void
+gc_unblock_checkpoint(void)
+{
+	assert(gc.checkpoint_block_count > 0);
+	if (--gc.checkpoint_block_count == 0)
+		fiber_cond_broadcast(&gc.checkpoint_cond);
+}
+
 void
 gc_trigger_checkpoint(void)
 {
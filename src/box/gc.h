@@ -151,6 +151,16 @@ struct gc_state {
 	 * Set if there's a fiber making a checkpoint right now.
 	 */
 	bool checkpoint_is_in_progress;
+	/**
+	 * Number of fibers that don't allow to make a checkpoint
+	 * right now, see gc_block_checkpoint().
+	 */
+	int checkpoint_block_count;
+	/**
+	 * Condition variable signaled when a checkpoint completes
+	 * or the last checkpoint block is released.
+	 */
+	struct fiber_cond checkpoint_cond;
 	/**
 	 * If this flag is set, the checkpoint daemon should create
 	 * a checkpoint as soon as possible despite the schedule.
@@ -253,6 +263,25 @@ gc_add_checkpoint(const struct vclock *vclock);
 int
 gc_checkpoint(void);
 
+/**
+ * Don't allow to make a checkpoint until gc_unblock_checkpoint()
+ * is called. Used by operations that change the engine state
+ * before writing the changes to WAL. If a checkpoint is in
+ * progress, wait for it to complete. A checkpoint started while
+ * checkpointing is blocked waits for all blocks to be released.
+ *
+ * Returns 0 on success. On failure (the fiber was cancelled)
+ * returns -1 and sets diag.
+ */
+int
+gc_block_checkpoint(void);
+
+/**
+ * Release a block taken by gc_block_checkpoint().
+ */
+void
+gc_unblock_checkpoint(void);
+
 /**
  * Trigger background checkpointing.
  *
@@ -254,6 +254,49 @@ box_index_get(uint32_t space_id, uint32_t index_id, const char *key,
 	return 0;
 }
 
+int
+box_index_get_many(uint32_t space_id, uint32_t index_id, const char *keys,
+		   const char *keys_end, box_tuple_t **result)
+{
+	assert(keys != NULL && keys_end != NULL && result != NULL);
+	mp_tuple_assert(keys, keys_end);
+	struct space *space;
+	struct index *index;
+	if (check_index(space_id, index_id, &space, &index) != 0)
+		return -1;
+	if (!index->def->opts.is_unique) {
+		diag_set(ClientError, ER_MORE_THAN_ONE_TUPLE);
+		return -1;
+	}
+	uint32_t key_count = mp_decode_array(&keys);
+	const char *key = keys;
+	for (uint32_t i = 0; i < key_count; i++) {
+		if (mp_typeof(*key) != MP_ARRAY) {
+			diag_set(ClientError, ER_ILLEGAL_PARAMS,
+				 "key must be an array");
+			return -1;
+		}
+		uint32_t part_count = mp_decode_array(&key);
+		if (exact_key_validate(index->def->key_def, key, part_count))
+			return -1;
+		for (uint32_t j = 0; j < part_count; j++)
+			mp_next(&key);
+	}
+	/* Start transaction in the engine. */
+	struct txn *txn;
+	struct txn_ro_savepoint svp;
+	if (txn_begin_ro_stmt(space, &txn, &svp) != 0)
+		return -1;
+	if (index_get_many(index, keys, key_count, result) != 0) {
+		txn_rollback_stmt(txn);
+		return -1;
+	}
+	txn_commit_ro_stmt(txn, &svp);
+	/* Count statistics. */
+	rmean_collect(rmean_box, IPROTO_SELECT, key_count);
+	return 0;
+}
+
 int
 box_index_min(uint32_t space_id, uint32_t index_id, const char *key,
 	      const char *key_end, box_tuple_t **result)
@@ -495,6 +538,7 @@ index_create(struct index *index, struct engine *engine,
 	index->def = def;
 	index->refs = 1;
 	index->space_cache_version = space_cache_version;
+	index->tx_range_set = NULL;
 	return 0;
 }
 
@@ -550,8 +594,7 @@ index_build(struct index *index, struct index *pk)
 	if (rc != 0)
 		return -1;
 
-	index_end_build(index);
-	return 0;
+	return index_end_build(index);
 }
 
 struct tuple *
@@ -690,6 +733,28 @@ generic_index_get(struct index *index, const char *key,
 	return -1;
 }
 
+int
+generic_index_get_many(struct index *index, const char *keys,
+		       uint32_t key_count, struct tuple **result)
+{
+	const char *key = keys;
+	for (uint32_t i = 0; i < key_count; i++) {
+		uint32_t part_count = mp_decode_array(&key);
+		if (index_get(index, key, part_count, &result[i]) != 0) {
+			for (uint32_t j = 0; j < i; j++) {
+				if (result[j] != NULL)
+					tuple_unref(result[j]);
+			}
+			return -1;
+		}
+		if (result[i] != NULL)
+			tuple_ref(result[i]);
+		for (uint32_t j = 0; j < part_count; j++)
+			mp_next(&key);
+	}
+	return 0;
+}
+
 int
 generic_index_replace(struct index *index, struct tuple *old_tuple,
 		      struct tuple *new_tuple, enum dup_replace_mode mode,
@@ -712,6 +777,29 @@ generic_index_create_iterator(struct index *base, enum iterator_type type,
 	return NULL;
 }
 
+struct iterator *
+generic_index_create_iterator_with_offset(struct index *index,
+					  enum iterator_type type,
+					  const char *key, uint32_t part_count,
+					  uint32_t offset)
+{
+	struct iterator *it = index_create_iterator(index, type,
+						    key, part_count);
+	if (it == NULL)
+		return NULL;
+	struct tuple *tuple;
+	while (offset > 0) {
+		if (iterator_next(it, &tuple) != 0) {
+			iterator_delete(it);
+			return NULL;
+		}
+		if (tuple == NULL)
+			break;
+		offset--;
+	}
+	return it;
+}
+
 
 struct snapshot_iterator *
 generic_index_create_snapshot_iterator(struct index *index)
@@ -765,9 +853,10 @@ generic_index_build_next(struct index *index, struct tuple *tuple)
 	return index_replace(index, NULL, tuple, DUP_INSERT, &unused);
 }
 
-void
+int
 generic_index_end_build(struct index *)
 {
+	return 0;
 }
 
 int
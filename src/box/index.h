@@ -45,6 +45,7 @@ struct index;
 struct index_def;
 struct key_def;
 struct info_handler;
+struct memtx_tx_range_set;
 
 typedef struct tuple box_tuple_t;
 typedef struct key_def box_key_def_t;
@@ -147,6 +148,32 @@ int
 box_index_get(uint32_t space_id, uint32_t index_id, const char *key,
 	      const char *key_end, box_tuple_t **result);
 
+/**
+ * Get tuples from index by a batch of keys.
+ *
+ * The keys are looked up at once, which lets the engine read
+ * them in parallel. This is much faster than calling
+ * box_index_get() for each key if the data is on disk.
+ *
+ * \param space_id space identifier
+ * \param index_id index identifier
+ * \param keys encoded keys in MsgPack Array format
+ * ([[part1, part2, ...], [part1, part2, ...], ...]).
+ * \param keys_end the end of encoded \a keys
+ * \param[out] result array of tuples, result[i] is the tuple
+ * matching the i-th key or NULL if there's no such tuple;
+ * must have room for as many tuples as there are keys;
+ * returned tuples must be unreferenced with box_tuple_unref()
+ * after usage
+ * \retval -1 on error (check box_error_last())
+ * \retval 0 on success
+ * \pre keys != NULL
+ * \sa \code box.space[space_id].index[index_id]:get_many(keys) \endcode
+ */
+int
+box_index_get_many(uint32_t space_id, uint32_t index_id, const char *keys,
+		   const char *keys_end, box_tuple_t **result);
+
 /**
  * Return a first (minimal) tuple matched the provided key.
  *
@@ -413,6 +440,15 @@ struct index_vtab {
 			 const char *key, uint32_t part_count);
 	int (*get)(struct index *index, const char *key,
 		   uint32_t part_count, struct tuple **result);
+	/**
+	 * Look up tuples by @a key_count full keys stored one
+	 * after another in @a keys, each encoded as a MsgPack
+	 * array. The tuple matching the i-th key is stored in
+	 * result[i] (NULL if there's none) with its reference
+	 * counter incremented.
+	 */
+	int (*get_many)(struct index *index, const char *keys,
+			uint32_t key_count, struct tuple **result);
 	int (*replace)(struct index *index, struct tuple *old_tuple,
 		       struct tuple *new_tuple, enum dup_replace_mode mode,
 		       struct tuple **result);
@@ -420,6 +456,13 @@ struct index_vtab {
 	struct iterator *(*create_iterator)(struct index *index,
 			enum iterator_type type,
 			const char *key, uint32_t part_count);
+	/**
+	 * Create an index iterator positioned after the first
+	 * @a offset tuples the iterator would return otherwise.
+	 */
+	struct iterator *(*create_iterator_with_offset)(struct index *index,
+			enum iterator_type type, const char *key,
+			uint32_t part_count, uint32_t offset);
 	/**
 	 * Create an ALL iterator with personal read view so further
 	 * index modifications will not affect the iteration results.
@@ -446,7 +489,7 @@ struct index_vtab {
 	 */
 	int (*reserve)(struct index *index, uint32_t size_hint);
 	int (*build_next)(struct index *index, struct tuple *tuple);
-	void (*end_build)(struct index *index);
+	int (*end_build)(struct index *index);
 };
 
 struct index {
@@ -460,6 +503,12 @@ struct index {
 	int refs;
 	/* Space cache version at the time of construction. */
 	uint32_t space_cache_version;
+	/**
+	 * Ranges of this index read by in-progress transactions,
+	 * maintained by memtx transaction manager. NULL until the
+	 * first range is tracked. See memtx_tx_track_range().
+	 */
+	struct memtx_tx_range_set *tx_range_set;
 };
 
 /**
@@ -623,6 +672,13 @@ index_get(struct index *index, const char *key,
 	return index->vtab->get(index, key, part_count, result);
 }
 
+static inline int
+index_get_many(struct index *index, const char *keys,
+	       uint32_t key_count, struct tuple **result)
+{
+	return index->vtab->get_many(index, keys, key_count, result);
+}
+
 /**
  * Get tuple to be inserted in index, based on index-specific constraints
  * (current constraint: if exclude_null = true, return NULL)
@@ -662,6 +718,15 @@ index_create_iterator(struct index *index, enum iterator_type type,
 	return index->vtab->create_iterator(index, type, key, part_count);
 }
 
+static inline struct iterator *
+index_create_iterator_with_offset(struct index *index, enum iterator_type type,
+				  const char *key, uint32_t part_count,
+				  uint32_t offset)
+{
+	return index->vtab->create_iterator_with_offset(index, type, key,
+							part_count, offset);
+}
+
 static inline struct snapshot_iterator *
 index_create_snapshot_iterator(struct index *index)
 {
@@ -704,10 +769,10 @@ index_build_next(struct index *index, struct tuple *tuple)
 	return index->vtab->build_next(index, tuple);
 }
 
-static inline void
+static inline int
 index_end_build(struct index *index)
 {
-	index->vtab->end_build(index);
+	return index->vtab->end_build(index);
 }
 
 /*
@@ -729,6 +794,8 @@ int generic_index_random(struct index *, uint32_t, struct tuple **);
 ssize_t generic_index_count(struct index *, enum iterator_type,
 			    const char *, uint32_t);
 int generic_index_get(struct index *, const char *, uint32_t, struct tuple **);
+int generic_index_get_many(struct index *, const char *, uint32_t,
+			   struct tuple **);
 int generic_index_replace(struct index *, struct tuple *, struct tuple *,
 			  enum dup_replace_mode, struct tuple **);
 struct snapshot_iterator *generic_index_create_snapshot_iterator(struct index *);
@@ -740,8 +807,13 @@ int generic_index_reserve(struct index *, uint32_t);
 struct iterator *
 generic_index_create_iterator(struct index *base, enum iterator_type type,
 			      const char *key, uint32_t part_count);
+struct iterator *
+generic_index_create_iterator_with_offset(struct index *index,
+					  enum iterator_type type,
+					  const char *key, uint32_t part_count,
+					  uint32_t offset);
 int generic_index_build_next(struct index *, struct tuple *);
-void generic_index_end_build(struct index *);
+int generic_index_end_build(struct index *);
 int
 disabled_index_build_next(struct index *index, struct tuple *tuple);
 int
@@ -39,6 +39,8 @@ const char *index_type_strs[] = { "HASH", "TREE", "BITSET", "RTREE" };
 
 const char *rtree_index_distance_type_strs[] = { "EUCLID", "MANHATTAN" };
 
+const char *compaction_strategy_strs[] = { "TIERED", "LEVELED" };
+
 const struct index_opts index_opts_default = {
 	/* .unique              = */ true,
 	/* .dimension           = */ 2,
@@ -47,11 +49,14 @@ const struct index_opts index_opts_default = {
 	/* .page_size           = */ 8192,
 	/* .run_count_per_level = */ 2,
 	/* .run_size_ratio      = */ 3.5,
+	/* .compaction_strategy = */ COMPACTION_STRATEGY_TIERED,
+	/* .value_log_threshold = */ 0,
 	/* .bloom_fpr           = */ 0.05,
 	/* .lsn                 = */ 0,
 	/* .stat                = */ NULL,
 	/* .func                = */ 0,
 	/* .hint                = */ true,
+	/* .hash_func           = */ KEY_HASH_MURMUR3,
 };
 
 const struct opt_def index_opts_reg[] = {
@@ -63,11 +68,17 @@ const struct opt_def index_opts_reg[] = {
 	OPT_DEF("page_size", OPT_INT64, struct index_opts, page_size),
 	OPT_DEF("run_count_per_level", OPT_INT64, struct index_opts, run_count_per_level),
 	OPT_DEF("run_size_ratio", OPT_FLOAT, struct index_opts, run_size_ratio),
+	OPT_DEF_ENUM("compaction_strategy", compaction_strategy,
+		     struct index_opts, compaction_strategy, NULL),
+	OPT_DEF("value_log_threshold", OPT_UINT32, struct index_opts,
+		value_log_threshold),
 	OPT_DEF("bloom_fpr", OPT_FLOAT, struct index_opts, bloom_fpr),
 	OPT_DEF("lsn", OPT_INT64, struct index_opts, lsn),
 	OPT_DEF("func", OPT_UINT32, struct index_opts, func_id),
 	OPT_DEF_LEGACY("sql"),
 	OPT_DEF("hint", OPT_BOOL, struct index_opts, hint),
+	OPT_DEF_ENUM("hash_func", key_hash_func, struct index_opts,
+		     hash_func, NULL),
 	OPT_END,
 };
 
@@ -111,6 +122,10 @@ index_def_new(uint32_t space_id, uint32_t iid, const char *name,
 		index_def_delete(def);
 		return NULL;
 	}
+	if (opts->hash_func != KEY_HASH_MURMUR3) {
+		key_def_update_hash_func(def->key_def, opts->hash_func);
+		key_def_update_hash_func(def->cmp_def, opts->hash_func);
+	}
 	def->type = type;
 	def->space_id = space_id;
 	def->iid = iid;
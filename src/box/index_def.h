@@ -58,6 +58,23 @@ enum rtree_index_distance_type {
 };
 extern const char *rtree_index_distance_type_strs[];
 
+/** Vinyl compaction strategy. */
+enum compaction_strategy {
+	/**
+	 * Up to run_count_per_level runs are accumulated at each
+	 * level before they are compacted and moved to the next one.
+	 */
+	COMPACTION_STRATEGY_TIERED,
+	/**
+	 * Each level except the first one stores a single run,
+	 * which is merged into the next level as soon as it gets
+	 * bigger than 1/run_size_ratio of it.
+	 */
+	COMPACTION_STRATEGY_LEVELED,
+	compaction_strategy_MAX
+};
+extern const char *compaction_strategy_strs[];
+
 /** Simple alias to represent logarithm metrics. */
 typedef int16_t log_est_t;
 
@@ -151,6 +168,15 @@ struct index_opts {
 	 * previous one.
 	 */
 	double run_size_ratio;
+	/** Vinyl compaction strategy. */
+	enum compaction_strategy compaction_strategy;
+	/**
+	 * Min size of a non-indexed field of a vinyl primary
+	 * index tuple to store it in a value file rather than
+	 * in a run, see vy_value_log.h. 0 disables key-value
+	 * separation.
+	 */
+	uint32_t value_log_threshold;
 	/* Bloom filter false positive rate. */
 	double bloom_fpr;
 	/**
@@ -169,6 +195,11 @@ struct index_opts {
 	 * Use hint optimization for tree index.
 	 */
 	bool hint;
+	/**
+	 * Function used for hashing keys in a hash index and
+	 * in vinyl bloom filters.
+	 */
+	enum key_hash_func hash_func;
 };
 
 extern const struct index_opts index_opts_default;
@@ -211,12 +242,19 @@ index_opts_cmp(const struct index_opts *o1, const struct index_opts *o2)
 		       -1 : 1;
 	if (o1->run_size_ratio != o2->run_size_ratio)
 		return o1->run_size_ratio < o2->run_size_ratio ? -1 : 1;
+	if (o1->compaction_strategy != o2->compaction_strategy)
+		return o1->compaction_strategy - o2->compaction_strategy;
+	if (o1->value_log_threshold != o2->value_log_threshold)
+		return o1->value_log_threshold < o2->value_log_threshold ?
+		       -1 : 1;
 	if (o1->bloom_fpr != o2->bloom_fpr)
 		return o1->bloom_fpr < o2->bloom_fpr ? -1 : 1;
 	if (o1->func_id != o2->func_id)
 		return o1->func_id - o2->func_id;
 	if (o1->hint != o2->hint)
 		return o1->hint - o2->hint;
+	if (o1->hash_func != o2->hash_func)
+		return o1->hash_func - o2->hash_func;
 	return 0;
 }
 
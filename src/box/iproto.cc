@@ -63,6 +63,7 @@
 #include "execute.h"
 #include "errinj.h"
 #include "tt_static.h"
+#include "read_pool.h"
 
 enum {
 	IPROTO_SALT_SIZE = 32,
@@ -200,6 +201,11 @@ struct iproto_msg
 		/** In case of iproto parse error, saved diagnostics. */
 		struct diag diag;
 	};
+	/**
+	 * SELECT executed in a read thread, if the request allows
+	 * a stale read, see read_pool.h. Uses @dml as input.
+	 */
+	struct read_pool_select stale_select;
 	/**
 	 * Input buffer which stores the request data. It can be
 	 * discarded only when the message returns to iproto thread.
@@ -1164,6 +1170,15 @@ tx_process1(struct cmsg *msg);
 static void
 tx_process_select(struct cmsg *msg);
 
+static void
+tx_process_stale_select(struct cmsg *msg);
+
+static void
+read_process_stale_select(struct cmsg *msg);
+
+static void
+tx_end_stale_select(struct cmsg *msg);
+
 static void
 tx_process_sql(struct cmsg *msg);
 
@@ -1203,6 +1218,25 @@ static const struct cmsg_hop select_route[] = {
 	{ net_send_msg, NULL },
 };
 
+/**
+ * A stale SELECT is either sent to a read thread or executed in
+ * tx, so its route is chosen in tx, see tx_process_stale_select().
+ */
+static const struct cmsg_hop stale_select_route[] = {
+	{ tx_process_stale_select, NULL },
+};
+
+/** Route of a stale SELECT that has been executed in tx. */
+static const struct cmsg_hop stale_select_fallback_route[] = {
+	{ net_send_msg, NULL },
+};
+
+/**
+ * Routes of a stale SELECT executed in a read thread, one per
+ * thread. Initialized in iproto_init().
+ */
+static struct cmsg_hop read_select_route[READ_POOL_THREADS_MAX][3];
+
 static const struct cmsg_hop process1_route[] = {
 	{ tx_process1, &net_pipe },
 	{ net_send_msg, NULL },
@@ -1228,6 +1262,7 @@ static const struct cmsg_hop *dml_route[IPROTO_TYPE_STAT_MAX] = {
 	sql_route,                              /* IPROTO_EXECUTE */
 	NULL,                                   /* IPROTO_NOP */
 	sql_route,                              /* IPROTO_PREPARE */
+	NULL,                                   /* IPROTO_DELETE_RANGE */
 };
 
 static const struct cmsg_hop join_route[] = {
@@ -1273,7 +1308,10 @@ iproto_msg_decode(struct iproto_msg *msg, const char **pos, const char *reqend,
 				    dml_request_key_map(type)))
 			goto error;
 		assert(type < sizeof(dml_route)/sizeof(*dml_route));
-		cmsg_init(&msg->base, dml_route[type]);
+		if (type == IPROTO_SELECT && msg->header.is_stale_read)
+			cmsg_init(&msg->base, stale_select_route);
+		else
+			cmsg_init(&msg->base, dml_route[type]);
 		break;
 	case IPROTO_CALL_16:
 	case IPROTO_CALL:
@@ -1289,6 +1327,7 @@ iproto_msg_decode(struct iproto_msg *msg, const char **pos, const char *reqend,
 		cmsg_init(&msg->base, sql_route);
 		break;
 	case IPROTO_PING:
+	case IPROTO_ID:
 		cmsg_init(&msg->base, misc_route);
 		break;
 	case IPROTO_JOIN:
@@ -1553,9 +1592,8 @@ error:
 }
 
 static void
-tx_process_select(struct cmsg *m)
+tx_do_select(struct iproto_msg *msg)
 {
-	struct iproto_msg *msg = tx_accept_msg(m);
 	struct obuf *out;
 	struct obuf_svp svp;
 	struct port port;
@@ -1595,6 +1633,74 @@ error:
 	tx_reply_error(msg);
 }
 
+static void
+tx_process_select(struct cmsg *m)
+{
+	struct iproto_msg *msg = tx_accept_msg(m);
+	tx_do_select(msg);
+}
+
+static void
+tx_process_stale_select(struct cmsg *m)
+{
+	struct iproto_msg *msg = tx_accept_msg(m);
+	struct request *req = &msg->dml;
+	int id = -1;
+	/* Schema mismatch is reported by tx_do_select(). */
+	if (tx_check_schema(msg->header.schema_version) == 0) {
+		id = read_pool_select_prepare(&msg->stale_select,
+					      req->space_id, req->index_id,
+					      req->iterator, req->offset,
+					      req->limit, req->key);
+	}
+	if (id < 0) {
+		tx_do_select(msg);
+		cmsg_init(&msg->base, stale_select_fallback_route);
+		cpipe_push(&net_pipe, &msg->base);
+		return;
+	}
+	cmsg_init(&msg->base, read_select_route[id]);
+	cpipe_push(read_pool_thread_pipe(id), &msg->base);
+}
+
+static void
+read_process_stale_select(struct cmsg *m)
+{
+	struct iproto_msg *msg = (struct iproto_msg *) m;
+	read_pool_select_execute(&msg->stale_select);
+}
+
+static void
+tx_end_stale_select(struct cmsg *m)
+{
+	/*
+	 * Don't accept the write position again: it was accepted
+	 * in tx_process_stale_select() and other requests of the
+	 * connection may have been processed since then.
+	 */
+	struct iproto_msg *msg = (struct iproto_msg *) m;
+	struct read_pool_select *select = &msg->stale_select;
+	struct obuf *out = msg->connection->tx.p_obuf;
+	struct obuf_svp svp;
+	if (read_pool_select_complete(select) != 0)
+		goto error;
+	if (iproto_prepare_select(out, &svp) != 0)
+		goto error;
+	if (obuf_dup(out, select->data, select->size) != select->size) {
+		diag_set(OutOfMemory, select->size, "obuf_dup", "data");
+		obuf_rollback_to_svp(out, &svp);
+		goto error;
+	}
+	iproto_reply_select(out, &svp, msg->header.sync,
+			    ::schema_version, select->count);
+	iproto_wpos_create(&msg->wpos, out);
+	read_pool_select_destroy(select);
+	return;
+error:
+	read_pool_select_destroy(select);
+	tx_reply_error(msg);
+}
+
 static int
 tx_process_call_on_yield(struct trigger *trigger, void *event)
 {
@@ -1706,6 +1812,10 @@ tx_process_misc(struct cmsg *m)
 			iproto_reply_ok_xc(out, msg->header.sync,
 					   ::schema_version);
 			break;
+		case IPROTO_ID:
+			iproto_reply_id_xc(out, msg->header.sync,
+					   ::schema_version);
+			break;
 		case IPROTO_VOTE_DEPRECATED:
 			iproto_reply_vclock_xc(out, &replicaset.vclock,
 					       msg->header.sync,
@@ -2196,6 +2306,12 @@ iproto_init(void)
 	/* Create a pipe to "net" thread. */
 	cpipe_create(&net_pipe, "net");
 	cpipe_set_max_input(&net_pipe, iproto_msg_max / 2);
+	for (int i = 0; i < READ_POOL_THREADS_MAX; i++) {
+		struct cmsg_hop *route = read_select_route[i];
+		route[0] = { read_process_stale_select, read_pool_tx_pipe(i) };
+		route[1] = { tx_end_stale_select, &net_pipe };
+		route[2] = { net_send_msg, NULL };
+	}
 	struct session_vtab iproto_session_vtab = {
 		/* .push = */ iproto_session_push,
 		/* .fd = */ iproto_session_fd,
@@ -52,6 +52,28 @@ enum {
 enum {
 	/** Set for the last xrow in a transaction. */
 	IPROTO_FLAG_COMMIT = 0x01,
+	/**
+	 * Set by a client for a SELECT that may be served from
+	 * a slightly stale read view, see memtx_read_threads.
+	 * A client may set it only if the server reported
+	 * IPROTO_FEATURE_STALE_READ in reply to IPROTO_ID.
+	 * Taken from the top of the byte, so that transaction
+	 * flags can grow from the bottom.
+	 */
+	IPROTO_FLAG_STALE_READ = 0x80,
+};
+
+/** Version of the binary protocol reported in reply to IPROTO_ID. */
+enum { IPROTO_CURRENT_VERSION = 1 };
+
+/**
+ * Optional protocol features reported by the server in reply
+ * to IPROTO_ID, in IPROTO_FEATURES.
+ */
+enum iproto_feature_id {
+	/** SELECT requests may be flagged with IPROTO_FLAG_STALE_READ. */
+	IPROTO_FEATURE_STALE_READ = 0,
+	iproto_feature_id_MAX,
 };
 
 enum iproto_key {
@@ -127,6 +149,8 @@ enum iproto_key {
 	IPROTO_REPLICA_ANON = 0x50,
 	IPROTO_ID_FILTER = 0x51,
 	IPROTO_ERROR = 0x52,
+	IPROTO_VERSION = 0x53,
+	IPROTO_FEATURES = 0x54,
 	IPROTO_KEY_MAX
 };
 
@@ -217,6 +241,8 @@ enum iproto_type {
 	IPROTO_NOP = 12,
 	/** Prepare SQL statement. */
 	IPROTO_PREPARE = 13,
+	/** Delete all tuples in a key range. */
+	IPROTO_DELETE_RANGE = 14,
 	/** The maximum typecode used for box.stat() */
 	IPROTO_TYPE_STAT_MAX,
 
@@ -241,6 +267,8 @@ enum iproto_type {
 	IPROTO_FETCH_SNAPSHOT = 69,
 	/** REGISTER request to leave anonymous replication. */
 	IPROTO_REGISTER = 70,
+	/** Protocol version and features request. */
+	IPROTO_ID = 73,
 
 	/** Vinyl run info stored in .index file */
 	VY_INDEX_RUN_INFO = 100,
@@ -276,11 +304,14 @@ static inline const char *
 iproto_type_name(uint32_t type)
 {
 	/*
-	 * Sic: iptoto_type_strs[IPROTO_NOP] is NULL
+	 * Sic: iptoto_type_strs[IPROTO_NOP] and
+	 * iproto_type_strs[IPROTO_DELETE_RANGE] are NULL
 	 * to suppress box.stat() output.
 	 */
 	if (type == IPROTO_NOP)
 		return "NOP";
+	if (type == IPROTO_DELETE_RANGE)
+		return "DELETE_RANGE";
 
 	if (type < IPROTO_TYPE_STAT_MAX)
 		return iproto_type_strs[type];
@@ -319,7 +350,8 @@ static inline bool
 iproto_type_is_dml(uint32_t type)
 {
 	return (type >= IPROTO_SELECT && type <= IPROTO_DELETE) ||
-		type == IPROTO_UPSERT || type == IPROTO_NOP;
+		type == IPROTO_UPSERT || type == IPROTO_NOP ||
+		type == IPROTO_DELETE_RANGE;
 }
 
 /**
@@ -396,6 +428,26 @@ enum vy_run_info_key {
 	VY_RUN_INFO_BLOOM = 7,
 	/** Number of statements of each type (map). */
 	VY_RUN_INFO_STMT_STAT = 8,
+	/**
+	 * Bloom filter for keys hashed with a function other
+	 * than MurmurHash3: [hash function, bloom filter].
+	 * Stored under a separate key so that older versions,
+	 * which can't check it, ignore it.
+	 */
+	VY_RUN_INFO_BLOOM_HASHED = 9,
+	/**
+	 * Bloom filter having register-blocked parts (see enum
+	 * bloom_type): [hash function, bloom filter]. Stored under
+	 * a separate key so that older versions, which can't decode
+	 * it, ignore it.
+	 */
+	VY_RUN_INFO_BLOOM_BLOCKED = 10,
+	/**
+	 * Value files referenced by the run (array of arrays
+	 * [file id, file size, size of referenced values]),
+	 * see vy_value_log.h.
+	 */
+	VY_RUN_INFO_VALUE_FILES = 11,
 	/** The last key in this enum + 1 */
 	VY_RUN_INFO_KEY_MAX
 };
@@ -43,6 +43,8 @@
 
 const char *sort_order_strs[] = { "asc", "desc", "undef" };
 
+const char *key_hash_func_strs[] = { "MURMUR3", "WYHASH" };
+
 const struct key_part_def key_part_def_default = {
 	0,
 	field_type_MAX,
@@ -733,6 +735,14 @@ key_def_update_optionality(struct key_def *def, uint32_t min_field_count)
 	key_def_set_func(def);
 }
 
+void
+key_def_update_hash_func(struct key_def *def, enum key_hash_func hash_func)
+{
+	assert(hash_func < key_hash_func_MAX);
+	def->hash_func = hash_func;
+	key_def_set_hash_func(def);
+}
+
 int
 key_def_snprint_parts(char *buf, int size, const struct key_part_def *parts,
 		      uint32_t part_count)
@@ -1106,6 +1116,7 @@ key_def_merge(const struct key_def *first, const struct key_def *second)
 	new_def->is_multikey = first->is_multikey || second->is_multikey;
 	new_def->for_func_index = first->for_func_index;
 	new_def->func_index_func = first->func_index_func;
+	new_def->hash_func = first->hash_func;
 
 	/* JSON paths data in the new key_def. */
 	char *path_pool = (char *)new_def + key_def_sizeof(new_part_count, 0);
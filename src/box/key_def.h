@@ -52,6 +52,17 @@ enum sort_order {
 	sort_order_MAX
 };
 
+/** Hash function used by tuple_hash() and key_hash(). */
+extern const char *key_hash_func_strs[];
+
+enum key_hash_func {
+	/** 32-bit MurmurHash3, compatible with all versions. */
+	KEY_HASH_MURMUR3 = 0,
+	/** 64-bit wyhash folded to 32 bits. */
+	KEY_HASH_WYHASH,
+	key_hash_func_MAX
+};
+
 struct key_part_def {
 	/** Tuple field index for this part. */
 	uint32_t fieldno;
@@ -77,6 +88,16 @@ struct key_part_def {
 
 extern const struct key_part_def key_part_def_default;
 
+struct coll;
+
+/**
+ * Compare two MessagePack fields of a key part, none of which is
+ * NULL. An implementation is specialized for the part type and
+ * collation presence.
+ */
+typedef int (*key_part_compare_f)(const char *field_a, const char *field_b,
+				  struct coll *coll);
+
 /** Descriptor of a single part in a multipart key. */
 struct key_part {
 	/** Tuple field index for this part */
@@ -116,6 +137,12 @@ struct key_part {
 	 * offset corresponding to the last used tuple format.
 	 */
 	int32_t offset_slot_cache;
+	/**
+	 * Field comparator for this part, selected according to
+	 * the part type and collation by key_def_set_compare_func().
+	 * NULL if the part type is not comparable.
+	 */
+	key_part_compare_f compare;
 };
 
 struct key_def;
@@ -216,6 +243,8 @@ struct key_def {
 	bool has_optional_parts;
 	/** Key fields mask. @sa column_mask.h for details. */
 	uint64_t column_mask;
+	/** Hash function used by tuple_hash() and key_hash(). */
+	enum key_hash_func hash_func;
 	/**
 	 * A pointer to a functional index function.
 	 * Initially set to NULL and is initialized when the
@@ -675,6 +704,13 @@ key_def_dump_parts(const struct key_def *def, struct key_part_def *parts,
 void
 key_def_update_optionality(struct key_def *def, uint32_t min_field_count);
 
+/**
+ * Switch tuple_hash() and key_hash() of @a def to the given
+ * hash function.
+ */
+void
+key_def_update_hash_func(struct key_def *def, enum key_hash_func hash_func);
+
 /**
  * An snprint-style function to print a key definition.
  */
@@ -1025,6 +1061,36 @@ uint32_t
 tuple_hash_key_part(uint32_t *ph1, uint32_t *pcarry, struct tuple *tuple,
 		    struct key_part *part, int multikey_idx);
 
+/**
+ * Same as tuple_hash_field(), but for KEY_HASH_WYHASH.
+ * @param h - running hash
+ * @param field - pointer to field data, advanced past the field
+ * @param coll - collation to use for hashing strings or NULL
+ * @return updated running hash
+ */
+uint64_t
+tuple_hash_field_wyhash(uint64_t h, const char **field, struct coll *coll);
+
+/**
+ * Same as tuple_hash_key_part(), but for KEY_HASH_WYHASH.
+ * @return updated running hash
+ */
+uint64_t
+tuple_hash_key_part_wyhash(uint64_t h, struct tuple *tuple,
+			   struct key_part *part, int multikey_idx);
+
+/** Initial value of the running hash for KEY_HASH_WYHASH. */
+enum { TUPLE_HASH_WYHASH_SEED = 13 };
+
+/**
+ * Fold a KEY_HASH_WYHASH running hash to a 32-bit hash value.
+ */
+static inline uint32_t
+tuple_hash_wyhash_result(uint64_t h)
+{
+	return (uint32_t)(h ^ (h >> 32));
+}
+
 /**
  * Calculates a common hash value for a tuple
  * @param tuple - a tuple
@@ -230,6 +230,28 @@ lbox_cfg_set_vinyl_cache(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_vinyl_page_cache(struct lua_State *L)
+{
+	try {
+		box_set_vinyl_page_cache();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
+static int
+lbox_cfg_set_vinyl_value_cache(struct lua_State *L)
+{
+	try {
+		box_set_vinyl_value_cache();
+	} catch (Exception *) {
+		luaT_error(L);
+	}
+	return 0;
+}
+
 static int
 lbox_cfg_set_vinyl_timeout(struct lua_State *L)
 {
@@ -277,6 +299,30 @@ lbox_cfg_set_election_mode(struct lua_State *L)
 	return 0;
 }
 
+static int
+lbox_cfg_set_memtx_read_view_refresh_interval(struct lua_State *L)
+{
+	if (box_set_memtx_read_view_refresh_interval() != 0)
+		luaT_error(L);
+	return 0;
+}
+
+static int
+lbox_cfg_set_memtx_tx_gc_batch_size(struct lua_State *L)
+{
+	if (box_set_memtx_tx_gc_batch_size() != 0)
+		luaT_error(L);
+	return 0;
+}
+
+static int
+lbox_cfg_set_memtx_tx_story_memory_limit(struct lua_State *L)
+{
+	if (box_set_memtx_tx_story_memory_limit() != 0)
+		luaT_error(L);
+	return 0;
+}
+
 static int
 lbox_cfg_set_election_timeout(struct lua_State *L)
 {
@@ -395,6 +441,9 @@ box_lua_cfg_init(struct lua_State *L)
 		{"cfg_set_readahead", lbox_cfg_set_readahead},
 		{"cfg_set_io_collect_interval", lbox_cfg_set_io_collect_interval},
 		{"cfg_set_too_long_threshold", lbox_cfg_set_too_long_threshold},
+		{"cfg_set_memtx_read_view_refresh_interval", lbox_cfg_set_memtx_read_view_refresh_interval},
+		{"cfg_set_memtx_tx_gc_batch_size", lbox_cfg_set_memtx_tx_gc_batch_size},
+		{"cfg_set_memtx_tx_story_memory_limit", lbox_cfg_set_memtx_tx_story_memory_limit},
 		{"cfg_set_snap_io_rate_limit", lbox_cfg_set_snap_io_rate_limit},
 		{"cfg_set_checkpoint_count", lbox_cfg_set_checkpoint_count},
 		{"cfg_set_checkpoint_interval", lbox_cfg_set_checkpoint_interval},
@@ -405,6 +454,8 @@ box_lua_cfg_init(struct lua_State *L)
 		{"cfg_set_vinyl_memory", lbox_cfg_set_vinyl_memory},
 		{"cfg_set_vinyl_max_tuple_size", lbox_cfg_set_vinyl_max_tuple_size},
 		{"cfg_set_vinyl_cache", lbox_cfg_set_vinyl_cache},
+		{"cfg_set_vinyl_page_cache", lbox_cfg_set_vinyl_page_cache},
+		{"cfg_set_vinyl_value_cache", lbox_cfg_set_vinyl_value_cache},
 		{"cfg_set_vinyl_timeout", lbox_cfg_set_vinyl_timeout},
 		{"cfg_set_election_mode", lbox_cfg_set_election_mode},
 		{"cfg_set_election_timeout", lbox_cfg_set_election_timeout},
@@ -36,6 +36,8 @@
 #include "box/index.h"
 #include "box/lua/tuple.h"
 #include "box/lua/misc.h" /* lbox_encode_tuple_on_gc() */
+#include "fiber.h"
+#include "msgpuck.h"
 
 /** {{{ box.index Lua library: access to spaces and indexes
  */
@@ -135,6 +137,27 @@ lbox_index_delete(lua_State *L)
 	return luaT_pushtupleornil(L, result);
 }
 
+static int
+lbox_index_delete_range(lua_State *L)
+{
+	if (lua_gettop(L) != 4 || !lua_isnumber(L, 1) || !lua_isnumber(L, 2) ||
+	    (lua_type(L, 3) != LUA_TTABLE && luaT_istuple(L, 3) == NULL) ||
+	    (lua_type(L, 4) != LUA_TTABLE && luaT_istuple(L, 4) == NULL))
+		return luaL_error(L, "Usage index:delete_range(begin, end)");
+
+	uint32_t space_id = lua_tonumber(L, 1);
+	uint32_t index_id = lua_tonumber(L, 2);
+	size_t begin_len;
+	const char *begin = lbox_encode_tuple_on_gc(L, 3, &begin_len);
+	size_t end_len;
+	const char *end = lbox_encode_tuple_on_gc(L, 4, &end_len);
+
+	if (box_delete_range(space_id, index_id, begin, begin + begin_len,
+			     end, end + end_len) != 0)
+		return luaT_error(L);
+	return 0;
+}
+
 static int
 lbox_index_random(lua_State *L)
 {
@@ -169,6 +192,43 @@ lbox_index_get(lua_State *L)
 	return luaT_pushtupleornil(L, tuple);
 }
 
+static int
+lbox_index_get_many(lua_State *L)
+{
+	if (lua_gettop(L) != 3 || !lua_isnumber(L, 1) || !lua_isnumber(L, 2) ||
+	    !lua_istable(L, 3))
+		return luaL_error(L, "Usage index.get_many(space_id, index_id, "
+				  "keys)");
+
+	uint32_t space_id = lua_tonumber(L, 1);
+	uint32_t index_id = lua_tonumber(L, 2);
+	size_t keys_len;
+	const char *keys = lbox_encode_tuple_on_gc(L, 3, &keys_len);
+	const char *pos = keys;
+	uint32_t key_count = mp_decode_array(&pos);
+
+	size_t size;
+	struct tuple **result = region_alloc_array(&fiber()->gc,
+						   typeof(result[0]),
+						   key_count, &size);
+	if (result == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "result");
+		return luaT_error(L);
+	}
+	if (box_index_get_many(space_id, index_id, keys, keys + keys_len,
+			       result) != 0)
+		return luaT_error(L);
+	lua_createtable(L, key_count, 0);
+	for (uint32_t i = 0; i < key_count; i++) {
+		if (result[i] == NULL)
+			continue;
+		luaT_pushtuple(L, result[i]);
+		box_tuple_unref(result[i]);
+		lua_rawseti(L, -2, i + 1);
+	}
+	return 1;
+}
+
 static int
 lbox_index_min(lua_State *L)
 {
@@ -355,8 +415,10 @@ box_lua_index_init(struct lua_State *L)
 		{"update", lbox_index_update},
 		{"upsert",  lbox_upsert},
 		{"delete",  lbox_index_delete},
+		{"delete_range", lbox_index_delete_range},
 		{"random", lbox_index_random},
 		{"get",  lbox_index_get},
+		{"get_many", lbox_index_get_many},
 		{"min", lbox_index_min},
 		{"max", lbox_index_max},
 		{"count", lbox_index_count},
@@ -382,7 +382,7 @@ lbox_info_memory_call(struct lua_State *L)
 	struct engine_memory_stat stat;
 	engine_memory_stat(&stat);
 
-	lua_createtable(L, 0, 6);
+	lua_createtable(L, 0, 7);
 
 	lua_pushstring(L, "data");
 	luaL_pushuint64(L, stat.data);
@@ -400,6 +400,10 @@ lbox_info_memory_call(struct lua_State *L)
 	luaL_pushuint64(L, stat.tx);
 	lua_settable(L, -3);
 
+	lua_pushstring(L, "read_view");
+	luaL_pushuint64(L, stat.read_view);
+	lua_settable(L, -3);
+
 	lua_pushstring(L, "net");
 	luaL_pushuint64(L, iproto_mem_used());
 	lua_settable(L, -3);
@@ -53,6 +53,7 @@
 #include "box/lua/sequence.h"
 #include "box/lua/misc.h"
 #include "box/lua/stat.h"
+#include "box/lua/read_view.h"
 #include "box/lua/info.h"
 #include "box/lua/ctl.h"
 #include "box/lua/session.h"
@@ -472,6 +473,7 @@ box_lua_init(struct lua_State *L)
 	box_lua_misc_init(L);
 	box_lua_info_init(L);
 	box_lua_stat_init(L);
+	box_lua_read_view_init(L);
 	box_lua_ctl_init(L);
 	box_lua_session_init(L);
 	box_lua_xlog_init(L);
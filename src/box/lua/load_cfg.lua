@@ -42,6 +42,10 @@ local default_cfg = {
     strip_core          = true,
     memtx_min_tuple_size = 16,
     memtx_max_tuple_size = 1024 * 1024,
+    memtx_read_threads  = 0,
+    memtx_read_view_refresh_interval = 1,
+    memtx_tx_gc_batch_size = 100,
+    memtx_tx_story_memory_limit = 0,
     slab_alloc_factor   = 1.05,
     work_dir            = nil,
     memtx_dir           = ".",
@@ -50,6 +54,8 @@ local default_cfg = {
     vinyl_dir           = '.',
     vinyl_memory        = 128 * 1024 * 1024,
     vinyl_cache         = 128 * 1024 * 1024,
+    vinyl_page_cache    = 0,
+    vinyl_value_cache   = 0,
     vinyl_max_tuple_size = 1024 * 1024,
     vinyl_read_threads  = 1,
     vinyl_write_threads = 4,
@@ -123,6 +129,10 @@ local template_cfg = {
     strip_core          = 'boolean',
     memtx_min_tuple_size  = 'number',
     memtx_max_tuple_size  = 'number',
+    memtx_read_threads  = 'number',
+    memtx_read_view_refresh_interval = 'number',
+    memtx_tx_gc_batch_size = 'number',
+    memtx_tx_story_memory_limit = 'number',
     slab_alloc_factor   = 'number',
     work_dir            = 'string',
     memtx_dir            = 'string',
@@ -130,6 +140,8 @@ local template_cfg = {
     vinyl_dir           = 'string',
     vinyl_memory        = 'number',
     vinyl_cache               = 'number',
+    vinyl_page_cache          = 'number',
+    vinyl_value_cache         = 'number',
     vinyl_max_tuple_size      = 'number',
     vinyl_read_threads        = 'number',
     vinyl_write_threads       = 'number',
@@ -270,9 +282,16 @@ local dynamic_cfg = {
     read_only               = private.cfg_set_read_only,
     memtx_memory            = private.cfg_set_memtx_memory,
     memtx_max_tuple_size    = private.cfg_set_memtx_max_tuple_size,
+    memtx_read_view_refresh_interval =
+        private.cfg_set_memtx_read_view_refresh_interval,
+    memtx_tx_gc_batch_size  = private.cfg_set_memtx_tx_gc_batch_size,
+    memtx_tx_story_memory_limit =
+        private.cfg_set_memtx_tx_story_memory_limit,
     vinyl_memory            = private.cfg_set_vinyl_memory,
     vinyl_max_tuple_size    = private.cfg_set_vinyl_max_tuple_size,
     vinyl_cache             = private.cfg_set_vinyl_cache,
+    vinyl_page_cache        = private.cfg_set_vinyl_page_cache,
+    vinyl_value_cache       = private.cfg_set_vinyl_value_cache,
     vinyl_timeout           = private.cfg_set_vinyl_timeout,
     checkpoint_count        = private.cfg_set_checkpoint_count,
     checkpoint_interval     = private.cfg_set_checkpoint_interval,
@@ -358,9 +377,12 @@ local dynamic_cfg_skip_at_load = {
     listen                  = true,
     memtx_memory            = true,
     memtx_max_tuple_size    = true,
+    memtx_read_view_refresh_interval = true,
     vinyl_memory            = true,
     vinyl_max_tuple_size    = true,
     vinyl_cache             = true,
+    vinyl_page_cache        = true,
+    vinyl_value_cache       = true,
     vinyl_timeout           = true,
     too_long_threshold      = true,
     election_mode           = true,
@@ -53,7 +53,8 @@
 #define cfg luaL_msgpack_default
 
 static inline size_t
-netbox_prepare_request(lua_State *L, struct mpstream *stream, uint32_t r_type)
+netbox_prepare_request_with_flags(lua_State *L, struct mpstream *stream,
+				  uint32_t r_type, uint64_t flags)
 {
 	struct ibuf *ibuf = (struct ibuf *) lua_topointer(L, 1);
 	uint64_t sync = luaL_touint64(L, 2);
@@ -70,7 +71,7 @@ netbox_prepare_request(lua_State *L, struct mpstream *stream, uint32_t r_type)
 	mpstream_advance(stream, fixheader_size);
 
 	/* encode header */
-	mpstream_encode_map(stream, 2);
+	mpstream_encode_map(stream, flags != 0 ? 3 : 2);
 
 	mpstream_encode_uint(stream, IPROTO_SYNC);
 	mpstream_encode_uint(stream, sync);
@@ -78,10 +79,21 @@ netbox_prepare_request(lua_State *L, struct mpstream *stream, uint32_t r_type)
 	mpstream_encode_uint(stream, IPROTO_REQUEST_TYPE);
 	mpstream_encode_uint(stream, r_type);
 
+	if (flags != 0) {
+		mpstream_encode_uint(stream, IPROTO_FLAGS);
+		mpstream_encode_uint(stream, flags);
+	}
+
 	/* Caller should remember how many bytes was used in ibuf */
 	return used;
 }
 
+static inline size_t
+netbox_prepare_request(lua_State *L, struct mpstream *stream, uint32_t r_type)
+{
+	return netbox_prepare_request_with_flags(L, stream, r_type, 0);
+}
+
 static inline void
 netbox_encode_request(struct mpstream *stream, size_t initial_size)
 {
@@ -120,6 +132,18 @@ netbox_encode_ping(lua_State *L)
 	return 0;
 }
 
+static int
+netbox_encode_id(lua_State *L)
+{
+	if (lua_gettop(L) < 2)
+		return luaL_error(L, "Usage: netbox.encode_id(ibuf, sync)");
+
+	struct mpstream stream;
+	size_t svp = netbox_prepare_request(L, &stream, IPROTO_ID);
+	netbox_encode_request(&stream, svp);
+	return 0;
+}
+
 static int
 netbox_encode_auth(lua_State *L)
 {
@@ -229,11 +253,13 @@ netbox_encode_select(lua_State *L)
 	if (lua_gettop(L) < 8) {
 		return luaL_error(L, "Usage netbox.encode_select(ibuf, sync, "
 				     "space_id, index_id, iterator, offset, "
-				     "limit, key)");
+				     "limit, key[, stale_read])");
 	}
 
+	uint64_t flags = lua_toboolean(L, 9) ? IPROTO_FLAG_STALE_READ : 0;
 	struct mpstream stream;
-	size_t svp = netbox_prepare_request(L, &stream, IPROTO_SELECT);
+	size_t svp = netbox_prepare_request_with_flags(L, &stream,
+						       IPROTO_SELECT, flags);
 
 	mpstream_encode_map(&stream, 6);
 
@@ -900,6 +926,7 @@ luaopen_net_box(struct lua_State *L)
 		{ "encode_upsert",  netbox_encode_upsert },
 		{ "encode_execute", netbox_encode_execute},
 		{ "encode_prepare", netbox_encode_prepare},
+		{ "encode_id",      netbox_encode_id },
 		{ "encode_auth",    netbox_encode_auth },
 		{ "decode_greeting",netbox_decode_greeting },
 		{ "communicate",    netbox_communicate },
@@ -24,6 +24,7 @@ local check_space_arg     = box.internal.check_space_arg
 local check_primary_index = box.internal.check_primary_index
 
 local communicate     = internal.communicate
+local encode_id       = internal.encode_id
 local encode_auth     = internal.encode_auth
 local encode_select   = internal.encode_select
 local decode_greeting = internal.decode_greeting
@@ -34,6 +35,11 @@ local VINDEX_ID        = 289
 local VCOLLATION_ID    = 277
 local DEFAULT_CONNECT_TIMEOUT = 10
 
+-- Protocol features reported by the server in reply to IPROTO_ID.
+local IPROTO_FEATURE_NAMES = {
+    [0] = 'stale_read',
+}
+
 local IPROTO_STATUS_KEY    = 0x00
 local IPROTO_ERRNO_MASK    = 0x7FFF
 local IPROTO_SYNC_KEY      = 0x01
@@ -41,6 +47,7 @@ local IPROTO_SCHEMA_VERSION_KEY = 0x05
 local IPROTO_DATA_KEY      = 0x30
 local IPROTO_ERROR_24      = 0x31
 local IPROTO_ERROR         = 0x52
+local IPROTO_FEATURES_KEY  = 0x54
 local IPROTO_GREETING_SIZE = 128
 local IPROTO_CHUNK_KEY     = 128
 local IPROTO_OK_KEY        = 0
@@ -250,6 +257,7 @@ local function on_push_sync_default() end
 --
 --  'state_changed', state, error
 --  'handshake', greeting -> nil (accept) / errno, error (reject)
+--  'did_fetch_features', features
 --  'will_fetch_schema'   -> true (approve) / false (skip fetch)
 --  'did_fetch_schema', schema_version, spaces, indices
 --  'reconnect_timeout'   -> get reconnect timeout if set and > 0,
@@ -728,7 +736,8 @@ local function create_transport(host, port, user, password, callback,
     -- tail-recursive calls to each other. Yep, Lua optimizes
     -- such calls, and yep, this is the canonical way to implement
     -- a state machine in Lua.
-    local console_sm, iproto_auth_sm, iproto_schema_sm, iproto_sm, error_sm
+    local console_sm, iproto_id_sm, iproto_auth_sm, iproto_schema_sm
+    local iproto_sm, error_sm
 
     --
     -- Protocol_sm is a core function of netbox. It calls all
@@ -761,7 +770,7 @@ local function create_transport(host, port, user, password, callback,
             set_state('active')
             return console_sm(rid)
         elseif greeting.protocol == 'Binary' then
-            return iproto_auth_sm(greeting.salt)
+            return iproto_id_sm(greeting.salt)
         else
             return error_sm(E_NO_CONNECTION,
                             'Unknown protocol: '..greeting.protocol)
@@ -785,6 +794,31 @@ local function create_transport(host, port, user, password, callback,
         end
     end
 
+    --
+    -- Ask the server which protocol features it supports.
+    -- Servers that don't know IPROTO_ID reply with an error,
+    -- which means that they support none.
+    --
+    iproto_id_sm = function(salt)
+        encode_id(send_buf, new_request_id())
+        local err, hdr, body_rpos = send_and_recv_iproto()
+        if err then
+            return error_sm(err, hdr)
+        end
+        local features = {}
+        if hdr[IPROTO_STATUS_KEY] == 0 then
+            local body = decode(body_rpos)
+            for _, id in ipairs(body[IPROTO_FEATURES_KEY] or {}) do
+                local name = IPROTO_FEATURE_NAMES[id]
+                if name ~= nil then
+                    features[name] = true
+                end
+            end
+        end
+        callback('did_fetch_features', features)
+        return iproto_auth_sm(salt)
+    end
+
     iproto_auth_sm = function(salt)
         set_state('auth')
         if not user or not password then
@@ -1029,6 +1063,8 @@ local function new_sm(host, port, opts, connection, greeting)
             remote.protocol = greeting.protocol
             remote.peer_uuid = greeting.uuid
             remote.peer_version_id = greeting.version_id
+        elseif what == 'did_fetch_features' then
+            remote.peer_features = ...
         elseif what == 'will_fetch_schema' then
             return not opts.console
         elseif what == 'fetch_connect_timeout' then
@@ -1520,9 +1556,14 @@ index_metatable = function(remote)
         local iterator = check_iterator_type(opts, key_is_nil)
         local offset = tonumber(opts and opts.offset) or 0
         local limit = tonumber(opts and opts.limit) or 0xFFFFFFFF
+        -- Servers that don't know the flag would ignore it or,
+        -- worse, take it for another one.
+        local stale_read = opts and opts.stale_read and
+                           remote.peer_features ~= nil and
+                           remote.peer_features.stale_read or false
         return (remote:_request('select', opts, self.space._format_cdata,
                                 self.space.id, self.id, iterator, offset,
-                                limit, key))
+                                limit, key, stale_read))
     end
 
     function methods:get(key, opts)
@@ -0,0 +1,310 @@
+/*
+ * Copyright 2010-2021, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "box/lua/read_view.h"
+#include "box/lua/tuple.h"
+
+#include <string.h>
+
+#include "lua/utils.h"
+#include "diag.h"
+#include "fiber.h"
+#include "box/errcode.h"
+#include "box/read_view.h"
+#include "box/schema.h"
+#include "box/space.h"
+#include "box/tuple.h"
+
+/** {{{ box.read_view Lua library
+ *
+ * A read view is exposed to Lua as a userdata object that owns
+ * a pointer to struct read_view. The pointer is reset on close,
+ * so a closed read view may still be referenced from Lua.
+ */
+
+static const char *read_viewlib_name = "box.read_view";
+
+static struct read_view **
+lbox_check_read_view_ptr(struct lua_State *L, int idx)
+{
+	return (struct read_view **)luaL_checkudata(L, idx,
+						    read_viewlib_name);
+}
+
+static struct read_view *
+lbox_check_read_view(struct lua_State *L, int idx)
+{
+	struct read_view *rv = *lbox_check_read_view_ptr(L, idx);
+	if (rv == NULL)
+		luaL_error(L, "read view is closed");
+	return rv;
+}
+
+/** Resolve a space name or id at the given stack index. */
+static uint32_t
+lbox_read_view_space_id(struct lua_State *L, int idx)
+{
+	if (lua_type(L, idx) == LUA_TNUMBER)
+		return lua_tointeger(L, idx);
+	if (lua_type(L, idx) != LUA_TSTRING)
+		luaL_error(L, "space name or id expected");
+	const char *name = lua_tostring(L, idx);
+	struct space *space = space_by_name(name);
+	if (space == NULL) {
+		diag_set(ClientError, ER_NO_SUCH_SPACE, name);
+		luaT_error(L);
+	}
+	return space_id(space);
+}
+
+/**
+ * box.read_view.open(spaces[, opts]) - open a read view of the
+ * given spaces. Supported options: name.
+ */
+static int
+lbox_read_view_open(struct lua_State *L)
+{
+	if (lua_gettop(L) < 1 || !lua_istable(L, 1) ||
+	    (!lua_isnoneornil(L, 2) && !lua_istable(L, 2)))
+		return luaL_error(L, "Usage: box.read_view.open(spaces[, opts])");
+	const char *name = "unknown";
+	if (lua_istable(L, 2)) {
+		lua_getfield(L, 2, "name");
+		if (lua_isstring(L, -1))
+			name = lua_tostring(L, -1);
+		else if (!lua_isnil(L, -1))
+			return luaL_error(L, "name must be a string");
+		/* Keep the name on the stack so it isn't collected. */
+	}
+	uint32_t space_count = lua_objlen(L, 1);
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	size_t size;
+	uint32_t *space_ids = region_alloc_array(region, typeof(*space_ids),
+						 space_count, &size);
+	if (space_ids == NULL && space_count > 0) {
+		diag_set(OutOfMemory, size, "region_alloc_array",
+			 "space_ids");
+		return luaT_error(L);
+	}
+	for (uint32_t i = 0; i < space_count; i++) {
+		lua_rawgeti(L, 1, i + 1);
+		space_ids[i] = lbox_read_view_space_id(L, -1);
+		lua_pop(L, 1);
+	}
+	struct read_view **ptr = (struct read_view **)
+		lua_newuserdata(L, sizeof(*ptr));
+	*ptr = NULL;
+	luaL_getmetatable(L, read_viewlib_name);
+	lua_setmetatable(L, -2);
+	*ptr = read_view_open(name, space_ids, space_count);
+	region_truncate(region, region_svp);
+	if (*ptr == NULL)
+		return luaT_error(L);
+	return 1;
+}
+
+/** rv:close() - close a read view. Closing twice is a no-op. */
+static int
+lbox_read_view_close(struct lua_State *L)
+{
+	struct read_view **ptr = lbox_check_read_view_ptr(L, 1);
+	if (*ptr != NULL) {
+		read_view_close(*ptr);
+		*ptr = NULL;
+	}
+	return 0;
+}
+
+/**
+ * Generator of rv:pairs(). The read view is stored in an upvalue,
+ * the space id is passed as the param and the ordinal number of
+ * the last returned tuple as the state.
+ */
+static int
+lbox_read_view_next(struct lua_State *L)
+{
+	struct read_view *rv = lbox_check_read_view(L, lua_upvalueindex(1));
+	uint32_t space_id = lua_tointeger(L, 1);
+	uint64_t n = lua_tointeger(L, 2);
+	struct read_view_space *space = read_view_space_by_id(rv, space_id);
+	assert(space != NULL);
+	const char *data;
+	uint32_t size;
+	if (read_view_space_next(space, &data, &size) != 0)
+		return luaT_error(L);
+	if (data == NULL)
+		return 0;
+	struct tuple *tuple = tuple_new(tuple_format_runtime, data,
+					data + size);
+	if (tuple == NULL)
+		return luaT_error(L);
+	lua_pushinteger(L, n + 1);
+	luaT_pushtuple(L, tuple);
+	return 2;
+}
+
+/**
+ * Find a space of a read view by the name or id at the given
+ * stack index. The name is looked up in the read view rather
+ * than in the schema, because the space may have been dropped
+ * or renamed since the read view was opened.
+ */
+static struct read_view_space *
+lbox_read_view_check_space(struct lua_State *L, struct read_view *rv,
+			   int idx)
+{
+	if (lua_type(L, idx) == LUA_TNUMBER) {
+		struct read_view_space *space =
+			read_view_space_by_id(rv, lua_tointeger(L, idx));
+		if (space != NULL)
+			return space;
+	} else if (lua_type(L, idx) == LUA_TSTRING) {
+		const char *name = lua_tostring(L, idx);
+		for (uint32_t i = 0; i < rv->space_count; i++) {
+			if (strcmp(rv->spaces[i].name, name) == 0)
+				return &rv->spaces[i];
+		}
+	} else {
+		luaL_error(L, "space name or id expected");
+	}
+	luaL_error(L, "space '%s' is not in the read view",
+		   lua_tostring(L, idx));
+	return NULL;
+}
+
+/**
+ * rv:pairs(space) - iterate over a frozen space in the order of
+ * its primary index. Each space may be iterated only once.
+ */
+static int
+lbox_read_view_pairs(struct lua_State *L)
+{
+	if (lua_gettop(L) != 2)
+		return luaL_error(L, "Usage: read_view:pairs(space)");
+	struct read_view *rv = lbox_check_read_view(L, 1);
+	struct read_view_space *space = lbox_read_view_check_space(L, rv, 2);
+	if (space->row_count > 0 || space->is_exhausted)
+		return luaL_error(L, "space '%s' has already been iterated",
+				  space->name);
+	lua_pushvalue(L, 1);
+	lua_pushcclosure(L, lbox_read_view_next, 1);
+	lua_pushinteger(L, space->id);
+	lua_pushinteger(L, 0);
+	return 3;
+}
+
+static void
+lbox_read_view_push_info(struct lua_State *L, struct read_view *rv)
+{
+	lua_createtable(L, 0, 4);
+	luaL_pushuint64(L, rv->id);
+	lua_setfield(L, -2, "id");
+	lua_pushstring(L, rv->name);
+	lua_setfield(L, -2, "name");
+	lua_pushnumber(L, ev_monotonic_now(loop()) - rv->open_time);
+	lua_setfield(L, -2, "age");
+	lua_createtable(L, 0, rv->space_count);
+	for (uint32_t i = 0; i < rv->space_count; i++) {
+		struct read_view_space *space = &rv->spaces[i];
+		lua_createtable(L, 0, 3);
+		lua_pushinteger(L, space->id);
+		lua_setfield(L, -2, "id");
+		luaL_pushuint64(L, space->row_count);
+		lua_setfield(L, -2, "rows");
+		lua_pushboolean(L, space->is_exhausted);
+		lua_setfield(L, -2, "done");
+		lua_setfield(L, -2, space->name);
+	}
+	lua_setfield(L, -2, "spaces");
+}
+
+/** rv:info() - statistics of a read view. */
+static int
+lbox_read_view_info(struct lua_State *L)
+{
+	struct read_view *rv = lbox_check_read_view(L, 1);
+	lbox_read_view_push_info(L, rv);
+	return 1;
+}
+
+/**
+ * box.read_view.list() - statistics of all open read views,
+ * oldest first. The memory pinned by them is reported by
+ * box.info.memory().read_view.
+ */
+static int
+lbox_read_view_list(struct lua_State *L)
+{
+	lua_newtable(L);
+	int i = 1;
+	struct read_view *rv;
+	rlist_foreach_entry(rv, &read_views, in_all) {
+		lbox_read_view_push_info(L, rv);
+		lua_rawseti(L, -2, i++);
+	}
+	return 1;
+}
+
+static int
+lbox_read_view_tostring(struct lua_State *L)
+{
+	struct read_view *rv = *lbox_check_read_view_ptr(L, 1);
+	if (rv == NULL)
+		lua_pushliteral(L, "read view (closed)");
+	else
+		lua_pushfstring(L, "read view '%s'", rv->name);
+	return 1;
+}
+
+static const struct luaL_Reg lbox_read_view_meta[] = {
+	{"__gc", lbox_read_view_close},
+	{"__tostring", lbox_read_view_tostring},
+	{"close", lbox_read_view_close},
+	{"pairs", lbox_read_view_pairs},
+	{"info", lbox_read_view_info},
+	{NULL, NULL}
+};
+
+static const struct luaL_Reg lbox_read_viewlib[] = {
+	{"open", lbox_read_view_open},
+	{"list", lbox_read_view_list},
+	{NULL, NULL}
+};
+
+/* }}} */
+
+void
+box_lua_read_view_init(struct lua_State *L)
+{
+	luaL_register_type(L, read_viewlib_name, lbox_read_view_meta);
+	luaL_register_module(L, read_viewlib_name, lbox_read_viewlib);
+	lua_pop(L, 1);
+}
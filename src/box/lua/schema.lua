@@ -399,6 +399,29 @@ local function update_format(format)
     return result
 end
 
+--
+-- Convert the expire_field option, which is a field name or
+-- a 1-based field number, to a 0-based field number.
+--
+local function expire_field_resolve(expire_field, format)
+    if type(expire_field) == 'string' then
+        for i, field in ipairs(format) do
+            if field.name == expire_field then
+                return i - 1
+            end
+        end
+        box.error(box.error.ILLEGAL_PARAMS,
+                  "options parameter 'expire_field': field '" ..
+                  expire_field .. "' was not found in the space format")
+    end
+    if expire_field < 1 or expire_field % 1 ~= 0 then
+        box.error(box.error.ILLEGAL_PARAMS,
+                  "options parameter 'expire_field' should be a " ..
+                  "positive integer")
+    end
+    return expire_field - 1
+end
+
 box.schema.space = {}
 box.schema.space.create = function(name, options)
     check_param(name, 'name', 'string')
@@ -412,6 +435,8 @@ box.schema.space.create = function(name, options)
         is_local = 'boolean',
         temporary = 'boolean',
         is_sync = 'boolean',
+        expire_field = 'number, string',
+        full_field_map = 'boolean',
     }
     local options_defaults = {
         engine = 'memtx',
@@ -453,10 +478,16 @@ box.schema.space.create = function(name, options)
     check_param(format, 'format', 'table')
     format = update_format(format)
     -- filter out global parameters from the options array
+    local expire_field
+    if options.expire_field ~= nil then
+        expire_field = expire_field_resolve(options.expire_field, format)
+    end
     local space_options = setmap({
         group_id = options.is_local and 1 or nil,
         temporary = options.temporary and true or nil,
-        is_sync = options.is_sync
+        is_sync = options.is_sync,
+        expire_field = expire_field,
+        full_field_map = options.full_field_map,
     })
     _space:insert{id, uid, name, options.engine, options.field_count,
         space_options, format}
@@ -545,6 +576,8 @@ local alter_space_template = {
     format = 'table',
     temporary = 'boolean',
     is_sync = 'boolean',
+    expire_field = 'number, string, boolean',
+    full_field_map = 'boolean',
     name = 'string',
 }
 
@@ -581,6 +614,10 @@ box.schema.space.alter = function(space_id, options)
         flags.is_sync = options.is_sync
     end
 
+    if options.full_field_map ~= nil then
+        flags.full_field_map = options.full_field_map
+    end
+
     local format
     if options.format ~= nil then
         format = update_format(options.format)
@@ -588,6 +625,18 @@ box.schema.space.alter = function(space_id, options)
         format = tuple.format
     end
 
+    if options.expire_field == false then
+        flags.expire_field = nil
+        setmap(flags)
+    elseif options.expire_field == true then
+        box.error(box.error.ILLEGAL_PARAMS,
+                  "options parameter 'expire_field' can only be " ..
+                  "set to false to disable expiration")
+    elseif options.expire_field ~= nil then
+        flags.expire_field = expire_field_resolve(options.expire_field,
+                                                  format)
+    end
+
     tuple = tuple:totable()
     tuple[2] = owner
     tuple[3] = name
@@ -1047,11 +1096,14 @@ local index_options = {
     distance = 'string',
     run_count_per_level = 'number',
     run_size_ratio = 'number',
+    compaction_strategy = 'string',
+    value_log_threshold = 'number',
     range_size = 'number',
     page_size = 'number',
     bloom_fpr = 'number',
     func = 'number, string',
     hint = 'boolean',
+    hash_func = 'string',
 }
 
 local function jsonpaths_from_idx_parts(parts)
@@ -1159,6 +1211,11 @@ box.schema.index.create = function(space_id, name, options)
         box.error(box.error.MODIFY_INDEX, name, space.name,
                 "functional index can't use hints")
     end
+    if options.hash_func and options.type ~= 'hash' and
+            box.space[space_id].engine ~= 'vinyl' then
+        box.error(box.error.MODIFY_INDEX, name, space.name,
+                "hash_func is only reasonable with hash or vinyl index")
+    end
 
     local _index = box.space[box.schema.INDEX_ID]
     local _vindex = box.space[box.schema.VINDEX_ID]
@@ -1196,9 +1253,12 @@ box.schema.index.create = function(space_id, name, options)
             range_size = options.range_size,
             run_count_per_level = options.run_count_per_level,
             run_size_ratio = options.run_size_ratio,
+            compaction_strategy = options.compaction_strategy,
+            value_log_threshold = options.value_log_threshold,
             bloom_fpr = options.bloom_fpr,
             func = options.func,
             hint = options.hint,
+            hash_func = options.hash_func,
     }
     local field_type_aliases = {
         num = 'unsigned'; -- Deprecated since 1.7.2
@@ -1352,6 +1412,12 @@ box.schema.index.alter = function(space_id, index_id, options)
                                           space.name,
                 "functional index can't use hints")
     end
+    if options.hash_func and options.type ~= 'hash' and
+       box.space[space_id].engine ~= 'vinyl' then
+        box.error(box.error.MODIFY_INDEX, space.index[index_id].name,
+                                          space.name,
+            "hash_func is only reasonable with hash or vinyl index")
+    end
     if options.parts then
         local parts_can_be_simplified
         parts, parts_can_be_simplified =
@@ -1898,6 +1964,18 @@ base_index_mt.get_luac = function(index, key)
     return internal.get(index.space_id, index.id, key)
 end
 
+base_index_mt.get_many = function(index, keys)
+    check_index_arg(index, 'get_many')
+    if type(keys) ~= 'table' then
+        box.error(box.error.PROC_LUA, "Usage: index:get_many({key, ...})")
+    end
+    local raw_keys = {}
+    for i, key in ipairs(keys) do
+        raw_keys[i] = keify(key)
+    end
+    return internal.get_many(index.space_id, index.id, raw_keys)
+end
+
 local function check_select_opts(opts, key_is_nil)
     local offset = 0
     local limit = 4294967295
@@ -1951,6 +2029,11 @@ base_index_mt.delete = function(index, key)
     check_index_arg(index, 'delete')
     return internal.delete(index.space_id, index.id, keify(key));
 end
+base_index_mt.delete_range = function(index, begin_key, end_key)
+    check_index_arg(index, 'delete_range')
+    return internal.delete_range(index.space_id, index.id, keify(begin_key),
+                                 keify(end_key))
+end
 
 base_index_mt.stat = function(index)
     return internal.stat(index.space_id, index.id);
@@ -2017,6 +2100,10 @@ space_mt.get = function(space, key)
     check_space_arg(space, 'get')
     return check_primary_index(space):get(key)
 end
+space_mt.get_many = function(space, keys)
+    check_space_arg(space, 'get_many')
+    return check_primary_index(space):get_many(keys)
+end
 space_mt.select = function(space, key, opts)
     check_space_arg(space, 'select')
     return check_primary_index(space):select(key, opts)
@@ -2060,6 +2147,10 @@ space_mt.delete = function(space, key)
     check_space_arg(space, 'delete')
     return check_primary_index(space):delete(key)
 end
+space_mt.delete_range = function(space, begin_key, end_key)
+    check_space_arg(space, 'delete_range')
+    return check_primary_index(space):delete_range(begin_key, end_key)
+end
 -- Assumes that spaceno has a TREE (NUM) primary key
 -- inserts a tuple after getting the next value of the
 -- primary key and returns it back to the user
@@ -2131,6 +2222,19 @@ space_mt.run_triggers = function(space, yesno)
     builtin.space_run_triggers(s, yesno)
 end
 space_mt.frommap = box.internal.space.frommap
+space_mt.bulk_load = function(space, tuples, param, state)
+    check_space_arg(space, 'bulk_load')
+    local gen = tuples
+    if type(tuples) == 'table' then
+        if getmetatable(tuples) ~= nil and tuples.gen ~= nil then
+            -- luafun iterator
+            gen, param, state = tuples.gen, tuples.param, tuples.state
+        else
+            gen, param, state = ipairs(tuples)
+        end
+    end
+    return box.internal.space.bulk_load(space, gen, param, state)
+end
 space_mt.__index = space_mt
 
 local ck_constraint_mt = {}
@@ -51,6 +51,7 @@ extern "C" {
 #include "box/txn.h"
 #include "box/sequence.h"
 #include "box/coll_id_cache.h"
+#include "box/box.h" /* box_space_bulk_load() */
 #include "box/replication.h" /* GROUP_LOCAL */
 #include "box/iproto_constants.h" /* iproto_type_name */
 #include "vclock/vclock.h"
@@ -258,6 +259,19 @@ lbox_fillspace(struct lua_State *L, struct space *space, int i)
 	lua_pushboolean(L, space->def->opts.is_sync);
 	lua_settable(L, i);
 
+	/* space.expire_field */
+	lua_pushstring(L, "expire_field");
+	if (space->def->opts.expire_field != UINT32_MAX)
+		lua_pushnumber(L, space->def->opts.expire_field + 1);
+	else
+		lua_pushnil(L);
+	lua_settable(L, i);
+
+	/* space.full_field_map */
+	lua_pushstring(L, "full_field_map");
+	lua_pushboolean(L, space->def->opts.full_field_map);
+	lua_settable(L, i);
+
 	lua_pushstring(L, "enabled");
 	lua_pushboolean(L, space_index(space, 0) != 0);
 	lua_settable(L, i);
@@ -436,6 +450,16 @@ lbox_fillspace(struct lua_State *L, struct space *space, int i)
 			lua_pushnumber(L, index_opts->run_size_ratio);
 			lua_setfield(L, -2, "run_size_ratio");
 
+			lua_pushstring(L, index_opts->compaction_strategy ==
+				       COMPACTION_STRATEGY_LEVELED ?
+				       "leveled" : "tiered");
+			lua_setfield(L, -2, "compaction_strategy");
+
+			if (index_opts->value_log_threshold != 0) {
+				lua_pushnumber(L, index_opts->value_log_threshold);
+				lua_setfield(L, -2, "value_log_threshold");
+			}
+
 			lua_pushnumber(L, index_opts->bloom_fpr);
 			lua_setfield(L, -2, "bloom_fpr");
 
@@ -610,6 +634,77 @@ usage_error:
 	return luaL_error(L, "Usage: space:frommap(map, opts)");
 }
 
+/**
+ * Load tuples produced by a Lua iterator into an empty space,
+ * see box_space_bulk_load().
+ * @param Lua space object.
+ * @param gen, param, state Lua iterator triplet. The iterator
+ *        returns the next state and a tuple or a table.
+ */
+static int
+lbox_space_bulk_load(struct lua_State *L)
+{
+	if (lua_gettop(L) < 2 || !lua_istable(L, 1) || !lua_isfunction(L, 2))
+		return luaL_error(L, "Usage: space:bulk_load(tuples)");
+	lua_settop(L, 4);
+	lua_getfield(L, 1, "id");
+	uint32_t space_id = lua_tointeger(L, -1);
+	lua_pop(L, 1);
+
+	struct tuple **tuples = NULL;
+	uint32_t count = 0, capacity = 0;
+	int rc = 0;
+	while (true) {
+		lua_pushvalue(L, 2);
+		lua_pushvalue(L, 3);
+		lua_pushvalue(L, 4);
+		if (luaT_call(L, 2, 2) != 0) {
+			rc = -1;
+			break;
+		}
+		if (lua_isnil(L, -2)) {
+			lua_pop(L, 2);
+			break;
+		}
+		lua_pushvalue(L, -2);
+		lua_replace(L, 4);
+		/* The iterator may yield and the space be altered. */
+		struct space *space = space_cache_find(space_id);
+		struct tuple *tuple = space == NULL ? NULL :
+				      luaT_tuple_new(L, -1, space->format);
+		lua_pop(L, 2);
+		if (tuple == NULL) {
+			rc = -1;
+			break;
+		}
+		tuple_ref(tuple);
+		if (count == capacity) {
+			uint32_t new_capacity = MAX(capacity * 2, 1024U);
+			size_t size = new_capacity * sizeof(*tuples);
+			struct tuple **new_tuples =
+				(struct tuple **)realloc(tuples, size);
+			if (new_tuples == NULL) {
+				diag_set(OutOfMemory, size, "realloc",
+					 "tuples");
+				tuple_unref(tuple);
+				rc = -1;
+				break;
+			}
+			tuples = new_tuples;
+			capacity = new_capacity;
+		}
+		tuples[count++] = tuple;
+	}
+	if (rc == 0)
+		rc = box_space_bulk_load(space_id, tuples, count);
+	for (uint32_t i = 0; i < count; i++)
+		tuple_unref(tuples[i]);
+	free(tuples);
+	if (rc != 0)
+		return luaT_error(L);
+	return 0;
+}
+
 void
 box_lua_space_init(struct lua_State *L)
 {
@@ -709,6 +804,7 @@ box_lua_space_init(struct lua_State *L)
 
 	static const struct luaL_Reg space_internal_lib[] = {
 		{"frommap", lbox_space_frommap},
+		{"bulk_load", lbox_space_bulk_load},
 		{NULL, NULL}
 	};
 	luaL_register(L, "box.internal.space", space_internal_lib);
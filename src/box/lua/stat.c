@@ -43,6 +43,8 @@
 #include "box/engine.h"
 #include "box/vinyl.h"
 #include "box/sql.h"
+#include "box/memtx_tx.h"
+#include "box/read_pool.h"
 #include "info/info.h"
 #include "lua/info.h"
 #include "lua/utils.h"
@@ -211,6 +213,24 @@ lbox_stat_sql(struct lua_State *L)
 	return 1;
 }
 
+static int
+lbox_stat_memtx_tx(struct lua_State *L)
+{
+	struct info_handler info;
+	luaT_info_handler_create(&info, L);
+	memtx_tx_stat(&info);
+	return 1;
+}
+
+static int
+lbox_stat_memtx_read_threads(struct lua_State *L)
+{
+	struct info_handler info;
+	luaT_info_handler_create(&info, L);
+	read_pool_stat(&info);
+	return 1;
+}
+
 static const struct luaL_Reg lbox_stat_meta [] = {
 	{"__index", lbox_stat_index},
 	{"__call",  lbox_stat_call},
@@ -251,5 +271,14 @@ box_lua_stat_init(struct lua_State *L)
 	luaL_register(L, NULL, lbox_stat_net_meta);
 	lua_setmetatable(L, -2);
 	lua_pop(L, 1); /* stat net module */
+
+	static const struct luaL_Reg memtxstatlib [] = {
+		{"tx", lbox_stat_memtx_tx},
+		{"read_threads", lbox_stat_memtx_read_threads},
+		{NULL, NULL}
+	};
+
+	luaL_register_module(L, "box.stat.memtx", memtxstatlib);
+	lua_pop(L, 1); /* stat memtx module */
 }
 
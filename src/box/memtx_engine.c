@@ -86,7 +86,8 @@ memtx_end_build_primary_key(struct space *space, void *param)
 	    memtx_space->replace == memtx_space_replace_all_keys)
 		return 0;
 
-	index_end_build(space->index[0]);
+	if (index_end_build(space->index[0]) != 0)
+		return -1;
 	memtx_space->replace = memtx_space_replace_primary_key;
 	return 0;
 }
@@ -313,7 +314,8 @@ memtx_engine_begin_final_recovery(struct engine *engine)
 
 	assert(memtx->state == MEMTX_INITIAL_RECOVERY);
 	/* End of the fast path: loaded the primary key. */
-	space_foreach(memtx_end_build_primary_key, memtx);
+	if (space_foreach(memtx_end_build_primary_key, memtx) != 0)
+		return -1;
 
 	if (!memtx->force_recovery) {
 		/*
@@ -989,6 +991,8 @@ memtx_engine_memory_stat(struct engine *engine, struct engine_memory_stat *stat)
 	small_stats(&memtx->alloc, &data_stats, small_stats_noop_cb, NULL);
 	stat->data += data_stats.used;
 	stat->index += index_stats.totals.used;
+	stat->read_view += memtx->delayed_free_size +
+			   memtx->delayed_free_extents * MEMTX_EXTENT_SIZE;
 }
 
 static const struct engine_vtab memtx_engine_vtab = {
@@ -1207,8 +1211,11 @@ void
 memtx_leave_delayed_free_mode(struct memtx_engine *memtx)
 {
 	assert(memtx->delayed_free_mode > 0);
-	if (--memtx->delayed_free_mode == 0)
+	if (--memtx->delayed_free_mode == 0) {
 		small_alloc_setopt(&memtx->alloc, SMALL_DELAYED_FREE_MODE, false);
+		memtx->delayed_free_size = 0;
+		memtx->delayed_free_extents = 0;
+	}
 }
 
 struct tuple *
@@ -1291,11 +1298,25 @@ memtx_tuple_delete(struct tuple_format *format, struct tuple *tuple)
 	    memtx_tuple->version == memtx->snapshot_version ||
 	    format->is_temporary)
 		smfree(&memtx->alloc, memtx_tuple, total);
-	else
+	else {
 		smfree_delayed(&memtx->alloc, memtx_tuple, total);
+		memtx->delayed_free_size += total;
+	}
 	tuple_format_unref(format);
 }
 
+bool
+memtx_tuple_is_in_read_view(struct tuple *tuple)
+{
+	struct tuple_format *format = tuple_format(tuple);
+	struct memtx_engine *memtx = (struct memtx_engine *)format->engine;
+	struct memtx_tuple *memtx_tuple =
+		container_of(tuple, struct memtx_tuple, base);
+	return memtx->delayed_free_mode > 0 &&
+	       memtx_tuple->version != memtx->snapshot_version &&
+	       !format->is_temporary;
+}
+
 void
 metmx_tuple_chunk_delete(struct tuple_format *format, const char *data)
 {
@@ -1338,12 +1359,13 @@ void *
 memtx_index_extent_alloc(void *ctx)
 {
 	struct memtx_engine *memtx = (struct memtx_engine *)ctx;
+	void *ret;
 	if (memtx->reserved_extents) {
 		assert(memtx->num_reserved_extents > 0);
 		memtx->num_reserved_extents--;
-		void *result = memtx->reserved_extents;
+		ret = memtx->reserved_extents;
 		memtx->reserved_extents = *(void **)memtx->reserved_extents;
-		return result;
+		goto out;
 	}
 	ERROR_INJECT(ERRINJ_INDEX_ALLOC, {
 		/* same error as in mempool_alloc */
@@ -1351,16 +1373,20 @@ memtx_index_extent_alloc(void *ctx)
 			 "mempool", "new slab");
 		return NULL;
 	});
-	void *ret;
 	while ((ret = mempool_alloc(&memtx->index_extent_pool)) == NULL) {
 		bool stop;
 		memtx_engine_run_gc(memtx, &stop);
 		if (stop)
 			break;
 	}
-	if (ret == NULL)
+	if (ret == NULL) {
 		diag_set(OutOfMemory, MEMTX_EXTENT_SIZE,
 			 "mempool", "new slab");
+		return NULL;
+	}
+out:
+	if (memtx->delayed_free_mode > 0)
+		memtx->delayed_free_extents++;
 	return ret;
 }
 
@@ -1371,6 +1397,8 @@ void
 memtx_index_extent_free(void *ctx, void *extent)
 {
 	struct memtx_engine *memtx = (struct memtx_engine *)ctx;
+	if (memtx->delayed_free_extents > 0)
+		memtx->delayed_free_extents--;
 	return mempool_free(&memtx->index_extent_pool, extent);
 }
 
@@ -1425,6 +1453,9 @@ memtx_index_def_change_requires_rebuild(struct index *index,
 		return true;
 	if (old_def->opts.hint != new_def->opts.hint)
 		return true;
+	if (old_def->type == HASH &&
+	    old_def->opts.hash_func != new_def->opts.hash_func)
+		return true;
 
 	const struct key_def *old_cmp_def, *new_cmp_def;
 	if (index_depends_on_pk(index)) {
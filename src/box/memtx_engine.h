@@ -160,6 +160,21 @@ struct memtx_engine {
 	 * memtx_leave_delayed_free_mode() is called.
 	 */
 	uint32_t delayed_free_mode;
+	/**
+	 * Size of tuples freed while in the delayed free mode,
+	 * i.e. memory pinned by open read views (checkpoint,
+	 * replica join, box.read_view()). Reset when the last
+	 * read view is closed.
+	 */
+	size_t delayed_free_size;
+	/**
+	 * Number of index extents allocated and not freed while
+	 * in the delayed free mode. Most of them are copies of
+	 * index pages shared with open read views (matras copy on
+	 * write), the rest is index growth. Reset along with
+	 * delayed_free_size.
+	 */
+	size_t delayed_free_extents;
 	/** Memory pool for rtree index iterator. */
 	struct mempool rtree_iterator_pool;
 	/**
@@ -253,6 +268,13 @@ memtx_tuple_new(struct tuple_format *format, const char *data, const char *end);
 void
 memtx_tuple_delete(struct tuple_format *format, struct tuple *tuple);
 
+/**
+ * Check if a tuple may be accessed by an open read view, e.g.
+ * a checkpoint in progress, so its data must not be changed.
+ */
+bool
+memtx_tuple_is_in_read_view(struct tuple *tuple);
+
 /** Tuple format vtab for memtx engine. */
 extern struct tuple_format_vtab memtx_tuple_format_vtab;
 
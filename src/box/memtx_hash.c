@@ -544,8 +544,11 @@ static const struct index_vtab memtx_hash_index_vtab = {
 	/* .random = */ memtx_hash_index_random,
 	/* .count = */ memtx_hash_index_count,
 	/* .get = */ memtx_hash_index_get,
+	/* .get_many = */ generic_index_get_many,
 	/* .replace = */ memtx_hash_index_replace,
 	/* .create_iterator = */ memtx_hash_index_create_iterator,
+	/* .create_iterator_with_offset = */
+		generic_index_create_iterator_with_offset,
 	/* .create_snapshot_iterator = */
 		memtx_hash_index_create_snapshot_iterator,
 	/* .stat = */ generic_index_stat,
@@ -50,6 +50,10 @@ struct memtx_rtree_index {
 	struct index base;
 	unsigned dimension;
 	struct rtree tree;
+	/** Number of records bulk load extents are reserved for. */
+	size_t bulk_reserved;
+	/** Number of extents needed to bulk load bulk_reserved records. */
+	int bulk_extents;
 };
 
 /* {{{ Utilities. *************************************************/
@@ -282,8 +286,57 @@ memtx_rtree_index_reserve(struct index *base, uint32_t size_hint)
 		diag_set(OutOfMemory, MEMTX_EXTENT_SIZE, "mempool", "new slab");
 		return -1;
 	});
+	struct memtx_rtree_index *index = (struct memtx_rtree_index *)base;
 	struct memtx_engine *memtx = (struct memtx_engine *)base->engine;
-	return memtx_index_extent_reserve(memtx, RESERVE_EXTENTS_BEFORE_REPLACE);
+	/* While building in bulk, also keep what end_build needs. */
+	return memtx_index_extent_reserve(memtx, RESERVE_EXTENTS_BEFORE_REPLACE +
+					  index->bulk_extents);
+}
+
+static int
+memtx_rtree_index_build_next(struct index *base, struct tuple *tuple)
+{
+	struct memtx_rtree_index *index = (struct memtx_rtree_index *)base;
+	struct rtree_rect rect;
+	if (extract_rectangle(&rect, tuple, base->def) != 0)
+		return -1;
+	if (rtree_bulk_load_add(&index->tree, &rect, tuple) != 0) {
+		diag_set(OutOfMemory, index->tree.bulk_capacity * 2 *
+			 index->tree.page_branch_size, "realloc",
+			 "rtree bulk load");
+		return -1;
+	}
+	/*
+	 * Reserve the extents the packed tree is going to need
+	 * as the records come, so that a build that is short of
+	 * memory fails early. Reserve ahead for a few more percent
+	 * of records so as not to recount the pages on every
+	 * insertion.
+	 */
+	size_t count = index->tree.bulk_count;
+	if (count > index->bulk_reserved) {
+		index->bulk_reserved = count + MAX(count / 64, 1024);
+		index->bulk_extents = (int)rtree_bulk_load_extent_count(
+				&index->tree, index->bulk_reserved);
+	}
+	return memtx_rtree_index_reserve(base, 0);
+}
+
+static int
+memtx_rtree_index_end_build(struct index *base)
+{
+	struct memtx_rtree_index *index = (struct memtx_rtree_index *)base;
+	/*
+	 * The reserve is shared by all indexes and may have been
+	 * used up by others since the last build_next, so top it
+	 * up right before packing the tree, which can't fail.
+	 */
+	if (memtx_rtree_index_reserve(base, 0) != 0)
+		return -1;
+	rtree_bulk_load_end(&index->tree);
+	index->bulk_reserved = 0;
+	index->bulk_extents = 0;
+	return 0;
 }
 
 static struct iterator *
@@ -376,8 +429,11 @@ static const struct index_vtab memtx_rtree_index_vtab = {
 	/* .random = */ generic_index_random,
 	/* .count = */ memtx_rtree_index_count,
 	/* .get = */ memtx_rtree_index_get,
+	/* .get_many = */ generic_index_get_many,
 	/* .replace = */ memtx_rtree_index_replace,
 	/* .create_iterator = */ memtx_rtree_index_create_iterator,
+	/* .create_iterator_with_offset = */
+		generic_index_create_iterator_with_offset,
 	/* .create_snapshot_iterator = */
 		generic_index_create_snapshot_iterator,
 	/* .stat = */ generic_index_stat,
@@ -385,8 +441,8 @@ static const struct index_vtab memtx_rtree_index_vtab = {
 	/* .reset_stat = */ generic_index_reset_stat,
 	/* .begin_build = */ generic_index_begin_build,
 	/* .reserve = */ memtx_rtree_index_reserve,
-	/* .build_next = */ generic_index_build_next,
-	/* .end_build = */ generic_index_end_build,
+	/* .build_next = */ memtx_rtree_index_build_next,
+	/* .end_build = */ memtx_rtree_index_end_build,
 };
 
 struct index *
@@ -314,6 +314,26 @@ rollback:
 	return -1;
 }
 
+/**
+ * Replace function installed while the space is being bulk
+ * loaded, see memtx_space_begin_bulk_load(). The loaded tuples
+ * are already in the indexes, but may be not in WAL yet, so no
+ * changes are allowed until the load is over.
+ */
+static int
+memtx_space_replace_bulk_load(struct space *space, struct tuple *old_tuple,
+			      struct tuple *new_tuple,
+			      enum dup_replace_mode mode,
+			      struct tuple **result)
+{
+	(void)old_tuple;
+	(void)new_tuple;
+	(void)mode;
+	(void)result;
+	diag_set(ClientError, ER_SPACE_BULK_LOAD, space_name(space));
+	return -1;
+}
+
 static inline enum dup_replace_mode
 dup_replace_mode(uint32_t op)
 {
@@ -378,6 +398,104 @@ memtx_space_execute_delete(struct space *space, struct txn *txn,
 	return 0;
 }
 
+/** Undo record of an UPDATE applied to a tuple in place. */
+struct memtx_update_in_place {
+	/** Trigger restoring the tuple on statement rollback. */
+	struct trigger on_rollback;
+	/** The updated tuple. */
+	struct tuple *tuple;
+	/** Number of changed fields. */
+	uint32_t patch_count;
+	/** Old values of the changed fields. */
+	struct xrow_update_patch patches[XROW_UPDATE_IN_PLACE_OP_MAX];
+};
+
+static int
+memtx_update_in_place_rollback(struct trigger *trigger, void *event)
+{
+	(void)event;
+	struct memtx_update_in_place *undo =
+		(struct memtx_update_in_place *)trigger->data;
+	struct tuple *tuple = undo->tuple;
+	xrow_update_swap_in_place((char *)tuple + tuple->data_offset,
+				  undo->patches, undo->patch_count);
+	return 0;
+}
+
+/**
+ * Check if a tuple stored in a space may be changed in place,
+ * i.e. nobody except the space indexes can see it: there is no
+ * reference from Lua, a port, another statement, a transaction
+ * story or a read view, and no trigger will compare the old and
+ * the new tuple.
+ */
+static bool
+memtx_space_tuple_is_exclusive(struct space *space, struct tuple *tuple)
+{
+	if (memtx_tx_manager_use_mvcc_engine || tuple->is_dirty)
+		return false;
+	/*
+	 * The only reference is held by the primary index. The
+	 * tuple last returned by the public API is guaranteed to
+	 * be valid only until the next call, so its reference
+	 * doesn't count.
+	 */
+	uint16_t refs = tuple == box_tuple_last ? 2 : 1;
+	if (tuple->refs != refs || tuple_format(tuple) != space->format)
+		return false;
+	if (!rlist_empty(&space->before_replace) ||
+	    !rlist_empty(&space->on_replace))
+		return false;
+	/* Functional index keys may depend on any field. */
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		if (space->index[i]->def->key_def->for_func_index)
+			return false;
+	}
+	return !memtx_tuple_is_in_read_view(tuple);
+}
+
+/**
+ * Try to apply an UPDATE request to a tuple without allocating
+ * a new one. Only changes of not indexed numeric fields, which
+ * keep the tuple size, are done this way. The statement has
+ * neither old nor new tuple then, and the change is reverted by
+ * a rollback trigger. The request is written to WAL as usual.
+ *
+ * @retval 0 The tuple is updated.
+ * @retval -1 The update must be done by copying the tuple.
+ */
+static int
+memtx_space_update_in_place(struct space *space, struct txn *txn,
+			    struct request *request, struct tuple *tuple)
+{
+	if (!memtx_space_tuple_is_exclusive(space, tuple))
+		return -1;
+	struct region *region = &txn->region;
+	size_t region_svp = region_used(region);
+	int size;
+	struct memtx_update_in_place *undo =
+		region_alloc_object(region, struct memtx_update_in_place,
+				    &size);
+	if (undo == NULL)
+		return -1;
+	uint32_t bsize;
+	const char *data = tuple_data_range(tuple, &bsize);
+	if (xrow_update_prepare_in_place(request->tuple, request->tuple_end,
+					 data, data + bsize, space->format,
+					 request->index_base, undo->patches,
+					 &undo->patch_count) != 0) {
+		region_truncate(region, region_svp);
+		return -1;
+	}
+	undo->tuple = tuple;
+	xrow_update_swap_in_place((char *)data, undo->patches,
+				  undo->patch_count);
+	trigger_create(&undo->on_rollback, memtx_update_in_place_rollback,
+		       undo, NULL);
+	txn_stmt_on_rollback(txn_current_stmt(txn), &undo->on_rollback);
+	return 0;
+}
+
 static int
 memtx_space_execute_update(struct space *space, struct txn *txn,
 			   struct request *request, struct tuple **result)
@@ -401,6 +519,12 @@ memtx_space_execute_update(struct space *space, struct txn *txn,
 		return 0;
 	}
 
+	if (memtx_space_update_in_place(space, txn, request, old_tuple) == 0) {
+		stmt->engine_savepoint = stmt;
+		*result = old_tuple;
+		return 0;
+	}
+
 	/* Update the tuple; legacy, request ops are in request->tuple */
 	uint32_t new_size = 0, bsize;
 	struct tuple_format *format = space->format;
@@ -906,6 +1030,18 @@ memtx_space_check_format(struct space *space, struct tuple_format *format)
 	if (txn_check_singlestatement(txn, "space format check") != 0)
 		return -1;
 
+	/*
+	 * All tuples stored in the space are valid for its current
+	 * format, whatever format they were created with, so only
+	 * the difference between the two formats needs checking.
+	 */
+	struct tuple_format_upgrade upgrade;
+	if (tuple_format_upgrade_create(&upgrade, format,
+					space->format) != 0) {
+		iterator_delete(it);
+		return -1;
+	}
+
 	bool could_yield = txn_can_yield(txn, true);
 
 	struct memtx_engine *memtx = (struct memtx_engine *)space->engine;
@@ -927,7 +1063,7 @@ memtx_space_check_format(struct space *space, struct tuple_format *format)
 		 * Check that the tuple is OK according to the
 		 * new format.
 		 */
-		rc = tuple_validate(format, tuple);
+		rc = tuple_validate_upgrade(&upgrade, tuple);
 		if (rc != 0)
 			break;
 
@@ -948,6 +1084,7 @@ memtx_space_check_format(struct space *space, struct tuple_format *format)
 		}
 	}
 	iterator_delete(it);
+	tuple_format_upgrade_destroy(&upgrade);
 	diag_destroy(&state.diag);
 	trigger_clear(&on_replace);
 	txn_can_yield(txn, could_yield);
@@ -1025,6 +1162,209 @@ memtx_build_on_replace(struct trigger *trigger, void *event)
 	return 0;
 }
 
+/*
+ * Minimal number of tuples in a space to build a new index in
+ * a separate thread, see memtx_space_build_index_in_thread().
+ * Smaller spaces are faster to index in tx. Tests lower it with
+ * ERRINJ_MEMTX_DDL_THREAD_MIN_TUPLES.
+ */
+enum { MEMTX_DDL_THREAD_MIN_TUPLES = 100000 };
+
+/* A change made to the space while the index is built in a thread. */
+struct memtx_build_stmt {
+	/* Replaced or deleted tuple, referenced. */
+	struct tuple *old_tuple;
+	/* Inserted tuple, referenced. */
+	struct tuple *new_tuple;
+	/* Link in memtx_build_thread_state::stmts. */
+	struct stailq_entry in_stmts;
+};
+
+/* State of an index build done in a separate thread. */
+struct memtx_build_thread_state {
+	/* The index being built. */
+	struct index *index;
+	/* New format to be enforced. */
+	struct tuple_format *format;
+	/* Read view of the primary key the index is built from. */
+	struct memtx_tree_read_view *view;
+	/* Space name for the duplicate key error. */
+	const char *space_name;
+	/*
+	 * Changes made to the space since the read view was
+	 * created, in the order they were made. They are applied
+	 * to the index in tx once the thread is done.
+	 */
+	struct stailq stmts;
+	/* Set if a change couldn't be recorded. */
+	struct diag diag;
+	int rc;
+};
+
+static int
+memtx_build_thread_on_replace(struct trigger *trigger, void *event)
+{
+	struct txn *txn = event;
+	struct memtx_build_thread_state *state = trigger->data;
+	struct txn_stmt *stmt = txn_current_stmt(txn);
+
+	/* We have already failed. */
+	if (state->rc != 0)
+		return 0;
+
+	struct memtx_build_stmt *build_stmt = malloc(sizeof(*build_stmt));
+	if (build_stmt == NULL) {
+		diag_set(OutOfMemory, sizeof(*build_stmt),
+			 "malloc", "struct memtx_build_stmt");
+		diag_move(diag_get(), &state->diag);
+		state->rc = -1;
+		return 0;
+	}
+	build_stmt->old_tuple = stmt->old_tuple;
+	build_stmt->new_tuple = stmt->new_tuple;
+	if (build_stmt->old_tuple != NULL)
+		tuple_ref(build_stmt->old_tuple);
+	if (build_stmt->new_tuple != NULL)
+		tuple_ref(build_stmt->new_tuple);
+	stailq_add_tail_entry(&state->stmts, build_stmt, in_stmts);
+	return 0;
+}
+
+static int
+memtx_build_thread_add_tuple(struct tuple *tuple, void *arg)
+{
+	struct memtx_build_thread_state *state = arg;
+	if (tuple_validate(state->format, tuple) != 0)
+		return -1;
+	return index_build_next(state->index, tuple);
+}
+
+static int
+memtx_build_thread_f(va_list ap)
+{
+	struct memtx_build_thread_state *state =
+		va_arg(ap, struct memtx_build_thread_state *);
+	if (memtx_tree_read_view_select(state->view, ITER_ALL, NULL, 0, 0,
+					UINT32_MAX,
+					memtx_build_thread_add_tuple,
+					state) != 0)
+		return -1;
+	return memtx_tree_index_sort_build_array(state->index,
+						 state->space_name);
+}
+
+/*
+ * Check if the new index may be built in a separate thread, see
+ * memtx_space_build_index_in_thread().
+ */
+static bool
+memtx_space_can_build_index_in_thread(struct index *pk,
+				      struct index *new_index)
+{
+	struct memtx_engine *memtx = (struct memtx_engine *)pk->engine;
+	struct key_def *key_def = new_index->def->key_def;
+	int64_t min_tuples = MEMTX_DDL_THREAD_MIN_TUPLES;
+	struct errinj *inj = errinj(ERRINJ_MEMTX_DDL_THREAD_MIN_TUPLES,
+				    ERRINJ_INT);
+	if (inj != NULL && inj->iparam >= 0)
+		min_tuples = inj->iparam;
+	/*
+	 * Uncommitted changes can't be replayed on the new index
+	 * in the order they are committed, so the threaded build
+	 * is not used along with the transaction manager.
+	 */
+	return memtx->state == MEMTX_OK &&
+	       !memtx_tx_manager_use_mvcc_engine &&
+	       new_index->def->iid != 0 &&
+	       new_index->def->type == TREE &&
+	       !key_def->is_multikey && !key_def->for_func_index &&
+	       pk->def->type == TREE &&
+	       index_size(pk) >= min_tuples;
+}
+
+/*
+ * Build a secondary tree index of a big space without loading
+ * the tx thread. A thread scans a read view of the primary key,
+ * checks the tuples against the new format, collects the keys
+ * and sorts them. Meanwhile tx serves requests and records the
+ * changes made to the space. Then tx bulk loads the tree from
+ * the sorted keys and applies the recorded changes to it without
+ * yielding, so the index is published consistent with the space.
+ */
+static int
+memtx_space_build_index_in_thread(struct space *space, struct index *pk,
+				  struct index *new_index,
+				  struct tuple_format *new_format)
+{
+	struct txn *txn = in_txn();
+	bool could_yield = txn_can_yield(txn, true);
+
+	struct memtx_build_thread_state state;
+	state.index = new_index;
+	state.format = new_format;
+	state.space_name = space_name(space);
+	stailq_create(&state.stmts);
+	diag_create(&state.diag);
+	state.rc = 0;
+
+	int rc = -1;
+	struct trigger on_replace;
+	struct cord cord;
+	struct memtx_build_stmt *stmt, *next;
+	state.view = memtx_tree_read_view_new(pk);
+	if (state.view == NULL)
+		goto out;
+	if (index_reserve(new_index, index_size(pk)) != 0)
+		goto out_view;
+
+	trigger_create(&on_replace, memtx_build_thread_on_replace, &state, NULL);
+	trigger_add(&space->on_replace, &on_replace);
+
+	index_begin_build(new_index);
+	if (cord_costart(&cord, "index_build", memtx_build_thread_f,
+			 &state) == 0)
+		rc = cord_cojoin(&cord);
+	/*
+	 * Sleep after the thread is done to test replaying of the
+	 * changes made while the index was being built.
+	 */
+	ERROR_INJECT_YIELD(ERRINJ_BUILD_INDEX_DELAY);
+	trigger_clear(&on_replace);
+	if (rc == 0)
+		rc = memtx_tree_index_reserve_build(new_index);
+	if (rc == 0)
+		rc = index_end_build(new_index);
+	if (rc == 0) {
+		if (state.rc != 0) {
+			rc = -1;
+			diag_move(&state.diag, diag_get());
+		}
+	}
+	stailq_foreach_entry_safe(stmt, next, &state.stmts, in_stmts) {
+		if (rc == 0 && stmt->new_tuple != NULL)
+			rc = tuple_validate(new_format, stmt->new_tuple);
+		if (rc == 0) {
+			struct tuple *unused;
+			enum dup_replace_mode mode =
+				new_index->def->opts.is_unique ?
+				DUP_INSERT : DUP_REPLACE_OR_INSERT;
+			rc = index_replace(new_index, stmt->old_tuple,
+					   stmt->new_tuple, mode, &unused);
+		}
+		if (stmt->old_tuple != NULL)
+			tuple_unref(stmt->old_tuple);
+		if (stmt->new_tuple != NULL)
+			tuple_unref(stmt->new_tuple);
+		free(stmt);
+	}
+out_view:
+	memtx_tree_read_view_delete(state.view);
+out:
+	diag_destroy(&state.diag);
+	txn_can_yield(txn, could_yield);
+	return rc;
+}
+
 static int
 memtx_space_build_index(struct space *src_space, struct index *new_index,
 			struct tuple_format *new_format,
@@ -1056,6 +1396,13 @@ memtx_space_build_index(struct space *src_space, struct index *new_index,
 		return -1;
 	}
 
+	if (memtx_space_can_build_index_in_thread(pk, new_index)) {
+		if (txn_check_singlestatement(txn, "index build") != 0)
+			return -1;
+		return memtx_space_build_index_in_thread(src_space, pk,
+							 new_index, new_format);
+	}
+
 	/* Now deal with any kind of add index during normal operation. */
 	struct iterator *it = index_create_iterator(pk, ITER_ALL, NULL, 0);
 	if (it == NULL)
@@ -1152,6 +1499,10 @@ memtx_space_prepare_alter(struct space *old_space, struct space *new_space)
 	struct memtx_space *old_memtx_space = (struct memtx_space *)old_space;
 	struct memtx_space *new_memtx_space = (struct memtx_space *)new_space;
 
+	if (old_memtx_space->replace == memtx_space_replace_bulk_load) {
+		diag_set(ClientError, ER_SPACE_BULK_LOAD, space_name(old_space));
+		return -1;
+	}
 	if (old_memtx_space->bsize != 0 &&
 	    space_is_temporary(old_space) != space_is_temporary(new_space)) {
 		diag_set(ClientError, ER_ALTER_SPACE, old_space->def->name,
@@ -1166,6 +1517,137 @@ memtx_space_prepare_alter(struct space *old_space, struct space *new_space)
 
 /* }}} DDL */
 
+/* {{{ Bulk load */
+
+/*
+ * Add the tuples to an empty index of a space being bulk loaded.
+ * Tree indexes are built from a sorted array of tuples, other
+ * index types use the build method they use on recovery.
+ */
+static int
+memtx_space_bulk_load_index(struct space *space, struct index *index,
+			    struct tuple **tuples, uint32_t count)
+{
+	struct key_def *key_def = index->def->key_def;
+	if (index->def->type == TREE &&
+	    (key_def->is_multikey || key_def->for_func_index)) {
+		/*
+		 * The build of such indexes doesn't check unique
+		 * constraints, so insert tuples one by one.
+		 */
+		for (uint32_t i = 0; i < count; i++) {
+			struct tuple *unused;
+			if (index_replace(index, NULL, tuples[i],
+					  DUP_INSERT, &unused) != 0)
+				return -1;
+		}
+		return 0;
+	}
+	index_begin_build(index);
+	if (index_reserve(index, count) != 0)
+		return -1;
+	for (uint32_t i = 0; i < count; i++) {
+		if (index_build_next(index, tuples[i]) != 0)
+			return -1;
+	}
+	if (index->def->type == TREE &&
+	    (memtx_tree_index_sort_build_array(index, space_name(space)) != 0 ||
+	     memtx_tree_index_reserve_build(index) != 0))
+		return -1;
+	return index_end_build(index);
+}
+
+/* Remove the tuples from the first index_count indexes of a space. */
+static void
+memtx_space_bulk_unload(struct space *space, uint32_t index_count,
+			struct tuple **tuples, uint32_t count)
+{
+	/*
+	 * A tuple that failed to be added to an index can't be
+	 * removed from it either. Ignore such errors and keep
+	 * the original one.
+	 */
+	struct diag diag;
+	diag_create(&diag);
+	diag_move(diag_get(), &diag);
+	for (uint32_t i = 0; i < index_count; i++) {
+		struct index *index = space->index[i];
+		for (uint32_t j = 0; j < count; j++) {
+			struct tuple *unused;
+			(void)index_replace(index, tuples[j], NULL,
+					    DUP_REPLACE_OR_INSERT, &unused);
+		}
+	}
+	diag_move(&diag, diag_get());
+	diag_destroy(&diag);
+}
+
+int
+memtx_space_begin_bulk_load(struct space *space, struct tuple **tuples,
+			    uint32_t count)
+{
+	struct memtx_space *memtx_space = (struct memtx_space *)space;
+	if (memtx_space->replace == memtx_space_replace_bulk_load) {
+		diag_set(ClientError, ER_SPACE_BULK_LOAD, space_name(space));
+		return -1;
+	}
+	if (memtx_space_is_recovering(space)) {
+		diag_set(ClientError, ER_UNSUPPORTED, "Bulk load",
+			 "recovery");
+		return -1;
+	}
+	struct index *pk = index_find(space, 0);
+	if (pk == NULL)
+		return -1;
+	assert(memtx_space->replace == memtx_space_replace_all_keys);
+	if (index_size(pk) != 0) {
+		diag_set(ClientError, ER_UNSUPPORTED, "Bulk load",
+			 "non-empty spaces");
+		return -1;
+	}
+	/* The space format may have changed since the tuples were made. */
+	for (uint32_t i = 0; i < count; i++) {
+		if (tuple_format(tuples[i]) != space->format &&
+		    tuple_validate(space->format, tuples[i]) != 0)
+			return -1;
+	}
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		if (memtx_space_bulk_load_index(space, space->index[i],
+						tuples, count) != 0) {
+			memtx_space_bulk_unload(space, i + 1, tuples, count);
+			return -1;
+		}
+	}
+	/*
+	 * All tuples stored in a memtx space must be
+	 * referenced by the primary index.
+	 */
+	for (uint32_t i = 0; i < count; i++) {
+		memtx_space_update_bsize(space, NULL, tuples[i]);
+		tuple_ref(tuples[i]);
+	}
+	memtx_space->replace = memtx_space_replace_bulk_load;
+	return 0;
+}
+
+void
+memtx_space_end_bulk_load(struct space *space, struct tuple **tuples,
+			  uint32_t count, uint32_t logged_count)
+{
+	struct memtx_space *memtx_space = (struct memtx_space *)space;
+	assert(memtx_space->replace == memtx_space_replace_bulk_load);
+	assert(logged_count <= count);
+	memtx_space_bulk_unload(space, space->index_count,
+				tuples + logged_count, count - logged_count);
+	for (uint32_t i = logged_count; i < count; i++) {
+		memtx_space_update_bsize(space, tuples[i], NULL);
+		tuple_unref(tuples[i]);
+	}
+	memtx_space->replace = memtx_space_replace_all_keys;
+}
+
+/* }}} Bulk load */
+
 static const struct space_vtab memtx_space_vtab = {
 	/* .destroy = */ memtx_space_destroy,
 	/* .bsize = */ memtx_space_bsize,
@@ -1173,6 +1655,7 @@ static const struct space_vtab memtx_space_vtab = {
 	/* .execute_delete = */ memtx_space_execute_delete,
 	/* .execute_update = */ memtx_space_execute_update,
 	/* .execute_upsert = */ memtx_space_execute_upsert,
+	/* .execute_delete_range = */ generic_space_execute_delete_range,
 	/* .ephemeral_replace = */ memtx_space_ephemeral_replace,
 	/* .ephemeral_delete = */ memtx_space_ephemeral_delete,
 	/* .ephemeral_rowid_next = */ memtx_space_ephemeral_rowid_next,
@@ -1211,7 +1694,8 @@ memtx_space_new(struct memtx_engine *memtx,
 		tuple_format_new(&memtx_tuple_format_vtab, memtx, keys, key_count,
 				 def->fields, def->field_count,
 				 def->exact_field_count, def->dict,
-				 def->opts.is_temporary, def->opts.is_ephemeral);
+				 def->opts.is_temporary, def->opts.is_ephemeral,
+				 def->opts.full_field_map);
 	if (format == NULL) {
 		free(memtx_space);
 		return NULL;
@@ -88,6 +88,27 @@ struct space *
 memtx_space_new(struct memtx_engine *memtx,
 		struct space_def *def, struct rlist *key_list);
 
+/**
+ * Load tuples into an empty memtx space bypassing transactions:
+ * all indexes are built from the given tuples at once, the way
+ * they are built on recovery. The tuples must be created with
+ * the space format. Until memtx_space_end_bulk_load() is called,
+ * the space can't be changed or altered: the caller is supposed
+ * to write the tuples to WAL meanwhile.
+ */
+int
+memtx_space_begin_bulk_load(struct space *space, struct tuple **tuples,
+			    uint32_t count);
+
+/**
+ * Finish a bulk load started with memtx_space_begin_bulk_load().
+ * The first @a logged_count tuples stay in the space, the rest,
+ * which failed to be written to WAL, are removed from it.
+ */
+void
+memtx_space_end_bulk_load(struct space *space, struct tuple **tuples,
+			  uint32_t count, uint32_t logged_count);
+
 static inline bool
 memtx_space_is_recovering(struct space *space)
 {
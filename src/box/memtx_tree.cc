@@ -117,6 +117,7 @@ memtx_tree_data_is_equal(const struct memtx_tree_data_common *a,
 			       (b)->part_count, (b)->hint, arg)
 #define BPS_TREE_IS_IDENTICAL(a, b) memtx_tree_data_is_equal(&a, &b)
 #define BPS_TREE_NO_DEBUG 1
+#define BPS_INNER_CARD
 #define bps_tree_arg_t struct key_def *
 
 #define BPS_TREE_NAMESPACE NS_NO_HINT
@@ -146,6 +147,7 @@ memtx_tree_data_is_equal(const struct memtx_tree_data_common *a,
 #undef BPS_TREE_COMPARE_KEY
 #undef BPS_TREE_IS_IDENTICAL
 #undef BPS_TREE_NO_DEBUG
+#undef BPS_INNER_CARD
 #undef bps_tree_arg_t
 
 using namespace NS_NO_HINT;
@@ -179,6 +181,22 @@ struct memtx_tree_iterator_selector<true> {
 template <bool USE_HINT>
 using memtx_tree_iterator_t = typename memtx_tree_iterator_selector<USE_HINT>::type;
 
+template <bool USE_HINT>
+struct memtx_tree_view_selector;
+
+template <>
+struct memtx_tree_view_selector<false> {
+	using type = NS_NO_HINT::memtx_tree_view;
+};
+
+template <>
+struct memtx_tree_view_selector<true> {
+	using type = NS_USE_HINT::memtx_tree_view;
+};
+
+template <bool USE_HINT>
+using memtx_tree_view_t = typename memtx_tree_view_selector<USE_HINT>::type;
+
 static void
 invalidate_tree_iterator(NS_NO_HINT::memtx_tree_iterator *itr)
 {
@@ -197,6 +215,8 @@ struct memtx_tree_index {
 	memtx_tree_t<USE_HINT> tree;
 	struct memtx_tree_data<USE_HINT> *build_array;
 	size_t build_array_size, build_array_alloc_size;
+	/** Set if build_array was sorted in advance, see end_build. */
+	bool build_array_is_sorted;
 	struct memtx_gc_task gc_task;
 	memtx_tree_iterator_t<USE_HINT> gc_iterator;
 };
@@ -479,6 +499,48 @@ tree_iterator_set_next_method(struct tree_iterator<USE_HINT> *it)
 	}
 }
 
+/**
+ * Fetch the first tuple of an iterator from the element the tree
+ * iterator points to and set the method for the following tuples.
+ */
+template <bool USE_HINT>
+static int
+tree_iterator_start_at(struct iterator *iterator, struct tuple **ret)
+{
+	*ret = NULL;
+	struct memtx_tree_index<USE_HINT> *index =
+		(struct memtx_tree_index<USE_HINT> *)iterator->index;
+	struct tree_iterator<USE_HINT> *it = get_tree_iterator<USE_HINT>(iterator);
+	it->base.next = tree_iterator_dummie;
+	memtx_tree_t<USE_HINT> *tree = &index->tree;
+	assert(it->current.tuple == NULL);
+	struct memtx_tree_data<USE_HINT> *res =
+		memtx_tree_iterator_get_elem(tree, &it->tree_iterator);
+	if (!res)
+		return 0;
+	*ret = res->tuple;
+	tuple_ref(*ret);
+	it->current = *res;
+	tree_iterator_set_next_method(it);
+
+	uint32_t iid = iterator->index->def->iid;
+	bool is_multikey = iterator->index->def->key_def->is_multikey;
+	struct txn *txn = in_txn();
+	struct space *space = space_by_id(iterator->space_id);
+	bool is_rw = txn != NULL;
+	uint32_t mk_index = is_multikey ? (uint32_t)res->hint : 0;
+	*ret = memtx_tx_tuple_clarify(txn, space, *ret, iid, mk_index, is_rw);
+	if (*ret == NULL) {
+		return iterator->next(iterator, ret);
+	} else {
+		tuple_unref(it->current.tuple);
+		it->current.tuple = *ret;
+		tuple_ref(it->current.tuple);
+	}
+
+	return 0;
+}
+
 template <bool USE_HINT>
 static int
 tree_iterator_start(struct iterator *iterator, struct tuple **ret)
@@ -492,6 +554,18 @@ tree_iterator_start(struct iterator *iterator, struct tuple **ret)
 	enum iterator_type type = it->type;
 	bool exact = false;
 	assert(it->current.tuple == NULL);
+	struct txn *txn = in_txn();
+	if (memtx_tx_manager_use_mvcc_engine && txn != NULL) {
+		/*
+		 * Track the whole requested range: the iterator may
+		 * be advanced beyond any point we could record now.
+		 */
+		struct space *space = space_by_id(iterator->space_id);
+		if (memtx_tx_track_range(txn, space, iterator->index, type,
+					 it->key_data.key,
+					 it->key_data.part_count) != 0)
+			return -1;
+	}
 	if (it->key_data.key == 0) {
 		if (iterator_type_is_reverse(it->type))
 			it->tree_iterator = memtx_tree_iterator_last(tree);
@@ -527,32 +601,7 @@ tree_iterator_start(struct iterator *iterator, struct tuple **ret)
 			memtx_tree_iterator_prev(tree, &it->tree_iterator);
 		}
 	}
-
-	struct memtx_tree_data<USE_HINT> *res =
-		memtx_tree_iterator_get_elem(tree, &it->tree_iterator);
-	if (!res)
-		return 0;
-	*ret = res->tuple;
-	tuple_ref(*ret);
-	it->current = *res;
-	tree_iterator_set_next_method(it);
-
-	uint32_t iid = iterator->index->def->iid;
-	bool is_multikey = iterator->index->def->key_def->is_multikey;
-	struct txn *txn = in_txn();
-	struct space *space = space_by_id(iterator->space_id);
-	bool is_rw = txn != NULL;
-	uint32_t mk_index = is_multikey ? (uint32_t)res->hint : 0;
-	*ret = memtx_tx_tuple_clarify(txn, space, *ret, iid, mk_index, is_rw);
-	if (*ret == NULL) {
-		return iterator->next(iterator, ret);
-	} else {
-		tuple_unref(it->current.tuple);
-		it->current.tuple = *ret;
-		tuple_ref(it->current.tuple);
-	}
-
-	return 0;
+	return tree_iterator_start_at<USE_HINT>(iterator, ret);
 }
 
 /* }}} */
@@ -628,6 +677,7 @@ memtx_tree_index_destroy(struct index *base)
 	struct memtx_tree_index<USE_HINT> *index =
 		(struct memtx_tree_index<USE_HINT> *)base;
 	struct memtx_engine *memtx = (struct memtx_engine *)base->engine;
+	memtx_tx_on_index_delete(base);
 	if (base->def->iid == 0) {
 		/*
 		 * Primary index. We need to free all tuples stored
@@ -700,6 +750,44 @@ memtx_tree_index_random(struct index *base, uint32_t rnd, struct tuple **result)
 	return 0;
 }
 
+/**
+ * Find the range [*begin, *end) of offsets of the tree elements
+ * an iterator of the given type and key would visit.
+ */
+template <bool USE_HINT>
+static void
+memtx_tree_range(memtx_tree_t<USE_HINT> *tree, enum iterator_type type,
+		 struct memtx_tree_key_data<USE_HINT> *key_data,
+		 size_t *begin, size_t *end)
+{
+	*begin = 0;
+	*end = memtx_tree_size(tree);
+	if (key_data->key == NULL)
+		return;
+	switch (type) {
+	case ITER_EQ:
+	case ITER_REQ:
+		memtx_tree_lower_bound_get_offset(tree, key_data, NULL, begin);
+		memtx_tree_upper_bound_get_offset(tree, key_data, NULL, end);
+		break;
+	case ITER_ALL:
+	case ITER_GE:
+		memtx_tree_lower_bound_get_offset(tree, key_data, NULL, begin);
+		break;
+	case ITER_GT:
+		memtx_tree_upper_bound_get_offset(tree, key_data, NULL, begin);
+		break;
+	case ITER_LE:
+		memtx_tree_upper_bound_get_offset(tree, key_data, NULL, end);
+		break;
+	case ITER_LT:
+		memtx_tree_lower_bound_get_offset(tree, key_data, NULL, end);
+		break;
+	default:
+		unreachable();
+	}
+}
+
 template <bool USE_HINT>
 static ssize_t
 memtx_tree_index_count(struct index *base, enum iterator_type type,
@@ -707,7 +795,26 @@ memtx_tree_index_count(struct index *base, enum iterator_type type,
 {
 	if (type == ITER_ALL)
 		return memtx_tree_index_size<USE_HINT>(base); /* optimization */
-	return generic_index_count(base, type, key, part_count);
+	/*
+	 * Tuples invisible to the current transaction are stored
+	 * in the tree as well, so they can't be counted by offsets.
+	 */
+	if (memtx_tx_manager_use_mvcc_engine || type > ITER_GT)
+		return generic_index_count(base, type, key, part_count);
+	if (part_count == 0)
+		return memtx_tree_index_size<USE_HINT>(base);
+	struct memtx_tree_index<USE_HINT> *index =
+		(struct memtx_tree_index<USE_HINT> *)base;
+	struct key_def *cmp_def = memtx_tree_cmp_def(&index->tree);
+	struct memtx_tree_key_data<USE_HINT> key_data;
+	key_data.key = key;
+	key_data.part_count = part_count;
+	if (USE_HINT)
+		key_data.set_hint(key_hint(key, part_count, cmp_def));
+	size_t begin, end;
+	memtx_tree_range<USE_HINT>(&index->tree, type, &key_data,
+				   &begin, &end);
+	return end - begin;
 }
 
 template <bool USE_HINT>
@@ -727,17 +834,22 @@ memtx_tree_index_get(struct index *base, const char *key,
 		key_data.set_hint(key_hint(key, part_count, cmp_def));
 	struct memtx_tree_data<USE_HINT> *res =
 		memtx_tree_find(&index->tree, &key_data);
-	if (res == NULL) {
-		*result = NULL;
-		return 0;
-	}
 	struct txn *txn = in_txn();
 	struct space *space = space_by_id(base->def->space_id);
-	bool is_rw = txn != NULL;
-	bool is_multikey = base->def->key_def->is_multikey;
-	uint32_t mk_index = is_multikey ? (uint32_t)res->hint : 0;
-	*result = memtx_tx_tuple_clarify(txn, space, res->tuple, base->def->iid,
-					 mk_index, is_rw);
+	*result = NULL;
+	if (res != NULL) {
+		bool is_rw = txn != NULL;
+		bool is_multikey = base->def->key_def->is_multikey;
+		uint32_t mk_index = is_multikey ? (uint32_t)res->hint : 0;
+		*result = memtx_tx_tuple_clarify(txn, space, res->tuple,
+						 base->def->iid, mk_index,
+						 is_rw);
+	}
+	/* Nothing found: remember the gap to catch a phantom insert. */
+	if (*result == NULL && memtx_tx_manager_use_mvcc_engine &&
+	    memtx_tx_track_range(txn, space, base, ITER_EQ,
+				 key, part_count) != 0)
+		return -1;
 	return 0;
 }
 
@@ -1223,6 +1335,43 @@ memtx_tree_index_create_iterator(struct index *base, enum iterator_type type,
 	return (struct iterator *)it;
 }
 
+template <bool USE_HINT>
+static struct iterator *
+memtx_tree_index_create_iterator_with_offset(struct index *base,
+					     enum iterator_type type,
+					     const char *key,
+					     uint32_t part_count,
+					     uint32_t offset)
+{
+	/*
+	 * With MVCC the number of tuples to skip can't be found
+	 * without checking visibility of each of them.
+	 */
+	if (offset == 0 || memtx_tx_manager_use_mvcc_engine)
+		return generic_index_create_iterator_with_offset(base, type,
+				key, part_count, offset);
+	struct memtx_tree_index<USE_HINT> *index =
+		(struct memtx_tree_index<USE_HINT> *)base;
+	struct iterator *iterator =
+		memtx_tree_index_create_iterator<USE_HINT>(base, type, key,
+							   part_count);
+	if (iterator == NULL)
+		return NULL;
+	struct tree_iterator<USE_HINT> *it = get_tree_iterator<USE_HINT>(iterator);
+	size_t begin, end;
+	memtx_tree_range<USE_HINT>(&index->tree, it->type, &it->key_data,
+				   &begin, &end);
+	if (offset >= end - begin) {
+		iterator->next = tree_iterator_dummie;
+		return iterator;
+	}
+	size_t pos = iterator_type_is_reverse(it->type) ?
+		     end - 1 - offset : begin + offset;
+	it->tree_iterator = memtx_tree_iterator_at(&index->tree, pos);
+	iterator->next = tree_iterator_start_at<USE_HINT>;
+	return iterator;
+}
+
 template <bool USE_HINT>
 static void
 memtx_tree_index_begin_build(struct index *base)
@@ -1230,7 +1379,9 @@ memtx_tree_index_begin_build(struct index *base)
 	struct memtx_tree_index<USE_HINT> *index =
 		(struct memtx_tree_index<USE_HINT> *)base;
 	assert(memtx_tree_size(&index->tree) == 0);
-	(void)index;
+	/* Drop leftovers of a previous failed build, if any. */
+	index->build_array_size = 0;
+	index->build_array_is_sorted = false;
 }
 
 template <bool USE_HINT>
@@ -1397,15 +1548,17 @@ memtx_tree_index_build_array_deduplicate(struct memtx_tree_index<USE_HINT> *inde
 }
 
 template <bool USE_HINT>
-static void
+static int
 memtx_tree_index_end_build(struct index *base)
 {
 	struct memtx_tree_index<USE_HINT> *index =
 		(struct memtx_tree_index<USE_HINT> *)base;
 	struct key_def *cmp_def = memtx_tree_cmp_def(&index->tree);
-	qsort_arg(index->build_array, index->build_array_size,
-		  sizeof(index->build_array[0]),
-		  memtx_tree_qcompare<USE_HINT>, cmp_def);
+	if (!index->build_array_is_sorted) {
+		qsort_arg(index->build_array, index->build_array_size,
+			  sizeof(index->build_array[0]),
+			  memtx_tree_qcompare<USE_HINT>, cmp_def);
+	}
 	if (cmp_def->is_multikey) {
 		/*
 		 * Multikey index may have equal(in terms of
@@ -1419,13 +1572,73 @@ memtx_tree_index_end_build(struct index *base)
 		memtx_tree_index_build_array_deduplicate<USE_HINT>(index,
 							 tuple_chunk_delete);
 	}
-	memtx_tree_build(&index->tree, index->build_array,
-			 index->build_array_size);
-
+	/*
+	 * Can't fail if the caller reserved extents with
+	 * memtx_tree_index_reserve_build().
+	 */
+	int rc = memtx_tree_build(&index->tree, index->build_array,
+				  index->build_array_size);
+	if (rc != 0 && cmp_def->for_func_index) {
+		/* The tree didn't take ownership of functional keys. */
+		for (size_t i = 0; i < index->build_array_size; i++) {
+			tuple_chunk_delete(index->build_array[i].tuple,
+				(const char *)index->build_array[i].hint);
+		}
+	}
 	free(index->build_array);
 	index->build_array = NULL;
 	index->build_array_size = 0;
 	index->build_array_alloc_size = 0;
+	index->build_array_is_sorted = false;
+	return rc;
+}
+
+template <bool USE_HINT>
+static int
+memtx_tree_index_sort_build_array_tpl(struct index *base,
+				      const char *space_name)
+{
+	struct memtx_tree_index<USE_HINT> *index =
+		(struct memtx_tree_index<USE_HINT> *)base;
+	struct key_def *cmp_def = memtx_tree_cmp_def(&index->tree);
+	assert(!cmp_def->is_multikey && !cmp_def->for_func_index);
+	qsort_arg(index->build_array, index->build_array_size,
+		  sizeof(index->build_array[0]),
+		  memtx_tree_qcompare<USE_HINT>, cmp_def);
+	index->build_array_is_sorted = true;
+	if (!base->def->opts.is_unique)
+		return 0;
+	/*
+	 * Tuples with equal keys are adjacent in the sorted
+	 * array, because the key definition is a prefix of
+	 * the comparison definition.
+	 */
+	struct key_def *key_def = base->def->key_def;
+	for (size_t i = 1; i < index->build_array_size; i++) {
+		struct tuple *tuple = index->build_array[i].tuple;
+		if (tuple_compare(index->build_array[i - 1].tuple, HINT_NONE,
+				  tuple, HINT_NONE, key_def) != 0)
+			continue;
+		if (key_def->is_nullable &&
+		    tuple_key_contains_null(tuple, key_def, MULTIKEY_NONE))
+			continue;
+		diag_set(ClientError, ER_TUPLE_FOUND, base->def->name,
+			 space_name);
+		return -1;
+	}
+	return 0;
+}
+
+template <bool USE_HINT>
+static int
+memtx_tree_index_reserve_build_tpl(struct index *base)
+{
+	struct memtx_tree_index<USE_HINT> *index =
+		(struct memtx_tree_index<USE_HINT> *)base;
+	struct memtx_engine *memtx = (struct memtx_engine *)base->engine;
+	size_t extents = memtx_tree_build_extent_count(&index->tree,
+						index->build_array_size);
+	return memtx_index_extent_reserve(memtx, (int)extents);
 }
 
 template <bool USE_HINT>
@@ -1539,8 +1752,11 @@ static const struct index_vtab memtx_tree_no_hint_index_vtab = {
 	/* .random = */ memtx_tree_index_random<false>,
 	/* .count = */ memtx_tree_index_count<false>,
 	/* .get = */ memtx_tree_index_get<false>,
+	/* .get_many = */ generic_index_get_many,
 	/* .replace = */ memtx_tree_index_replace<false>,
 	/* .create_iterator = */ memtx_tree_index_create_iterator<false>,
+	/* .create_iterator_with_offset = */
+		memtx_tree_index_create_iterator_with_offset<false>,
 	/* .create_snapshot_iterator = */
 		memtx_tree_index_create_snapshot_iterator<false>,
 	/* .stat = */ generic_index_stat,
@@ -1569,8 +1785,11 @@ static const struct index_vtab memtx_tree_use_hint_index_vtab = {
 	/* .random = */ memtx_tree_index_random<true>,
 	/* .count = */ memtx_tree_index_count<true>,
 	/* .get = */ memtx_tree_index_get<true>,
+	/* .get_many = */ generic_index_get_many,
 	/* .replace = */ memtx_tree_index_replace<true>,
 	/* .create_iterator = */ memtx_tree_index_create_iterator<true>,
+	/* .create_iterator_with_offset = */
+		memtx_tree_index_create_iterator_with_offset<true>,
 	/* .create_snapshot_iterator = */
 		memtx_tree_index_create_snapshot_iterator<true>,
 	/* .stat = */ generic_index_stat,
@@ -1599,8 +1818,11 @@ static const struct index_vtab memtx_tree_index_multikey_vtab = {
 	/* .random = */ memtx_tree_index_random<true>,
 	/* .count = */ memtx_tree_index_count<true>,
 	/* .get = */ memtx_tree_index_get<true>,
+	/* .get_many = */ generic_index_get_many,
 	/* .replace = */ memtx_tree_index_replace_multikey,
 	/* .create_iterator = */ memtx_tree_index_create_iterator<true>,
+	/* .create_iterator_with_offset = */
+		memtx_tree_index_create_iterator_with_offset<true>,
 	/* .create_snapshot_iterator = */
 		memtx_tree_index_create_snapshot_iterator<true>,
 	/* .stat = */ generic_index_stat,
@@ -1629,8 +1851,11 @@ static const struct index_vtab memtx_tree_func_index_vtab = {
 	/* .random = */ memtx_tree_index_random<true>,
 	/* .count = */ memtx_tree_index_count<true>,
 	/* .get = */ memtx_tree_index_get<true>,
+	/* .get_many = */ generic_index_get_many,
 	/* .replace = */ memtx_tree_func_index_replace,
 	/* .create_iterator = */ memtx_tree_index_create_iterator<true>,
+	/* .create_iterator_with_offset = */
+		memtx_tree_index_create_iterator_with_offset<true>,
 	/* .create_snapshot_iterator = */
 		memtx_tree_index_create_snapshot_iterator<true>,
 	/* .stat = */ generic_index_stat,
@@ -1665,8 +1890,11 @@ static const struct index_vtab memtx_tree_disabled_index_vtab = {
 	/* .random = */ generic_index_random,
 	/* .count = */ generic_index_count,
 	/* .get = */ generic_index_get,
+	/* .get_many = */ generic_index_get_many,
 	/* .replace = */ disabled_index_replace,
 	/* .create_iterator = */ generic_index_create_iterator,
+	/* .create_iterator_with_offset = */
+		generic_index_create_iterator_with_offset,
 	/* .create_snapshot_iterator = */
 		generic_index_create_snapshot_iterator,
 	/* .stat = */ generic_index_stat,
@@ -1726,3 +1954,205 @@ memtx_tree_index_new(struct memtx_engine *memtx, struct index_def *def)
 	}
 	return memtx_tree_index_new_tpl<true>(memtx, def, vtab);
 }
+
+/* {{{ Read views *************************************************/
+
+struct memtx_tree_read_view {
+	/** Index the view was created for, referenced. */
+	struct index *index;
+	/**
+	 * Copy of the index definition. The index definition may
+	 * be updated by tx while the view is in use, so lookups
+	 * use the copy.
+	 */
+	struct index_def *def;
+	/** Filters out dirty tuples, see memtx_tx_snapshot_clarify(). */
+	struct memtx_tx_snapshot_cleaner cleaner;
+	/** Type specific implementation of the select. */
+	int (*select)(struct memtx_tree_read_view *view,
+		      enum iterator_type type, const char *key,
+		      uint32_t part_count, uint32_t offset, uint32_t limit,
+		      memtx_tree_read_view_select_f cb, void *arg);
+	/** Type specific destructor of the tree view. */
+	void (*destroy)(struct memtx_tree_read_view *view);
+};
+
+template <bool USE_HINT>
+struct memtx_tree_read_view_impl {
+	struct memtx_tree_read_view base;
+	memtx_tree_view_t<USE_HINT> tree_view;
+};
+
+template <bool USE_HINT>
+static int
+memtx_tree_read_view_select_tpl(struct memtx_tree_read_view *base,
+				enum iterator_type type, const char *key,
+				uint32_t part_count, uint32_t offset,
+				uint32_t limit, memtx_tree_read_view_select_f cb,
+				void *arg)
+{
+	struct memtx_tree_read_view_impl<USE_HINT> *view =
+		(struct memtx_tree_read_view_impl<USE_HINT> *)base;
+	struct memtx_tree_index<USE_HINT> *index =
+		(struct memtx_tree_index<USE_HINT> *)base->index;
+	memtx_tree_t<USE_HINT> *tree = &index->tree;
+	struct key_def *cmp_def = view->tree_view.arg;
+	assert(memtx_tree_read_view_supports(type));
+
+	struct memtx_tree_key_data<USE_HINT> key_data;
+	key_data.key = key;
+	key_data.part_count = part_count;
+	if (USE_HINT)
+		key_data.set_hint(key_hint(key, part_count, cmp_def));
+
+	memtx_tree_iterator_t<USE_HINT> itr;
+	if (part_count == 0) {
+		type = ITER_ALL;
+		itr = memtx_tree_view_first(&view->tree_view);
+	} else if (type == ITER_GT) {
+		itr = memtx_tree_view_upper_bound(tree, &view->tree_view,
+						  &key_data, NULL);
+	} else {
+		itr = memtx_tree_view_lower_bound(tree, &view->tree_view,
+						  &key_data, NULL);
+	}
+	for (; limit > 0; memtx_tree_view_iterator_next(tree, &view->tree_view,
+							&itr)) {
+		struct memtx_tree_data<USE_HINT> *res =
+			memtx_tree_view_iterator_get_elem(tree,
+							  &view->tree_view,
+							  &itr);
+		if (res == NULL)
+			break;
+		if (type == ITER_EQ &&
+		    tuple_compare_with_key(res->tuple, res->hint, key,
+					   part_count, key_data.hint,
+					   cmp_def) != 0)
+			break;
+		struct tuple *tuple =
+			memtx_tx_snapshot_clarify(&base->cleaner, res->tuple);
+		if (tuple == NULL)
+			continue;
+		if (offset > 0) {
+			offset--;
+			continue;
+		}
+		int rc = cb(tuple, arg);
+		if (rc != 0)
+			return rc;
+		limit--;
+	}
+	return 0;
+}
+
+template <bool USE_HINT>
+static void
+memtx_tree_read_view_destroy_tpl(struct memtx_tree_read_view *base)
+{
+	struct memtx_tree_read_view_impl<USE_HINT> *view =
+		(struct memtx_tree_read_view_impl<USE_HINT> *)base;
+	struct memtx_tree_index<USE_HINT> *index =
+		(struct memtx_tree_index<USE_HINT> *)base->index;
+	memtx_tree_view_destroy(&index->tree, &view->tree_view);
+}
+
+template <bool USE_HINT>
+static struct memtx_tree_read_view *
+memtx_tree_read_view_new_tpl(struct index *base)
+{
+	struct memtx_tree_index<USE_HINT> *index =
+		(struct memtx_tree_index<USE_HINT> *)base;
+	struct memtx_tree_read_view_impl<USE_HINT> *view =
+		(struct memtx_tree_read_view_impl<USE_HINT> *)
+		calloc(1, sizeof(*view));
+	if (view == NULL) {
+		diag_set(OutOfMemory, sizeof(*view),
+			 "malloc", "struct memtx_tree_read_view");
+		return NULL;
+	}
+	view->base.def = index_def_dup(base->def);
+	if (view->base.def == NULL) {
+		free(view);
+		return NULL;
+	}
+	struct space *space = space_cache_find(base->def->space_id);
+	if (space == NULL ||
+	    memtx_tx_snapshot_cleaner_create(&view->base.cleaner, space,
+					     "memtx_tree_read_view") != 0) {
+		index_def_delete(view->base.def);
+		free(view);
+		return NULL;
+	}
+	/* See comment to memtx_tree_index_update_def(). */
+	struct index_def *def = view->base.def;
+	struct key_def *cmp_def = def->opts.is_unique &&
+				  !def->key_def->is_nullable ?
+				  def->key_def : def->cmp_def;
+	view->base.index = base;
+	view->base.select = memtx_tree_read_view_select_tpl<USE_HINT>;
+	view->base.destroy = memtx_tree_read_view_destroy_tpl<USE_HINT>;
+	index_ref(base);
+	memtx_tree_view_create(&index->tree, &view->tree_view, cmp_def);
+	memtx_enter_delayed_free_mode((struct memtx_engine *)base->engine);
+	return &view->base;
+}
+
+int
+memtx_tree_index_sort_build_array(struct index *index, const char *space_name)
+{
+	if (index->vtab == &memtx_tree_no_hint_index_vtab)
+		return memtx_tree_index_sort_build_array_tpl<false>(index,
+								    space_name);
+	assert(index->vtab == &memtx_tree_use_hint_index_vtab);
+	return memtx_tree_index_sort_build_array_tpl<true>(index, space_name);
+}
+
+int
+memtx_tree_index_reserve_build(struct index *index)
+{
+	if (index->vtab == &memtx_tree_no_hint_index_vtab)
+		return memtx_tree_index_reserve_build_tpl<false>(index);
+	return memtx_tree_index_reserve_build_tpl<true>(index);
+}
+
+struct memtx_tree_read_view *
+memtx_tree_read_view_new(struct index *index)
+{
+	if (index->vtab == &memtx_tree_no_hint_index_vtab)
+		return memtx_tree_read_view_new_tpl<false>(index);
+	if (index->vtab == &memtx_tree_use_hint_index_vtab)
+		return memtx_tree_read_view_new_tpl<true>(index);
+	diag_set(UnsupportedIndexFeature, index->def, "read view");
+	return NULL;
+}
+
+void
+memtx_tree_read_view_delete(struct memtx_tree_read_view *view)
+{
+	struct index *index = view->index;
+	view->destroy(view);
+	memtx_leave_delayed_free_mode((struct memtx_engine *)index->engine);
+	index_unref(index);
+	memtx_tx_snapshot_cleaner_destroy(&view->cleaner);
+	index_def_delete(view->def);
+	free(view);
+}
+
+struct index *
+memtx_tree_read_view_index(struct memtx_tree_read_view *view)
+{
+	return view->index;
+}
+
+int
+memtx_tree_read_view_select(struct memtx_tree_read_view *view,
+			    enum iterator_type type, const char *key,
+			    uint32_t part_count, uint32_t offset,
+			    uint32_t limit, memtx_tree_read_view_select_f cb,
+			    void *arg)
+{
+	return view->select(view, type, key, part_count, offset, limit,
+			    cb, arg);
+}
+
+/* }}} */
@@ -31,6 +31,10 @@
  * SUCH DAMAGE.
  */
 
+#include <stdint.h>
+
+#include "iterator_type.h"
+
 #if defined(__cplusplus)
 extern "C" {
 #endif /* defined(__cplusplus) */
@@ -38,10 +42,84 @@ extern "C" {
 struct index;
 struct index_def;
 struct memtx_engine;
+struct tuple;
+struct memtx_tree_read_view;
 
 struct index *
 memtx_tree_index_new(struct memtx_engine *memtx, struct index_def *def);
 
+/**
+ * Sort the tuples added to a tree index with index_build_next()
+ * so that index_end_build() only has to bulk load the tree.
+ * Doesn't touch the memtx arena and so may be called from any
+ * thread. Multikey and functional indexes aren't supported.
+ * Returns -1 and sets ER_TUPLE_FOUND if the index is unique and
+ * there are tuples with equal keys.
+ */
+int
+memtx_tree_index_sort_build_array(struct index *index, const char *space_name);
+
+/**
+ * Reserve memtx index extents needed by index_end_build() to
+ * build a tree index from the tuples added with index_build_next().
+ * Must be called right before index_end_build(), without yielding
+ * in between, because other fibers may use reserved extents.
+ */
+int
+memtx_tree_index_reserve_build(struct index *index);
+
+/**
+ * Create a frozen view of a memtx tree index. Lookups in the
+ * view don't touch the index and the tuple cache, so they may
+ * be done from any thread while tx keeps modifying the index.
+ * The view keeps the engine in the delayed free mode, so it
+ * must not live for too long. Returns NULL and sets diag if
+ * the index doesn't support read views (multikey and
+ * functional indexes don't).
+ *
+ * Must be called and destroyed in the tx thread.
+ */
+struct memtx_tree_read_view *
+memtx_tree_read_view_new(struct index *index);
+
+/** Destroy a read view created by memtx_tree_read_view_new(). */
+void
+memtx_tree_read_view_delete(struct memtx_tree_read_view *view);
+
+/** Index the read view was created for. */
+struct index *
+memtx_tree_read_view_index(struct memtx_tree_read_view *view);
+
+/**
+ * Callback invoked by memtx_tree_read_view_select() for each
+ * tuple matching the request. Non-zero return value stops the
+ * iteration and is returned by the select.
+ */
+typedef int
+(*memtx_tree_read_view_select_f)(struct tuple *tuple, void *arg);
+
+/**
+ * Select tuples from a read view. Only ITER_EQ, ITER_GE, ITER_GT
+ * and ITER_ALL are supported, see memtx_tree_read_view_supports().
+ * The key must be validated by the caller. Tuples passed to the
+ * callback stay valid until the view is destroyed, no reference
+ * is taken. Thread-safe.
+ */
+int
+memtx_tree_read_view_select(struct memtx_tree_read_view *view,
+			    enum iterator_type type, const char *key,
+			    uint32_t part_count, uint32_t offset,
+			    uint32_t limit, memtx_tree_read_view_select_f cb,
+			    void *arg);
+
+/** Check if a select with the given iterator type is supported. */
+static inline bool
+memtx_tree_read_view_supports(enum iterator_type type)
+{
+	return type == ITER_EQ || type == ITER_GE || type == ITER_GT ||
+	       type == ITER_ALL;
+}
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
@@ -33,10 +33,17 @@
 #include <assert.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
+#include "msgpuck.h"
+#include "fiber.h"
+#include "fiber_cond.h"
 #include "txn.h"
+#include "schema.h"
 #include "schema_def.h"
 #include "small/mempool.h"
+#include "info/info.h"
 
 static uint32_t
 memtx_tx_story_key_hash(const struct tuple *a)
@@ -75,6 +82,37 @@ struct tx_manager
 	struct rlist all_stories;
 	/** Iterator that sequentially traverses all memtx_story objects. */
 	struct rlist *traverse_all_stories;
+	/** Number of existing memtx_story objects. */
+	int64_t story_count;
+	/** Memory used by memtx_story objects, in bytes. */
+	int64_t story_memory;
+	/**
+	 * Soft limit of story_memory. New transactions are throttled
+	 * while it is exceeded. 0 means unlimited.
+	 */
+	int64_t story_memory_limit;
+	/** Number of tuples referenced by stories and history links. */
+	int64_t retained_tuples;
+	/** Number of transactions delayed by the story memory limit. */
+	int64_t throttle_count;
+	/** Fiber that collects stories in background. */
+	struct fiber *gc_fiber;
+	/** Set while the GC fiber has nothing to do. */
+	bool gc_is_idle;
+	/** Number of stories the GC fiber inspects before yielding. */
+	int gc_batch_size;
+	/** Number of stories deleted in the current GC pass. */
+	int64_t gc_pass_freed;
+	/** Number of stories deleted in the last complete GC pass. */
+	int64_t gc_last_pass_freed;
+	/** Signaled when the GC completes a pass over all stories. */
+	struct fiber_cond gc_cond;
+	/** Number of ranges tracked by in-progress transactions. */
+	int64_t range_count;
+	/** Number of transactions marked as conflicted. */
+	int64_t conflict_count;
+	/** Number of transactions sent to a read view. */
+	int64_t read_view_count;
 };
 
 enum {
@@ -84,14 +122,64 @@ enum {
 	 * a new story.
 	 */
 		TX_MANAGER_GC_STEPS_SIZE = 2,
+	/** Default number of GC steps per a GC fiber iteration. */
+	TX_MANAGER_GC_BATCH_SIZE_DEFAULT = 100,
 };
 
+/**
+ * How long the GC fiber sleeps if all stories are in use, seconds.
+ * A new story wakes it up earlier.
+ */
+static const double TX_MANAGER_GC_IDLE_TIMEOUT = 0.1;
+
 /** That's a definition, see declaration for description. */
 bool memtx_tx_manager_use_mvcc_engine = false;
 
 /** The one and only instance of tx_manager. */
 static struct tx_manager txm;
 
+/** See definition for details */
+static bool
+memtx_tx_story_gc_step();
+
+/**
+ * Body of the fiber that collects stories in background, inspecting
+ * at most gc_batch_size stories per event loop iteration.
+ */
+static int
+memtx_tx_gc_f(va_list ap)
+{
+	(void)ap;
+	while (!fiber_is_cancelled()) {
+		bool is_pass_complete = false;
+		for (int i = 0; i < txm.gc_batch_size && !is_pass_complete; i++)
+			is_pass_complete = memtx_tx_story_gc_step();
+		if (is_pass_complete && txm.gc_last_pass_freed == 0) {
+			/*
+			 * Remaining stories, if any, are used by
+			 * transactions or read views. Wait for them
+			 * to end or for new stories.
+			 */
+			txm.gc_is_idle = true;
+			fiber_yield_timeout(rlist_empty(&txm.all_stories) ?
+					    TIMEOUT_INFINITY :
+					    TX_MANAGER_GC_IDLE_TIMEOUT);
+			txm.gc_is_idle = false;
+			continue;
+		}
+		fiber_sleep(0);
+	}
+	return 0;
+}
+
+/** Wake up the GC fiber if it waits for work. */
+static inline void
+memtx_tx_gc_wakeup(void)
+{
+	if (txm.gc_is_idle)
+		fiber_wakeup(txm.gc_fiber);
+}
+
 void
 memtx_tx_manager_init()
 {
@@ -105,6 +193,13 @@ memtx_tx_manager_init()
 	txm.history = mh_history_new();
 	rlist_create(&txm.all_stories);
 	txm.traverse_all_stories = &txm.all_stories;
+	txm.gc_batch_size = TX_MANAGER_GC_BATCH_SIZE_DEFAULT;
+	fiber_cond_create(&txm.gc_cond);
+	txm.gc_fiber = fiber_new("memtx.tx_gc", memtx_tx_gc_f);
+	if (txm.gc_fiber == NULL)
+		panic("failed to start memtx transaction manager GC fiber");
+	txm.gc_is_idle = false;
+	fiber_wakeup(txm.gc_fiber);
 }
 
 void
@@ -161,6 +256,19 @@ memtx_tx_cause_conflict(struct txn *breaker, struct txn *victim)
 	return 0;
 }
 
+/**
+ * Mark transaction @a txn as conflicted: it will be aborted on
+ * commit attempt.
+ */
+static void
+memtx_tx_set_conflicted(struct txn *txn)
+{
+	if (txn->status == TXN_CONFLICTED)
+		return;
+	txn->status = TXN_CONFLICTED;
+	txm.conflict_count++;
+}
+
 void
 memtx_tx_handle_conflict(struct txn *breaker, struct txn *victim)
 {
@@ -174,15 +282,20 @@ memtx_tx_handle_conflict(struct txn *breaker, struct txn *victim)
 		victim->status = TXN_IN_READ_VIEW;
 		victim->rv_psn = breaker->psn;
 		rlist_add_tail(&txm.read_view_txs, &victim->in_read_view_txs);
+		txm.read_view_count++;
 	} else {
 		/* Mark as conflicted. */
-		victim->status = TXN_CONFLICTED;
+		memtx_tx_set_conflicted(victim);
 	}
 }
 
-/** See definition for details */
-static void
-memtx_tx_story_gc_step();
+/** Memory occupied by a story of a space with @a index_count indexes. */
+static inline size_t
+memtx_tx_story_size(uint32_t index_count)
+{
+	return sizeof(struct memtx_story) +
+	       index_count * sizeof(struct memtx_story_link);
+}
 
 /**
  * Create a new story and link it with the @a tuple.
@@ -191,19 +304,23 @@ memtx_tx_story_gc_step();
 static struct memtx_story *
 memtx_tx_story_new(struct space *space, struct tuple *tuple)
 {
-	/* Free some memory. */
-	for (size_t i = 0; i < TX_MANAGER_GC_STEPS_SIZE; i++)
-		memtx_tx_story_gc_step();
+	/*
+	 * Stories are collected by the GC fiber. Help it only if the
+	 * memory limit is exceeded, e.g. if writers don't yield.
+	 */
+	if (txm.story_memory_limit != 0 &&
+	    txm.story_memory > txm.story_memory_limit) {
+		for (size_t i = 0; i < TX_MANAGER_GC_STEPS_SIZE; i++)
+			memtx_tx_story_gc_step();
+	}
 	assert(!tuple->is_dirty);
 	uint32_t index_count = space->index_count;
 	assert(index_count < BOX_INDEX_MAX);
 	struct mempool *pool = &txm.memtx_tx_story_pool[index_count];
 	struct memtx_story *story = (struct memtx_story *) mempool_alloc(pool);
 	if (story == NULL) {
-		size_t item_size = sizeof(struct memtx_story) +
-				   index_count *
-				   sizeof(struct memtx_story_link);
-		diag_set(OutOfMemory, item_size, "mempool_alloc", "story");
+		diag_set(OutOfMemory, memtx_tx_story_size(index_count),
+			 "mempool_alloc", "story");
 		return NULL;
 	}
 	story->tuple = tuple;
@@ -220,6 +337,7 @@ memtx_tx_story_new(struct space *space, struct tuple *tuple)
 	}
 	tuple->is_dirty = true;
 	tuple_ref(tuple);
+	txm.retained_tuples++;
 
 	story->space = space;
 	story->index_count = index_count;
@@ -228,6 +346,10 @@ memtx_tx_story_new(struct space *space, struct tuple *tuple)
 	story->del_stmt = NULL;
 	story->del_psn = 0;
 	rlist_create(&story->reader_list);
+	story->create_time = ev_monotonic_now(loop());
+	txm.story_count++;
+	txm.story_memory += memtx_tx_story_size(index_count);
+	memtx_tx_gc_wakeup();
 	rlist_add_tail(&txm.all_stories, &story->in_all_stories);
 	rlist_add(&space->memtx_stories, &story->in_space_stories);
 	memset(story->link, 0, sizeof(story->link[0]) * index_count);
@@ -356,6 +478,7 @@ memtx_tx_story_link_tuple(struct memtx_story *story,
 	}
 	link->older.tuple = older_tuple;
 	tuple_ref(link->older.tuple);
+	txm.retained_tuples++;
 }
 
 /**
@@ -369,6 +492,7 @@ memtx_tx_story_unlink(struct memtx_story *story, uint32_t index)
 		link->older.story->link[index].newer_story = NULL;
 	} else if (link->older.tuple != NULL) {
 		tuple_unref(link->older.tuple);
+		txm.retained_tuples--;
 		link->older.tuple = NULL;
 	}
 	link->older.is_story = false;
@@ -378,14 +502,18 @@ memtx_tx_story_unlink(struct memtx_story *story, uint32_t index)
 /**
  * Run one step of a crawler that traverses all stories and removes no more
  * used stories.
+ * @return true if the crawler has completed a pass over all stories.
  */
-static void
+static bool
 memtx_tx_story_gc_step()
 {
 	if (txm.traverse_all_stories == &txm.all_stories) {
 		/* We came to the head of the list. */
 		txm.traverse_all_stories = txm.traverse_all_stories->next;
-		return;
+		txm.gc_last_pass_freed = txm.gc_pass_freed;
+		txm.gc_pass_freed = 0;
+		fiber_cond_broadcast(&txm.gc_cond);
+		return true;
 	}
 
 	/* Lowest read view PSN */
@@ -406,12 +534,12 @@ memtx_tx_story_gc_step()
 	if (story->add_stmt != NULL || story->del_stmt != NULL ||
 	    !rlist_empty(&story->reader_list)) {
 		/* The story is used directly by some transactions. */
-		return;
+		return false;
 	}
 	if (story->add_psn >= lowest_rv_psm ||
 	    story->del_psn >= lowest_rv_psm) {
 		/* The story can be used by a read view. */
-		return;
+		return false;
 	}
 
 	/* Unlink and delete the story */
@@ -462,6 +590,8 @@ memtx_tx_story_gc_step()
 	}
 
 	memtx_tx_story_delete(story);
+	txm.gc_pass_freed++;
+	return false;
 }
 
 /**
@@ -872,6 +1002,10 @@ memtx_tx_history_rollback_stmt(struct txn_stmt *stmt)
 	}
 }
 
+/** See definition for details */
+static void
+memtx_tx_handle_range_conflicts(struct txn_stmt *stmt);
+
 void
 memtx_tx_history_prepare_stmt(struct txn_stmt *stmt)
 {
@@ -922,7 +1056,7 @@ memtx_tx_history_prepare_stmt(struct txn_stmt *stmt)
 		}
 
 		if (old_story->add_stmt->does_require_old_tuple || i != 0)
-			old_story->add_stmt->txn->status = TXN_CONFLICTED;
+			memtx_tx_set_conflicted(old_story->add_stmt->txn);
 
 		/* Swap story and old story. */
 		struct memtx_story_link *link = &story->link[i];
@@ -978,7 +1112,7 @@ memtx_tx_history_prepare_stmt(struct txn_stmt *stmt)
 			assert(dels != NULL);
 			do {
 				if (dels->txn != stmt->txn)
-					dels->txn->status = TXN_CONFLICTED;
+					memtx_tx_set_conflicted(dels->txn);
 				dels->del_story = NULL;
 				struct txn_stmt *next = dels->next_in_del_list;
 				dels->next_in_del_list = NULL;
@@ -1022,6 +1156,7 @@ memtx_tx_history_prepare_stmt(struct txn_stmt *stmt)
 		stmt->del_story->del_stmt = stmt;
 		stmt->next_in_del_list = NULL;
 	}
+	memtx_tx_handle_range_conflicts(stmt);
 }
 
 ssize_t
@@ -1106,6 +1241,7 @@ memtx_tx_story_delete(struct memtx_story *story)
 
 	story->tuple->is_dirty = false;
 	tuple_unref(story->tuple);
+	txm.retained_tuples--;
 
 #ifndef NDEBUG
 	/* Expecting to delete fully unlinked story. */
@@ -1116,6 +1252,8 @@ memtx_tx_story_delete(struct memtx_story *story)
 	}
 #endif
 
+	txm.story_count--;
+	txm.story_memory -= memtx_tx_story_size(story->index_count);
 	struct mempool *pool = &txm.memtx_tx_story_pool[story->index_count];
 	mempool_free(pool, story);
 }
@@ -1190,6 +1328,441 @@ memtx_tx_track_read(struct txn *txn, struct space *space, struct tuple *tuple)
 	return 0;
 }
 
+/* {{{ Range read tracking *****************************************/
+
+/** Part count of an encoded key. */
+static inline uint32_t
+tx_range_key_part_count(const char *key)
+{
+	return mp_decode_array(&key);
+}
+
+/** Compare left ends of two ranges of the same index. */
+static int
+tx_range_cmpl(const struct tx_range_tracker *a,
+	      const struct tx_range_tracker *b)
+{
+	assert(a->index == b->index);
+	struct key_def *cmp_def = a->index->def->cmp_def;
+	int cmp = key_compare(a->left, HINT_NONE, b->left, HINT_NONE,
+			      cmp_def);
+	if (cmp != 0)
+		return cmp;
+	if (a->left_belongs && !b->left_belongs)
+		return -1;
+	if (!a->left_belongs && b->left_belongs)
+		return 1;
+	uint32_t a_parts = tx_range_key_part_count(a->left);
+	uint32_t b_parts = tx_range_key_part_count(b->left);
+	if (a->left_belongs)
+		return a_parts < b_parts ? -1 : a_parts > b_parts;
+	else
+		return a_parts > b_parts ? -1 : a_parts < b_parts;
+}
+
+/** Compare right ends of two ranges of the same index. */
+static int
+tx_range_cmpr(const struct tx_range_tracker *a,
+	      const struct tx_range_tracker *b)
+{
+	assert(a->index == b->index);
+	struct key_def *cmp_def = a->index->def->cmp_def;
+	int cmp = key_compare(a->right, HINT_NONE, b->right, HINT_NONE,
+			      cmp_def);
+	if (cmp != 0)
+		return cmp;
+	if (a->right_belongs && !b->right_belongs)
+		return 1;
+	if (!a->right_belongs && b->right_belongs)
+		return -1;
+	uint32_t a_parts = tx_range_key_part_count(a->right);
+	uint32_t b_parts = tx_range_key_part_count(b->right);
+	if (a->right_belongs)
+		return a_parts > b_parts ? -1 : a_parts < b_parts;
+	else
+		return a_parts < b_parts ? -1 : a_parts > b_parts;
+}
+
+/**
+ * Interval tree of ranges read from an index by all in-progress
+ * transactions. Sorted by the left end, then by reader, then by
+ * tracker address, because the same transaction may read
+ * intersecting or even equal ranges.
+ */
+typedef rb_tree(struct tx_range_tracker) tx_range_tree_t;
+
+static inline int
+tx_range_tree_cmp(const struct tx_range_tracker *a,
+		  const struct tx_range_tracker *b)
+{
+	int rc = tx_range_cmpl(a, b);
+	if (rc == 0)
+		rc = a->reader < b->reader ? -1 : a->reader > b->reader;
+	if (rc == 0)
+		rc = a < b ? -1 : a > b;
+	return rc;
+}
+
+static inline void
+tx_range_tree_aug(struct tx_range_tracker *node,
+		  const struct tx_range_tracker *left,
+		  const struct tx_range_tracker *right)
+{
+	node->subtree_last = node;
+	if (left != NULL &&
+	    tx_range_cmpr(left->subtree_last, node->subtree_last) > 0)
+		node->subtree_last = left->subtree_last;
+	if (right != NULL &&
+	    tx_range_cmpr(right->subtree_last, node->subtree_last) > 0)
+		node->subtree_last = right->subtree_last;
+}
+
+rb_gen_aug(MAYBE_UNUSED static inline, tx_range_tree_, tx_range_tree_t,
+	   struct tx_range_tracker, in_index, tx_range_tree_cmp,
+	   tx_range_tree_aug);
+
+/** Ranges read from an index, see index::tx_range_set. */
+struct memtx_tx_range_set {
+	tx_range_tree_t tree;
+};
+
+/** Key that stands for infinity: an empty msgpack array. */
+static const char tx_range_inf_key[] = { (char)0x90 };
+
+/** Check if two encoded keys are byte-wise equal. */
+static bool
+tx_range_key_is_equal(const char *a, const char *b)
+{
+	if (a == b)
+		return true;
+	const char *a_end = a, *b_end = b;
+	mp_next(&a_end);
+	mp_next(&b_end);
+	return a_end - a == b_end - b && memcmp(a, b, a_end - a) == 0;
+}
+
+int
+memtx_tx_track_range(struct txn *txn, struct space *space,
+		     struct index *index, enum iterator_type type,
+		     const char *key, uint32_t part_count)
+{
+	if (!memtx_tx_manager_use_mvcc_engine)
+		return 0;
+	if (txn == NULL)
+		return 0;
+	if (space == NULL)
+		return 0;
+	if (txn->status != TXN_INPROGRESS)
+		return 0;
+	/*
+	 * System spaces and DDL are isolated by the schema version.
+	 * Besides, a yielding index build scans the whole space and
+	 * would be aborted by any concurrent insert.
+	 */
+	if (space_is_system(space) || txn_has_flag(txn, TXN_HANDLES_DDL))
+		return 0;
+
+	/* Encode the key with an array header. */
+	const char *range_key = tx_range_inf_key;
+	if (key != NULL && part_count > 0) {
+		const char *key_end = key;
+		for (uint32_t i = 0; i < part_count; i++)
+			mp_next(&key_end);
+		size_t size = mp_sizeof_array(part_count) + (key_end - key);
+		char *buf = (char *)region_alloc(&txn->region, size);
+		if (buf == NULL) {
+			diag_set(OutOfMemory, size, "tx region", "range key");
+			return -1;
+		}
+		char *data = mp_encode_array(buf, part_count);
+		memcpy(data, key, key_end - key);
+		range_key = buf;
+	} else {
+		type = ITER_ALL;
+	}
+
+	const char *left = tx_range_inf_key, *right = tx_range_inf_key;
+	bool left_belongs = true, right_belongs = true;
+	switch (type) {
+	case ITER_EQ:
+	case ITER_REQ:
+		left = right = range_key;
+		break;
+	case ITER_GE:
+		left = range_key;
+		break;
+	case ITER_GT:
+		left = range_key;
+		left_belongs = false;
+		break;
+	case ITER_LE:
+		right = range_key;
+		break;
+	case ITER_LT:
+		right = range_key;
+		right_belongs = false;
+		break;
+	default:
+		/* Any other iterator may return any tuple. */
+		break;
+	}
+
+	/* Most likely the same range is being read over and over. */
+	if (!rlist_empty(&txn->range_set)) {
+		struct tx_range_tracker *last =
+			rlist_first_entry(&txn->range_set,
+					  struct tx_range_tracker,
+					  in_range_set);
+		if (last->index == index &&
+		    last->left_belongs == left_belongs &&
+		    last->right_belongs == right_belongs &&
+		    tx_range_key_is_equal(last->left, left) &&
+		    tx_range_key_is_equal(last->right, right))
+			return 0;
+	}
+
+	struct memtx_tx_range_set *set = index->tx_range_set;
+	if (set == NULL) {
+		set = (struct memtx_tx_range_set *)malloc(sizeof(*set));
+		if (set == NULL) {
+			diag_set(OutOfMemory, sizeof(*set), "malloc",
+				 "tx_range_set");
+			return -1;
+		}
+		tx_range_tree_new(&set->tree);
+		index->tx_range_set = set;
+	}
+	size_t sz;
+	struct tx_range_tracker *tracker =
+		region_alloc_object(&txn->region, struct tx_range_tracker,
+				    &sz);
+	if (tracker == NULL) {
+		diag_set(OutOfMemory, sz, "tx region", "range_tracker");
+		return -1;
+	}
+	tracker->reader = txn;
+	tracker->index = index;
+	tracker->left = left;
+	tracker->right = right;
+	tracker->left_belongs = left_belongs;
+	tracker->right_belongs = right_belongs;
+	tracker->subtree_last = NULL;
+	tx_range_tree_insert(&set->tree, tracker);
+	rlist_add(&txn->range_set, &tracker->in_range_set);
+	txm.range_count++;
+	return 0;
+}
+
+void
+memtx_tx_untrack_ranges(struct txn *txn)
+{
+	struct tx_range_tracker *tracker, *tmp;
+	rlist_foreach_entry_safe(tracker, &txn->range_set,
+				 in_range_set, tmp) {
+		if (tracker->index != NULL) {
+			tx_range_tree_remove(&tracker->index->tx_range_set->tree,
+					     tracker);
+		}
+		rlist_del(&tracker->in_range_set);
+		txm.range_count--;
+	}
+	assert(rlist_empty(&txn->range_set));
+}
+
+void
+memtx_tx_on_index_delete(struct index *index)
+{
+	struct memtx_tx_range_set *set = index->tx_range_set;
+	if (set == NULL)
+		return;
+	/*
+	 * Trackers are owned by their readers, just detach them.
+	 * The readers can't see anything in the dropped index.
+	 */
+	struct tx_range_tracker *tracker;
+	while ((tracker = tx_range_tree_first(&set->tree)) != NULL) {
+		tx_range_tree_remove(&set->tree, tracker);
+		tracker->index = NULL;
+	}
+	free(set);
+	index->tx_range_set = NULL;
+}
+
+/** Compare a tuple with an end of a range. */
+static inline int
+tx_range_tuple_compare(struct tuple *tuple, const char *key,
+		       struct key_def *cmp_def)
+{
+	uint32_t part_count = mp_decode_array(&key);
+	return tuple_compare_with_key(tuple, HINT_NONE, key, part_count,
+				      HINT_NONE, cmp_def);
+}
+
+/**
+ * Check if @a txn has replaced the tuple of @a story in index
+ * @a idx by its own in-progress change, so that the tuple is
+ * invisible for @a txn anyway.
+ */
+static bool
+memtx_tx_story_is_overwritten_by(struct memtx_story *story, uint32_t idx,
+				 struct txn *txn)
+{
+	struct memtx_story *newer = story->link[idx].newer_story;
+	for (; newer != NULL; newer = newer->link[idx].newer_story) {
+		if (newer->add_stmt != NULL && newer->add_stmt->txn == txn)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Handle conflicts of @a breaker with all transactions that have
+ * read a range of index @a idx which contains the tuple of @a story.
+ */
+static void
+memtx_tx_handle_index_range_conflicts(struct txn *breaker,
+				      struct memtx_story *story,
+				      uint32_t idx)
+{
+	struct index *index = story->space->index[idx];
+	struct memtx_tx_range_set *set = index->tx_range_set;
+	if (set == NULL)
+		return;
+	struct tuple *tuple = story->tuple;
+	struct key_def *cmp_def = index->def->cmp_def;
+	/*
+	 * A tuple has many keys in a multikey or functional index,
+	 * so conservatively treat it as a member of any range.
+	 */
+	bool is_any = cmp_def->is_multikey || cmp_def->for_func_index;
+	struct tx_range_tree_walk walk;
+	tx_range_tree_walk_init(&walk, &set->tree);
+	int dir = 0;
+	struct tx_range_tracker *curr, *left, *right;
+	while ((curr = tx_range_tree_walk_next(&walk, dir,
+					       &left, &right)) != NULL) {
+		dir = RB_WALK_LEFT | RB_WALK_RIGHT;
+		if (!is_any) {
+			const struct tx_range_tracker *last =
+				curr->subtree_last;
+			int cmp_right = tx_range_tuple_compare(tuple,
+							       last->right,
+							       cmp_def);
+			if (cmp_right == 0 && !last->right_belongs)
+				cmp_right = 1;
+			if (cmp_right > 0) {
+				/*
+				 * The tuple is to the right of all ranges
+				 * of the subtree.
+				 */
+				dir = 0;
+				continue;
+			}
+			int cmp_left = tx_range_tuple_compare(tuple,
+							      curr->left,
+							      cmp_def);
+			if (cmp_left == 0 && !curr->left_belongs)
+				cmp_left = -1;
+			if (cmp_left < 0) {
+				/* Only the left subtree may contain it. */
+				dir = RB_WALK_LEFT;
+				continue;
+			}
+			if (curr != last) {
+				cmp_right = tx_range_tuple_compare(tuple,
+								   curr->right,
+								   cmp_def);
+				if (cmp_right == 0 && !curr->right_belongs)
+					cmp_right = 1;
+			}
+			if (cmp_right > 0)
+				continue;
+		}
+		if (curr->reader == breaker)
+			continue;
+		if (curr->reader->status != TXN_INPROGRESS)
+			continue;
+		if (memtx_tx_story_is_overwritten_by(story, idx, curr->reader))
+			continue;
+		memtx_tx_handle_conflict(breaker, curr->reader);
+	}
+}
+
+/**
+ * Handle conflicts of the transaction of @a stmt with transactions
+ * that have read a range which the new tuple of @a stmt falls into.
+ */
+static void
+memtx_tx_handle_range_conflicts(struct txn_stmt *stmt)
+{
+	struct memtx_story *story = stmt->add_story;
+	if (story == NULL || story->space == NULL)
+		return;
+	for (uint32_t i = 0; i < story->index_count; i++)
+		memtx_tx_handle_index_range_conflicts(stmt->txn, story, i);
+}
+
+void
+memtx_tx_stat(struct info_handler *info)
+{
+	double gc_lag = 0;
+	if (!rlist_empty(&txm.all_stories)) {
+		struct memtx_story *oldest =
+			rlist_first_entry(&txm.all_stories, struct memtx_story,
+					  in_all_stories);
+		gc_lag = ev_monotonic_now(loop()) - oldest->create_time;
+	}
+	info_begin(info);
+	info_append_int(info, "stories", txm.story_count);
+	info_append_int(info, "story_memory", txm.story_memory);
+	info_append_int(info, "retained_tuples", txm.retained_tuples);
+	info_append_double(info, "gc_lag", gc_lag);
+	info_append_int(info, "ranges", txm.range_count);
+	info_append_int(info, "conflicts", txm.conflict_count);
+	info_append_int(info, "read_views", txm.read_view_count);
+	info_append_int(info, "throttled", txm.throttle_count);
+	info_end(info);
+}
+
+void
+memtx_tx_set_gc_batch_size(int batch_size)
+{
+	assert(batch_size > 0);
+	txm.gc_batch_size = batch_size;
+}
+
+void
+memtx_tx_set_story_memory_limit(int64_t limit)
+{
+	assert(limit >= 0);
+	txm.story_memory_limit = limit;
+	/* Let throttled transactions re-check the limit. */
+	fiber_cond_broadcast(&txm.gc_cond);
+}
+
+int
+memtx_tx_throttle(void)
+{
+	if (!memtx_tx_manager_use_mvcc_engine)
+		return 0;
+	bool is_throttled = false;
+	while (txm.story_memory_limit != 0 &&
+	       txm.story_memory > txm.story_memory_limit) {
+		if (!is_throttled) {
+			is_throttled = true;
+			txm.throttle_count++;
+		}
+		memtx_tx_gc_wakeup();
+		if (fiber_cond_wait(&txm.gc_cond) != 0)
+			return -1;
+		if (txm.gc_last_pass_freed == 0)
+			break;
+	}
+	return 0;
+}
+
+/* }}} */
+
 static uint32_t
 memtx_tx_snapshot_cleaner_hash(const struct tuple *a)
 {
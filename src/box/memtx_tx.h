@@ -35,6 +35,8 @@
 #include "tuple.h"
 
 #include "small/rlist.h"
+#define RB_COMPACT 1
+#include <small/rb.h>
 
 #if defined(__cplusplus)
 extern "C" {
@@ -76,6 +78,43 @@ struct tx_read_tracker {
 	struct rlist in_read_set;
 };
 
+/**
+ * Record that links transaction and a range of an index that the
+ * transaction have read, including the gaps between tuples. Every
+ * tuple that gets into the range is a phantom for the reader.
+ *
+ * A range is defined by two keys, each of which is an encoded
+ * msgpack array of key parts. An empty key stands for infinity
+ * (-inf for the left end and +inf for the right end) provided the
+ * corresponding belongs flag is set.
+ */
+struct tx_range_tracker {
+	/** The TX that read the range. */
+	struct txn *reader;
+	/**
+	 * The index the range was read from. Set to NULL when the
+	 * index is dropped while the reader is still in progress.
+	 */
+	struct index *index;
+	/** Left end of the range. */
+	const char *left;
+	/** Right end of the range. */
+	const char *right;
+	/** Set if the left end belongs to the range. */
+	bool left_belongs;
+	/** Set if the right end belongs to the range. */
+	bool right_belongs;
+	/**
+	 * The range with the max right end in the subtree rooted
+	 * at this node, used to prune the interval tree search.
+	 */
+	struct tx_range_tracker *subtree_last;
+	/** Link in the interval tree of the index. */
+	rb_node(struct tx_range_tracker) in_index;
+	/** Link in reader->range_set. */
+	struct rlist in_range_set;
+};
+
 /**
  * Pointer to tuple or story.
  */
@@ -143,6 +182,8 @@ struct memtx_story {
 	 * List of trackers - transactions that has read this tuple.
 	 */
 	struct rlist reader_list;
+	/** Monotonic time the story was created at, for GC lag metric. */
+	double create_time;
 	/**
 	 * Link in tx_manager::all_stories
 	 */
@@ -285,6 +326,65 @@ memtx_tx_tuple_clarify_slow(struct txn *txn, struct space *space,
 int
 memtx_tx_track_read(struct txn *txn, struct space *space, struct tuple *tuple);
 
+/**
+ * Record in TX manager that a transaction @a txn have read all tuples
+ * of @a index that are (or will be) visited by an iterator of @a type
+ * positioned by @a key, including the gaps between them. On prepare
+ * of another transaction that inserts a tuple into the range @a txn
+ * is either sent to a read view or marked as conflicted.
+ * @param key - key parts without array header, NULL for a full scan.
+ * @return 0 on success, -1 on memory error.
+ */
+int
+memtx_tx_track_range(struct txn *txn, struct space *space,
+		     struct index *index, enum iterator_type type,
+		     const char *key, uint32_t part_count);
+
+/**
+ * Forget all ranges read by transaction @a txn. Called when the
+ * transaction is freed.
+ */
+void
+memtx_tx_untrack_ranges(struct txn *txn);
+
+/**
+ * Notify manager that an index is deleted: the ranges read from
+ * the index by in-progress transactions are detached from it.
+ */
+void
+memtx_tx_on_index_delete(struct index *index);
+
+/**
+ * Fill @a info with the transaction manager statistics: stories,
+ * tuples retained by them, GC lag, tracked ranges and the number
+ * of transactions conflicted, sent to a read view or throttled.
+ */
+void
+memtx_tx_stat(struct info_handler *info);
+
+/**
+ * Set the number of stories the GC fiber inspects per event loop
+ * iteration.
+ */
+void
+memtx_tx_set_gc_batch_size(int batch_size);
+
+/**
+ * Set the soft limit of memory used by stories, 0 is unlimited.
+ * See memtx_tx_throttle().
+ */
+void
+memtx_tx_set_story_memory_limit(int64_t limit);
+
+/**
+ * Delay a new transaction while the memory used by stories exceeds
+ * the limit, until the GC completes a pass without freeing anything,
+ * i.e. the rest of stories is in use.
+ * @return 0 on success, -1 if the fiber is cancelled (diag is set).
+ */
+int
+memtx_tx_throttle(void);
+
 /**
  * Clean a tuple if it's dirty - finds a visible tuple in history.
  * @param txn - current transactions.
@@ -0,0 +1,452 @@
+/*
+ * Copyright 2010-2021, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "read_pool.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "cbus.h"
+#include "diag.h"
+#include "fiber.h"
+#include "fiber_cond.h"
+#include "index.h"
+#include "info/info.h"
+#include "iproto_constants.h"
+#include "memtx_tree.h"
+#include "msgpuck.h"
+#include "rmean.h"
+#include "schema.h"
+#include "say.h"
+#include "space.h"
+#include "trivia/util.h"
+#include "tt_pthread.h"
+#include "tuple.h"
+#include "tuple_format.h"
+#include "txn.h"
+
+/** Read view of an index. */
+struct read_pool_view_index {
+	uint32_t space_id;
+	uint32_t index_id;
+	struct memtx_tree_read_view *view;
+};
+
+/** Read view of all memtx spaces. */
+struct read_pool_view {
+	/** Number of requests executed in the view. */
+	int refs;
+	/** Signaled when the last request releases the view. */
+	struct fiber_cond release_cond;
+	/** Index views, sorted by space id and index id. */
+	struct read_pool_view_index *indexes;
+	/** Number of entries in @indexes. */
+	uint32_t index_count;
+	/** Allocated size of @indexes. */
+	uint32_t index_capacity;
+	/**
+	 * Tuple formats referenced by the view, so that formats of
+	 * tuples that are deleted from spaces but still visible in
+	 * the view aren't freed.
+	 */
+	struct tuple_format **formats;
+	/** Number of entries in @formats. */
+	uint32_t format_count;
+};
+
+/** Read-only query thread. */
+struct read_pool_thread {
+	/** Thread that executes requests. */
+	struct cord cord;
+	/** Pipe from tx to the thread. */
+	struct cpipe thread_pipe;
+	/** Pipe from the thread to tx. */
+	struct cpipe tx_pipe;
+};
+
+static struct {
+	/** Read threads. */
+	struct read_pool_thread threads[READ_POOL_THREADS_MAX];
+	/** Number of started threads. */
+	int thread_count;
+	/** Thread to send the next request to. */
+	int next_thread;
+	/** Current read view or NULL if it is being refreshed. */
+	struct read_pool_view *view;
+	/** Fiber refreshing the read view. */
+	struct fiber *refresher;
+	/** How often to refresh the read view, in seconds. */
+	double refresh_interval;
+	/** Signaled when @refresh_interval is updated. */
+	struct fiber_cond refresh_cond;
+	/** Number of requests executed in read threads. */
+	int64_t request_count;
+} read_pool;
+
+static int
+read_pool_view_index_cmp(const void *a_ptr, const void *b_ptr)
+{
+	const struct read_pool_view_index *a = a_ptr;
+	const struct read_pool_view_index *b = b_ptr;
+	if (a->space_id != b->space_id)
+		return a->space_id < b->space_id ? -1 : 1;
+	if (a->index_id != b->index_id)
+		return a->index_id < b->index_id ? -1 : 1;
+	return 0;
+}
+
+static void
+read_pool_view_delete(struct read_pool_view *view)
+{
+	assert(view->refs == 0);
+	for (uint32_t i = 0; i < view->index_count; i++)
+		memtx_tree_read_view_delete(view->indexes[i].view);
+	if (view->formats != NULL)
+		tuple_format_unref_all(view->formats, view->format_count);
+	fiber_cond_destroy(&view->release_cond);
+	free(view->indexes);
+	free(view);
+}
+
+static int
+read_pool_view_add_space_cb(struct space *space, void *arg)
+{
+	struct read_pool_view *view = arg;
+	if (!space_is_memtx(space) || space_is_temporary(space))
+		return 0;
+	for (uint32_t i = 0; i < space->index_count; i++) {
+		struct index *index = space->index[i];
+		if (index->def->type != TREE)
+			continue;
+		struct memtx_tree_read_view *index_view =
+			memtx_tree_read_view_new(index);
+		if (index_view == NULL) {
+			/* Unsupported index, served in tx. */
+			diag_clear(diag_get());
+			continue;
+		}
+		if (view->index_count == view->index_capacity) {
+			uint32_t capacity = MAX(view->index_capacity * 2, 16);
+			struct read_pool_view_index *indexes =
+				realloc(view->indexes,
+					capacity * sizeof(*indexes));
+			if (indexes == NULL) {
+				memtx_tree_read_view_delete(index_view);
+				diag_set(OutOfMemory,
+					 capacity * sizeof(*indexes),
+					 "realloc", "indexes");
+				return -1;
+			}
+			view->indexes = indexes;
+			view->index_capacity = capacity;
+		}
+		struct read_pool_view_index *entry =
+			&view->indexes[view->index_count++];
+		entry->space_id = space->def->id;
+		entry->index_id = index->def->iid;
+		entry->view = index_view;
+	}
+	return 0;
+}
+
+static struct read_pool_view *
+read_pool_view_new(void)
+{
+	struct read_pool_view *view = calloc(1, sizeof(*view));
+	if (view == NULL) {
+		diag_set(OutOfMemory, sizeof(*view), "malloc",
+			 "struct read_pool_view");
+		return NULL;
+	}
+	fiber_cond_create(&view->release_cond);
+	view->formats = tuple_format_ref_all(&view->format_count);
+	if (view->formats == NULL ||
+	    space_foreach(read_pool_view_add_space_cb, view) != 0) {
+		read_pool_view_delete(view);
+		return NULL;
+	}
+	qsort(view->indexes, view->index_count, sizeof(*view->indexes),
+	      read_pool_view_index_cmp);
+	return view;
+}
+
+static void
+read_pool_view_unref(struct read_pool_view *view)
+{
+	assert(view->refs > 0);
+	if (--view->refs == 0)
+		fiber_cond_signal(&view->release_cond);
+}
+
+static struct memtx_tree_read_view *
+read_pool_view_find(struct read_pool_view *view, uint32_t space_id,
+		    uint32_t index_id)
+{
+	struct read_pool_view_index key;
+	key.space_id = space_id;
+	key.index_id = index_id;
+	struct read_pool_view_index *entry =
+		bsearch(&key, view->indexes, view->index_count,
+			sizeof(*view->indexes), read_pool_view_index_cmp);
+	return entry != NULL ? entry->view : NULL;
+}
+
+static int
+read_pool_refresher_f(va_list ap)
+{
+	(void)ap;
+	while (!fiber_is_cancelled()) {
+		/*
+		 * Release the old view before creating a new one,
+		 * see the comment in read_pool.h. Requests are
+		 * served in tx meanwhile.
+		 */
+		struct read_pool_view *view = read_pool.view;
+		read_pool.view = NULL;
+		if (view != NULL) {
+			while (view->refs > 0)
+				fiber_cond_wait(&view->release_cond);
+			read_pool_view_delete(view);
+		}
+		read_pool.view = read_pool_view_new();
+		if (read_pool.view == NULL)
+			diag_log();
+		fiber_cond_wait_timeout(&read_pool.refresh_cond,
+					read_pool.refresh_interval);
+	}
+	return 0;
+}
+
+static int
+read_pool_thread_f(va_list ap)
+{
+	struct read_pool_thread *thread = va_arg(ap, struct read_pool_thread *);
+	struct cbus_endpoint endpoint;
+
+	cpipe_create(&thread->tx_pipe, "tx");
+	cbus_endpoint_create(&endpoint, cord_name(cord()),
+			     fiber_schedule_cb, fiber());
+	cbus_loop(&endpoint);
+	cbus_endpoint_destroy(&endpoint, cbus_process);
+	cpipe_destroy(&thread->tx_pipe);
+	return 0;
+}
+
+void
+read_pool_init(int thread_count, double refresh_interval)
+{
+	assert(thread_count <= READ_POOL_THREADS_MAX);
+	read_pool.refresh_interval = refresh_interval;
+	fiber_cond_create(&read_pool.refresh_cond);
+	if (thread_count == 0)
+		return;
+	/*
+	 * Read threads look up tuple formats by id, so the table
+	 * of formats must never be reallocated.
+	 */
+	if (tuple_format_reserve_max() != 0)
+		panic("failed to allocate tuple format table");
+	for (int i = 0; i < thread_count; i++) {
+		struct read_pool_thread *thread = &read_pool.threads[i];
+		char name[FIBER_NAME_MAX];
+
+		snprintf(name, sizeof(name), "memtx.reader.%d", i);
+		if (cord_costart(&thread->cord, name,
+				 read_pool_thread_f, thread) != 0)
+			panic("failed to start memtx read thread");
+		cpipe_create(&thread->thread_pipe, name);
+	}
+	read_pool.thread_count = thread_count;
+	read_pool.next_thread = 0;
+	read_pool.refresher = fiber_new("read_view_refresh",
+					read_pool_refresher_f);
+	if (read_pool.refresher == NULL)
+		panic("failed to start read view refresh fiber");
+	fiber_start(read_pool.refresher);
+}
+
+void
+read_pool_set_refresh_interval(double refresh_interval)
+{
+	read_pool.refresh_interval = refresh_interval;
+	fiber_cond_signal(&read_pool.refresh_cond);
+}
+
+void
+read_pool_free(void)
+{
+	/*
+	 * The fiber isn't cancelled and the view isn't deleted
+	 * as the event loop isn't running when this function is
+	 * called.
+	 */
+	for (int i = 0; i < read_pool.thread_count; i++) {
+		struct read_pool_thread *thread = &read_pool.threads[i];
+		tt_pthread_cancel(thread->cord.id);
+		tt_pthread_join(thread->cord.id, NULL);
+	}
+	read_pool.thread_count = 0;
+}
+
+struct cpipe *
+read_pool_thread_pipe(int id)
+{
+	assert(id >= 0 && id < READ_POOL_THREADS_MAX);
+	return &read_pool.threads[id].thread_pipe;
+}
+
+struct cpipe *
+read_pool_tx_pipe(int id)
+{
+	assert(id >= 0 && id < READ_POOL_THREADS_MAX);
+	return &read_pool.threads[id].tx_pipe;
+}
+
+int
+read_pool_select_prepare(struct read_pool_select *req, uint32_t space_id,
+			 uint32_t index_id, int iterator, uint32_t offset,
+			 uint32_t limit, const char *key)
+{
+	struct read_pool_view *view = read_pool.view;
+	if (view == NULL || iterator < 0 || iterator >= iterator_type_MAX)
+		return -1;
+	enum iterator_type type = (enum iterator_type)iterator;
+	if (!memtx_tree_read_view_supports(type))
+		return -1;
+	/*
+	 * Errors are reported by the fallback path, which does
+	 * the same checks, so just clear them here.
+	 */
+	struct space *space = space_by_id(space_id);
+	if (space == NULL)
+		return -1;
+	if (access_check_space(space, PRIV_R) != 0)
+		goto fail;
+	struct index *index = space_index(space, index_id);
+	if (index == NULL)
+		return -1;
+	struct memtx_tree_read_view *index_view =
+		read_pool_view_find(view, space_id, index_id);
+	/* The index may have been recreated since the view creation. */
+	if (index_view == NULL ||
+	    memtx_tree_read_view_index(index_view) != index)
+		return -1;
+	uint32_t part_count = key != NULL ? mp_decode_array(&key) : 0;
+	if (key_validate(index->def, type, key, part_count) != 0)
+		goto fail;
+
+	rmean_collect(rmean_box, IPROTO_SELECT, 1);
+	view->refs++;
+	req->view = view;
+	req->index_view = index_view;
+	req->type = type;
+	req->key = key;
+	req->part_count = part_count;
+	req->offset = offset;
+	req->limit = limit;
+	req->data = NULL;
+	req->size = 0;
+	req->capacity = 0;
+	req->count = 0;
+	req->rc = 0;
+	diag_create(&req->diag);
+	int id = read_pool.next_thread++;
+	read_pool.next_thread %= read_pool.thread_count;
+	return id;
+fail:
+	diag_clear(diag_get());
+	return -1;
+}
+
+static int
+read_pool_select_add_tuple(struct tuple *tuple, void *arg)
+{
+	struct read_pool_select *req = arg;
+	uint32_t size;
+	const char *data = tuple_data_range(tuple, &size);
+	if (req->size + size > req->capacity) {
+		size_t capacity = MAX(req->capacity * 2, 1024);
+		while (capacity < req->size + size)
+			capacity *= 2;
+		char *new_data = realloc(req->data, capacity);
+		if (new_data == NULL) {
+			diag_set(OutOfMemory, capacity, "realloc", "data");
+			return -1;
+		}
+		req->data = new_data;
+		req->capacity = capacity;
+	}
+	memcpy(req->data + req->size, data, size);
+	req->size += size;
+	req->count++;
+	return 0;
+}
+
+void
+read_pool_select_execute(struct read_pool_select *req)
+{
+	req->rc = memtx_tree_read_view_select(req->index_view, req->type,
+					      req->key, req->part_count,
+					      req->offset, req->limit,
+					      read_pool_select_add_tuple, req);
+	if (req->rc != 0)
+		diag_move(diag_get(), &req->diag);
+}
+
+int
+read_pool_select_complete(struct read_pool_select *req)
+{
+	read_pool_view_unref(req->view);
+	req->view = NULL;
+	req->index_view = NULL;
+	read_pool.request_count++;
+	if (req->rc != 0) {
+		diag_move(&req->diag, diag_get());
+		return -1;
+	}
+	return 0;
+}
+
+void
+read_pool_select_destroy(struct read_pool_select *req)
+{
+	free(req->data);
+	req->data = NULL;
+	req->size = req->capacity = 0;
+}
+
+void
+read_pool_stat(struct info_handler *h)
+{
+	info_begin(h);
+	info_append_int(h, "threads", read_pool.thread_count);
+	info_append_int(h, "requests", read_pool.request_count);
+	info_end(h);
+}
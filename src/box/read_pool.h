@@ -0,0 +1,171 @@
+#ifndef TARANTOOL_BOX_READ_POOL_H_INCLUDED
+#define TARANTOOL_BOX_READ_POOL_H_INCLUDED
+/*
+ * Copyright 2010-2021, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/**
+ * Read-only query threads.
+ *
+ * A client may mark a SELECT with IPROTO_FLAG_STALE_READ to allow
+ * it to be served from a read view of memtx that is at most
+ * memtx_read_view_refresh_interval seconds old. Such requests are
+ * executed in one of memtx_read_threads threads, so that they
+ * don't compete with writes for the tx thread CPU time.
+ *
+ * A background fiber periodically creates a frozen view of all
+ * TREE indexes of persistent memtx spaces. The previous view is
+ * destroyed before a new one is created: while any view exists
+ * memtx tuples are freed in the delayed mode, so views must not
+ * overlap, otherwise garbage would never be collected. While
+ * there's no view, as well as for requests that the view can't
+ * serve (other index types, LE/LT iterators, invalid keys and so
+ * on), the request is executed in tx as usual.
+ *
+ * The view covers all persistent memtx spaces, and since the
+ * delayed free mode is engine-wide, memtx stays in it as long as
+ * read threads are enabled. This is the price of stale reads:
+ * replaced and deleted tuples are freed only when the view that
+ * pins them is destroyed, i.e. at most one refresh interval
+ * later, and the first update of a tuple after each refresh
+ * allocates a new tuple instead of changing the old one in place,
+ * see memtx_space_tuple_is_exclusive().
+ *
+ * Only access checks and key validation are done in tx, the
+ * lookup itself and result encoding are done in a read thread.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "diag.h"
+#include "iterator_type.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct cpipe;
+struct info_handler;
+struct read_pool_view;
+struct memtx_tree_read_view;
+
+enum { READ_POOL_THREADS_MAX = 32 };
+
+/** A SELECT request executed in a read thread. */
+struct read_pool_select {
+	/** Read view the request is executed in, referenced. */
+	struct read_pool_view *view;
+	/** View of the index to select from. */
+	struct memtx_tree_read_view *index_view;
+	/** Request parameters, validated in tx. */
+	enum iterator_type type;
+	const char *key;
+	uint32_t part_count;
+	uint32_t offset;
+	uint32_t limit;
+	/** Msgpack of the selected tuples, allocated with malloc. */
+	char *data;
+	/** Size of @data. */
+	size_t size;
+	/** Allocated size of @data. */
+	size_t capacity;
+	/** Number of tuples in @data. */
+	uint32_t count;
+	/** Return code of the request. */
+	int rc;
+	/** Error of the request if @rc is not 0. */
+	struct diag diag;
+};
+
+/**
+ * Start @a thread_count read threads and the fiber refreshing
+ * the read view every @a refresh_interval seconds. Does nothing
+ * if @a thread_count is 0. Must be called after recovery.
+ */
+void
+read_pool_init(int thread_count, double refresh_interval);
+
+/** Update the read view refresh interval. */
+void
+read_pool_set_refresh_interval(double refresh_interval);
+
+/** Stop read threads. */
+void
+read_pool_free(void);
+
+/**
+ * Pipe to the read thread @a id, valid even if the pool isn't
+ * started, so that it can be used in static cbus routes.
+ */
+struct cpipe *
+read_pool_thread_pipe(int id);
+
+/** Pipe from the read thread @a id to tx. */
+struct cpipe *
+read_pool_tx_pipe(int id);
+
+/**
+ * Check if a SELECT may be served from the current read view
+ * and prepare it for execution in a read thread. Returns the id
+ * of the read thread the request must be sent to. If the request
+ * can't be served from the read view, returns -1, without
+ * setting diag, and the request must be executed in tx.
+ */
+int
+read_pool_select_prepare(struct read_pool_select *req, uint32_t space_id,
+			 uint32_t index_id, int iterator, uint32_t offset,
+			 uint32_t limit, const char *key);
+
+/** Execute a prepared request. Called in a read thread. */
+void
+read_pool_select_execute(struct read_pool_select *req);
+
+/**
+ * Release the read view used by an executed request. If the
+ * request failed, moves its error to the fiber diag and returns
+ * -1. The result stays in @a req until read_pool_select_destroy().
+ */
+int
+read_pool_select_complete(struct read_pool_select *req);
+
+/** Free the result of an executed request. */
+void
+read_pool_select_destroy(struct read_pool_select *req);
+
+/** Report read thread statistics, see box.stat.memtx.read_threads(). */
+void
+read_pool_stat(struct info_handler *h);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_BOX_READ_POOL_H_INCLUDED */
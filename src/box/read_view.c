@@ -0,0 +1,174 @@
+/*
+ * Copyright 2010-2021, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "read_view.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "diag.h"
+#include "errcode.h"
+#include "fiber.h"
+#include "index.h"
+#include "schema.h"
+#include "space.h"
+#include "trivia/util.h"
+
+RLIST_HEAD(read_views);
+
+/** Id of the next read view. */
+static uint64_t read_view_next_id = 1;
+
+static void
+read_view_delete(struct read_view *rv)
+{
+	for (uint32_t i = 0; i < rv->space_count; i++) {
+		struct read_view_space *space = &rv->spaces[i];
+		if (space->iterator != NULL)
+			space->iterator->free(space->iterator);
+		free(space->name);
+	}
+	free(rv->spaces);
+	free(rv->name);
+	free(rv);
+}
+
+/**
+ * Freeze the primary index of a space. The space must be
+ * a persistent memtx space, because tuples of temporary
+ * spaces are freed immediately, even in the delayed free mode.
+ */
+static int
+read_view_space_create(struct read_view_space *space, uint32_t space_id)
+{
+	struct space *sp = space_cache_find(space_id);
+	if (sp == NULL)
+		return -1;
+	if (!space_is_memtx(sp)) {
+		diag_set(ClientError, ER_UNSUPPORTED, sp->engine->name,
+			 "read view");
+		return -1;
+	}
+	if (space_is_temporary(sp)) {
+		diag_set(ClientError, ER_UNSUPPORTED, "Temporary space",
+			 "read view");
+		return -1;
+	}
+	struct index *pk = space_index(sp, 0);
+	if (pk == NULL) {
+		diag_set(ClientError, ER_NO_SUCH_INDEX_ID, 0, space_name(sp));
+		return -1;
+	}
+	space->id = space_id;
+	space->name = strdup(space_name(sp));
+	if (space->name == NULL) {
+		diag_set(OutOfMemory, strlen(space_name(sp)) + 1,
+			 "strdup", "space name");
+		return -1;
+	}
+	space->iterator = index_create_snapshot_iterator(pk);
+	if (space->iterator == NULL)
+		return -1;
+	return 0;
+}
+
+struct read_view *
+read_view_open(const char *name, const uint32_t *space_ids,
+	       uint32_t space_count)
+{
+	struct read_view *rv = calloc(1, sizeof(*rv));
+	if (rv == NULL) {
+		diag_set(OutOfMemory, sizeof(*rv), "calloc", "read_view");
+		return NULL;
+	}
+	rv->spaces = calloc(space_count, sizeof(*rv->spaces));
+	if (rv->spaces == NULL && space_count > 0) {
+		diag_set(OutOfMemory, space_count * sizeof(*rv->spaces),
+			 "calloc", "read_view_space");
+		goto fail;
+	}
+	rv->name = strdup(name);
+	if (rv->name == NULL) {
+		diag_set(OutOfMemory, strlen(name) + 1, "strdup",
+			 "read view name");
+		goto fail;
+	}
+	/*
+	 * Snapshot iterators are created without yielding, so
+	 * all spaces are frozen at the same point in time.
+	 */
+	for (uint32_t i = 0; i < space_count; i++) {
+		rv->space_count = i + 1;
+		if (read_view_space_create(&rv->spaces[i], space_ids[i]) != 0)
+			goto fail;
+	}
+	rv->id = read_view_next_id++;
+	rv->open_time = ev_monotonic_now(loop());
+	rlist_add_tail_entry(&read_views, rv, in_all);
+	return rv;
+fail:
+	read_view_delete(rv);
+	return NULL;
+}
+
+void
+read_view_close(struct read_view *rv)
+{
+	rlist_del_entry(rv, in_all);
+	read_view_delete(rv);
+}
+
+struct read_view_space *
+read_view_space_by_id(struct read_view *rv, uint32_t space_id)
+{
+	for (uint32_t i = 0; i < rv->space_count; i++) {
+		if (rv->spaces[i].id == space_id)
+			return &rv->spaces[i];
+	}
+	return NULL;
+}
+
+int
+read_view_space_next(struct read_view_space *space,
+		     const char **data, uint32_t *size)
+{
+	if (space->is_exhausted) {
+		*data = NULL;
+		return 0;
+	}
+	struct snapshot_iterator *it = space->iterator;
+	if (it->next(it, data, size) != 0)
+		return -1;
+	if (*data == NULL)
+		space->is_exhausted = true;
+	else
+		space->row_count++;
+	return 0;
+}
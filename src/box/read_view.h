@@ -0,0 +1,130 @@
+#ifndef TARANTOOL_BOX_READ_VIEW_H_INCLUDED
+#define TARANTOOL_BOX_READ_VIEW_H_INCLUDED
+/*
+ * Copyright 2010-2021, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <COPYRIGHT HOLDER> ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * <COPYRIGHT HOLDER> OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <small/rlist.h>
+
+/**
+ * Consistent read views of memtx spaces.
+ *
+ * A read view freezes the primary indexes of the given spaces
+ * at the moment it is opened, the same way a checkpoint does:
+ * tuples deleted or replaced after that are not freed until the
+ * read view is closed, see memtx_enter_delayed_free_mode(), and
+ * dirty tuples of transactions in progress are filtered out with
+ * a snapshot cleaner. Writers are never blocked, so a read view
+ * may be scanned for as long as needed, yielding in between.
+ *
+ * Each space of a read view is scanned once, in the order of
+ * its primary index. Apart from opening and closing, a read view
+ * doesn't touch the schema or the transaction manager, so it may
+ * be scanned from a thread other than tx, provided the read view
+ * is not closed concurrently.
+ */
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct snapshot_iterator;
+
+/** A space frozen in a read view. */
+struct read_view_space {
+	/** Space id. */
+	uint32_t id;
+	/** Space name, for reporting. */
+	char *name;
+	/** Iterator over the frozen primary index. */
+	struct snapshot_iterator *iterator;
+	/** Set when the iterator has returned the last tuple. */
+	bool is_exhausted;
+	/** Number of tuples returned so far. */
+	uint64_t row_count;
+};
+
+/** A consistent read view of a set of spaces. */
+struct read_view {
+	/** Unique id, assigned on open. */
+	uint64_t id;
+	/** Name given by the user, for reporting. */
+	char *name;
+	/** Monotonic time when the read view was opened. */
+	double open_time;
+	/** Number of spaces in the read view. */
+	uint32_t space_count;
+	/** Frozen spaces. */
+	struct read_view_space *spaces;
+	/** Link in the list of all open read views. */
+	struct rlist in_all;
+};
+
+/** List of all open read views, ordered by open time. */
+extern struct rlist read_views;
+
+/**
+ * Open a read view of the spaces with the given ids. Only
+ * persistent memtx spaces are supported.
+ *
+ * Returns NULL and sets diag on error.
+ */
+struct read_view *
+read_view_open(const char *name, const uint32_t *space_ids,
+	       uint32_t space_count);
+
+/**
+ * Close a read view and release the memory pinned by it.
+ * Must be called from the tx thread.
+ */
+void
+read_view_close(struct read_view *rv);
+
+/**
+ * Find a space in a read view by id. Returns NULL if the
+ * space is not a part of the read view.
+ */
+struct read_view_space *
+read_view_space_by_id(struct read_view *rv, uint32_t space_id);
+
+/**
+ * Return the next tuple of a frozen space. On EOF, @a data is
+ * set to NULL. Returns -1 and sets diag on error.
+ */
+int
+read_view_space_next(struct read_view_space *space,
+		     const char **data, uint32_t *size);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_BOX_READ_VIEW_H_INCLUDED */
@@ -552,11 +552,13 @@ space_execute_dml(struct space *space, struct txn *txn,
 	}
 
 	if (unlikely(!rlist_empty(&space->before_replace) &&
-		     space->run_triggers)) {
+		     space->run_triggers &&
+		     request->type != IPROTO_DELETE_RANGE)) {
 		/*
 		 * Call BEFORE triggers if any before dispatching
 		 * the request. Note, it may change the request
-		 * type and arguments.
+		 * type and arguments. Range deletion doesn't look
+		 * up deleted tuples so it doesn't fire triggers.
 		 */
 		if (space_before_replace(space, txn, request) != 0)
 			return -1;
@@ -594,6 +596,12 @@ space_execute_dml(struct space *space, struct txn *txn,
 		if (space->vtab->execute_upsert(space, txn, request) != 0)
 			return -1;
 		break;
+	case IPROTO_DELETE_RANGE:
+		*result = NULL;
+		if (space->vtab->execute_delete_range(space, txn,
+						      request) != 0)
+			return -1;
+		break;
 	default:
 		*result = NULL;
 	}
@@ -680,6 +688,17 @@ generic_space_bsize(struct space *space)
 	return 0;
 }
 
+int
+generic_space_execute_delete_range(struct space *space, struct txn *txn,
+				   struct request *request)
+{
+	(void)txn;
+	(void)request;
+	diag_set(ClientError, ER_UNSUPPORTED, space->engine->name,
+		 "delete_range()");
+	return -1;
+}
+
 int
 generic_space_ephemeral_replace(struct space *space, const char *tuple,
 				const char *tuple_end)
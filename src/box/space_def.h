@@ -73,6 +73,18 @@ struct space_opts {
 	 * until replicated to a quorum of replicas.
 	 */
 	bool is_sync;
+	/**
+	 * Number of the field that stores the time when a tuple
+	 * expires, in seconds since the Epoch, or UINT32_MAX if
+	 * tuples never expire. See expire.h.
+	 */
+	uint32_t expire_field;
+	/**
+	 * Store offsets of all fields defined in the space format
+	 * in the tuple field map, not only of the indexed ones, so
+	 * that any of them can be accessed in constant time.
+	 */
+	bool full_field_map;
 	/** SQL statement that produced this space. */
 	char *sql;
 };
@@ -140,6 +140,41 @@ tuple_validate_raw(struct tuple_format *format, const char *tuple)
 	return rc;
 }
 
+int
+tuple_validate_upgrade(const struct tuple_format_upgrade *upgrade,
+		       struct tuple *tuple)
+{
+	struct tuple_format *format = upgrade->format;
+	if (upgrade->is_full)
+		return tuple_validate(format, tuple);
+	const char *data = tuple_data(tuple);
+	uint32_t field_count = mp_decode_array(&data);
+	if (upgrade->check_field_count &&
+	    field_count != format->exact_field_count)
+		goto invalid;
+	for (uint32_t i = 0; i < upgrade->field_count; i++) {
+		struct tuple_field *field = upgrade->fields[i];
+		bool is_nullable = tuple_field_is_nullable(field);
+		uint32_t fieldno = field->token.num;
+		if (fieldno >= field_count) {
+			if (is_nullable)
+				continue;
+			goto invalid;
+		}
+		const char *pos = tuple_field(tuple, fieldno);
+		assert(pos != NULL);
+		if (!field_mp_type_is_compatible(field->type, pos, is_nullable))
+			goto invalid;
+	}
+	return 0;
+invalid:
+	/*
+	 * Let the full validation report the error, so that it
+	 * doesn't depend on the way the tuple was checked.
+	 */
+	return tuple_validate(format, tuple);
+}
+
 /**
  * Incremented on every snapshot and is used to distinguish tuples
  * which were created after start of a snapshot (these tuples can
@@ -306,7 +341,7 @@ tuple_init(field_name_hash_f hash)
 	 */
 	tuple_format_runtime = tuple_format_new(&tuple_format_runtime_vtab, NULL,
 						NULL, 0, NULL, 0, 0, NULL, false,
-						false);
+						false, false);
 	if (tuple_format_runtime == NULL)
 		return -1;
 
@@ -401,8 +436,7 @@ tuple_field_go_to_index(const char **field, uint64_t index)
 		uint32_t count = mp_decode_array(field);
 		if (index >= count)
 			return -1;
-		for (; index > 0; --index)
-			mp_next(field);
+		mp_next_n(field, index);
 		return 0;
 	} else if (type == MP_MAP) {
 		index += TUPLE_INDEX_BASE;
@@ -579,7 +613,7 @@ box_tuple_format_new(struct key_def **keys, uint16_t key_count)
 	box_tuple_format_t *format =
 		tuple_format_new(&tuple_format_runtime_vtab, NULL,
 				 keys, key_count, NULL, 0, 0, NULL, false,
-				 false);
+				 false, false);
 	if (format != NULL)
 		tuple_format_ref(format);
 	return format;
@@ -31,6 +31,7 @@
  * SUCH DAMAGE.
  */
 #include "trivia/util.h"
+#include "bit/bit.h"
 #include "say.h"
 #include "diag.h"
 #include "error.h"
@@ -526,6 +527,18 @@ tuple_validate(struct tuple_format *format, struct tuple *tuple)
 	return tuple_validate_raw(format, tuple_data(tuple));
 }
 
+/**
+ * Check that a tuple valid for the format @a upgrade was created
+ * from is valid for the target format as well. Only the fields
+ * listed in @a upgrade are looked at, the error reported on
+ * failure is the same as the one of tuple_validate().
+ * @retval  0 The tuple is valid.
+ * @retval -1 The tuple is invalid.
+ */
+int
+tuple_validate_upgrade(const struct tuple_format_upgrade *upgrade,
+		       struct tuple *tuple);
+
 /*
  * Return a field map for the tuple.
  * @param tuple tuple
@@ -568,6 +581,42 @@ int
 tuple_go_to_path(const char **data, const char *path, uint32_t path_len,
 		 int multikey_idx);
 
+/**
+ * Skip @a count consecutive MessagePack values.
+ *
+ * Wide tuples often consist of small integers, which are encoded
+ * in a single byte. Such runs are detected eight bytes at a time:
+ * a byte is a complete value if it is a positive (0xxxxxxx) or
+ * a negative (111xxxxx) fixint. Loading eight bytes is safe while
+ * at least eight values remain, since a value takes at least one
+ * byte.
+ */
+static inline void
+mp_next_n(const char **data, uint32_t count)
+{
+	const uint64_t high_bits = 0x8080808080808080ULL;
+	while (count >= 8) {
+		uint64_t word = load_u64(*data);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+		word = bswap_u64(word);
+#endif
+		/* The high bit is set in bytes starting with 111. */
+		uint64_t negative = word & (word << 1) & (word << 2);
+		uint64_t multibyte = word & ~negative & high_bits;
+		if (multibyte == 0) {
+			*data += 8;
+			count -= 8;
+			continue;
+		}
+		uint32_t fixint_count = bit_ctz_u64(multibyte) / 8;
+		*data += fixint_count;
+		mp_next(data);
+		count -= fixint_count + 1;
+	}
+	for (; count > 0; count--)
+		mp_next(data);
+}
+
 /**
  * Propagate @a field to MessagePack(field)[index].
  * @param[in][out] field Field to propagate.
@@ -672,8 +721,7 @@ parse:
 		field_count = mp_decode_array(&tuple);
 		if (unlikely(fieldno >= field_count))
 			return NULL;
-		for (uint32_t k = 0; k < fieldno; k++)
-			mp_next(&tuple);
+		mp_next_n(&tuple, fieldno);
 		if (path != NULL &&
 		    unlikely(tuple_go_to_path(&tuple, path, path_len,
 					      multikey_idx) != 0))
@@ -721,8 +769,7 @@ parse:
 		uint32_t field_count = mp_decode_array(&tuple);
 		if (unlikely(field_no >= field_count))
 			return NULL;
-		for ( ; field_no > 0; field_no--)
-			mp_next(&tuple);
+		mp_next_n(&tuple, field_no);
 	}
 	return tuple;
 }
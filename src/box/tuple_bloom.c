@@ -47,8 +47,70 @@
 
 enum { HASH_SEED = 13U };
 
+/**
+ * Running hash of a partial key. Hashes of all partial keys are
+ * computed in one pass over the key parts.
+ */
+struct tuple_bloom_hash {
+	/** Hash function, see enum key_hash_func. */
+	enum key_hash_func func;
+	/** MurmurHash3 state. */
+	uint32_t h;
+	uint32_t carry;
+	uint32_t total_size;
+	/** wyhash state. */
+	uint64_t h64;
+};
+
+static inline void
+tuple_bloom_hash_create(struct tuple_bloom_hash *hash,
+			enum key_hash_func func)
+{
+	hash->func = func;
+	hash->h = HASH_SEED;
+	hash->carry = 0;
+	hash->total_size = 0;
+	hash->h64 = TUPLE_HASH_WYHASH_SEED;
+}
+
+/**
+ * Append a key part of a tuple to a running hash.
+ * Return the hash of the partial key ending with this part.
+ */
+static inline uint32_t
+tuple_bloom_hash_add_part(struct tuple_bloom_hash *hash, struct tuple *tuple,
+			  struct key_part *part, int multikey_idx)
+{
+	if (hash->func == KEY_HASH_WYHASH) {
+		hash->h64 = tuple_hash_key_part_wyhash(hash->h64, tuple,
+						       part, multikey_idx);
+		return tuple_hash_wyhash_result(hash->h64);
+	}
+	hash->total_size += tuple_hash_key_part(&hash->h, &hash->carry,
+						tuple, part, multikey_idx);
+	return PMurHash32_Result(hash->h, hash->carry, hash->total_size);
+}
+
+/**
+ * Append a key field to a running hash and advance @a key.
+ * Return the hash of the partial key ending with this field.
+ */
+static inline uint32_t
+tuple_bloom_hash_add_field(struct tuple_bloom_hash *hash, const char **key,
+			   struct key_part *part)
+{
+	if (hash->func == KEY_HASH_WYHASH) {
+		hash->h64 = tuple_hash_field_wyhash(hash->h64, key,
+						    part->coll);
+		return tuple_hash_wyhash_result(hash->h64);
+	}
+	hash->total_size += tuple_hash_field(&hash->h, &hash->carry, key,
+					     part->coll);
+	return PMurHash32_Result(hash->h, hash->carry, hash->total_size);
+}
+
 struct tuple_bloom_builder *
-tuple_bloom_builder_new(uint32_t part_count)
+tuple_bloom_builder_new(uint32_t part_count, enum key_hash_func hash_func)
 {
 	size_t size = sizeof(struct tuple_bloom_builder) +
 		part_count * sizeof(struct tuple_hash_array);
@@ -58,6 +120,7 @@ tuple_bloom_builder_new(uint32_t part_count)
 		return NULL;
 	}
 	memset(builder, 0, size);
+	builder->hash_func = hash_func;
 	builder->part_count = part_count;
 	return builder;
 }
@@ -111,15 +174,13 @@ tuple_bloom_builder_add(struct tuple_bloom_builder *builder,
 	assert(builder->part_count == key_def->part_count);
 	assert(!key_def->is_multikey || multikey_idx != MULTIKEY_NONE);
 
-	uint32_t h = HASH_SEED;
-	uint32_t carry = 0;
-	uint32_t total_size = 0;
+	struct tuple_bloom_hash h;
+	tuple_bloom_hash_create(&h, builder->hash_func);
 
 	for (uint32_t i = 0; i < key_def->part_count; i++) {
-		total_size += tuple_hash_key_part(&h, &carry, tuple,
-						  &key_def->parts[i],
-						  multikey_idx);
-		uint32_t hash = PMurHash32_Result(h, carry, total_size);
+		uint32_t hash = tuple_bloom_hash_add_part(&h, tuple,
+							  &key_def->parts[i],
+							  multikey_idx);
 		if (tuple_hash_array_add(&builder->parts[i], hash) != 0)
 			return -1;
 	}
@@ -135,14 +196,12 @@ tuple_bloom_builder_add_key(struct tuple_bloom_builder *builder,
 	assert(part_count >= key_def->part_count);
 	assert(builder->part_count == key_def->part_count);
 
-	uint32_t h = HASH_SEED;
-	uint32_t carry = 0;
-	uint32_t total_size = 0;
+	struct tuple_bloom_hash h;
+	tuple_bloom_hash_create(&h, builder->hash_func);
 
 	for (uint32_t i = 0; i < key_def->part_count; i++) {
-		total_size += tuple_hash_field(&h, &carry, &key,
-					       key_def->parts[i].coll);
-		uint32_t hash = PMurHash32_Result(h, carry, total_size);
+		uint32_t hash = tuple_bloom_hash_add_field(&h, &key,
+							   &key_def->parts[i]);
 		if (tuple_hash_array_add(&builder->parts[i], hash) != 0)
 			return -1;
 	}
@@ -162,6 +221,7 @@ tuple_bloom_new(struct tuple_bloom_builder *builder, double fpr)
 	}
 
 	bloom->is_legacy = false;
+	bloom->hash_func = builder->hash_func;
 	bloom->part_count = 0;
 
 	for (uint32_t i = 0; i < part_count; i++) {
@@ -207,21 +267,22 @@ tuple_bloom_maybe_has(const struct tuple_bloom *bloom, struct tuple *tuple,
 	assert(!key_def->is_multikey || multikey_idx != MULTIKEY_NONE);
 
 	if (bloom->is_legacy) {
+		/* Legacy filters store MurmurHash3 of full keys. */
+		if (key_def->hash_func != KEY_HASH_MURMUR3)
+			return true;
 		return bloom_maybe_has(&bloom->parts[0],
 				       tuple_hash(tuple, key_def));
 	}
 
 	assert(bloom->part_count == key_def->part_count);
 
-	uint32_t h = HASH_SEED;
-	uint32_t carry = 0;
-	uint32_t total_size = 0;
+	struct tuple_bloom_hash h;
+	tuple_bloom_hash_create(&h, bloom->hash_func);
 
 	for (uint32_t i = 0; i < key_def->part_count; i++) {
-		total_size += tuple_hash_key_part(&h, &carry, tuple,
-						  &key_def->parts[i],
-						  multikey_idx);
-		uint32_t hash = PMurHash32_Result(h, carry, total_size);
+		uint32_t hash = tuple_bloom_hash_add_part(&h, tuple,
+							  &key_def->parts[i],
+							  multikey_idx);
 		if (!bloom_maybe_has(&bloom->parts[i], hash))
 			return false;
 	}
@@ -234,7 +295,8 @@ tuple_bloom_maybe_has_key(const struct tuple_bloom *bloom,
 			  struct key_def *key_def)
 {
 	if (bloom->is_legacy) {
-		if (part_count < key_def->part_count)
+		if (part_count < key_def->part_count ||
+		    key_def->hash_func != KEY_HASH_MURMUR3)
 			return true;
 		return bloom_maybe_has(&bloom->parts[0],
 				       key_hash(key, key_def));
@@ -243,39 +305,52 @@ tuple_bloom_maybe_has_key(const struct tuple_bloom *bloom,
 	assert(part_count <= key_def->part_count);
 	assert(bloom->part_count == key_def->part_count);
 
-	uint32_t h = HASH_SEED;
-	uint32_t carry = 0;
-	uint32_t total_size = 0;
+	struct tuple_bloom_hash h;
+	tuple_bloom_hash_create(&h, bloom->hash_func);
 
 	for (uint32_t i = 0; i < part_count; i++) {
-		total_size += tuple_hash_field(&h, &carry, &key,
-					       key_def->parts[i].coll);
-		uint32_t hash = PMurHash32_Result(h, carry, total_size);
+		uint32_t hash = tuple_bloom_hash_add_field(&h, &key,
+							   &key_def->parts[i]);
 		if (!bloom_maybe_has(&bloom->parts[i], hash))
 			return false;
 	}
 	return true;
 }
 
+/*
+ * A part is encoded as [table_size, hash_count, table] if it is
+ * a classic bloom filter, which can be decoded by any version,
+ * or [table_size, hash_count, table, type] otherwise.
+ */
+static uint32_t
+tuple_bloom_part_field_count(const struct bloom *part)
+{
+	return part->type == BLOOM_CLASSIC ? 3 : 4;
+}
+
 static size_t
 tuple_bloom_sizeof_part(const struct bloom *part)
 {
 	size_t size = 0;
-	size += mp_sizeof_array(3);
+	size += mp_sizeof_array(tuple_bloom_part_field_count(part));
 	size += mp_sizeof_uint(part->table_size);
 	size += mp_sizeof_uint(part->hash_count);
 	size += mp_sizeof_bin(bloom_store_size(part));
+	if (part->type != BLOOM_CLASSIC)
+		size += mp_sizeof_uint(part->type);
 	return size;
 }
 
 static char *
 tuple_bloom_encode_part(const struct bloom *part, char *buf)
 {
-	buf = mp_encode_array(buf, 3);
+	buf = mp_encode_array(buf, tuple_bloom_part_field_count(part));
 	buf = mp_encode_uint(buf, part->table_size);
 	buf = mp_encode_uint(buf, part->hash_count);
 	buf = mp_encode_binl(buf, bloom_store_size(part));
 	buf = bloom_store(part, buf);
+	if (part->type != BLOOM_CLASSIC)
+		buf = mp_encode_uint(buf, part->type);
 	return buf;
 }
 
@@ -283,21 +358,42 @@ static int
 tuple_bloom_decode_part(struct bloom *part, const char **data)
 {
 	memset(part, 0, sizeof(*part));
-	if (mp_decode_array(data) != 3)
+	uint32_t field_count = mp_decode_array(data);
+	if (field_count != 3 && field_count != 4)
 		unreachable();
 	part->table_size = mp_decode_uint(data);
 	part->hash_count = mp_decode_uint(data);
 	size_t store_size = mp_decode_binl(data);
+	const char *table = *data;
+	*data += store_size;
+	if (field_count > 3) {
+		uint64_t type = mp_decode_uint(data);
+		if (type >= bloom_type_MAX) {
+			diag_set(ClientError, ER_INVALID_MSGPACK,
+				 "unknown bloom filter type");
+			return -1;
+		}
+		part->type = type;
+	}
 	assert(store_size == bloom_store_size(part));
-	if (bloom_load_table(part, *data) != 0) {
+	if (bloom_load_table(part, table) != 0) {
 		diag_set(OutOfMemory, store_size, "bloom_load_table",
 			 "tuple bloom part");
 		return -1;
 	}
-	*data += store_size;
 	return 0;
 }
 
+bool
+tuple_bloom_is_blocked(const struct tuple_bloom *bloom)
+{
+	for (uint32_t i = 0; i < bloom->part_count; i++) {
+		if (bloom->parts[i].type != BLOOM_CLASSIC)
+			return true;
+	}
+	return false;
+}
+
 size_t
 tuple_bloom_size(const struct tuple_bloom *bloom)
 {
@@ -331,6 +427,7 @@ tuple_bloom_decode(const char **data)
 	}
 
 	bloom->is_legacy = false;
+	bloom->hash_func = KEY_HASH_MURMUR3;
 	bloom->part_count = 0;
 
 	for (uint32_t i = 0; i < part_count; i++) {
@@ -355,6 +452,7 @@ tuple_bloom_decode_legacy(const char **data)
 	}
 
 	bloom->is_legacy = true;
+	bloom->hash_func = KEY_HASH_MURMUR3;
 	bloom->part_count = 1;
 
 	if (mp_decode_array(data) != 4)
@@ -362,6 +460,7 @@ tuple_bloom_decode_legacy(const char **data)
 	if (mp_decode_uint(data) != 0) /* version */
 		unreachable();
 
+	bloom->parts[0].type = BLOOM_CLASSIC;
 	bloom->parts[0].table_size = mp_decode_uint(data);
 	bloom->parts[0].hash_count = mp_decode_uint(data);
 
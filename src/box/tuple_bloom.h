@@ -35,13 +35,13 @@
 #include <stddef.h>
 #include <stdint.h>
 #include "salad/bloom.h"
+#include "key_def.h"
 
 #if defined(__cplusplus)
 extern "C" {
 #endif /* defined(__cplusplus) */
 
 struct tuple;
-struct key_def;
 
 /**
  * Tuple bloom filter.
@@ -58,6 +58,8 @@ struct tuple_bloom {
 	 * (see tuple_bloom_decode_legacy).
 	 */
 	bool is_legacy;
+	/** Function used for hashing keys, see enum key_hash_func. */
+	enum key_hash_func hash_func;
 	/** Number of key parts. */
 	uint32_t part_count;
 	/** Array of bloom filters, one per each partial key. */
@@ -103,6 +105,8 @@ struct tuple_hash_array {
  * For more details, see tuple_bloom_new() implementation.
  */
 struct tuple_bloom_builder {
+	/** Function used for hashing keys, see enum key_hash_func. */
+	enum key_hash_func hash_func;
 	/** Number of key parts. */
 	uint32_t part_count;
 	/** Hash arrays, one per each partial key. */
@@ -112,10 +116,11 @@ struct tuple_bloom_builder {
 /**
  * Create a new tuple bloom filter builder.
  * @param part_count - number of key parts
+ * @param hash_func - function used for hashing keys
  * @return bloom filter builder on success or NULL on OOM
  */
 struct tuple_bloom_builder *
-tuple_bloom_builder_new(uint32_t part_count);
+tuple_bloom_builder_new(uint32_t part_count, enum key_hash_func hash_func);
 
 /**
  * Destroy a tuple bloom filter builder.
@@ -193,6 +198,14 @@ tuple_bloom_maybe_has_key(const struct tuple_bloom *bloom,
 			  const char *key, uint32_t part_count,
 			  struct key_def *key_def);
 
+/**
+ * Return true if a tuple bloom filter has register-blocked parts
+ * (see enum bloom_type), which can't be decoded by versions that
+ * predate them.
+ */
+bool
+tuple_bloom_is_blocked(const struct tuple_bloom *bloom);
+
 /**
  * Return the size of a tuple bloom filter when encoded.
  * @param bloom - bloom filter
@@ -440,15 +440,18 @@ mp_compare_scalar_coll(const char *field_a, const char *field_b,
 /**
  * @brief Compare two fields parts using a type definition
  * @param field_a field
+ * @param a_type MessagePack type of @a field_a
  * @param field_b field
+ * @param b_type MessagePack type of @a field_b
  * @param field_type field type definition
  * @retval 0  if field_a == field_b
  * @retval <0 if field_a < field_b
  * @retval >0 if field_a > field_b
  */
-static int
-tuple_compare_field(const char *field_a, const char *field_b,
-		    int8_t type, struct coll *coll)
+static inline int
+tuple_compare_field_with_type(const char *field_a, enum mp_type a_type,
+			      const char *field_b, enum mp_type b_type,
+			      int8_t type, struct coll *coll)
 {
 	switch (type) {
 	case FIELD_TYPE_UNSIGNED:
@@ -458,12 +461,11 @@ tuple_compare_field(const char *field_a, const char *field_b,
 		       mp_compare_str_coll(field_a, field_b, coll) :
 		       mp_compare_str(field_a, field_b);
 	case FIELD_TYPE_INTEGER:
-		return mp_compare_integer_with_type(field_a,
-						    mp_typeof(*field_a),
-						    field_b,
-						    mp_typeof(*field_b));
+		return mp_compare_integer_with_type(field_a, a_type,
+						    field_b, b_type);
 	case FIELD_TYPE_NUMBER:
-		return mp_compare_number(field_a, field_b);
+		return mp_compare_number_with_type(field_a, a_type,
+						   field_b, b_type);
 	case FIELD_TYPE_DOUBLE:
 		return mp_compare_double(field_a, field_b);
 	case FIELD_TYPE_BOOLEAN:
@@ -473,9 +475,13 @@ tuple_compare_field(const char *field_a, const char *field_b,
 	case FIELD_TYPE_SCALAR:
 		return coll != NULL ?
 		       mp_compare_scalar_coll(field_a, field_b, coll) :
-		       mp_compare_scalar(field_a, field_b);
+		       mp_compare_scalar_with_type(field_a, a_type,
+						   field_b, b_type);
 	case FIELD_TYPE_DECIMAL:
-		return mp_compare_decimal(field_a, field_b);
+		if (a_type == MP_EXT && b_type == MP_EXT)
+			return mp_compare_decimal(field_a, field_b);
+		return mp_compare_number_with_type(field_a, a_type,
+						   field_b, b_type);
 	case FIELD_TYPE_UUID:
 		return mp_compare_uuid(field_a, field_b);
 	default:
@@ -484,43 +490,54 @@ tuple_compare_field(const char *field_a, const char *field_b,
 	}
 }
 
+/**
+ * Field comparator of a key part of the given type. Being
+ * instantiated for a constant type it is reduced to a direct call
+ * of the type comparator, so a key part doesn't need to dispatch
+ * on its type on each comparison.
+ */
+template<enum field_type type, bool has_coll>
 static int
-tuple_compare_field_with_type(const char *field_a, enum mp_type a_type,
-			      const char *field_b, enum mp_type b_type,
-			      int8_t type, struct coll *coll)
+key_part_compare_field(const char *field_a, const char *field_b,
+		       struct coll *coll)
 {
-	switch (type) {
+	return tuple_compare_field_with_type(field_a, mp_typeof(*field_a),
+					     field_b, mp_typeof(*field_b),
+					     type, has_coll ? coll : NULL);
+}
+
+/** Select a field comparator for a key part. */
+static key_part_compare_f
+key_part_compare_func(const struct key_part *part)
+{
+	switch (part->type) {
 	case FIELD_TYPE_UNSIGNED:
-		return mp_compare_uint(field_a, field_b);
+		return key_part_compare_field<FIELD_TYPE_UNSIGNED, false>;
 	case FIELD_TYPE_STRING:
-		return coll != NULL ?
-		       mp_compare_str_coll(field_a, field_b, coll) :
-		       mp_compare_str(field_a, field_b);
+		return part->coll != NULL ?
+		       key_part_compare_field<FIELD_TYPE_STRING, true> :
+		       key_part_compare_field<FIELD_TYPE_STRING, false>;
 	case FIELD_TYPE_INTEGER:
-		return mp_compare_integer_with_type(field_a, a_type,
-						    field_b, b_type);
+		return key_part_compare_field<FIELD_TYPE_INTEGER, false>;
 	case FIELD_TYPE_NUMBER:
-		return mp_compare_number_with_type(field_a, a_type,
-						   field_b, b_type);
+		return key_part_compare_field<FIELD_TYPE_NUMBER, false>;
 	case FIELD_TYPE_DOUBLE:
-		return mp_compare_double(field_a, field_b);
+		return key_part_compare_field<FIELD_TYPE_DOUBLE, false>;
 	case FIELD_TYPE_BOOLEAN:
-		return mp_compare_bool(field_a, field_b);
+		return key_part_compare_field<FIELD_TYPE_BOOLEAN, false>;
 	case FIELD_TYPE_VARBINARY:
-		return mp_compare_bin(field_a, field_b);
+		return key_part_compare_field<FIELD_TYPE_VARBINARY, false>;
 	case FIELD_TYPE_SCALAR:
-		return coll != NULL ?
-		       mp_compare_scalar_coll(field_a, field_b, coll) :
-		       mp_compare_scalar_with_type(field_a, a_type,
-						   field_b, b_type);
+		return part->coll != NULL ?
+		       key_part_compare_field<FIELD_TYPE_SCALAR, true> :
+		       key_part_compare_field<FIELD_TYPE_SCALAR, false>;
 	case FIELD_TYPE_DECIMAL:
-		return mp_compare_number_with_type(field_a, a_type,
-						   field_b, b_type);
+		return key_part_compare_field<FIELD_TYPE_DECIMAL, false>;
 	case FIELD_TYPE_UUID:
-		return mp_compare_uuid(field_a, field_b);
+		return key_part_compare_field<FIELD_TYPE_UUID, false>;
 	default:
-		unreachable();
-		return 0;
+		/* Invalid key definition. */
+		return NULL;
 	}
 }
 
@@ -554,8 +571,7 @@ tuple_compare_slowpath(struct tuple *tuple_a, hint_t tuple_a_hint,
 		mp_decode_array(&tuple_a_raw);
 		mp_decode_array(&tuple_b_raw);
 		if (! is_nullable) {
-			return tuple_compare_field(tuple_a_raw, tuple_b_raw,
-						   part->type, part->coll);
+			return part->compare(tuple_a_raw, tuple_b_raw, part->coll);
 		}
 		enum mp_type a_type = mp_typeof(*tuple_a_raw);
 		enum mp_type b_type = mp_typeof(*tuple_b_raw);
@@ -563,9 +579,7 @@ tuple_compare_slowpath(struct tuple *tuple_a, hint_t tuple_a_hint,
 			return b_type == MP_NIL ? 0 : -1;
 		else if (b_type == MP_NIL)
 			return 1;
-		return tuple_compare_field_with_type(tuple_a_raw,  a_type,
-						     tuple_b_raw, b_type,
-						     part->type, part->coll);
+		return part->compare(tuple_a_raw, tuple_b_raw, part->coll);
 	}
 
 	bool was_null_met = false;
@@ -605,8 +619,7 @@ tuple_compare_slowpath(struct tuple *tuple_a, hint_t tuple_a_hint,
 		assert(has_optional_parts ||
 		       (field_a != NULL && field_b != NULL));
 		if (! is_nullable) {
-			rc = tuple_compare_field(field_a, field_b, part->type,
-						 part->coll);
+			rc = part->compare(field_a, field_b, part->coll);
 			if (rc != 0)
 				return rc;
 			else
@@ -626,10 +639,7 @@ tuple_compare_slowpath(struct tuple *tuple_a, hint_t tuple_a_hint,
 		} else if (b_type == MP_NIL) {
 			return 1;
 		} else {
-			rc = tuple_compare_field_with_type(field_a, a_type,
-							   field_b, b_type,
-							   part->type,
-							   part->coll);
+			rc = part->compare(field_a, field_b, part->coll);
 			if (rc != 0)
 				return rc;
 		}
@@ -673,8 +683,7 @@ tuple_compare_slowpath(struct tuple *tuple_a, hint_t tuple_a_hint,
 		 * be absent or be NULLs.
 		 */
 		assert(field_a != NULL && field_b != NULL);
-		rc = tuple_compare_field(field_a, field_b, part->type,
-					 part->coll);
+		rc = part->compare(field_a, field_b, part->coll);
 		if (rc != 0)
 			return rc;
 	}
@@ -720,8 +729,7 @@ tuple_compare_with_key_slowpath(struct tuple *tuple, hint_t tuple_hint,
 						part->fieldno);
 		}
 		if (! is_nullable) {
-			return tuple_compare_field(field, key, part->type,
-						   part->coll);
+			return part->compare(field, key, part->coll);
 		}
 		if (has_optional_parts)
 			a_type = field != NULL ? mp_typeof(*field) : MP_NIL;
@@ -733,9 +741,7 @@ tuple_compare_with_key_slowpath(struct tuple *tuple, hint_t tuple_hint,
 		} else if (b_type == MP_NIL) {
 			return 1;
 		} else {
-			return tuple_compare_field_with_type(field, a_type, key,
-							     b_type, part->type,
-							     part->coll);
+			return part->compare(field, key, part->coll);
 		}
 	}
 
@@ -755,8 +761,7 @@ tuple_compare_with_key_slowpath(struct tuple *tuple, hint_t tuple_hint,
 						part->fieldno);
 		}
 		if (! is_nullable) {
-			rc = tuple_compare_field(field, key, part->type,
-						 part->coll);
+			rc = part->compare(field, key, part->coll);
 			if (rc != 0)
 				return rc;
 			else
@@ -773,9 +778,7 @@ tuple_compare_with_key_slowpath(struct tuple *tuple, hint_t tuple_hint,
 		} else if (b_type == MP_NIL) {
 			return 1;
 		} else {
-			rc = tuple_compare_field_with_type(field, a_type, key,
-							   b_type, part->type,
-							   part->coll);
+			rc = part->compare(field, key, part->coll);
 			if (rc != 0)
 				return rc;
 		}
@@ -793,8 +796,7 @@ key_compare_parts(const char *key_a, const char *key_b, uint32_t part_count,
 	struct key_part *part = key_def->parts;
 	if (likely(part_count == 1)) {
 		if (! is_nullable) {
-			return tuple_compare_field(key_a, key_b, part->type,
-						   part->coll);
+			return part->compare(key_a, key_b, part->coll);
 		}
 		enum mp_type a_type = mp_typeof(*key_a);
 		enum mp_type b_type = mp_typeof(*key_b);
@@ -803,10 +805,7 @@ key_compare_parts(const char *key_a, const char *key_b, uint32_t part_count,
 		} else if (b_type == MP_NIL) {
 			return 1;
 		} else {
-			return tuple_compare_field_with_type(key_a, a_type,
-							     key_b, b_type,
-							     part->type,
-							     part->coll);
+			return part->compare(key_a, key_b, part->coll);
 		}
 	}
 
@@ -814,8 +813,7 @@ key_compare_parts(const char *key_a, const char *key_b, uint32_t part_count,
 	int rc;
 	for (; part < end; ++part, mp_next(&key_a), mp_next(&key_b)) {
 		if (! is_nullable) {
-			rc = tuple_compare_field(key_a, key_b, part->type,
-						 part->coll);
+			rc = part->compare(key_a, key_b, part->coll);
 			if (rc != 0)
 				return rc;
 			else
@@ -829,9 +827,7 @@ key_compare_parts(const char *key_a, const char *key_b, uint32_t part_count,
 		} else if (b_type == MP_NIL) {
 			return 1;
 		} else {
-			rc = tuple_compare_field_with_type(key_a, a_type, key_b,
-							   b_type, part->type,
-							   part->coll);
+			rc = part->compare(key_a, key_b, part->coll);
 			if (rc != 0)
 				return rc;
 		}
@@ -949,9 +945,7 @@ tuple_compare_sequential(struct tuple *tuple_a, hint_t tuple_a_hint,
 		} else if (b_type == MP_NIL) {
 			return 1;
 		} else {
-			rc = tuple_compare_field_with_type(key_a, a_type, key_b,
-							   b_type, part->type,
-							   part->coll);
+			rc = part->compare(key_a, key_b, part->coll);
 			if (rc != 0)
 				return rc;
 		}
@@ -970,8 +964,7 @@ tuple_compare_sequential(struct tuple *tuple_a, hint_t tuple_a_hint,
 		 * not be absent or be null.
 		 */
 		assert(i < fc_a && i < fc_b);
-		rc = tuple_compare_field(key_a, key_b, part->type,
-					 part->coll);
+		rc = part->compare(key_a, key_b, part->coll);
 		if (rc != 0)
 			return rc;
 	}
@@ -1398,8 +1391,7 @@ func_index_compare(struct tuple *tuple_a, hint_t tuple_a_hint,
 						  field_map_b, part,
 						  MULTIKEY_NONE);
 		assert(field_a != NULL && field_b != NULL);
-		rc = tuple_compare_field(field_a, field_b, part->type,
-					 part->coll);
+		rc = part->compare(field_a, field_b, part->coll);
 		if (rc != 0)
 			return rc;
 		else
@@ -2054,6 +2046,8 @@ key_def_set_compare_func_for_func_index(struct key_def *def)
 void
 key_def_set_compare_func(struct key_def *def)
 {
+	for (uint32_t i = 0; i < def->part_count; i++)
+		def->parts[i].compare = key_part_compare_func(&def->parts[i]);
 	if (def->for_func_index) {
 		if (def->is_nullable)
 			key_def_set_compare_func_for_func_index<true>(def);
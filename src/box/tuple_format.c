@@ -79,6 +79,8 @@ tuple_format_cmp(const struct tuple_format *format1,
 	struct tuple_format *b = (struct tuple_format *)format2;
 	if (a->exact_field_count != b->exact_field_count)
 		return a->exact_field_count - b->exact_field_count;
+	if (a->full_field_map != b->full_field_map)
+		return (int)a->full_field_map - (int)b->full_field_map;
 	if (a->total_field_count != b->total_field_count)
 		return a->total_field_count - b->total_field_count;
 
@@ -478,6 +480,23 @@ tuple_format_create(struct tuple_format *format, struct key_def * const *keys,
 		}
 	}
 
+	if (format->full_field_map) {
+		/*
+		 * Allocate offset slots for the remaining fields
+		 * of the space format so that accessing any of them
+		 * doesn't need to decode the preceding fields.
+		 */
+		for (uint32_t i = 1; i < field_count; i++) {
+			struct tuple_field *field = tuple_format_field(format, i);
+			if (field->offset_slot == TUPLE_OFFSET_SLOT_NIL) {
+				current_slot--;
+				field->offset_slot = current_slot;
+			}
+		}
+		format->index_field_count = MAX(format->index_field_count,
+						field_count);
+	}
+
 	assert(tuple_format_field(format, 0)->offset_slot == TUPLE_OFFSET_SLOT_NIL
 	       || json_token_is_multikey(&tuple_format_field(format, 0)->token));
 	size_t field_map_size = -current_slot * sizeof(uint32_t);
@@ -592,6 +611,62 @@ tuple_format_deregister(struct tuple_format *format)
 	format->id = FORMAT_ID_NIL;
 }
 
+int
+tuple_format_reserve_max(void)
+{
+	if (formats_capacity == FORMAT_ID_MAX + 1)
+		return 0;
+	uint32_t new_capacity = FORMAT_ID_MAX + 1;
+	struct tuple_format **formats = (struct tuple_format **)
+		realloc(tuple_formats, new_capacity * sizeof(tuple_formats[0]));
+	if (formats == NULL) {
+		diag_set(OutOfMemory, new_capacity * sizeof(tuple_formats[0]),
+			 "malloc", "tuple_formats");
+		return -1;
+	}
+	formats_capacity = new_capacity;
+	tuple_formats = formats;
+	return 0;
+}
+
+struct tuple_format **
+tuple_format_ref_all(uint32_t *count)
+{
+	/* Slots of deleted formats store the recycled id list. */
+	size_t recycled_words = DIV_ROUND_UP(formats_size + 1,
+					     CHAR_BIT * sizeof(long));
+	long *recycled = (long *)calloc(recycled_words, sizeof(long));
+	struct tuple_format **formats = (struct tuple_format **)
+		malloc((formats_size + 1) * sizeof(*formats));
+	if (recycled == NULL || formats == NULL) {
+		free(recycled);
+		free(formats);
+		diag_set(OutOfMemory, formats_size * sizeof(*formats),
+			 "malloc", "tuple_formats");
+		return NULL;
+	}
+	for (intptr_t id = recycled_format_ids; id != FORMAT_ID_NIL;
+	     id = (intptr_t)tuple_formats[id])
+		bit_set(recycled, id);
+	*count = 0;
+	for (uint32_t id = 0; id < formats_size; id++) {
+		if (bit_test(recycled, id))
+			continue;
+		tuple_format_ref(tuple_formats[id]);
+		formats[(*count)++] = tuple_formats[id];
+	}
+	free(recycled);
+	return formats;
+}
+
+void
+tuple_format_unref_all(struct tuple_format **formats, uint32_t count)
+{
+	for (uint32_t i = 0; i < count; i++)
+		tuple_format_unref(formats[i]);
+	free(formats);
+}
+
 /*
  * Dismantle the tuple field tree attached to the format and free
  * memory occupied by tuple fields.
@@ -775,7 +850,7 @@ tuple_format_new(struct tuple_format_vtab *vtab, void *engine,
 		 const struct field_def *space_fields,
 		 uint32_t space_field_count, uint32_t exact_field_count,
 		 struct tuple_dictionary *dict, bool is_temporary,
-		 bool is_ephemeral)
+		 bool is_ephemeral, bool full_field_map)
 {
 	struct tuple_format *format =
 		tuple_format_alloc(keys, key_count, space_field_count, dict);
@@ -788,6 +863,7 @@ tuple_format_new(struct tuple_format_vtab *vtab, void *engine,
 	format->engine = engine;
 	format->is_temporary = is_temporary;
 	format->is_ephemeral = is_ephemeral;
+	format->full_field_map = full_field_map;
 	format->exact_field_count = exact_field_count;
 	format->epoch = ++formats_epoch;
 	if (tuple_format_create(format, keys, key_count, space_fields,
@@ -808,48 +884,118 @@ err:
 	return NULL;
 }
 
+/**
+ * Check if a field of format1 may be invalid in tuples of format2.
+ * @param field1 field of format1
+ * @param field2 the same field in format2, NULL if format2 doesn't
+ *        define it
+ */
+static bool
+tuple_field1_needs_check(struct tuple_field *field1,
+			 struct tuple_field *field2)
+{
+	/*
+	 * The field has a data type in format1, but has
+	 * no data type in format2.
+	 */
+	if (field2 == NULL) {
+		/*
+		 * The field can get a name added
+		 * for it, and this doesn't require a data
+		 * check.
+		 * If the field is defined as not
+		 * nullable, however, we need a data
+		 * check, since old data may contain
+		 * NULLs or miss the subject field.
+		 */
+		return field1->type != FIELD_TYPE_ANY ||
+		       !tuple_field_is_nullable(field1);
+	}
+	if (! field_type1_contains_type2(field1->type, field2->type))
+		return true;
+	/*
+	 * Do not allow transition from nullable to non-nullable:
+	 * it would require a check of all data in the space.
+	 */
+	return tuple_field_is_nullable(field2) &&
+	       !tuple_field_is_nullable(field1);
+}
+
+/**
+ * Check if tuples of format2 may have a field count not allowed
+ * by format1. Dropping the restriction needs no check.
+ */
+static bool
+tuple_format1_needs_field_count_check(struct tuple_format *format1,
+				      struct tuple_format *format2)
+{
+	return format1->exact_field_count != 0 &&
+	       format1->exact_field_count != format2->exact_field_count;
+}
+
 bool
 tuple_format1_can_store_format2_tuples(struct tuple_format *format1,
 				       struct tuple_format *format2)
 {
-	if (format1->exact_field_count != format2->exact_field_count)
+	if (tuple_format1_needs_field_count_check(format1, format2))
 		return false;
 	struct tuple_field *field1;
 	json_tree_foreach_entry_preorder(field1, &format1->fields.root,
 					 struct tuple_field, token) {
 		struct tuple_field *field2 =
 			tuple_format1_field_by_format2_field(format2, field1);
-		/*
-		 * The field has a data type in format1, but has
-		 * no data type in format2.
-		 */
-		if (field2 == NULL) {
+		if (tuple_field1_needs_check(field1, field2))
+			return false;
+	}
+	return true;
+}
+
+int
+tuple_format_upgrade_create(struct tuple_format_upgrade *upgrade,
+			    struct tuple_format *format1,
+			    struct tuple_format *format2)
+{
+	upgrade->format = format1;
+	upgrade->fields = NULL;
+	upgrade->field_count = 0;
+	upgrade->check_field_count =
+		tuple_format1_needs_field_count_check(format1, format2);
+	upgrade->is_full = false;
+	uint32_t capacity = tuple_format_field_count(format1);
+	if (capacity == 0)
+		return 0;
+	size_t size = capacity * sizeof(upgrade->fields[0]);
+	upgrade->fields = (struct tuple_field **)malloc(size);
+	if (upgrade->fields == NULL) {
+		diag_set(OutOfMemory, size, "malloc", "upgrade->fields");
+		return -1;
+	}
+	struct tuple_field *field1;
+	json_tree_foreach_entry_preorder(field1, &format1->fields.root,
+					 struct tuple_field, token) {
+		struct tuple_field *field2 =
+			tuple_format1_field_by_format2_field(format2, field1);
+		if (!tuple_field1_needs_check(field1, field2))
+			continue;
+		if (field1->token.parent != &format1->fields.root) {
 			/*
-			 * The field can get a name added
-			 * for it, and this doesn't require a data
-			 * check.
-			 * If the field is defined as not
-			 * nullable, however, we need a data
-			 * check, since old data may contain
-			 * NULLs or miss the subject field.
+			 * JSON path fields are checked by full
+			 * validation, there's no cheap way to
+			 * locate them in a tuple.
 			 */
-			if (field1->type == FIELD_TYPE_ANY &&
-			    tuple_field_is_nullable(field1))
-				continue;
-			else
-				return false;
+			upgrade->is_full = true;
+			break;
 		}
-		if (! field_type1_contains_type2(field1->type, field2->type))
-			return false;
-		/*
-		 * Do not allow transition from nullable to non-nullable:
-		 * it would require a check of all data in the space.
-		 */
-		if (tuple_field_is_nullable(field2) &&
-		    !tuple_field_is_nullable(field1))
-			return false;
+		assert(upgrade->field_count < capacity);
+		upgrade->fields[upgrade->field_count++] = field1;
 	}
-	return true;
+	return 0;
+}
+
+void
+tuple_format_upgrade_destroy(struct tuple_format_upgrade *upgrade)
+{
+	free(upgrade->fields);
 }
 
 static int
@@ -193,6 +193,11 @@ struct tuple_format {
 	 * be shared with other ephemeral spaces.
 	 */
 	bool is_ephemeral;
+	/**
+	 * Offsets of all fields defined in the space format are
+	 * stored in the field map, see space_opts::full_field_map.
+	 */
+	bool full_field_map;
 	/**
 	 * Size of minimal field map of tuple where each indexed
 	 * field has own offset slot (in bytes). The real tuple
@@ -207,7 +212,8 @@ struct tuple_format {
 	uint32_t exact_field_count;
 	/**
 	 * The longest field array prefix in which the last
-	 * element is used by an index.
+	 * element is used by an index. If full_field_map is set,
+	 * it also covers all fields of the space format.
 	 */
 	uint32_t index_field_count;
 	/**
@@ -321,6 +327,28 @@ tuple_format_unref(struct tuple_format *format)
 		tuple_format_delete(format);
 }
 
+/**
+ * Allocate the global table of tuple formats for the maximal
+ * number of formats, so that it is never reallocated and
+ * tuple_format_by_id() may be called from threads other than
+ * tx (provided the format is referenced).
+ */
+int
+tuple_format_reserve_max(void);
+
+/**
+ * Reference all registered tuple formats. Returns an array of
+ * referenced formats and sets @a count to its size, the array
+ * must be released with tuple_format_unref_all(). Returns NULL
+ * and sets diag on memory allocation error.
+ */
+struct tuple_format **
+tuple_format_ref_all(uint32_t *count);
+
+/** Unreference formats and free the array of tuple_format_ref_all(). */
+void
+tuple_format_unref_all(struct tuple_format **formats, uint32_t count);
+
 /**
  * Allocate, construct and register a new in-memory tuple format.
  * @param vtab Virtual function table for specific engines.
@@ -332,6 +360,8 @@ tuple_format_unref(struct tuple_format *format)
  * @param exact_field_count Exact field count for format.
  * @param is_temporary Set if format belongs to temporary space.
  * @param is_ephemeral Set if format belongs to ephemeral space.
+ * @param full_field_map Set to allocate offset slots for all
+ *        fields of @a space_fields, not only for indexed ones.
  *
  * @retval not NULL Tuple format.
  * @retval     NULL Memory error.
@@ -342,7 +372,7 @@ tuple_format_new(struct tuple_format_vtab *vtab, void *engine,
 		 const struct field_def *space_fields,
 		 uint32_t space_field_count, uint32_t exact_field_count,
 		 struct tuple_dictionary *dict, bool is_temporary,
-		 bool is_ephemeral);
+		 bool is_ephemeral, bool full_field_map);
 
 /**
  * Check, if @a format1 can store any tuples of @a format2. For
@@ -359,6 +389,45 @@ bool
 tuple_format1_can_store_format2_tuples(struct tuple_format *format1,
 				       struct tuple_format *format2);
 
+/**
+ * Difference between two formats: what must be checked in a tuple
+ * valid for format2 to make sure it is valid for format1 as well.
+ * Lets a space format change validate only the affected fields of
+ * existing tuples instead of rebuilding their field maps.
+ */
+struct tuple_format_upgrade {
+	/** The format tuples are checked against (format1). */
+	struct tuple_format *format;
+	/**
+	 * Top level fields of format1 which may be invalid in
+	 * tuples of format2.
+	 */
+	struct tuple_field **fields;
+	/** Number of entries in fields. */
+	uint32_t field_count;
+	/** Set if tuple field count must be checked. */
+	bool check_field_count;
+	/**
+	 * Set if a field accessed by JSON path needs a check:
+	 * tuples must be fully validated then.
+	 */
+	bool is_full;
+};
+
+/**
+ * Find out what must be checked in tuples of @a format2 to store
+ * them in a space of @a format1. See tuple_validate_upgrade().
+ * @retval 0 Success.
+ * @retval -1 Memory error.
+ */
+int
+tuple_format_upgrade_create(struct tuple_format_upgrade *upgrade,
+			    struct tuple_format *format1,
+			    struct tuple_format *format2);
+
+void
+tuple_format_upgrade_destroy(struct tuple_format_upgrade *upgrade);
+
 /**
  * Calculate minimal field count of tuples with specified keys and
  * space format.
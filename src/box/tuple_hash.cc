@@ -32,6 +32,7 @@
 #include "tuple_hash.h"
 #include "tuple.h"
 #include "third_party/PMurHash.h"
+#include "third_party/wyhash.h"
 #include "coll/coll.h"
 #include <math.h>
 
@@ -52,7 +53,7 @@ field_hash(uint32_t *ph, uint32_t *pcarry, const char **field)
 	* for performance reasons. Please follow MsgPack specification
 	* and pack all your numbers to the most compact representation.
 	* If you still want to add support for broken MsgPack,
-	* please don't forget to patch tuple_compare_field().
+	* please don't forget to patch tuple_compare_field_with_type().
 	*/
 	const char *f = *field;
 	uint32_t size;
@@ -224,8 +225,15 @@ tuple_hash_slowpath(struct tuple *tuple, struct key_def *key_def);
 uint32_t
 key_hash_slowpath(const char *key, struct key_def *key_def);
 
+static void
+key_def_set_wyhash_func(struct key_def *key_def);
+
 void
 key_def_set_hash_func(struct key_def *key_def) {
+	if (key_def->hash_func == KEY_HASH_WYHASH) {
+		key_def_set_wyhash_func(key_def);
+		return;
+	}
 	if (key_def->is_nullable || key_def->has_json_paths)
 		goto slowpath;
 	/*
@@ -274,14 +282,16 @@ slowpath:
 	key_def->key_hash = key_hash_slowpath;
 }
 
-uint32_t
-tuple_hash_field(uint32_t *ph1, uint32_t *pcarry, const char **field,
-		 struct coll *coll)
+/**
+ * Get the bytes of a field that are fed to the hash function
+ * and advance @a field past the field. Numbers that have the same
+ * value must produce the same bytes, so floating point numbers
+ * are converted to integers into @a buf whenever possible.
+ */
+static inline const char *
+tuple_hash_field_data(const char **field, char *buf, uint32_t *size)
 {
-	char buf[9]; /* enough to store MP_INT/MP_UINT */
 	const char *f = *field;
-	uint32_t size;
-
 	switch (mp_typeof(**field)) {
 	case MP_STR:
 		/*
@@ -290,9 +300,7 @@ tuple_hash_field(uint32_t *ph1, uint32_t *pcarry, const char **field,
 		 * with old third-party MsgPack (spec-old.md) implementations.
 		 * \sa https://github.com/tarantool/tarantool/issues/522
 		 */
-		f = mp_decode_str(field, &size);
-		if (coll != NULL)
-			return coll->hash(f, size, ph1, pcarry, coll);
+		f = mp_decode_str(field, size);
 		break;
 	case MP_FLOAT:
 	case MP_DOUBLE: {
@@ -308,7 +316,7 @@ tuple_hash_field(uint32_t *ph1, uint32_t *pcarry, const char **field,
 			     mp_decode_double(field);
 		if (!isfinite(val) || modf(val, &iptr) != 0 ||
 		    val < -exp2(63) || val >= exp2(64)) {
-			size = *field - f;
+			*size = *field - f;
 			break;
 		}
 		char *data;
@@ -316,25 +324,39 @@ tuple_hash_field(uint32_t *ph1, uint32_t *pcarry, const char **field,
 			data = mp_encode_uint(buf, (uint64_t)val);
 		else
 			data = mp_encode_int(buf, (int64_t)val);
-		size = data - buf;
-		assert(size <= sizeof(buf));
+		*size = data - buf;
+		assert(*size <= 9);
 		f = buf;
 		break;
 	}
 	default:
 		mp_next(field);
-		size = *field - f;  /* calculate the size of field */
+		*size = *field - f;  /* calculate the size of field */
 		/*
 		 * (!) All other fields hashed **including** MsgPack format
 		 * identifier (e.g. 0xcc). This was done **intentionally**
 		 * for performance reasons. Please follow MsgPack specification
 		 * and pack all your numbers to the most compact representation.
 		 * If you still want to add support for broken MsgPack,
-		 * please don't forget to patch tuple_compare_field().
+		 * please don't forget to patch tuple_compare_field_with_type().
 		 */
 		break;
 	}
-	assert(size < INT32_MAX);
+	assert(*size < INT32_MAX);
+	return f;
+}
+
+uint32_t
+tuple_hash_field(uint32_t *ph1, uint32_t *pcarry, const char **field,
+		 struct coll *coll)
+{
+	char buf[9]; /* enough to store MP_INT/MP_UINT */
+	uint32_t size;
+	if (coll != NULL && mp_typeof(**field) == MP_STR) {
+		const char *f = mp_decode_str(field, &size);
+		return coll->hash(f, size, ph1, pcarry, coll);
+	}
+	const char *f = tuple_hash_field_data(field, buf, &size);
 	PMurHash32_Process(ph1, pcarry, f, size);
 	return size;
 }
@@ -431,3 +453,114 @@ key_hash_slowpath(const char *key, struct key_def *key_def)
 
 	return PMurHash32_Result(h, carry, total_size);
 }
+
+/* {{{ wyhash */
+
+uint64_t
+tuple_hash_field_wyhash(uint64_t h, const char **field, struct coll *coll)
+{
+	char buf[9]; /* enough to store MP_INT/MP_UINT */
+	uint32_t size;
+	if (coll != NULL && mp_typeof(**field) == MP_STR) {
+		/*
+		 * Collations produce a sort key on the fly and feed
+		 * it to MurmurHash, so hash the string with it and
+		 * mix the result into the running hash.
+		 */
+		const char *f = mp_decode_str(field, &size);
+		uint32_t ch = HASH_SEED;
+		uint32_t carry = 0;
+		size = coll->hash(f, size, &ch, &carry, coll);
+		return wyhash_mix(h ^ PMurHash32_Result(ch, carry, size),
+				  WYHASH_P1);
+	}
+	const char *f = tuple_hash_field_data(field, buf, &size);
+	return wyhash(f, size, h);
+}
+
+static inline uint64_t
+tuple_hash_null_wyhash(uint64_t h)
+{
+	const char null = 0xc0;
+	return wyhash(&null, 1, h);
+}
+
+uint64_t
+tuple_hash_key_part_wyhash(uint64_t h, struct tuple *tuple,
+			   struct key_part *part, int multikey_idx)
+{
+	const char *field = tuple_field_by_part(tuple, part, multikey_idx);
+	if (field == NULL)
+		return tuple_hash_null_wyhash(h);
+	return tuple_hash_field_wyhash(h, &field, part->coll);
+}
+
+template <bool has_optional_parts, bool has_json_paths>
+static uint32_t
+tuple_hash_wyhash(struct tuple *tuple, struct key_def *key_def)
+{
+	assert(has_json_paths == key_def->has_json_paths);
+	assert(has_optional_parts == key_def->has_optional_parts);
+	assert(!key_def->is_multikey);
+	assert(!key_def->for_func_index);
+	uint64_t h = TUPLE_HASH_WYHASH_SEED;
+	struct tuple_format *format = tuple_format(tuple);
+	const char *tuple_raw = tuple_data(tuple);
+	const uint32_t *field_map = tuple_field_map(tuple);
+	const char *end = (char *)tuple + tuple_size(tuple);
+	const char *field = NULL;
+	uint32_t prev_fieldno = UINT32_MAX;
+	for (uint32_t part_id = 0; part_id < key_def->part_count; part_id++) {
+		struct key_part *part = &key_def->parts[part_id];
+		/*
+		 * Sequential parts are hashed without looking up
+		 * the field map, see tuple_hash_slowpath().
+		 */
+		if (prev_fieldno == UINT32_MAX ||
+		    prev_fieldno + 1 != part->fieldno || has_json_paths) {
+			if (has_json_paths) {
+				field = tuple_field_raw_by_part(format,
+						tuple_raw, field_map, part,
+						MULTIKEY_NONE);
+			} else {
+				field = tuple_field_raw(format, tuple_raw,
+						field_map, part->fieldno);
+			}
+		}
+		if (has_optional_parts && (field == NULL || field >= end))
+			h = tuple_hash_null_wyhash(h);
+		else
+			h = tuple_hash_field_wyhash(h, &field, part->coll);
+		prev_fieldno = part->fieldno;
+	}
+	return tuple_hash_wyhash_result(h);
+}
+
+static uint32_t
+key_hash_wyhash(const char *key, struct key_def *key_def)
+{
+	uint64_t h = TUPLE_HASH_WYHASH_SEED;
+	for (struct key_part *part = key_def->parts;
+	     part < key_def->parts + key_def->part_count; part++)
+		h = tuple_hash_field_wyhash(h, &key, part->coll);
+	return tuple_hash_wyhash_result(h);
+}
+
+static void
+key_def_set_wyhash_func(struct key_def *key_def)
+{
+	if (key_def->has_optional_parts) {
+		if (key_def->has_json_paths)
+			key_def->tuple_hash = tuple_hash_wyhash<true, true>;
+		else
+			key_def->tuple_hash = tuple_hash_wyhash<true, false>;
+	} else {
+		if (key_def->has_json_paths)
+			key_def->tuple_hash = tuple_hash_wyhash<false, true>;
+		else
+			key_def->tuple_hash = tuple_hash_wyhash<false, false>;
+	}
+	key_def->key_hash = key_hash_wyhash;
+}
+
+/* }}} wyhash */
@@ -32,6 +32,7 @@
 #include "memtx_tx.h"
 #include "txn_limbo.h"
 #include "engine.h"
+#include "schema.h"
 #include "tuple.h"
 #include "journal.h"
 #include <fiber.h>
@@ -200,6 +201,7 @@ txn_new(void)
 	assert(region_used(&region) == sizeof(*txn));
 	txn->region = region;
 	rlist_create(&txn->read_set);
+	rlist_create(&txn->range_set);
 	rlist_create(&txn->conflict_list);
 	rlist_create(&txn->conflicted_by_list);
 	rlist_create(&txn->in_read_view_txs);
@@ -219,6 +221,7 @@ txn_free(struct txn *txn)
 		rlist_del(&tracker->in_read_set);
 	}
 	assert(rlist_empty(&txn->read_set));
+	memtx_tx_untrack_ranges(txn);
 
 	struct tx_conflict_tracker *entry, *next;
 	rlist_foreach_entry_safe(entry, &txn->conflict_list,
@@ -340,6 +343,8 @@ txn_begin_stmt(struct txn *txn, struct space *space)
 		goto fail;
 
 	stmt->space = space;
+	if (space_is_system(space))
+		txn_set_flag(txn, TXN_HANDLES_DDL);
 	if (engine_begin_statement(engine, txn) != 0)
 		goto fail;
 
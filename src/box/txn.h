@@ -90,6 +90,8 @@ enum txn_flag {
 	 * example, when applier receives snapshot from master.
 	 */
 	TXN_FORCE_ASYNC,
+	/** Transaction has modified a system space. */
+	TXN_HANDLES_DDL,
 };
 
 enum {
@@ -391,6 +393,8 @@ struct txn {
 	struct rlist in_read_view_txs;
 	/** List of tx_read_trackers with stories that the TX have read. */
 	struct rlist read_set;
+	/** List of tx_range_trackers with index ranges the TX have read. */
+	struct rlist range_set;
 };
 
 static inline bool
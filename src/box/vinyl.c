@@ -33,6 +33,7 @@
 #include "vy_mem.h"
 #include "vy_run.h"
 #include "vy_range.h"
+#include "vy_range_tombstone.h"
 #include "vy_lsm.h"
 #include "vy_tx.h"
 #include "vy_cache.h"
@@ -71,6 +72,7 @@
 #include "column_mask.h"
 #include "trigger.h"
 #include "wal.h" /* wal_mode() */
+#include "third_party/qsort_arg.h"
 
 /**
  * Yield after iterating over this many objects (e.g. ranges).
@@ -300,6 +302,32 @@ vy_info_append_memory(struct vy_env *env, struct info_handler *h)
 	info_table_end(h); /* memory */
 }
 
+static void
+vy_info_append_page_cache(struct vy_env *env, struct info_handler *h)
+{
+	struct vy_page_cache *cache = &env->run_env.page_cache;
+
+	info_table_begin(h, "page_cache");
+	info_append_int(h, "bytes", cache->mem_used);
+	info_append_int(h, "hit", cache->stat.hit);
+	info_append_int(h, "miss", cache->stat.miss);
+	info_append_int(h, "evict", cache->stat.evict);
+	info_table_end(h); /* page_cache */
+}
+
+static void
+vy_info_append_value_cache(struct vy_env *env, struct info_handler *h)
+{
+	struct vy_value_cache *cache = &env->run_env.value_cache;
+
+	info_table_begin(h, "value_cache");
+	info_append_int(h, "bytes", cache->mem_used);
+	info_append_int(h, "hit", cache->stat.hit);
+	info_append_int(h, "miss", cache->stat.miss);
+	info_append_int(h, "evict", cache->stat.evict);
+	info_table_end(h); /* value_cache */
+}
+
 static void
 vy_info_append_disk(struct vy_env *env, struct info_handler *h)
 {
@@ -321,6 +349,8 @@ vinyl_engine_stat(struct engine *engine, struct info_handler *h)
 	vy_info_append_disk(env, h);
 	vy_info_append_scheduler(env, h);
 	vy_info_append_regulator(env, h);
+	vy_info_append_page_cache(env, h);
+	vy_info_append_value_cache(env, h);
 	info_end(h);
 }
 
@@ -350,6 +380,36 @@ vy_info_append_disk_stmt_counter(struct info_handler *h, const char *name,
 		info_table_end(h);
 }
 
+/**
+ * Append write, read, and space amplification of an LSM tree:
+ * - write: bytes written to disk by dump and compaction per
+ *   byte of dumped data;
+ * - read: runs looked up per index lookup;
+ * - space: size of all runs per size of the last level.
+ * Write and read amplification are accumulated since the last
+ * statistics reset and can be used to choose the compaction
+ * strategy.
+ */
+static void
+vy_info_append_amplification(struct info_handler *h, struct vy_lsm *lsm)
+{
+	struct vy_lsm_stat *stat = &lsm->stat;
+	int64_t written = stat->disk.dump.output.bytes +
+			  stat->disk.compaction.output.bytes;
+	int64_t dumped = stat->disk.dump.input.bytes;
+	int64_t last_level = stat->disk.last_level_count.bytes;
+
+	info_table_begin(h, "amplification");
+	info_append_double(h, "write", dumped > 0 ?
+			   (double)written / dumped : 0);
+	info_append_double(h, "read", stat->lookup > 0 ?
+			   (double)stat->disk.iterator.lookup /
+			   stat->lookup : 0);
+	info_append_double(h, "space", last_level > 0 ?
+			   (double)stat->disk.count.bytes / last_level : 0);
+	info_table_end(h); /* amplification */
+}
+
 static void
 vinyl_index_stat(struct index *index, struct info_handler *h)
 {
@@ -454,6 +514,7 @@ vinyl_index_stat(struct index *index, struct info_handler *h)
 	info_append_str(h, "run_histogram", buf);
 	info_append_int(h, "dumps_per_compaction",
 			vy_lsm_dumps_per_compaction(lsm));
+	vy_info_append_amplification(h, lsm);
 
 	info_end(h);
 }
@@ -522,6 +583,12 @@ vinyl_engine_reset_stat(struct engine *engine)
 
 	vy_scheduler_reset_stat(&env->scheduler);
 	vy_regulator_reset_stat(&env->regulator);
+
+	struct vy_page_cache *page_cache = &env->run_env.page_cache;
+	memset(&page_cache->stat, 0, sizeof(page_cache->stat));
+
+	struct vy_value_cache *value_cache = &env->run_env.value_cache;
+	memset(&value_cache->stat, 0, sizeof(value_cache->stat));
 }
 
 /** }}} Introspection */
@@ -582,6 +649,11 @@ vinyl_engine_check_space_def(struct space_def *def)
 			 def->name, "engine does not support temporary flag");
 		return -1;
 	}
+	if (def->opts.full_field_map) {
+		diag_set(ClientError, ER_ALTER_SPACE,
+			 def->name, "engine does not support full_field_map");
+		return -1;
+	}
 	return 0;
 }
 
@@ -2366,6 +2438,56 @@ vinyl_space_execute_delete(struct space *space, struct txn *txn,
 	return 0;
 }
 
+/**
+ * Execute range deletion in a vinyl space: write a range
+ * tombstone covering primary keys in [request->key,
+ * request->tuple) to the transaction. An empty key stands
+ * for infinity.
+ */
+static int
+vy_delete_range(struct vy_env *env, struct vy_tx *tx, struct txn *txn,
+		struct space *space, struct request *request)
+{
+	struct vy_lsm *pk = vy_lsm_find(space, 0);
+	if (pk == NULL)
+		return -1;
+	if (vy_is_committed(env, pk))
+		return 0;
+	if (request->index_id != 0) {
+		diag_set(ClientError, ER_UNSUPPORTED, "Vinyl",
+			 "range deletion by a secondary index");
+		return -1;
+	}
+	if (txn_check_singlestatement(txn, "index.delete_range") != 0)
+		return -1;
+	struct index_def *def = space_index(space, 0)->def;
+	const char *begin = request->key;
+	uint32_t part_count = mp_decode_array(&begin);
+	if (key_validate(def, ITER_GE, begin, part_count) != 0)
+		return -1;
+	const char *end = request->tuple;
+	part_count = mp_decode_array(&end);
+	if (key_validate(def, ITER_LT, end, part_count) != 0)
+		return -1;
+	struct vy_range_tombstone *t;
+	t = vy_range_tombstone_new(vy_log_next_id(), pk->env->key_format,
+				   pk->cmp_def, request->key, request->tuple,
+				   0);
+	if (t == NULL)
+		return -1;
+	vy_tx_delete_range(tx, pk, t);
+	return 0;
+}
+
+static int
+vinyl_space_execute_delete_range(struct space *space, struct txn *txn,
+				 struct request *request)
+{
+	struct vy_env *env = vy_env(space->engine);
+	struct vy_tx *tx = txn->engine_tx;
+	return vy_delete_range(env, tx, txn, space, request);
+}
+
 static int
 vinyl_space_execute_update(struct space *space, struct txn *txn,
 			   struct request *request, struct tuple **result)
@@ -2698,6 +2820,20 @@ vinyl_engine_set_cache(struct engine *engine, size_t quota)
 	vy_cache_env_set_quota(&env->cache_env, quota);
 }
 
+void
+vinyl_engine_set_page_cache(struct engine *engine, size_t quota)
+{
+	struct vy_env *env = vy_env(engine);
+	vy_run_env_set_page_cache_quota(&env->run_env, quota);
+}
+
+void
+vinyl_engine_set_value_cache(struct engine *engine, size_t quota)
+{
+	struct vy_env *env = vy_env(engine);
+	vy_value_cache_set_quota(&env->run_env.value_cache, quota);
+}
+
 int
 vinyl_engine_set_memory(struct engine *engine, size_t size)
 {
@@ -3103,6 +3239,10 @@ vy_gc_lsm(struct vy_lsm_recovery_info *lsm_info)
 			vy_log_delete_slice(slice_info->id);
 		vy_log_delete_range(range_info->id);
 	}
+	struct vy_range_tombstone_recovery_info *tombstone_info;
+	rlist_foreach_entry(tombstone_info, &lsm_info->range_tombstones,
+			    in_lsm)
+		vy_log_delete_range_tombstone(tombstone_info->id);
 	struct vy_run_recovery_info *run_info;
 	rlist_foreach_entry(run_info, &lsm_info->runs, in_lsm) {
 		if (lsm_info->create_lsn < 0)
@@ -3114,7 +3254,8 @@ vy_gc_lsm(struct vy_lsm_recovery_info *lsm_info)
 		}
 	}
 	if (rlist_empty(&lsm_info->ranges) &&
-	    rlist_empty(&lsm_info->runs))
+	    rlist_empty(&lsm_info->runs) &&
+	    rlist_empty(&lsm_info->range_tombstones))
 		vy_log_forget_lsm(lsm_info->id);
 	vy_log_tx_try_commit();
 }
@@ -3223,6 +3364,18 @@ vinyl_engine_backup(struct engine *engine, const struct vclock *vclock,
 				if (rc != 0)
 					goto out;
 			}
+			uint32_t value_file_count = vy_value_files_count(
+					env->path, lsm_info->space_id,
+					lsm_info->index_id, run_info->id);
+			for (uint32_t i = 0; i < value_file_count; i++) {
+				vy_run_snprint_value_path(path, sizeof(path),
+						env->path, lsm_info->space_id,
+						lsm_info->index_id,
+						run_info->id, i);
+				rc = cb(path, cb_arg);
+				if (rc != 0)
+					goto out;
+			}
 			if (loops % VY_YIELD_LOOPS == 0)
 				fiber_sleep(0);
 		}
@@ -3796,6 +3949,218 @@ vinyl_index_get(struct index *index, const char *key,
 	return 0;
 }
 
+/**
+ * Max number of fibers vinyl_index_get_many() looks up keys in.
+ * Each fiber gets a contiguous chunk of sorted keys so that keys
+ * stored in the same page are likely to be read by the same fiber.
+ */
+enum { VY_GET_MANY_FIBER_MAX = 16 };
+
+/** A key looked up by vinyl_index_get_many(). */
+struct vy_get_many_key {
+	/** Key statement. */
+	struct tuple *stmt;
+	/** Position of the key in the request. */
+	uint32_t pos;
+	/** Set if the key is equal to the previous one. */
+	bool is_dup;
+};
+
+/** A chunk of keys looked up by one fiber. */
+struct vy_get_many_chunk {
+	struct vy_lsm *lsm;
+	struct vy_tx *tx;
+	const struct vy_read_view **rv;
+	/** Keys to look up. */
+	struct vy_get_many_key *keys;
+	/** Number of keys in the chunk. */
+	uint32_t key_count;
+	/** Result array indexed by vy_get_many_key::pos. */
+	struct tuple **result;
+};
+
+static int
+vy_get_many_key_cmp(const void *a, const void *b, void *arg)
+{
+	const struct vy_get_many_key *key_a = a;
+	const struct vy_get_many_key *key_b = b;
+	struct key_def *cmp_def = arg;
+	int rc = vy_stmt_compare(key_a->stmt, HINT_NONE,
+				 key_b->stmt, HINT_NONE, cmp_def);
+	/* Keep equal keys in the request order. */
+	return rc != 0 ? rc : key_a->pos < key_b->pos ? -1 : 1;
+}
+
+static int
+vy_get_many_chunk(struct vy_get_many_chunk *chunk)
+{
+	for (uint32_t i = 0; i < chunk->key_count; i++) {
+		struct vy_get_many_key *key = &chunk->keys[i];
+		if (key->is_dup)
+			continue;
+		/* The transaction may be aborted while we read disk. */
+		if (chunk->tx != NULL &&
+		    chunk->tx->state == VINYL_TX_ABORT) {
+			diag_set(ClientError, ER_TRANSACTION_CONFLICT);
+			return -1;
+		}
+		if (vy_get(chunk->lsm, chunk->tx, chunk->rv, key->stmt,
+			   &chunk->result[key->pos]) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+static int
+vy_get_many_f(va_list ap)
+{
+	struct vy_get_many_chunk *chunk =
+		va_arg(ap, struct vy_get_many_chunk *);
+	return vy_get_many_chunk(chunk);
+}
+
+/**
+ * Look up a batch of keys. The keys are sorted and split into
+ * chunks, each of which is looked up by a separate fiber, so
+ * that disk reads of different chunks are handed over to reader
+ * threads in parallel.
+ */
+static int
+vy_get_many(struct vy_env *env, struct vy_lsm *lsm, struct vy_tx *tx,
+	    const struct vy_read_view **rv, struct vy_get_many_key *keys,
+	    uint32_t key_count, struct tuple **result)
+{
+	qsort_arg(keys, key_count, sizeof(*keys),
+		  vy_get_many_key_cmp, lsm->cmp_def);
+	for (uint32_t i = 1; i < key_count; i++) {
+		keys[i].is_dup = vy_stmt_compare(keys[i - 1].stmt, HINT_NONE,
+						 keys[i].stmt, HINT_NONE,
+						 lsm->cmp_def) == 0;
+	}
+	/*
+	 * There's no point in using fibers if reads are done
+	 * synchronously, which is the case during recovery.
+	 */
+	uint32_t chunk_count = MIN(key_count, VY_GET_MANY_FIBER_MAX);
+	if (env->run_env.reader_pool == NULL)
+		chunk_count = 1;
+	struct vy_get_many_chunk chunks[VY_GET_MANY_FIBER_MAX];
+	struct fiber *fibers[VY_GET_MANY_FIBER_MAX];
+	uint32_t begin = 0;
+	for (uint32_t i = 0; i < chunk_count; i++) {
+		uint32_t end = (uint64_t)key_count * (i + 1) / chunk_count;
+		struct vy_get_many_chunk *chunk = &chunks[i];
+		chunk->lsm = lsm;
+		chunk->tx = tx;
+		chunk->rv = rv;
+		chunk->keys = &keys[begin];
+		chunk->key_count = end - begin;
+		chunk->result = result;
+		begin = end;
+	}
+	/*
+	 * The first chunk is looked up by the caller, the rest
+	 * by new fibers. If we fail to start a fiber, we look up
+	 * its chunk in the caller, too.
+	 */
+	uint32_t fiber_count = 0;
+	for (uint32_t i = 1; i < chunk_count; i++) {
+		struct fiber *f = fiber_new("vinyl.get_many", vy_get_many_f);
+		if (f == NULL) {
+			diag_clear(diag_get());
+			break;
+		}
+		fiber_set_joinable(f, true);
+		fibers[fiber_count++] = f;
+		fiber_start(f, &chunks[i]);
+	}
+	int rc = 0;
+	for (uint32_t i = 0; i < chunk_count; i++) {
+		if (i > 0 && i <= fiber_count)
+			continue;
+		if (rc == 0)
+			rc = vy_get_many_chunk(&chunks[i]);
+	}
+	for (uint32_t i = 0; i < fiber_count; i++) {
+		if (fiber_join(fibers[i]) != 0)
+			rc = -1;
+	}
+	if (rc != 0)
+		return -1;
+	for (uint32_t i = 1; i < key_count; i++) {
+		if (!keys[i].is_dup)
+			continue;
+		struct tuple *tuple = result[keys[i - 1].pos];
+		if (tuple != NULL)
+			tuple_ref(tuple);
+		result[keys[i].pos] = tuple;
+	}
+	return 0;
+}
+
+static int
+vinyl_index_get_many(struct index *index, const char *keys,
+		     uint32_t key_count, struct tuple **result)
+{
+	assert(index->def->opts.is_unique);
+
+	struct vy_lsm *lsm = vy_lsm(index);
+	struct vy_env *env = vy_env(index->engine);
+	struct vy_tx *tx = in_txn() ? in_txn()->engine_tx : NULL;
+	const struct vy_read_view **rv = (tx != NULL ? vy_tx_read_view(tx) :
+					  &env->xm->p_global_read_view);
+
+	if (tx != NULL && tx->state == VINYL_TX_ABORT) {
+		diag_set(ClientError, ER_TRANSACTION_CONFLICT);
+		return -1;
+	}
+	memset(result, 0, key_count * sizeof(*result));
+	if (key_count == 0)
+		return 0;
+
+	size_t size;
+	struct vy_get_many_key *key_stmts =
+		region_alloc_array(&fiber()->gc, typeof(key_stmts[0]),
+				   key_count, &size);
+	if (key_stmts == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "keys");
+		return -1;
+	}
+	int rc = -1;
+	uint32_t i;
+	const char *key = keys;
+	for (i = 0; i < key_count; i++) {
+		uint32_t part_count = mp_decode_array(&key);
+		assert(index->def->key_def->part_count == part_count);
+		key_stmts[i].stmt = vy_key_new(lsm->env->key_format,
+					       key, part_count);
+		if (key_stmts[i].stmt == NULL)
+			goto out;
+		key_stmts[i].pos = i;
+		key_stmts[i].is_dup = false;
+		for (uint32_t j = 0; j < part_count; j++)
+			mp_next(&key);
+	}
+	/*
+	 * Make sure the LSM tree isn't deleted while we are
+	 * reading from it.
+	 */
+	vy_lsm_ref(lsm);
+	rc = vy_get_many(env, lsm, tx, rv, key_stmts, key_count, result);
+	vy_lsm_unref(lsm);
+out:
+	for (uint32_t j = 0; j < i; j++)
+		tuple_unref(key_stmts[j].stmt);
+	if (rc != 0) {
+		for (uint32_t j = 0; j < key_count; j++) {
+			if (result[j] != NULL)
+				tuple_unref(result[j]);
+			result[j] = NULL;
+		}
+	}
+	return rc;
+}
+
 /*** }}} Cursor */
 
 /* {{{ Index build */
@@ -4468,6 +4833,17 @@ vy_deferred_delete_on_replace(struct trigger *trigger, void *event)
 		}
 		struct vy_entry entry;
 		vy_stmt_foreach_entry(entry, delete, lsm->cmp_def) {
+			/*
+			 * If there's a statement with the same key and
+			 * LSN, it overwrote the deleted tuple (see also
+			 * heap_less() in vy_write_iterator.c), so keep it.
+			 */
+			struct vy_mem_tree_key tree_key = {
+				.entry = entry,
+				.lsn = (int64_t)lsn,
+			};
+			if (vy_mem_tree_find(&mem->tree, &tree_key) != NULL)
+				continue;
 			rc = vy_lsm_set(lsm, mem, entry, &region_stmt);
 			if (rc != 0)
 				break;
@@ -4563,6 +4939,7 @@ static const struct space_vtab vinyl_space_vtab = {
 	/* .execute_delete = */ vinyl_space_execute_delete,
 	/* .execute_update = */ vinyl_space_execute_update,
 	/* .execute_upsert = */ vinyl_space_execute_upsert,
+	/* .execute_delete_range = */ vinyl_space_execute_delete_range,
 	/* .ephemeral_replace = */ generic_space_ephemeral_replace,
 	/* .ephemeral_delete = */ generic_space_ephemeral_delete,
 	/* .ephemeral_rowid_next = */ generic_space_ephemeral_rowid_next,
@@ -4596,8 +4973,11 @@ static const struct index_vtab vinyl_index_vtab = {
 	/* .random = */ generic_index_random,
 	/* .count = */ generic_index_count,
 	/* .get = */ vinyl_index_get,
+	/* .get_many = */ vinyl_index_get_many,
 	/* .replace = */ generic_index_replace,
 	/* .create_iterator = */ vinyl_index_create_iterator,
+	/* .create_iterator_with_offset = */
+		generic_index_create_iterator_with_offset,
 	/* .create_snapshot_iterator = */
 		vinyl_index_create_snapshot_iterator,
 	/* .stat = */ vinyl_index_stat,
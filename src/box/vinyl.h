@@ -57,6 +57,18 @@ vinyl_engine_stat(struct engine *engine, struct info_handler *handler);
 void
 vinyl_engine_set_cache(struct engine *engine, size_t quota);
 
+/**
+ * Update vinyl page cache size.
+ */
+void
+vinyl_engine_set_page_cache(struct engine *engine, size_t quota);
+
+/**
+ * Update vinyl value cache size.
+ */
+void
+vinyl_engine_set_value_cache(struct engine *engine, size_t quota);
+
 /**
  * Update vinyl memory size.
  */
@@ -503,6 +503,37 @@ vy_cache_on_write(struct vy_cache *cache, struct vy_entry entry,
 	}
 }
 
+void
+vy_cache_on_range_delete(struct vy_cache *cache, struct vy_entry begin,
+			 struct vy_entry end)
+{
+	while (true) {
+		struct vy_cache_tree_iterator itr;
+		if (begin.stmt != NULL) {
+			itr = vy_cache_tree_lower_bound(&cache->cache_tree,
+							begin, NULL);
+		} else {
+			itr = vy_cache_tree_iterator_first(&cache->cache_tree);
+		}
+		struct vy_cache_node **node =
+			vy_cache_tree_iterator_get_elem(&cache->cache_tree,
+							&itr);
+		if (node == NULL)
+			break;
+		struct vy_entry entry = (*node)->entry;
+		if (end.stmt != NULL &&
+		    vy_entry_compare(entry, end, cache->cmp_def) >= 0)
+			break;
+		/*
+		 * The node may be freed by vy_cache_on_write()
+		 * so pin the statement.
+		 */
+		tuple_ref(entry.stmt);
+		vy_cache_on_write(cache, entry, NULL);
+		tuple_unref(entry.stmt);
+	}
+}
+
 /**
  * Get a stmt by current position
  */
@@ -223,6 +223,14 @@ void
 vy_cache_on_write(struct vy_cache *cache, struct vy_entry entry,
 		  struct vy_entry *deleted);
 
+/**
+ * Invalidate all cached values in the interval [begin, end)
+ * due to a range delete. NULL statements stand for infinity.
+ */
+void
+vy_cache_on_range_delete(struct vy_cache *cache, struct vy_entry begin,
+			 struct vy_entry end);
+
 
 /**
  * Cache iterator
@@ -72,6 +72,20 @@ vy_history_cleanup(struct vy_history *history)
 	rlist_create(&history->stmts);
 }
 
+void
+vy_history_cut(struct vy_history *history, int64_t lsn)
+{
+	struct vy_history_node *node, *tmp;
+	rlist_foreach_entry_safe_reverse(node, &history->stmts, link, tmp) {
+		if (vy_stmt_lsn(node->entry.stmt) >= lsn)
+			break;
+		rlist_del_entry(node, link);
+		if (node->is_refable)
+			tuple_unref(node->entry.stmt);
+		mempool_free(history->pool, node);
+	}
+}
+
 int
 vy_history_apply(struct vy_history *history, struct key_def *cmp_def,
 		 bool keep_delete, int *upserts_applied, struct vy_entry *ret)
@@ -145,6 +145,13 @@ vy_history_append_stmt(struct vy_history *history, struct vy_entry entry);
 void
 vy_history_cleanup(struct vy_history *history);
 
+/**
+ * Release all statements older than @a lsn, i.e. statements
+ * deleted by a range tombstone with the given LSN.
+ */
+void
+vy_history_cut(struct vy_history *history, int64_t lsn);
+
 /**
  * Get a resultant statement from collected history.
  * If the resultant statement is a DELETE, the function
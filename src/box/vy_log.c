@@ -86,6 +86,8 @@ enum vy_log_key {
 	VY_LOG_KEY_DROP_LSN		= 14,
 	VY_LOG_KEY_GROUP_ID		= 15,
 	VY_LOG_KEY_DUMP_COUNT		= 16,
+	VY_LOG_KEY_TOMBSTONE_ID		= 17,
+	VY_LOG_KEY_TOMBSTONE_LSN	= 18,
 };
 
 /** vy_log_key -> human readable name. */
@@ -107,6 +109,8 @@ static const char *vy_log_key_name[] = {
 	[VY_LOG_KEY_DROP_LSN]		= "drop_lsn",
 	[VY_LOG_KEY_GROUP_ID]		= "group_id",
 	[VY_LOG_KEY_DUMP_COUNT]		= "dump_count",
+	[VY_LOG_KEY_TOMBSTONE_ID]	= "tombstone_id",
+	[VY_LOG_KEY_TOMBSTONE_LSN]	= "tombstone_lsn",
 };
 
 /** vy_log_type -> human readable name. */
@@ -129,6 +133,8 @@ static const char *vy_log_type_name[] = {
 	[VY_LOG_PREPARE_LSM]		= "prepare_lsm",
 	[VY_LOG_REBOOTSTRAP]		= "rebootstrap",
 	[VY_LOG_ABORT_REBOOTSTRAP]	= "abort_rebootstrap",
+	[VY_LOG_INSERT_RANGE_TOMBSTONE]	= "insert_range_tombstone",
+	[VY_LOG_DELETE_RANGE_TOMBSTONE]	= "delete_range_tombstone",
 };
 
 /** Batch of vylog records that must be written in one go. */
@@ -290,6 +296,10 @@ vy_log_record_snprint(char *buf, int size, const struct vy_log_record *record)
 		SNPRINT(total, snprintf, buf, size, "%s=%"PRIi64", ",
 			vy_log_key_name[VY_LOG_KEY_SLICE_ID],
 			record->slice_id);
+	if (record->tombstone_id > 0)
+		SNPRINT(total, snprintf, buf, size, "%s=%"PRIi64", ",
+			vy_log_key_name[VY_LOG_KEY_TOMBSTONE_ID],
+			record->tombstone_id);
 	if (record->create_lsn > 0)
 		SNPRINT(total, snprintf, buf, size, "%s=%"PRIi64", ",
 			vy_log_key_name[VY_LOG_KEY_CREATE_LSN],
@@ -314,6 +324,10 @@ vy_log_record_snprint(char *buf, int size, const struct vy_log_record *record)
 		SNPRINT(total, snprintf, buf, size, "%s=%"PRIu32", ",
 			vy_log_key_name[VY_LOG_KEY_DUMP_COUNT],
 			record->dump_count);
+	if (record->tombstone_lsn > 0)
+		SNPRINT(total, snprintf, buf, size, "%s=%"PRIi64", ",
+			vy_log_key_name[VY_LOG_KEY_TOMBSTONE_LSN],
+			record->tombstone_lsn);
 	SNPRINT(total, snprintf, buf, size, "}");
 	return total;
 }
@@ -445,6 +459,16 @@ vy_log_record_encode(const struct vy_log_record *record,
 		size += mp_sizeof_uint(record->dump_count);
 		n_keys++;
 	}
+	if (record->tombstone_id > 0) {
+		size += mp_sizeof_uint(VY_LOG_KEY_TOMBSTONE_ID);
+		size += mp_sizeof_uint(record->tombstone_id);
+		n_keys++;
+	}
+	if (record->tombstone_lsn > 0) {
+		size += mp_sizeof_uint(VY_LOG_KEY_TOMBSTONE_LSN);
+		size += mp_sizeof_uint(record->tombstone_lsn);
+		n_keys++;
+	}
 	size += mp_sizeof_map(n_keys);
 
 	/*
@@ -531,6 +555,14 @@ vy_log_record_encode(const struct vy_log_record *record,
 		pos = mp_encode_uint(pos, VY_LOG_KEY_DUMP_COUNT);
 		pos = mp_encode_uint(pos, record->dump_count);
 	}
+	if (record->tombstone_id > 0) {
+		pos = mp_encode_uint(pos, VY_LOG_KEY_TOMBSTONE_ID);
+		pos = mp_encode_uint(pos, record->tombstone_id);
+	}
+	if (record->tombstone_lsn > 0) {
+		pos = mp_encode_uint(pos, VY_LOG_KEY_TOMBSTONE_LSN);
+		pos = mp_encode_uint(pos, record->tombstone_lsn);
+	}
 	assert(pos == tuple + size);
 
 	/*
@@ -663,6 +695,12 @@ vy_log_record_decode(struct vy_log_record *record,
 		case VY_LOG_KEY_DUMP_COUNT:
 			record->dump_count = mp_decode_uint(&pos);
 			break;
+		case VY_LOG_KEY_TOMBSTONE_ID:
+			record->tombstone_id = mp_decode_uint(&pos);
+			break;
+		case VY_LOG_KEY_TOMBSTONE_LSN:
+			record->tombstone_lsn = mp_decode_uint(&pos);
+			break;
 		default:
 			mp_next(&pos); /* unknown key, ignore */
 			break;
@@ -1396,6 +1434,20 @@ vy_recovery_lookup_slice(struct vy_recovery *recovery, int64_t slice_id)
 	return mh_i64ptr_node(h, k)->val;
 }
 
+/**
+ * Lookup a range tombstone in vy_recovery::tombstone_hash map.
+ */
+static struct vy_range_tombstone_recovery_info *
+vy_recovery_lookup_range_tombstone(struct vy_recovery *recovery,
+				   int64_t tombstone_id)
+{
+	struct mh_i64ptr_t *h = recovery->tombstone_hash;
+	mh_int_t k = mh_i64ptr_find(h, tombstone_id, NULL);
+	if (k == mh_end(h))
+		return NULL;
+	return mh_i64ptr_node(h, k)->val;
+}
+
 /**
  * Allocate duplicate of the data of key_part_count
  * key_part_def objects. This function is required because the
@@ -1488,6 +1540,7 @@ vy_recovery_do_create_lsm(struct vy_recovery *recovery, int64_t id,
 	lsm->prepared = NULL;
 	rlist_create(&lsm->ranges);
 	rlist_create(&lsm->runs);
+	rlist_create(&lsm->range_tombstones);
 	/*
 	 * Keep newer LSM trees closer to the tail of the list
 	 * so that on log rotation we create/drop past incarnations
@@ -1660,10 +1713,11 @@ vy_recovery_forget_lsm(struct vy_recovery *recovery, int64_t id)
 		return -1;
 	}
 	struct vy_lsm_recovery_info *lsm = mh_i64ptr_node(h, k)->val;
-	if (!rlist_empty(&lsm->ranges) || !rlist_empty(&lsm->runs)) {
+	if (!rlist_empty(&lsm->ranges) || !rlist_empty(&lsm->runs) ||
+	    !rlist_empty(&lsm->range_tombstones)) {
 		diag_set(ClientError, ER_INVALID_VYLOG_FILE,
-			 tt_sprintf("Forgotten LSM tree %lld has ranges/runs",
-				    (long long)id));
+			 tt_sprintf("Forgotten LSM tree %lld has "
+				    "ranges/runs/tombstones", (long long)id));
 		return -1;
 	}
 	mh_i64ptr_del(h, k, NULL);
@@ -1721,6 +1775,7 @@ vy_recovery_do_create_run(struct vy_recovery *recovery, int64_t run_id)
 	run->dump_lsn = -1;
 	run->gc_lsn = -1;
 	run->dump_count = 0;
+	run->tombstone_lsn = 0;
 	run->is_incomplete = false;
 	run->is_dropped = false;
 	run->data = NULL;
@@ -1775,7 +1830,8 @@ vy_recovery_prepare_run(struct vy_recovery *recovery, int64_t lsm_id,
  */
 static int
 vy_recovery_create_run(struct vy_recovery *recovery, int64_t lsm_id,
-		       int64_t run_id, int64_t dump_lsn, uint32_t dump_count)
+		       int64_t run_id, int64_t dump_lsn, uint32_t dump_count,
+		       int64_t tombstone_lsn)
 {
 	struct vy_lsm_recovery_info *lsm;
 	lsm = vy_recovery_lookup_lsm(recovery, lsm_id);
@@ -1801,6 +1857,7 @@ vy_recovery_create_run(struct vy_recovery *recovery, int64_t lsm_id,
 	}
 	run->dump_lsn = dump_lsn;
 	run->dump_count = dump_count;
+	run->tombstone_lsn = tombstone_lsn;
 	run->is_incomplete = false;
 	rlist_move_entry(&lsm->runs, run, in_lsm);
 	return 0;
@@ -2075,6 +2132,105 @@ vy_recovery_delete_slice(struct vy_recovery *recovery, int64_t slice_id)
 	return 0;
 }
 
+/**
+ * Handle a VY_LOG_INSERT_RANGE_TOMBSTONE log record.
+ * This function allocates a new range tombstone with ID
+ * @tombstone_id, inserts it to the hash, and adds it to
+ * the list of tombstones of the LSM tree with ID @lsm_id.
+ * Return 0 on success, -1 on failure (ID collision or OOM).
+ */
+static int
+vy_recovery_insert_range_tombstone(struct vy_recovery *recovery,
+				   int64_t lsm_id, int64_t tombstone_id,
+				   const char *begin, const char *end,
+				   int64_t lsn)
+{
+	if (vy_recovery_lookup_range_tombstone(recovery,
+					       tombstone_id) != NULL) {
+		diag_set(ClientError, ER_INVALID_VYLOG_FILE,
+			 tt_sprintf("Duplicate range tombstone id %lld",
+				    (long long)tombstone_id));
+		return -1;
+	}
+	struct vy_lsm_recovery_info *lsm;
+	lsm = vy_recovery_lookup_lsm(recovery, lsm_id);
+	if (lsm == NULL) {
+		diag_set(ClientError, ER_INVALID_VYLOG_FILE,
+			 tt_sprintf("Range tombstone %lld created for "
+				    "unregistered LSM tree %lld",
+				    (long long)tombstone_id,
+				    (long long)lsm_id));
+		return -1;
+	}
+
+	size_t size = sizeof(struct vy_range_tombstone_recovery_info);
+	const char *data;
+	data = begin;
+	if (data != NULL)
+		mp_next(&data);
+	size_t begin_size = data - begin;
+	size += begin_size;
+	data = end;
+	if (data != NULL)
+		mp_next(&data);
+	size_t end_size = data - end;
+	size += end_size;
+
+	struct vy_range_tombstone_recovery_info *t = malloc(size);
+	if (t == NULL) {
+		diag_set(OutOfMemory, size, "malloc",
+			 "struct vy_range_tombstone_recovery_info");
+		return -1;
+	}
+	struct mh_i64ptr_t *h = recovery->tombstone_hash;
+	struct mh_i64ptr_node_t node = { tombstone_id, t };
+	if (mh_i64ptr_put(h, &node, NULL, NULL) == mh_end(h)) {
+		diag_set(OutOfMemory, 0, "mh_i64ptr_put", "mh_i64ptr_node_t");
+		free(t);
+		return -1;
+	}
+	t->id = tombstone_id;
+	t->lsn = lsn;
+	if (begin != NULL) {
+		t->begin = (void *)t + sizeof(*t);
+		memcpy(t->begin, begin, begin_size);
+	} else
+		t->begin = NULL;
+	if (end != NULL) {
+		t->end = (void *)t + sizeof(*t) + begin_size;
+		memcpy(t->end, end, end_size);
+	} else
+		t->end = NULL;
+	rlist_add_tail_entry(&lsm->range_tombstones, t, in_lsm);
+	if (recovery->max_id < tombstone_id)
+		recovery->max_id = tombstone_id;
+	return 0;
+}
+
+/**
+ * Handle a VY_LOG_DELETE_RANGE_TOMBSTONE log record.
+ * This function frees the range tombstone with ID @tombstone_id.
+ * Return 0 on success, -1 if the tombstone not found.
+ */
+static int
+vy_recovery_delete_range_tombstone(struct vy_recovery *recovery,
+				   int64_t tombstone_id)
+{
+	struct mh_i64ptr_t *h = recovery->tombstone_hash;
+	mh_int_t k = mh_i64ptr_find(h, tombstone_id, NULL);
+	if (k == mh_end(h)) {
+		diag_set(ClientError, ER_INVALID_VYLOG_FILE,
+			 tt_sprintf("Range tombstone %lld deleted but "
+				    "not registered", (long long)tombstone_id));
+		return -1;
+	}
+	struct vy_range_tombstone_recovery_info *t = mh_i64ptr_node(h, k)->val;
+	mh_i64ptr_del(h, k, NULL);
+	rlist_del_entry(t, in_lsm);
+	free(t);
+	return 0;
+}
+
 /**
  * Mark all LSM trees created during rebootstrap as dropped so
  * that they will be purged on the next garbage collection.
@@ -2163,7 +2319,8 @@ vy_recovery_process_record(struct vy_recovery *recovery,
 	case VY_LOG_CREATE_RUN:
 		rc = vy_recovery_create_run(recovery, record->lsm_id,
 					    record->run_id, record->dump_lsn,
-					    record->dump_count);
+					    record->dump_count,
+					    record->tombstone_lsn);
 		break;
 	case VY_LOG_DROP_RUN:
 		rc = vy_recovery_drop_run(recovery, record->run_id,
@@ -2194,6 +2351,16 @@ vy_recovery_process_record(struct vy_recovery *recovery,
 	case VY_LOG_ABORT_REBOOTSTRAP:
 		vy_recovery_abort_rebootstrap(recovery);
 		break;
+	case VY_LOG_INSERT_RANGE_TOMBSTONE:
+		rc = vy_recovery_insert_range_tombstone(recovery,
+				record->lsm_id, record->tombstone_id,
+				record->begin, record->end,
+				record->create_lsn);
+		break;
+	case VY_LOG_DELETE_RANGE_TOMBSTONE:
+		rc = vy_recovery_delete_range_tombstone(recovery,
+				record->tombstone_id);
+		break;
 	default:
 		unreachable();
 	}
@@ -2314,6 +2481,7 @@ vy_recovery_new_f(va_list ap)
 	recovery->range_hash = NULL;
 	recovery->run_hash = NULL;
 	recovery->slice_hash = NULL;
+	recovery->tombstone_hash = NULL;
 	recovery->max_id = -1;
 	recovery->in_rebootstrap = false;
 
@@ -2322,11 +2490,13 @@ vy_recovery_new_f(va_list ap)
 	recovery->range_hash = mh_i64ptr_new();
 	recovery->run_hash = mh_i64ptr_new();
 	recovery->slice_hash = mh_i64ptr_new();
+	recovery->tombstone_hash = mh_i64ptr_new();
 	if (recovery->index_id_hash == NULL ||
 	    recovery->lsm_hash == NULL ||
 	    recovery->range_hash == NULL ||
 	    recovery->run_hash == NULL ||
-	    recovery->slice_hash == NULL) {
+	    recovery->slice_hash == NULL ||
+	    recovery->tombstone_hash == NULL) {
 		diag_set(OutOfMemory, 0, "mh_i64ptr_new", "mh_i64ptr_t");
 		goto fail_free;
 	}
@@ -2441,6 +2611,7 @@ vy_recovery_delete(struct vy_recovery *recovery)
 	struct vy_range_recovery_info *range, *next_range;
 	struct vy_slice_recovery_info *slice, *next_slice;
 	struct vy_run_recovery_info *run, *next_run;
+	struct vy_range_tombstone_recovery_info *t, *next_t;
 
 	rlist_foreach_entry_safe(lsm, &recovery->lsms, in_recovery, next_lsm) {
 		rlist_foreach_entry_safe(range, &lsm->ranges,
@@ -2452,6 +2623,9 @@ vy_recovery_delete(struct vy_recovery *recovery)
 		}
 		rlist_foreach_entry_safe(run, &lsm->runs, in_lsm, next_run)
 			free(run);
+		rlist_foreach_entry_safe(t, &lsm->range_tombstones,
+					 in_lsm, next_t)
+			free(t);
 		free(lsm->key_parts);
 		free(lsm);
 	}
@@ -2465,6 +2639,8 @@ vy_recovery_delete(struct vy_recovery *recovery)
 		mh_i64ptr_delete(recovery->run_hash);
 	if (recovery->slice_hash != NULL)
 		mh_i64ptr_delete(recovery->slice_hash);
+	if (recovery->tombstone_hash != NULL)
+		mh_i64ptr_delete(recovery->tombstone_hash);
 	TRASH(recovery);
 	free(recovery);
 }
@@ -2490,6 +2666,7 @@ vy_log_append_lsm(struct xlog *xlog, struct vy_lsm_recovery_info *lsm)
 	struct vy_range_recovery_info *range;
 	struct vy_slice_recovery_info *slice;
 	struct vy_run_recovery_info *run;
+	struct vy_range_tombstone_recovery_info *t;
 	struct vy_log_record record;
 
 	vy_log_record_init(&record);
@@ -2515,6 +2692,7 @@ vy_log_append_lsm(struct xlog *xlog, struct vy_lsm_recovery_info *lsm)
 			record.type = VY_LOG_CREATE_RUN;
 			record.dump_lsn = run->dump_lsn;
 			record.dump_count = run->dump_count;
+			record.tombstone_lsn = run->tombstone_lsn;
 		}
 		record.lsm_id = lsm->id;
 		record.run_id = run->id;
@@ -2559,6 +2737,18 @@ vy_log_append_lsm(struct xlog *xlog, struct vy_lsm_recovery_info *lsm)
 		}
 	}
 
+	rlist_foreach_entry(t, &lsm->range_tombstones, in_lsm) {
+		vy_log_record_init(&record);
+		record.type = VY_LOG_INSERT_RANGE_TOMBSTONE;
+		record.lsm_id = lsm->id;
+		record.tombstone_id = t->id;
+		record.begin = t->begin;
+		record.end = t->end;
+		record.create_lsn = t->lsn;
+		if (vy_log_append_record(xlog, &record) != 0)
+			return -1;
+	}
+
 	if (lsm->drop_lsn >= 0) {
 		vy_log_record_init(&record);
 		record.type = VY_LOG_DROP_LSM;
@@ -97,6 +97,7 @@ enum vy_log_record_type {
 	/**
 	 * Commit a vinyl run file creation.
 	 * Requires vy_log_record::lsm_id, run_id, dump_lsn, dump_count.
+	 * Optionally stores vy_log_record::tombstone_lsn.
 	 *
 	 * Written after a run file was successfully created.
 	 */
@@ -217,6 +218,24 @@ enum vy_log_record_type {
 	 * See also VY_LOG_REBOOTSTRAP.
 	 */
 	VY_LOG_ABORT_REBOOTSTRAP	= 17,
+	/**
+	 * Insert a range tombstone into an LSM tree.
+	 * Requires vy_log_record::lsm_id, tombstone_id, begin, end,
+	 * create_lsn.
+	 *
+	 * A record of this type is written when the in-memory tree
+	 * a range tombstone was written to is dumped.
+	 */
+	VY_LOG_INSERT_RANGE_TOMBSTONE	= 18,
+	/**
+	 * Delete a range tombstone.
+	 * Requires vy_log_record::tombstone_id.
+	 *
+	 * A record of this type is written when there are no more
+	 * run slices that may store statements deleted by the
+	 * tombstone.
+	 */
+	VY_LOG_DELETE_RANGE_TOMBSTONE	= 19,
 
 	vy_log_record_type_MAX
 };
@@ -243,14 +262,16 @@ struct vy_log_record {
 	int64_t run_id;
 	/** Unique ID of the run slice. */
 	int64_t slice_id;
+	/** Unique ID of the range tombstone. */
+	int64_t tombstone_id;
 	/**
-	 * Msgpack key for start of the range/slice.
-	 * NULL if the range/slice starts from -inf.
+	 * Msgpack key for start of the range/slice/tombstone.
+	 * NULL if the range/slice/tombstone starts from -inf.
 	 */
 	const char *begin;
 	/**
-	 * Msgpack key for end of the range/slice.
-	 * NULL if the range/slice ends with +inf.
+	 * Msgpack key for end of the range/slice/tombstone.
+	 * NULL if the range/slice/tombstone ends with +inf.
 	 */
 	const char *end;
 	/** Ordinal index number in the space. */
@@ -265,7 +286,10 @@ struct vy_log_record {
 	struct key_part_def *key_parts;
 	/** Number of key parts. */
 	uint32_t key_part_count;
-	/** LSN of the WAL row that created the LSM tree. */
+	/**
+	 * LSN of the WAL row that created the LSM tree or
+	 * the range tombstone.
+	 */
 	int64_t create_lsn;
 	/** LSN of the WAL row that last modified the LSM tree. */
 	int64_t modify_lsn;
@@ -283,6 +307,11 @@ struct vy_log_record {
 	int64_t gc_lsn;
 	/** For runs: number of dumps it took to create the run. */
 	uint32_t dump_count;
+	/**
+	 * For runs: max LSN of range tombstones applied to the run,
+	 * see vy_run::applied_tombstone_lsn.
+	 */
+	int64_t tombstone_lsn;
 	/** Link in vy_log_tx::records. */
 	struct stailq_entry in_tx;
 };
@@ -304,6 +333,8 @@ struct vy_recovery {
 	struct mh_i64ptr_t *run_hash;
 	/** ID -> vy_slice_recovery_info. */
 	struct mh_i64ptr_t *slice_hash;
+	/** ID -> vy_range_tombstone_recovery_info. */
+	struct mh_i64ptr_t *tombstone_hash;
 	/**
 	 * Maximal vinyl object ID, according to the metadata log,
 	 * or -1 in case no vinyl objects were recovered.
@@ -360,6 +391,12 @@ struct vy_lsm_recovery_info {
 	 * vy_run_recovery_info::in_lsm.
 	 */
 	struct rlist runs;
+	/**
+	 * List of all range tombstones of the LSM tree, linked
+	 * by vy_range_tombstone_recovery_info::in_lsm. Older
+	 * tombstones are closer to the head.
+	 */
+	struct rlist range_tombstones;
 	/**
 	 * Pointer to an LSM tree that is going to replace
 	 * this one after successful ALTER.
@@ -403,6 +440,8 @@ struct vy_run_recovery_info {
 	int64_t gc_lsn;
 	/** Number of dumps it took to create the run. */
 	uint32_t dump_count;
+	/** Max LSN of range tombstones applied to the run. */
+	int64_t tombstone_lsn;
 	/**
 	 * True if the run was not committed (there's
 	 * VY_LOG_PREPARE_RUN, but no VY_LOG_CREATE_RUN).
@@ -435,6 +474,26 @@ struct vy_slice_recovery_info {
 	char *end;
 };
 
+/** Range tombstone info stored in a recovery context. */
+struct vy_range_tombstone_recovery_info {
+	/** Link in vy_lsm_recovery_info::range_tombstones. */
+	struct rlist in_lsm;
+	/** ID of the tombstone. */
+	int64_t id;
+	/** LSN of the tombstone. */
+	int64_t lsn;
+	/**
+	 * Start of the deleted interval, stored in MsgPack
+	 * array, or NULL if it starts from -inf.
+	 */
+	char *begin;
+	/**
+	 * End of the deleted interval, stored in MsgPack
+	 * array, or NULL if it ends with +inf.
+	 */
+	char *end;
+};
+
 /**
  * Initialize the metadata log.
  * @dir is the directory where log files are stored.
@@ -726,8 +785,8 @@ vy_log_prepare_run(int64_t lsm_id, int64_t run_id)
 
 /** Helper to log a vinyl run creation. */
 static inline void
-vy_log_create_run(int64_t lsm_id, int64_t run_id,
-		  int64_t dump_lsn, uint32_t dump_count)
+vy_log_create_run(int64_t lsm_id, int64_t run_id, int64_t dump_lsn,
+		  uint32_t dump_count, int64_t tombstone_lsn)
 {
 	struct vy_log_record record;
 	vy_log_record_init(&record);
@@ -736,6 +795,7 @@ vy_log_create_run(int64_t lsm_id, int64_t run_id,
 	record.run_id = run_id;
 	record.dump_lsn = dump_lsn;
 	record.dump_count = dump_count;
+	record.tombstone_lsn = tombstone_lsn;
 	vy_log_write(&record);
 }
 
@@ -801,6 +861,34 @@ vy_log_dump_lsm(int64_t id, int64_t dump_lsn)
 	vy_log_write(&record);
 }
 
+/** Helper to log a range tombstone insertion. */
+static inline void
+vy_log_insert_range_tombstone(int64_t lsm_id, int64_t tombstone_id,
+			      const char *begin, const char *end,
+			      int64_t lsn)
+{
+	struct vy_log_record record;
+	vy_log_record_init(&record);
+	record.type = VY_LOG_INSERT_RANGE_TOMBSTONE;
+	record.lsm_id = lsm_id;
+	record.tombstone_id = tombstone_id;
+	record.begin = begin;
+	record.end = end;
+	record.create_lsn = lsn;
+	vy_log_write(&record);
+}
+
+/** Helper to log a range tombstone deletion. */
+static inline void
+vy_log_delete_range_tombstone(int64_t tombstone_id)
+{
+	struct vy_log_record record;
+	vy_log_record_init(&record);
+	record.type = VY_LOG_DELETE_RANGE_TOMBSTONE;
+	record.tombstone_id = tombstone_id;
+	vy_log_write(&record);
+}
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
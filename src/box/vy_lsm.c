@@ -49,6 +49,7 @@
 #include "vy_log.h"
 #include "vy_mem.h"
 #include "vy_range.h"
+#include "vy_range_tombstone.h"
 #include "vy_run.h"
 #include "vy_stat.h"
 #include "vy_stmt.h"
@@ -196,6 +197,8 @@ vy_lsm_new(struct vy_lsm_env *lsm_env, struct vy_cache_env *cache_env,
 	vy_range_tree_new(&lsm->range_tree);
 	vy_range_heap_create(&lsm->range_heap);
 	rlist_create(&lsm->runs);
+	rlist_create(&lsm->in_value_gc);
+	rlist_create(&lsm->range_tombstones);
 	lsm->pk = pk;
 	if (pk != NULL)
 		vy_lsm_ref(pk);
@@ -271,6 +274,10 @@ vy_lsm_delete(struct vy_lsm *lsm)
 	rlist_foreach_entry_safe(run, &lsm->runs, in_lsm, next_run)
 		vy_lsm_remove_run(lsm, run);
 
+	struct vy_range_tombstone *t, *next_t;
+	rlist_foreach_entry_safe(t, &lsm->range_tombstones, in_lsm, next_t)
+		vy_lsm_remove_range_tombstone(lsm, t);
+
 	vy_range_tree_iter(&lsm->range_tree, NULL, vy_range_tree_free_cb, NULL);
 	vy_range_heap_destroy(&lsm->range_heap);
 	tuple_format_unref(lsm->disk_format);
@@ -367,6 +374,7 @@ vy_lsm_recover_run(struct vy_lsm *lsm, struct vy_run_recovery_info *run_info,
 
 	run->dump_lsn = run_info->dump_lsn;
 	run->dump_count = run_info->dump_count;
+	run->applied_tombstone_lsn = run_info->tombstone_lsn;
 	if (vy_run_recover(run, lsm->env->path, lsm->space_id, lsm->index_id,
 			   lsm->cmp_def) != 0 &&
 	    (!force_recovery ||
@@ -442,6 +450,22 @@ out:
 	return slice;
 }
 
+/** Return true if the given slice spans the whole range. */
+static bool
+vy_lsm_slice_spans_range(struct vy_slice *slice, struct vy_range *range,
+			 struct key_def *cmp_def)
+{
+	if (slice->begin.stmt != NULL &&
+	    (range->begin.stmt == NULL ||
+	     vy_entry_compare(slice->begin, range->begin, cmp_def) > 0))
+		return false;
+	if (slice->end.stmt != NULL &&
+	    (range->end.stmt == NULL ||
+	     vy_entry_compare(slice->end, range->end, cmp_def) < 0))
+		return false;
+	return true;
+}
+
 static struct vy_range *
 vy_lsm_recover_range(struct vy_lsm *lsm,
 		     struct vy_range_recovery_info *range_info,
@@ -484,12 +508,25 @@ vy_lsm_recover_range(struct vy_lsm *lsm,
 	 */
 	struct vy_slice_recovery_info *slice_info;
 	rlist_foreach_entry_reverse(slice_info, &range_info->slices, in_range) {
-		if (vy_lsm_recover_slice(lsm, range, slice_info,
-					 run_env, force_recovery) == NULL) {
+		struct vy_slice *slice = vy_lsm_recover_slice(lsm, range,
+					slice_info, run_env, force_recovery);
+		if (slice == NULL) {
 			vy_range_delete(range);
 			range = NULL;
 			goto out;
 		}
+		/*
+		 * A run created by major compaction of this range
+		 * or of a range it was split from spans the whole
+		 * range. Restore range tombstones applied to it.
+		 * Slices of coalesced ranges are ignored, which is
+		 * safe: tombstones will just be kept longer.
+		 */
+		if (vy_lsm_slice_spans_range(slice, range, lsm->cmp_def)) {
+			range->applied_tombstone_lsn =
+				MAX(range->applied_tombstone_lsn,
+				    slice->run->applied_tombstone_lsn);
+		}
 	}
 	vy_lsm_add_range(lsm, range);
 out:
@@ -684,6 +721,27 @@ vy_lsm_recover(struct vy_lsm *lsm, struct vy_recovery *recovery,
 				    (long long)prev->id));
 		return -1;
 	}
+
+	/*
+	 * Restore range tombstones. Whether a range needs to be
+	 * compacted isn't persisted so force compaction of ranges
+	 * that may still store statements covered by tombstones,
+	 * i.e. that haven't applied them yet.
+	 */
+	struct vy_range_tombstone_recovery_info *tombstone_info;
+	rlist_foreach_entry(tombstone_info, &lsm_info->range_tombstones,
+			    in_lsm) {
+		struct vy_range_tombstone *t;
+		t = vy_range_tombstone_new(tombstone_info->id,
+					   lsm->env->key_format, lsm->cmp_def,
+					   tombstone_info->begin,
+					   tombstone_info->end,
+					   tombstone_info->lsn);
+		if (t == NULL)
+			return -1;
+		vy_lsm_add_range_tombstone(lsm, t);
+		vy_lsm_force_compaction_range_tombstone(lsm, t);
+	}
 	return 0;
 }
 
@@ -1006,11 +1064,13 @@ vy_lsm_commit_upsert(struct vy_lsm *lsm, struct vy_mem *mem,
 
 	/*
 	 * If there are no other mems and runs and n_upserts == 0,
-	 * then we can turn the UPSERT into the REPLACE.
+	 * then we can turn the UPSERT into the REPLACE. Range
+	 * tombstones aren't stored in the memory tree so we can't
+	 * do that if there are any.
 	 */
 	if (n_upserts == 0 &&
 	    lsm->stat.memory.count.rows == lsm->mem->count.rows &&
-	    lsm->run_count == 0) {
+	    lsm->run_count == 0 && rlist_empty(&lsm->range_tombstones)) {
 		older = vy_mem_older_lsn(mem, entry);
 		assert(older.stmt == NULL ||
 		       vy_stmt_type(older.stmt) != IPROTO_UPSERT);
@@ -1117,32 +1177,45 @@ vy_lsm_find_range_intersection(struct vy_lsm *lsm,
 	return 0;
 }
 
-bool
-vy_lsm_split_range(struct vy_lsm *lsm, struct vy_range *range)
+/**
+ * Split a range by the given keys, which must be sorted in
+ * ascending order and lie strictly inside the range.
+ * Return true on success.
+ */
+static bool
+vy_lsm_split_range_by_keys(struct vy_lsm *lsm, struct vy_range *range,
+			   const char **split_keys_raw, int split_key_count)
 {
 	struct tuple_format *key_format = lsm->env->key_format;
 
-	const char *split_key_raw;
-	if (!vy_range_needs_split(range, vy_lsm_range_size(lsm),
-				  &split_key_raw))
-		return false;
-
-	/* Split a range in two parts. */
-	const int n_parts = 2;
-	struct vy_range *parts[2] = { NULL, NULL };
+	/* Split a range in split_key_count + 1 parts. */
+	const int n_parts = split_key_count + 1;
+	struct vy_range **parts;
+	struct vy_entry *keys;
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	parts = region_alloc(region, sizeof(*parts) * n_parts);
+	keys = region_alloc(region, sizeof(*keys) * (n_parts + 1));
+	if (parts == NULL || keys == NULL) {
+		diag_set(OutOfMemory, sizeof(*parts) * n_parts +
+			 sizeof(*keys) * (n_parts + 1), "region", "range split");
+		region_truncate(region, region_svp);
+		goto fail_log;
+	}
+	memset(parts, 0, sizeof(*parts) * n_parts);
+	memset(keys, 0, sizeof(*keys) * (n_parts + 1));
 	/*
 	 * Determine new ranges' boundaries.
 	 */
-	struct vy_entry split_key;
-	split_key = vy_entry_key_from_msgpack(key_format, lsm->cmp_def,
-					      split_key_raw);
-	if (split_key.stmt == NULL)
-		goto fail;
-
-	struct vy_entry keys[3];
 	keys[0] = range->begin;
-	keys[1] = split_key;
-	keys[2] = range->end;
+	keys[n_parts] = range->end;
+	for (int i = 0; i < split_key_count; i++) {
+		keys[i + 1] = vy_entry_key_from_msgpack(key_format,
+							lsm->cmp_def,
+							split_keys_raw[i]);
+		if (keys[i + 1].stmt == NULL)
+			goto fail;
+	}
 
 	/*
 	 * Allocate new ranges and create slices of
@@ -1170,6 +1243,9 @@ vy_lsm_split_range(struct vy_lsm *lsm, struct vy_range *range)
 				vy_range_add_slice(part, new_slice);
 		}
 		part->needs_compaction = range->needs_compaction;
+		part->needs_value_gc = range->needs_value_gc;
+		part->needs_tombstone_gc = range->needs_tombstone_gc;
+		part->applied_tombstone_lsn = range->applied_tombstone_lsn;
 		vy_range_update_compaction_priority(part, &lsm->opts);
 		vy_range_update_dumps_per_compaction(part);
 	}
@@ -1207,28 +1283,73 @@ vy_lsm_split_range(struct vy_lsm *lsm, struct vy_range *range)
 	}
 	lsm->range_tree_version++;
 
-	say_info("%s: split range %s by key %s", vy_lsm_name(lsm),
-		 vy_range_str(range), tuple_str(split_key.stmt));
+	for (int i = 0; i < split_key_count; i++) {
+		say_info("%s: split range %s by key %s", vy_lsm_name(lsm),
+			 vy_range_str(range), tuple_str(keys[i + 1].stmt));
+	}
 
 	rlist_foreach_entry(slice, &range->slices, in_range)
 		vy_slice_wait_pinned(slice);
 	vy_range_delete(range);
-	tuple_unref(split_key.stmt);
+	for (int i = 0; i < split_key_count; i++)
+		tuple_unref(keys[i + 1].stmt);
+	region_truncate(region, region_svp);
 	return true;
 fail:
 	for (int i = 0; i < n_parts; i++) {
 		if (parts[i] != NULL)
 			vy_range_delete(parts[i]);
 	}
-	if (split_key.stmt != NULL)
-		tuple_unref(split_key.stmt);
-
+	for (int i = 0; i < split_key_count; i++) {
+		if (keys[i + 1].stmt != NULL)
+			tuple_unref(keys[i + 1].stmt);
+	}
+	region_truncate(region, region_svp);
+fail_log:
 	diag_log();
 	say_error("%s: failed to split range %s",
 		  vy_lsm_name(lsm), vy_range_str(range));
 	return false;
 }
 
+bool
+vy_lsm_split_range(struct vy_lsm *lsm, struct vy_range *range)
+{
+	const char *split_key_raw;
+	if (!vy_range_needs_split(range, vy_lsm_range_size(lsm),
+				  &split_key_raw))
+		return false;
+	return vy_lsm_split_range_by_keys(lsm, range, &split_key_raw, 1);
+}
+
+bool
+vy_lsm_split_range_for_compaction(struct vy_lsm *lsm, struct vy_range *range,
+				  int max_parts)
+{
+	if (max_parts < 2)
+		return false;
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	size_t size = sizeof(const char *) * (max_parts - 1);
+	const char **split_keys_raw = region_alloc(region, size);
+	if (split_keys_raw == NULL) {
+		diag_set(OutOfMemory, size, "region", "split keys");
+		diag_log();
+		return false;
+	}
+	bool is_split = false;
+	int split_key_count = vy_range_needs_compaction_split(range,
+				vy_lsm_range_size(lsm), max_parts,
+				split_keys_raw);
+	if (split_key_count > 0) {
+		is_split = vy_lsm_split_range_by_keys(lsm, range,
+						      split_keys_raw,
+						      split_key_count);
+	}
+	region_truncate(region, region_svp);
+	return is_split;
+}
+
 bool
 vy_lsm_coalesce_range(struct vy_lsm *lsm, struct vy_range *range)
 {
@@ -1244,6 +1365,7 @@ vy_lsm_coalesce_range(struct vy_lsm *lsm, struct vy_range *range)
 
 	struct vy_range *it;
 	struct vy_range *end = vy_range_tree_next(&lsm->range_tree, last);
+	result->applied_tombstone_lsn = INT64_MAX;
 
 	/*
 	 * Log change in metadata.
@@ -1281,6 +1403,12 @@ vy_lsm_coalesce_range(struct vy_lsm *lsm, struct vy_range *range)
 		vy_disk_stmt_counter_add(&result->count, &it->count);
 		if (it->needs_compaction)
 			result->needs_compaction = true;
+		if (it->needs_value_gc)
+			result->needs_value_gc = true;
+		if (it->needs_tombstone_gc)
+			result->needs_tombstone_gc = true;
+		result->applied_tombstone_lsn = MIN(result->applied_tombstone_lsn,
+						    it->applied_tombstone_lsn);
 		vy_range_delete(it);
 		it = next;
 	}
@@ -1308,6 +1436,106 @@ fail_range:
 	return false;
 }
 
+int64_t
+vy_lsm_range_tombstone_lsn(struct vy_lsm *lsm, struct vy_entry entry,
+			   int64_t vlsn)
+{
+	struct vy_range_tombstone *t;
+	rlist_foreach_entry(t, &lsm->range_tombstones, in_lsm) {
+		/*
+		 * Tombstones are sorted by LSN in descending order
+		 * so the first match is the newest one.
+		 */
+		if (t->lsn <= vlsn &&
+		    vy_range_tombstone_covers(t, entry, lsm->cmp_def))
+			return t->lsn;
+	}
+	return -1;
+}
+
+bool
+vy_lsm_mem_has_range_tombstones(struct vy_lsm *lsm, struct vy_mem *mem)
+{
+	struct vy_range_tombstone *t;
+	rlist_foreach_entry(t, &lsm->range_tombstones, in_lsm) {
+		if (t->mem == mem)
+			return true;
+	}
+	return false;
+}
+
+void
+vy_lsm_add_range_tombstone(struct vy_lsm *lsm, struct vy_range_tombstone *t)
+{
+	assert(lsm->index_id == 0);
+	assert(rlist_empty(&t->in_lsm));
+	/* Keep the list sorted by LSN in descending order. */
+	struct rlist *prev = &lsm->range_tombstones;
+	struct vy_range_tombstone *it;
+	rlist_foreach_entry(it, &lsm->range_tombstones, in_lsm) {
+		if (it->lsn < t->lsn)
+			break;
+		prev = &it->in_lsm;
+	}
+	rlist_add(prev, &t->in_lsm);
+}
+
+void
+vy_lsm_remove_range_tombstone(struct vy_lsm *lsm,
+			      struct vy_range_tombstone *t)
+{
+	(void)lsm;
+	rlist_del_entry(t, in_lsm);
+	vy_range_tombstone_unref(t);
+}
+
+bool
+vy_lsm_range_tombstone_is_obsolete(struct vy_lsm *lsm,
+				   struct vy_range_tombstone *t)
+{
+	if (t->mem != NULL)
+		return false;
+	struct vy_range *range;
+	struct vy_range_tree_iterator it;
+	vy_range_tree_ifirst(&lsm->range_tree, &it);
+	while ((range = vy_range_tree_inext(&it)) != NULL) {
+		if (!vy_range_tombstone_intersects(t, range->begin,
+						   range->end, lsm->cmp_def))
+			continue;
+		if (range->applied_tombstone_lsn >= t->lsn)
+			continue;
+		struct vy_slice *slice;
+		rlist_foreach_entry(slice, &range->slices, in_range) {
+			if (slice->run->info.min_lsn < t->lsn)
+				return false;
+		}
+	}
+	return true;
+}
+
+void
+vy_lsm_force_compaction_range_tombstone(struct vy_lsm *lsm,
+					struct vy_range_tombstone *t)
+{
+	struct vy_range *range;
+	struct vy_range_tree_iterator it;
+
+	vy_range_tree_ifirst(&lsm->range_tree, &it);
+	while ((range = vy_range_tree_inext(&it)) != NULL) {
+		if (!vy_range_tombstone_intersects(t, range->begin,
+						   range->end, lsm->cmp_def))
+			continue;
+		if (range->applied_tombstone_lsn >= t->lsn)
+			continue;
+		vy_lsm_unacct_range(lsm, range);
+		range->needs_tombstone_gc = true;
+		vy_range_update_compaction_priority(range, &lsm->opts);
+		vy_lsm_acct_range(lsm, range);
+	}
+
+	vy_range_heap_update_all(&lsm->range_heap);
+}
+
 void
 vy_lsm_force_compaction(struct vy_lsm *lsm)
 {
@@ -1324,3 +1552,77 @@ vy_lsm_force_compaction(struct vy_lsm *lsm)
 
 	vy_range_heap_update_all(&lsm->range_heap);
 }
+
+uint64_t
+vy_lsm_value_file_ref_size(struct vy_lsm *lsm, int64_t id)
+{
+	uint64_t ref_size = 0;
+	struct vy_run *run;
+	rlist_foreach_entry(run, &lsm->runs, in_lsm) {
+		for (uint32_t i = 0; i < run->info.value_file_count; i++) {
+			struct vy_value_file_info *file =
+						&run->info.value_files[i];
+			if (file->id == id)
+				ref_size += file->ref_size;
+		}
+	}
+	return ref_size;
+}
+
+bool
+vy_lsm_value_file_is_garbage(struct vy_lsm *lsm,
+			     const struct vy_value_file_info *file)
+{
+	return vy_lsm_value_file_ref_size(lsm, file->id) < file->size / 2;
+}
+
+/** Return true if a slice of the range refers to the value file. */
+static bool
+vy_range_refers_to_value_file(struct vy_range *range, int64_t id)
+{
+	struct vy_slice *slice;
+	rlist_foreach_entry(slice, &range->slices, in_range) {
+		struct vy_run *run = slice->run;
+		for (uint32_t i = 0; i < run->info.value_file_count; i++) {
+			if (run->info.value_files[i].id == id)
+				return true;
+		}
+	}
+	return false;
+}
+
+bool
+vy_lsm_schedule_value_gc(struct vy_lsm *lsm)
+{
+	struct vy_run *run;
+	rlist_foreach_entry(run, &lsm->runs, in_lsm) {
+		for (uint32_t i = 0; i < run->info.value_file_count; i++) {
+			struct vy_value_file_info *file =
+						&run->info.value_files[i];
+			if (!vy_lsm_value_file_is_garbage(lsm, file))
+				continue;
+			struct vy_range *range;
+			struct vy_range_tree_iterator it;
+			vy_range_tree_ifirst(&lsm->range_tree, &it);
+			while ((range = vy_range_tree_inext(&it)) != NULL) {
+				if (range->needs_value_gc ||
+				    vy_range_is_scheduled(range) ||
+				    !vy_range_refers_to_value_file(range,
+								   file->id))
+					continue;
+				vy_lsm_unacct_range(lsm, range);
+				range->needs_value_gc = true;
+				vy_range_update_compaction_priority(range,
+								    &lsm->opts);
+				vy_lsm_acct_range(lsm, range);
+				vy_range_heap_update(&lsm->range_heap, range);
+				say_info("%s: scheduled value log GC of "
+					 "range %s, file %lld", vy_lsm_name(lsm),
+					 vy_range_str(range),
+					 (long long)file->id);
+				return true;
+			}
+		}
+	}
+	return false;
+}
@@ -57,9 +57,11 @@ struct tuple_format;
 struct vy_lsm;
 struct vy_mem;
 struct vy_mem_env;
+struct vy_range_tombstone;
 struct vy_recovery;
 struct vy_run;
 struct vy_run_env;
+struct vy_value_file_info;
 
 typedef void
 (*vy_upsert_thresh_cb)(struct vy_lsm *lsm, struct vy_entry entry, void *arg);
@@ -257,6 +259,13 @@ struct vy_lsm {
 	struct rlist runs;
 	/** Number of entries in all ranges. */
 	int run_count;
+	/**
+	 * List of range tombstones written to this LSM tree,
+	 * linked by vy_range_tombstone->in_lsm. The newer a
+	 * tombstone, the closer it to the list head. Only
+	 * a primary index may have range tombstones.
+	 */
+	struct rlist range_tombstones;
 	/**
 	 * Histogram accounting how many ranges of the LSM tree
 	 * have a particular number of runs.
@@ -305,6 +314,8 @@ struct vy_lsm {
 	struct heap_node in_dump;
 	/** Link in vy_scheduler->compaction_heap. */
 	struct heap_node in_compaction;
+	/** Link in vy_scheduler->value_gc_queue. */
+	struct rlist in_value_gc;
 	/**
 	 * Interval tree containing reads from this LSM tree done by
 	 * all active transactions. Linked by vy_tx_interval->in_lsm.
@@ -561,6 +572,17 @@ vy_lsm_find_range_intersection(struct vy_lsm *lsm,
 bool
 vy_lsm_split_range(struct vy_lsm *lsm, struct vy_range *range);
 
+/**
+ * Split a range scheduled for major compaction in up to @max_parts
+ * parts if it is big enough, return true if the range was split.
+ * The parts are then compacted independently so the compaction can
+ * be spread among several worker threads. Like vy_lsm_split_range(),
+ * this only affects metadata and is done immediately.
+ */
+bool
+vy_lsm_split_range_for_compaction(struct vy_lsm *lsm, struct vy_range *range,
+				  int max_parts);
+
 /**
  * Coalesce a range with one or more its neighbors if it is too small,
  * return true if the range was coalesced. We coalesce ranges by
@@ -580,6 +602,34 @@ vy_lsm_coalesce_range(struct vy_lsm *lsm, struct vy_range *range);
 void
 vy_lsm_force_compaction(struct vy_lsm *lsm);
 
+/**
+ * Return the size of values stored in the value file with
+ * the given ID that are referenced by runs of an LSM tree,
+ * see vy_value_log.h.
+ */
+uint64_t
+vy_lsm_value_file_ref_size(struct vy_lsm *lsm, int64_t id);
+
+/**
+ * Return true if less than a half of the given value file
+ * is referenced by runs of an LSM tree so that it should be
+ * rewritten rather than linked to the output of compaction.
+ */
+bool
+vy_lsm_value_file_is_garbage(struct vy_lsm *lsm,
+			     const struct vy_value_file_info *file);
+
+/**
+ * Look for a value file that is mostly garbage and mark a range
+ * referring to it for compaction so that the values that are
+ * still in use are moved to a new file, see vy_range::needs_value_gc.
+ * Returns true if a range was marked, false if there's nothing to
+ * collect or all ranges referring to garbage are already marked
+ * or being compacted.
+ */
+bool
+vy_lsm_schedule_value_gc(struct vy_lsm *lsm);
+
 /**
  * Insert a statement into the in-memory index of an LSM tree. If
  * the region_stmt is NULL and the statement is successfully inserted
@@ -623,6 +673,57 @@ void
 vy_lsm_rollback_stmt(struct vy_lsm *lsm, struct vy_mem *mem,
 		     struct vy_entry entry);
 
+/**
+ * Return LSN of the newest range tombstone of an LSM tree
+ * that covers the given key and is visible from a read view,
+ * i.e. has LSN <= @a vlsn, or -1 if there's no such tombstone.
+ */
+int64_t
+vy_lsm_range_tombstone_lsn(struct vy_lsm *lsm, struct vy_entry entry,
+			   int64_t vlsn);
+
+/**
+ * Return true if an in-memory tree of an LSM tree stores
+ * range tombstones that haven't been dumped yet.
+ */
+bool
+vy_lsm_mem_has_range_tombstones(struct vy_lsm *lsm, struct vy_mem *mem);
+
+/**
+ * Add a range tombstone to an LSM tree. The LSM tree takes
+ * the reference to the tombstone.
+ */
+void
+vy_lsm_add_range_tombstone(struct vy_lsm *lsm, struct vy_range_tombstone *t);
+
+/**
+ * Remove a range tombstone from an LSM tree and drop
+ * the reference the LSM tree holds.
+ */
+void
+vy_lsm_remove_range_tombstone(struct vy_lsm *lsm,
+			      struct vy_range_tombstone *t);
+
+/**
+ * Return true if a range tombstone of an LSM tree may be
+ * dropped, because it has been dumped and each range it
+ * intersects either has been compacted with the tombstone
+ * applied (see vy_range::applied_tombstone_lsn) or has no
+ * run slices that may store statements covered by it.
+ */
+bool
+vy_lsm_range_tombstone_is_obsolete(struct vy_lsm *lsm,
+				   struct vy_range_tombstone *t);
+
+/**
+ * Force compaction of all ranges intersecting the given
+ * range tombstone that haven't applied it yet so that the
+ * space occupied by statements covered by it is reclaimed.
+ */
+void
+vy_lsm_force_compaction_range_tombstone(struct vy_lsm *lsm,
+					struct vy_range_tombstone *t);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* defined(__cplusplus) */
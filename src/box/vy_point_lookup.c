@@ -38,6 +38,7 @@
 #include <small/rlist.h>
 
 #include "fiber.h"
+#include "fiber_cond.h"
 
 #include "vy_lsm.h"
 #include "vy_stmt.h"
@@ -153,6 +154,211 @@ vy_point_lookup_scan_slice(struct vy_lsm *lsm, struct vy_slice *slice,
 	return rc;
 }
 
+/**
+ * State of a point lookup that reads slices in parallel.
+ * See vy_point_lookup_read_slices().
+ */
+struct vy_point_lookup_reader {
+	struct vy_lsm *lsm;
+	const struct vy_read_view **rv;
+	struct vy_entry key;
+	/** Slices to read, newest first. */
+	struct vy_slice **slices;
+	/** Number of slices to read. */
+	int slice_count;
+	/** History read from each slice. */
+	struct vy_history *histories;
+	/** Return code of reading each slice. */
+	int *rcs;
+	/** Error that occurred while reading each slice. */
+	struct diag *diags;
+	/**
+	 * Position of the newest slice that was found to store
+	 * a terminal statement for the key. Older slices needn't
+	 * be read, because their statements are overwritten.
+	 */
+	int terminal_pos;
+	/** Number of slice reads in progress. */
+	int read_count;
+	/** Max number of slice reads that may be in progress. */
+	int read_count_max;
+	/** Signaled when a slice read completes. */
+	struct fiber_cond cond;
+};
+
+/** Return true if a slice may store statements for a key. */
+static bool
+vy_point_lookup_slice_maybe_has(struct vy_lsm *lsm, struct vy_slice *slice,
+				struct vy_entry key)
+{
+	struct tuple_bloom *bloom = slice->run->info.bloom;
+	return bloom == NULL || vy_bloom_maybe_has(bloom, key, lsm->key_def);
+}
+
+/**
+ * Read the slice at the given position. If there are too many
+ * reads in progress, wait for one of them to complete first.
+ * Give up if a newer slice turns out to store a terminal
+ * statement while we are waiting.
+ */
+static void
+vy_point_lookup_reader_read(struct vy_point_lookup_reader *reader, int pos)
+{
+	struct vy_slice *slice = reader->slices[pos];
+	int rc = 0;
+	/* The bloom filter check doesn't need a disk read. */
+	bool need_read = vy_point_lookup_slice_maybe_has(reader->lsm, slice,
+							 reader->key);
+	while (need_read && pos < reader->terminal_pos &&
+	       reader->read_count >= reader->read_count_max) {
+		if (fiber_cond_wait(&reader->cond) != 0) {
+			rc = -1;
+			goto out;
+		}
+	}
+	if (pos > reader->terminal_pos)
+		goto out;
+	reader->read_count++;
+	rc = vy_point_lookup_scan_slice(reader->lsm, slice, reader->rv,
+					reader->key, &reader->histories[pos]);
+	reader->read_count--;
+	if (rc == 0 && vy_history_is_terminal(&reader->histories[pos]) &&
+	    pos < reader->terminal_pos)
+		reader->terminal_pos = pos;
+out:
+	reader->rcs[pos] = rc;
+	if (rc != 0)
+		diag_move(diag_get(), &reader->diags[pos]);
+	fiber_cond_broadcast(&reader->cond);
+}
+
+static int
+vy_point_lookup_reader_f(va_list ap)
+{
+	struct vy_point_lookup_reader *reader =
+		va_arg(ap, struct vy_point_lookup_reader *);
+	int pos = va_arg(ap, int);
+	vy_point_lookup_reader_read(reader, pos);
+	return 0;
+}
+
+/**
+ * Read pinned slices in parallel, each in its own fiber, so that
+ * a cold lookup costs about one disk read rather than the sum of
+ * reads from all levels. The number of reads in flight is limited
+ * by the number of reader threads. Reads of slices older than the
+ * newest slice storing a terminal statement are skipped if they
+ * haven't been issued yet or discarded otherwise.
+ */
+static int
+vy_point_lookup_read_slices(struct vy_lsm *lsm, const struct vy_read_view **rv,
+			    struct vy_entry key, struct vy_slice **slices,
+			    int slice_count, struct vy_history *history)
+{
+	struct region *region = &fiber()->gc;
+	size_t size;
+	struct vy_history *histories =
+		region_alloc_array(region, typeof(histories[0]),
+				   slice_count, &size);
+	if (histories == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "histories");
+		return -1;
+	}
+	int *rcs = region_alloc_array(region, typeof(rcs[0]),
+				      slice_count, &size);
+	if (rcs == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "rcs");
+		return -1;
+	}
+	struct diag *diags = region_alloc_array(region, typeof(diags[0]),
+						slice_count, &size);
+	if (diags == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "diags");
+		return -1;
+	}
+	struct fiber **fibers = region_alloc_array(region, typeof(fibers[0]),
+						   slice_count, &size);
+	if (fibers == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "fibers");
+		return -1;
+	}
+	struct vy_point_lookup_reader reader;
+	reader.lsm = lsm;
+	reader.rv = rv;
+	reader.key = key;
+	reader.slices = slices;
+	reader.slice_count = slice_count;
+	reader.histories = histories;
+	reader.rcs = rcs;
+	reader.diags = diags;
+	reader.terminal_pos = slice_count;
+	reader.read_count = 0;
+	reader.read_count_max = slices[0]->run->env->reader_pool_size;
+	fiber_cond_create(&reader.cond);
+	for (int i = 0; i < slice_count; i++) {
+		vy_history_create(&histories[i], &lsm->env->history_node_pool);
+		diag_create(&diags[i]);
+		rcs[i] = 0;
+	}
+	/*
+	 * Start fibers in the slice order so that reads from newer
+	 * slices are issued first. If we fail to start a fiber, read
+	 * the slice in the current fiber.
+	 */
+	for (int i = 0; i < slice_count; i++) {
+		fibers[i] = fiber_new("vinyl.point_lookup",
+				      vy_point_lookup_reader_f);
+		if (fibers[i] == NULL) {
+			diag_clear(diag_get());
+			vy_point_lookup_reader_read(&reader, i);
+			continue;
+		}
+		fiber_set_joinable(fibers[i], true);
+		fiber_start(fibers[i], &reader, i);
+	}
+	for (int i = 0; i < slice_count; i++) {
+		if (fibers[i] != NULL)
+			fiber_join(fibers[i]);
+	}
+	int rc = 0;
+	for (int i = 0; i < slice_count; i++) {
+		if (rc == 0 && !vy_history_is_terminal(history)) {
+			if (rcs[i] != 0) {
+				diag_move(&diags[i], diag_get());
+				rc = -1;
+			} else {
+				vy_history_splice(history, &histories[i]);
+			}
+		}
+		vy_history_cleanup(&histories[i]);
+		diag_destroy(&diags[i]);
+	}
+	fiber_cond_destroy(&reader.cond);
+	return rc;
+}
+
+/**
+ * Replace the oldest statement of a key history read from
+ * the given slices with a statement storing values if it
+ * refers to values stored in value files.
+ */
+static int
+vy_point_lookup_resolve_values(struct vy_slice **slices, int slice_count,
+			       struct vy_history *history)
+{
+	size_t size;
+	struct vy_run **runs =
+		region_alloc_array(&fiber()->gc, typeof(runs[0]), slice_count,
+				   &size);
+	if (runs == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "runs");
+		return -1;
+	}
+	for (int i = 0; i < slice_count; i++)
+		runs[i] = slices[i]->run;
+	return vy_run_resolve_values(runs, slice_count, history);
+}
+
 /**
  * Find a range and scan all slices that belongs to the range.
  * Add found statements to the history list up to terminal statement.
@@ -176,19 +382,43 @@ vy_point_lookup_scan_slices(struct vy_lsm *lsm, const struct vy_read_view **rv,
 		return -1;
 	}
 	int i = 0;
+	int read_count = 0;
 	struct vy_slice *slice;
 	rlist_foreach_entry(slice, &range->slices, in_range) {
 		vy_slice_pin(slice);
 		slices[i++] = slice;
+		if (vy_point_lookup_slice_maybe_has(lsm, slice, key))
+			read_count++;
 	}
 	assert(i == slice_count);
 	int rc = 0;
-	for (i = 0; i < slice_count; i++) {
-		if (rc == 0 && !vy_history_is_terminal(history))
+	/*
+	 * Read slices in parallel if more than one of them may
+	 * store the key and reads are done by reader threads
+	 * (they are done synchronously during recovery).
+	 */
+	if (read_count > 1 && slices[0]->run->env->reader_pool != NULL) {
+		rc = vy_point_lookup_read_slices(lsm, rv, key, slices,
+						 slice_count, history);
+	} else {
+		for (i = 0; i < slice_count; i++) {
+			if (vy_history_is_terminal(history))
+				break;
 			rc = vy_point_lookup_scan_slice(lsm, slices[i],
 							rv, key, history);
-		vy_slice_unpin(slices[i]);
+			if (rc != 0)
+				break;
+		}
 	}
+	/*
+	 * Read values referred to by the statement found on disk
+	 * while the slices are still pinned, see vy_value_log.h.
+	 */
+	if (rc == 0 && slice_count > 0)
+		rc = vy_point_lookup_resolve_values(slices, slice_count,
+						    history);
+	for (i = 0; i < slice_count; i++)
+		vy_slice_unpin(slices[i]);
 	return rc;
 }
 
@@ -279,6 +509,21 @@ restart:
 	}
 
 done:
+	if (rc == 0 && !rlist_empty(&lsm->range_tombstones)) {
+		/*
+		 * Drop statements deleted by a range tombstone.
+		 * Statements of the transaction write set and the
+		 * cache are always newer than visible tombstones,
+		 * because the cache is invalidated when a tombstone
+		 * is written.
+		 */
+		int64_t lsn = vy_lsm_range_tombstone_lsn(lsm, key,
+							 (*rv)->vlsn);
+		if (lsn >= 0) {
+			vy_history_cut(&mem_history, lsn);
+			vy_history_cut(&disk_history, lsn);
+		}
+	}
 	vy_history_splice(&history, &mem_history);
 	vy_history_splice(&history, &disk_history);
 
@@ -261,6 +261,122 @@ vy_range_remove_slice(struct vy_range *range, struct vy_slice *slice)
 	range->version++;
 }
 
+/**
+ * Leveled counterpart of vy_range_update_compaction_priority().
+ *
+ * Runs created by dump form level 0, where up to run_count_per_level
+ * runs may be accumulated before they are merged into level 1 (or
+ * compacted into a new level 1 run if level 1 would get too big).
+ * Every other level stores exactly one run. The oldest run defines
+ * the size of the last level, each upper level is run_size_ratio times
+ * smaller than the next one. As soon as a run gets bigger than the
+ * target size of its level, it is merged into the next level. Since
+ * compaction always takes the newest runs of a range, upper levels are
+ * merged along with it. This bounds the number of runs a lookup may have to
+ * check by run_count_per_level plus the number of levels, at the cost
+ * of rewriting each level more often than the tiered strategy does.
+ */
+static void
+vy_range_update_compaction_priority_leveled(struct vy_range *range,
+					    const struct index_opts *opts)
+{
+	struct vy_slice *slice;
+	/* Total number of statements in checked runs. */
+	struct vy_disk_stmt_counter total_stmt_count;
+	vy_disk_stmt_counter_reset(&total_stmt_count);
+	/* Total number of checked runs. */
+	uint32_t total_run_count = 0;
+
+	/*
+	 * Level 0 consists of the newest runs that haven't been
+	 * compacted yet. The oldest run is always the last level.
+	 */
+	uint32_t level0_run_count = 0;
+	rlist_foreach_entry(slice, &range->slices, in_range) {
+		if (slice->run->dump_count > 1 ||
+		    level0_run_count == (uint32_t)range->slice_count - 1)
+			break;
+		level0_run_count++;
+	}
+	/*
+	 * Defer compaction of level 0 with some small probability to
+	 * spread compaction of different ranges in time, see the
+	 * comment in vy_range_update_compaction_priority().
+	 */
+	uint32_t max_run_count = opts->run_count_per_level;
+	slice = rlist_first_entry(&range->slices, struct vy_slice, in_range);
+	if (slice->seed < RAND_MAX / 10)
+		max_run_count++;
+
+	/*
+	 * Calculate the target size of level 1 by dividing the size
+	 * of the oldest run by run_size_ratio once per each level.
+	 */
+	uint64_t target_run_size;
+	slice = rlist_last_entry(&range->slices, struct vy_slice, in_range);
+	target_run_size = MAX(slice->count.bytes, 1);
+	for (int i = level0_run_count + 1; i < range->slice_count; i++) {
+		target_run_size = DIV_ROUND_UP(target_run_size,
+					       opts->run_size_ratio);
+	}
+
+	if (level0_run_count > max_run_count) {
+		/*
+		 * Merge level 0 into level 1 unless there's no level 1
+		 * yet (the next run is the oldest one, i.e. belongs to
+		 * the last level) or level 1 would outgrow its target
+		 * size, in which case level 0 is compacted into a new
+		 * level 1 run. Merging level 0 into the last level here
+		 * would turn each level 0 compaction into a major one.
+		 */
+		range->compaction_priority = level0_run_count;
+		if (level0_run_count + 1 < (uint32_t)range->slice_count) {
+			uint64_t size = 0;
+			uint32_t i = 0;
+			rlist_foreach_entry(slice, &range->slices, in_range) {
+				size += slice->count.bytes;
+				if (i++ == level0_run_count)
+					break;
+			}
+			if (size <= target_run_size)
+				range->compaction_priority++;
+		}
+	}
+
+	rlist_foreach_entry(slice, &range->slices, in_range) {
+		total_run_count++;
+		vy_disk_stmt_counter_add(&total_stmt_count, &slice->count);
+		if (total_run_count <= level0_run_count)
+			continue;
+		if (total_run_count == (uint32_t)range->slice_count)
+			break;
+		/*
+		 * Merge this level into the next one if it has
+		 * outgrown its target size. If this level is going
+		 * to be compacted anyway, check the estimated size
+		 * of the compacted run instead so as to avoid
+		 * a cascading compaction.
+		 */
+		uint64_t size = slice->count.bytes;
+		if (range->compaction_priority == (int)total_run_count)
+			size = total_stmt_count.bytes;
+		if (size > target_run_size)
+			range->compaction_priority = total_run_count + 1;
+		target_run_size *= opts->run_size_ratio;
+	}
+
+	if (range->compaction_priority > 0) {
+		/* Account the runs that are going to be compacted. */
+		int i = 0;
+		rlist_foreach_entry(slice, &range->slices, in_range) {
+			if (i++ == range->compaction_priority)
+				break;
+			vy_disk_stmt_counter_add(&range->compaction_queue,
+						 &slice->count);
+		}
+	}
+}
+
 /**
  * To reduce write amplification caused by compaction, we follow
  * the LSM tree design. Runs in each range are divided into groups
@@ -294,9 +410,17 @@ vy_range_update_compaction_priority(struct vy_range *range,
 	range->compaction_priority = 0;
 	vy_disk_stmt_counter_reset(&range->compaction_queue);
 
+	if (vy_range_needs_rewrite(range) && range->slice_count > 0) {
+		range->compaction_priority = range->slice_count;
+		range->compaction_queue = range->count;
+		return;
+	}
+
 	if (range->slice_count <= 1) {
 		/* Nothing to compact. */
 		range->needs_compaction = false;
+		range->needs_value_gc = false;
+		range->needs_tombstone_gc = false;
 		return;
 	}
 
@@ -306,6 +430,11 @@ vy_range_update_compaction_priority(struct vy_range *range,
 		return;
 	}
 
+	if (opts->compaction_strategy == COMPACTION_STRATEGY_LEVELED) {
+		vy_range_update_compaction_priority_leveled(range, opts);
+		return;
+	}
+
 	/* Total number of statements in checked runs. */
 	struct vy_disk_stmt_counter total_stmt_count;
 	vy_disk_stmt_counter_reset(&total_stmt_count);
@@ -515,6 +644,69 @@ vy_range_needs_split(struct vy_range *range, int64_t range_size,
 	return true;
 }
 
+/**
+ * Return the number of keys stored in split_keys if the range should
+ * be split before compaction so that its parts could be compacted by
+ * different worker threads concurrently.
+ *
+ * - We only do this for major compaction, because otherwise the oldest
+ *   run, which is usually the biggest one, isn't rewritten.
+ * - We don't split a range that hasn't been merged yet, in particular
+ *   a part of a range that was just split, see vy_range_needs_split().
+ * - We use the oldest run size as the size of the range, just like
+ *   vy_range_needs_split() does.
+ * - We never make a part smaller than half the target range size,
+ *   otherwise it would be coalesced back on the next compaction.
+ * - We split by min keys of pages of the oldest run, evenly
+ *   distributed over the slice.
+ */
+int
+vy_range_needs_compaction_split(struct vy_range *range, int64_t range_size,
+				int max_parts, const char **split_keys)
+{
+	if (range->n_compactions < 1 ||
+	    range->compaction_priority < range->slice_count)
+		return 0;
+
+	/* Find the oldest run. */
+	assert(!rlist_empty(&range->slices));
+	struct vy_slice *slice = rlist_last_entry(&range->slices,
+						  struct vy_slice, in_range);
+
+	int64_t part_count = slice->count.bytes / MAX(range_size / 2, 1);
+	uint32_t page_count = slice->last_page_no - slice->first_page_no + 1;
+	part_count = MIN(part_count, max_parts);
+	part_count = MIN(part_count, page_count);
+	if (part_count < 2)
+		return 0;
+
+	/*
+	 * Split keys must grow monotonically and be greater than
+	 * the beginning of the slice (see vy_range_needs_split()),
+	 * skip page boundaries that don't satisfy this.
+	 */
+	int key_count = 0;
+	struct vy_page_info *prev_page = vy_run_page_info(slice->run,
+							  slice->first_page_no);
+	for (int64_t i = 1; i < part_count; i++) {
+		struct vy_page_info *page = vy_run_page_info(slice->run,
+				slice->first_page_no + page_count * i /
+				part_count);
+		if (key_compare(prev_page->min_key, prev_page->min_key_hint,
+				page->min_key, page->min_key_hint,
+				range->cmp_def) >= 0)
+			continue;
+		if (slice->begin.stmt != NULL &&
+		    vy_entry_compare_with_raw_key(slice->begin, page->min_key,
+						  page->min_key_hint,
+						  range->cmp_def) >= 0)
+			continue;
+		split_keys[key_count++] = page->min_key;
+		prev_page = page;
+	}
+	return key_count;
+}
+
 /**
  * Check if a range should be coalesced with one or more its neighbors.
  * If it should, return true and set @p_first and @p_last to the first
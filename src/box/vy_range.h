@@ -117,8 +117,33 @@ struct vy_range {
 	 * is scheduled for compaction.
 	 */
 	bool needs_compaction;
+	/**
+	 * Set if the range refers to a value file most of which
+	 * isn't referenced by the LSM tree anymore. Such a range
+	 * is compacted even if it has only one run so that the
+	 * values still in use are moved to a new value file, see
+	 * vy_lsm_schedule_value_gc(). Cleared when the range is
+	 * scheduled for compaction.
+	 */
+	bool needs_value_gc;
+	/**
+	 * Set if the range may store statements covered by a range
+	 * tombstone it hasn't applied yet. Such a range is compacted
+	 * even if it has only one run so that the tombstone can be
+	 * dropped, see vy_lsm_force_compaction_range_tombstone().
+	 * Cleared when the range is scheduled for compaction.
+	 */
+	bool needs_tombstone_gc;
 	/** Number of times the range was compacted. */
 	int n_compactions;
+	/**
+	 * Range tombstones with LSN less than or equal to this
+	 * value have been applied to all statements stored in
+	 * this range by major compaction, so they don't need to
+	 * be kept for this range anymore. Restored on recovery
+	 * from vy_run::applied_tombstone_lsn.
+	 */
+	int64_t applied_tombstone_lsn;
 	/**
 	 * Number of dumps it takes to trigger major compaction in
 	 * this range, see vy_run::dump_count for more details.
@@ -159,6 +184,16 @@ vy_range_is_scheduled(struct vy_range *range)
 	return heap_node_is_stray(&range->heap_node);
 }
 
+/**
+ * Return true if the range must be compacted even if it has
+ * only one run, see vy_range::needs_value_gc, needs_tombstone_gc.
+ */
+static inline bool
+vy_range_needs_rewrite(struct vy_range *range)
+{
+	return range->needs_value_gc || range->needs_tombstone_gc;
+}
+
 /**
  * Search tree of all ranges of the same LSM tree, sorted by
  * vy_range->begin. Ranges in a tree are supposed to span
@@ -266,6 +301,23 @@ bool
 vy_range_needs_split(struct vy_range *range, int64_t range_size,
 		     const char **p_split_key);
 
+/**
+ * Check if a range should be split before major compaction so
+ * that its parts could be compacted in parallel.
+ *
+ * @param range             The range.
+ * @param range_size        Target range size.
+ * @param max_parts         Max number of parts to split the range in.
+ * @param[out] split_keys   Keys to split the range by, must have
+ *                          room for @max_parts - 1 keys.
+ *
+ * @retval  Number of keys stored in @split_keys, 0 if the range
+ *          shouldn't be split.
+ */
+int
+vy_range_needs_compaction_split(struct vy_range *range, int64_t range_size,
+				int max_parts, const char **split_keys);
+
 /**
  * Check if a range needs to be coalesced with adjacent
  * ranges in a range tree.
@@ -0,0 +1,216 @@
+#ifndef INCLUDES_TARANTOOL_BOX_VY_RANGE_TOMBSTONE_H
+#define INCLUDES_TARANTOOL_BOX_VY_RANGE_TOMBSTONE_H
+/*
+ * Copyright 2010-2021, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/**
+ * Range tombstones.
+ *
+ * A range tombstone deletes all keys of a primary index that
+ * fall in the interval [begin, end) and were written before it,
+ * i.e. have LSN less than the LSN of the tombstone. It takes
+ * O(1) space no matter how many keys it covers.
+ *
+ * A tombstone is written to the active in-memory tree of the
+ * primary index LSM tree, but unlike statements it isn't stored
+ * in the memory tree itself. Instead all tombstones of an LSM
+ * tree are linked in vy_lsm::range_tombstones and refer to the
+ * in-memory tree they were written to. When the in-memory tree
+ * is dumped, tombstones are persisted in the metadata log along
+ * with the dump record.
+ *
+ * Readers hide statements covered by tombstones visible from
+ * their read view. Compaction of the primary index drops covered
+ * statements and generates deferred DELETEs for secondary
+ * indexes. A tombstone is dropped once there are no run slices
+ * that may store statements covered by it.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <msgpuck.h>
+#include <small/rlist.h>
+
+#include "diag.h"
+#include "trivia/util.h"
+#include "vy_entry.h"
+#include "vy_stmt.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct key_def;
+struct vy_mem;
+
+struct vy_range_tombstone {
+	/** Link in vy_lsm::range_tombstones. */
+	struct rlist in_lsm;
+	/** Unique ID of the tombstone, used for logging. */
+	int64_t id;
+	/**
+	 * Start of the deleted interval (inclusive) or
+	 * vy_entry_none() if it starts from -inf.
+	 */
+	struct vy_entry begin;
+	/**
+	 * End of the deleted interval (exclusive) or
+	 * vy_entry_none() if it ends with +inf.
+	 */
+	struct vy_entry end;
+	/**
+	 * LSN of the tombstone. Set to MAX_LSN + psn while
+	 * the transaction that wrote it is being prepared.
+	 */
+	int64_t lsn;
+	/**
+	 * In-memory tree the tombstone was written to or NULL
+	 * if the tree has been dumped and the tombstone is now
+	 * stored in the metadata log.
+	 */
+	struct vy_mem *mem;
+	/**
+	 * Reference counter. A tombstone is referenced by the
+	 * LSM tree it belongs to and by compaction tasks that
+	 * apply it.
+	 */
+	int refs;
+};
+
+/**
+ * Allocate a new range tombstone.
+ * @param id        Unique ID of the tombstone.
+ * @param format    Format of key statements.
+ * @param cmp_def   Key definition of the primary index.
+ * @param begin     Start of the interval (MsgPack array) or
+ *                  NULL; an empty array stands for -inf.
+ * @param end       End of the interval (MsgPack array) or
+ *                  NULL; an empty array stands for +inf.
+ * @param lsn       LSN of the tombstone.
+ *
+ * @return the new tombstone or NULL on memory error.
+ */
+static inline struct vy_range_tombstone *
+vy_range_tombstone_new(int64_t id, struct tuple_format *format,
+		       struct key_def *cmp_def, const char *begin,
+		       const char *end, int64_t lsn)
+{
+	struct vy_range_tombstone *t = malloc(sizeof(*t));
+	if (t == NULL) {
+		diag_set(OutOfMemory, sizeof(*t), "malloc",
+			 "struct vy_range_tombstone");
+		return NULL;
+	}
+	t->id = id;
+	t->lsn = lsn;
+	t->mem = NULL;
+	t->refs = 1;
+	t->begin = t->end = vy_entry_none();
+	rlist_create(&t->in_lsm);
+	const char *tmp;
+	if (begin != NULL && (tmp = begin, mp_decode_array(&tmp) > 0)) {
+		t->begin = vy_entry_key_from_msgpack(format, cmp_def, begin);
+		if (t->begin.stmt == NULL)
+			goto fail;
+	}
+	if (end != NULL && (tmp = end, mp_decode_array(&tmp) > 0)) {
+		t->end = vy_entry_key_from_msgpack(format, cmp_def, end);
+		if (t->end.stmt == NULL)
+			goto fail;
+	}
+	return t;
+fail:
+	if (t->begin.stmt != NULL)
+		tuple_unref(t->begin.stmt);
+	free(t);
+	return NULL;
+}
+
+static inline void
+vy_range_tombstone_ref(struct vy_range_tombstone *t)
+{
+	assert(t->refs > 0);
+	t->refs++;
+}
+
+static inline void
+vy_range_tombstone_unref(struct vy_range_tombstone *t)
+{
+	assert(t->refs > 0);
+	if (--t->refs > 0)
+		return;
+	if (t->begin.stmt != NULL)
+		tuple_unref(t->begin.stmt);
+	if (t->end.stmt != NULL)
+		tuple_unref(t->end.stmt);
+	TRASH(t);
+	free(t);
+}
+
+/** Return true if a tombstone covers the given key. */
+static inline bool
+vy_range_tombstone_covers(const struct vy_range_tombstone *t,
+			  struct vy_entry entry, struct key_def *cmp_def)
+{
+	if (t->begin.stmt != NULL &&
+	    vy_entry_compare(entry, t->begin, cmp_def) < 0)
+		return false;
+	if (t->end.stmt != NULL &&
+	    vy_entry_compare(entry, t->end, cmp_def) >= 0)
+		return false;
+	return true;
+}
+
+/**
+ * Return true if a tombstone intersects the interval
+ * [begin, end). NULL statements stand for infinity.
+ */
+static inline bool
+vy_range_tombstone_intersects(const struct vy_range_tombstone *t,
+			      struct vy_entry begin, struct vy_entry end,
+			      struct key_def *cmp_def)
+{
+	if (t->begin.stmt != NULL && end.stmt != NULL &&
+	    vy_entry_compare(t->begin, end, cmp_def) >= 0)
+		return false;
+	if (t->end.stmt != NULL && begin.stmt != NULL &&
+	    vy_entry_compare(begin, t->end, cmp_def) >= 0)
+		return false;
+	return true;
+}
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* INCLUDES_TARANTOOL_BOX_VY_RANGE_TOMBSTONE_H */
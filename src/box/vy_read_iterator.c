@@ -378,6 +378,29 @@ vy_read_iterator_scan_disk(struct vy_read_iterator *itr, uint32_t disk_src,
 	return 0;
 }
 
+/**
+ * Read values referred to by the oldest statement of the key
+ * the iterator is positioned at if it was read from disk, see
+ * vy_value_log.h. Statements of sources newer than the first
+ * source storing a terminal statement aren't read, because
+ * they are overwritten. Must be called while slices are pinned.
+ */
+static NODISCARD int
+vy_read_iterator_resolve_values(struct vy_read_iterator *itr)
+{
+	for (uint32_t i = 0; i < itr->src_count; i++) {
+		struct vy_read_src *src = &itr->src[i];
+		if (src->front_id != itr->front_id ||
+		    !vy_history_is_terminal(&src->history))
+			continue;
+		if (i < itr->disk_src)
+			return 0;
+		return vy_run_resolve_values(&src->run_iterator.slice->run,
+					     1, &src->history);
+	}
+	return 0;
+}
+
 static void
 vy_read_iterator_restore(struct vy_read_iterator *itr);
 
@@ -447,6 +470,11 @@ rescan_disk:
 		if (stop)
 			break;
 	}
+	bool range_is_done = vy_read_iterator_range_is_done(itr, next);
+	if (!range_is_done && vy_read_iterator_resolve_values(itr) != 0) {
+		vy_read_iterator_unpin_slices(itr);
+		return -1;
+	}
 	vy_read_iterator_unpin_slices(itr);
 	/*
 	 * The transaction could have been aborted while we were
@@ -486,7 +514,7 @@ rescan_disk:
 	 * Scan the next range in case we transgressed the current
 	 * range's boundaries.
 	 */
-	if (vy_read_iterator_range_is_done(itr, next)) {
+	if (range_is_done) {
 		vy_read_iterator_next_range(itr);
 		goto rescan_disk;
 	}
@@ -755,18 +783,52 @@ vy_read_iterator_apply_history(struct vy_read_iterator *itr,
 			       struct vy_entry *ret)
 {
 	struct vy_lsm *lsm = itr->lsm;
-	struct vy_history history;
+	struct vy_history history, mem_history;
 	vy_history_create(&history, &lsm->env->history_node_pool);
+	vy_history_create(&mem_history, &lsm->env->history_node_pool);
 
+	/*
+	 * Statements read from the transaction write set and
+	 * the cache can't be deleted by a range tombstone so
+	 * collect them separately.
+	 */
 	for (uint32_t i = 0; i < itr->src_count; i++) {
 		struct vy_read_src *src = &itr->src[i];
+		struct vy_history *dst = i < itr->mem_src ?
+					 &history : &mem_history;
 		if (src->front_id == itr->front_id) {
-			vy_history_splice(&history, &src->history);
-			if (vy_history_is_terminal(&history))
+			vy_history_splice(dst, &src->history);
+			if (vy_history_is_terminal(dst))
 				break;
 		}
 	}
 
+	if (!rlist_empty(&lsm->range_tombstones) &&
+	    !rlist_empty(&mem_history.stmts)) {
+		struct vy_entry last = vy_history_last_stmt(&mem_history);
+		int64_t lsn = vy_lsm_range_tombstone_lsn(lsm, last,
+						(**itr->read_view).vlsn);
+		if (lsn >= 0 && rlist_empty(&history.stmts) &&
+		    vy_stmt_lsn(last.stmt) < lsn) {
+			/*
+			 * All statements are deleted. Return a DELETE
+			 * rather than NULL so that the caller skips
+			 * the key instead of stopping iteration.
+			 */
+			ret->hint = last.hint;
+			ret->stmt = vy_stmt_new_surrogate_delete(
+						lsm->mem_format, last.stmt);
+			vy_history_cleanup(&mem_history);
+			if (ret->stmt == NULL)
+				return -1;
+			vy_stmt_set_lsn(ret->stmt, lsn);
+			return 0;
+		}
+		if (lsn >= 0)
+			vy_history_cut(&mem_history, lsn);
+	}
+	vy_history_splice(&history, &mem_history);
+
 	int upserts_applied = 0;
 	int rc = vy_history_apply(&history, lsm->cmp_def,
 				  true, &upserts_applied, ret);
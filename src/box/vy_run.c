@@ -30,6 +30,7 @@
  */
 #include "vy_run.h"
 
+#include <fcntl.h>
 #include <zstd.h>
 
 #include "fiber.h"
@@ -111,6 +112,307 @@ struct vy_page_read_task {
 	struct vy_page *page;
 };
 
+/**
+ * Asynchronous read of a page ahead of a run iterator.
+ * The message is sent to a reader thread and back to tx.
+ */
+struct vy_page_read_ahead {
+	/** parent */
+	struct cmsg base;
+	/** Message route: read in a reader thread, complete in tx. */
+	struct cmsg_hop route[2];
+	/** vy_run with fd - ref. counted */
+	struct vy_run *run;
+	/** Number of the page to read. */
+	uint32_t page_no;
+	/** [out] The page read, owned by the task. */
+	struct vy_page *page;
+	/** [out] Result of the read. */
+	int rc;
+	/** [out] Error that occurred while reading the page. */
+	struct diag diag;
+	/** Set when the message returns to tx. */
+	bool is_complete;
+	/**
+	 * Set if the iterator doesn't need the page anymore.
+	 * The task is deleted as soon as it completes then.
+	 */
+	bool is_cancelled;
+	/** Fiber waiting for the read to complete or NULL. */
+	struct fiber *waiter;
+};
+
+static struct vy_page *
+vy_page_new(const struct vy_page_info *page_info)
+{
+	struct vy_page *page = malloc(sizeof(*page));
+	if (page == NULL) {
+		diag_set(OutOfMemory, sizeof(*page),
+			 "load_page", "page cache");
+		return NULL;
+	}
+	page->unpacked_size = page_info->unpacked_size;
+	page->row_count = page_info->row_count;
+	page->refs = 1;
+	page->run_id = -1;
+	page->is_cached = false;
+	page->is_protected = false;
+	rlist_create(&page->in_lru);
+	rlist_create(&page->in_run);
+	page->row_index = calloc(page_info->row_count, sizeof(uint32_t));
+	if (page->row_index == NULL) {
+		diag_set(OutOfMemory, page_info->row_count * sizeof(uint32_t),
+			 "malloc", "page->row_index");
+		free(page);
+		return NULL;
+	}
+
+	page->data = (char *)malloc(page_info->unpacked_size);
+	if (page->data == NULL) {
+		diag_set(OutOfMemory, page_info->unpacked_size,
+			 "malloc", "page->data");
+		free(page->row_index);
+		free(page);
+		return NULL;
+	}
+	return page;
+}
+
+static void
+vy_page_delete(struct vy_page *page)
+{
+	assert(!page->is_cached);
+	uint32_t *row_index = page->row_index;
+	char *data = page->data;
+#if !defined(NDEBUG)
+	memset(row_index, '#', sizeof(uint32_t) * page->row_count);
+	memset(data, '#', page->unpacked_size);
+	memset(page, '#', sizeof(*page));
+#endif /* !defined(NDEBUG) */
+	free(row_index);
+	free(data);
+	free(page);
+}
+
+static inline void
+vy_page_ref(struct vy_page *page)
+{
+	assert(page->refs > 0);
+	page->refs++;
+}
+
+static inline void
+vy_page_unref(struct vy_page *page)
+{
+	assert(page->refs > 0);
+	if (--page->refs == 0)
+		vy_page_delete(page);
+}
+
+/* {{{ Page cache */
+
+/**
+ * Max share of the page cache quota that may be used by the
+ * protected segment. Pages demoted from the protected segment
+ * get another chance in the probationary segment.
+ */
+static const double VY_PAGE_CACHE_PROTECTED_RATIO = 0.8;
+
+struct vy_page_cache_key {
+	int64_t run_id;
+	uint32_t page_no;
+};
+
+static inline uint32_t
+vy_page_cache_hash(int64_t run_id, uint32_t page_no)
+{
+	uint64_t h = (uint64_t)run_id * 0x9e3779b97f4a7c15ULL + page_no;
+	return (uint32_t)(h ^ (h >> 32));
+}
+
+#define mh_name _vy_page_cache
+#define mh_key_t const struct vy_page_cache_key *
+#define mh_node_t struct vy_page *
+#define mh_arg_t int
+#define mh_hash(a, arg) (vy_page_cache_hash((*(a))->run_id, (*(a))->page_no))
+#define mh_hash_key(a, arg) (vy_page_cache_hash((a)->run_id, (a)->page_no))
+#define mh_cmp(a, b, arg) ((*(a))->run_id != (*(b))->run_id || \
+			   (*(a))->page_no != (*(b))->page_no)
+#define mh_cmp_key(a, b, arg) ((a)->run_id != (*(b))->run_id || \
+			       (a)->page_no != (*(b))->page_no)
+#define MH_SOURCE
+#include "salad/mhash.h"
+
+/** Size of memory used by a page. */
+static inline size_t
+vy_page_mem_used(struct vy_page *page)
+{
+	return sizeof(*page) + page->row_count * sizeof(uint32_t) +
+	       page->unpacked_size;
+}
+
+static void
+vy_page_cache_create(struct vy_page_cache *cache)
+{
+	cache->hash = mh_vy_page_cache_new();
+	if (cache->hash == NULL)
+		panic("failed to allocate vinyl page cache");
+	rlist_create(&cache->probation);
+	rlist_create(&cache->protected);
+	cache->quota = 0;
+	cache->mem_used = 0;
+	cache->protected_mem_used = 0;
+	memset(&cache->stat, 0, sizeof(cache->stat));
+}
+
+/** Remove a page from the cache and drop the cache reference. */
+static void
+vy_page_cache_evict(struct vy_page_cache *cache, struct vy_page *page)
+{
+	assert(page->is_cached);
+	struct vy_page_cache_key key = { page->run_id, page->page_no };
+	mh_int_t pos = mh_vy_page_cache_find(cache->hash, &key, 0);
+	assert(pos != mh_end(cache->hash));
+	mh_vy_page_cache_del(cache->hash, pos, 0);
+	size_t size = vy_page_mem_used(page);
+	assert(cache->mem_used >= size);
+	cache->mem_used -= size;
+	if (page->is_protected) {
+		assert(cache->protected_mem_used >= size);
+		cache->protected_mem_used -= size;
+	}
+	rlist_del(&page->in_lru);
+	rlist_del(&page->in_run);
+	page->is_cached = false;
+	page->is_protected = false;
+	vy_page_unref(page);
+}
+
+static void
+vy_page_cache_destroy(struct vy_page_cache *cache)
+{
+	struct vy_page *page, *tmp;
+	rlist_foreach_entry_safe(page, &cache->probation, in_lru, tmp)
+		vy_page_cache_evict(cache, page);
+	rlist_foreach_entry_safe(page, &cache->protected, in_lru, tmp)
+		vy_page_cache_evict(cache, page);
+	mh_vy_page_cache_delete(cache->hash);
+}
+
+/**
+ * Evict pages until the cache fits in the quota. Pages are
+ * evicted from the tail of the probationary segment first.
+ */
+static void
+vy_page_cache_trim(struct vy_page_cache *cache)
+{
+	while (cache->mem_used > cache->quota) {
+		struct rlist *lru = !rlist_empty(&cache->probation) ?
+				    &cache->probation : &cache->protected;
+		assert(!rlist_empty(lru));
+		struct vy_page *page = rlist_last_entry(lru, struct vy_page,
+							in_lru);
+		vy_page_cache_evict(cache, page);
+		cache->stat.evict++;
+	}
+}
+
+/**
+ * Move least recently used pages from the protected segment
+ * to the head of the probationary segment until the protected
+ * segment fits in its share of the quota.
+ */
+static void
+vy_page_cache_demote(struct vy_page_cache *cache)
+{
+	size_t protected_quota = cache->quota * VY_PAGE_CACHE_PROTECTED_RATIO;
+	while (cache->protected_mem_used > protected_quota) {
+		assert(!rlist_empty(&cache->protected));
+		struct vy_page *page = rlist_last_entry(&cache->protected,
+							struct vy_page,
+							in_lru);
+		page->is_protected = false;
+		cache->protected_mem_used -= vy_page_mem_used(page);
+		rlist_move_entry(&cache->probation, page, in_lru);
+	}
+}
+
+/**
+ * Look up a page in the cache. On success the page is moved to
+ * the head of the protected segment. The function doesn't take
+ * a reference to the returned page.
+ */
+static struct vy_page *
+vy_page_cache_get(struct vy_page_cache *cache, int64_t run_id,
+		  uint32_t page_no)
+{
+	struct vy_page_cache_key key = { run_id, page_no };
+	mh_int_t pos = mh_vy_page_cache_find(cache->hash, &key, 0);
+	if (pos == mh_end(cache->hash)) {
+		cache->stat.miss++;
+		return NULL;
+	}
+	cache->stat.hit++;
+	struct vy_page *page = *mh_vy_page_cache_node(cache->hash, pos);
+	rlist_move_entry(&cache->protected, page, in_lru);
+	if (page->is_protected)
+		return page;
+	page->is_protected = true;
+	cache->protected_mem_used += vy_page_mem_used(page);
+	vy_page_cache_demote(cache);
+	return page;
+}
+
+/**
+ * Add a page read from disk to the probationary segment of
+ * the cache. The cache takes a reference to the page. Does
+ * nothing if the page is already cached, which may happen if
+ * another fiber read it while we were waiting for disk.
+ */
+static void
+vy_page_cache_put(struct vy_page_cache *cache, struct vy_run *run,
+		  struct vy_page *page)
+{
+	assert(!page->is_cached);
+	size_t size = vy_page_mem_used(page);
+	if (size > cache->quota)
+		return;
+	struct vy_page_cache_key key = { run->id, page->page_no };
+	if (mh_vy_page_cache_find(cache->hash, &key, 0) !=
+	    mh_end(cache->hash))
+		return;
+	page->run_id = run->id;
+	if (mh_vy_page_cache_put(cache->hash, &page, NULL, 0) ==
+	    mh_end(cache->hash))
+		return; /* Caching is an optimization, ignore OOM. */
+	vy_page_ref(page);
+	page->is_cached = true;
+	rlist_add_entry(&cache->probation, page, in_lru);
+	rlist_add_entry(&run->cached_pages, page, in_run);
+	cache->mem_used += size;
+	vy_page_cache_trim(cache);
+}
+
+/** Evict all pages of a run from the cache. */
+static void
+vy_page_cache_purge_run(struct vy_page_cache *cache, struct vy_run *run)
+{
+	struct vy_page *page, *tmp;
+	rlist_foreach_entry_safe(page, &run->cached_pages, in_run, tmp)
+		vy_page_cache_evict(cache, page);
+}
+
+void
+vy_run_env_set_page_cache_quota(struct vy_run_env *env, size_t quota)
+{
+	struct vy_page_cache *cache = &env->page_cache;
+	cache->quota = quota;
+	vy_page_cache_trim(cache);
+	vy_page_cache_demote(cache);
+}
+
+/* }}} Page cache */
+
 /** Destructor for env->zdctx_key thread-local variable */
 static void
 vy_free_zdctx(void *arg)
@@ -183,6 +485,10 @@ vy_run_env_create(struct vy_run_env *env, int read_threads)
 	tt_pthread_key_create(&env->zdctx_key, vy_free_zdctx);
 	mempool_create(&env->read_task_pool, cord_slab_cache(),
 		       sizeof(struct vy_page_read_task));
+	mempool_create(&env->read_ahead_pool, cord_slab_cache(),
+		       sizeof(struct vy_page_read_ahead));
+	vy_page_cache_create(&env->page_cache);
+	vy_value_cache_create(&env->value_cache);
 }
 
 /**
@@ -193,7 +499,10 @@ vy_run_env_destroy(struct vy_run_env *env)
 {
 	if (env->reader_pool != NULL)
 		vy_run_env_stop_readers(env);
+	vy_page_cache_destroy(&env->page_cache);
+	vy_value_cache_destroy(&env->value_cache);
 	mempool_destroy(&env->read_task_pool);
+	mempool_destroy(&env->read_ahead_pool);
 	tt_pthread_key_delete(env->zdctx_key);
 }
 
@@ -286,12 +595,61 @@ vy_run_new(struct vy_run_env *env, int64_t id)
 	run->refs = 1;
 	rlist_create(&run->in_lsm);
 	rlist_create(&run->in_unused);
+	rlist_create(&run->cached_pages);
 	return run;
 }
 
+/** Open value files referenced by a run for reading. */
+static int
+vy_run_open_value_files(struct vy_run *run, const char *dir,
+			uint32_t space_id, uint32_t iid)
+{
+	uint32_t count = run->info.value_file_count;
+	if (count == 0)
+		return 0;
+	assert(run->value_fds == NULL);
+	run->value_fds = malloc(count * sizeof(*run->value_fds));
+	if (run->value_fds == NULL) {
+		diag_set(OutOfMemory, count * sizeof(*run->value_fds),
+			 "malloc", "value file descriptors");
+		return -1;
+	}
+	for (uint32_t i = 0; i < count; i++)
+		run->value_fds[i] = -1;
+	char path[PATH_MAX];
+	for (uint32_t i = 0; i < count; i++) {
+		vy_run_snprint_value_path(path, sizeof(path), dir, space_id,
+					  iid, run->id, i);
+		run->value_fds[i] = open(path, O_RDONLY);
+		if (run->value_fds[i] < 0) {
+			diag_set(SystemError, "failed to open '%s' file",
+				 path);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static void
+vy_run_close_value_files(struct vy_run *run)
+{
+	if (run->value_fds == NULL)
+		return;
+	for (uint32_t i = 0; i < run->info.value_file_count; i++) {
+		if (run->value_fds[i] >= 0 && close(run->value_fds[i]) < 0)
+			say_syserror("close failed");
+	}
+	free(run->value_fds);
+	run->value_fds = NULL;
+}
+
 static void
 vy_run_clear(struct vy_run *run)
 {
+	vy_run_close_value_files(run);
+	free(run->info.value_files);
+	run->info.value_files = NULL;
+	run->info.value_file_count = 0;
 	if (run->page_info != NULL) {
 		uint32_t page_no;
 		for (page_no = 0; page_no < run->info.page_count; ++page_no)
@@ -315,6 +673,7 @@ void
 vy_run_delete(struct vy_run *run)
 {
 	assert(run->refs == 0);
+	vy_page_cache_purge_run(&run->env->page_cache, run);
 	if (run->fd >= 0 && close(run->fd) < 0)
 		say_syserror("close failed");
 	vy_run_clear(run);
@@ -622,6 +981,39 @@ vy_stmt_stat_decode(struct vy_stmt_stat *stat, const char **data)
 	}
 }
 
+/**
+ * Decode the list of value files referenced by a run:
+ * [[file id, file size, size of referenced values], ...].
+ */
+static int
+vy_run_info_decode_value_files(struct vy_run_info *run_info,
+			       const char **data, const char *filename)
+{
+	uint32_t count = mp_decode_array(data);
+	if (count == 0)
+		return 0;
+	size_t size = count * sizeof(*run_info->value_files);
+	run_info->value_files = malloc(size);
+	if (run_info->value_files == NULL) {
+		diag_set(OutOfMemory, size, "malloc",
+			 "struct vy_value_file_info");
+		return -1;
+	}
+	for (uint32_t i = 0; i < count; i++) {
+		struct vy_value_file_info *file = &run_info->value_files[i];
+		if (mp_decode_array(data) != 3) {
+			diag_set(ClientError, ER_INVALID_INDEX_FILE, filename,
+				 "Can't decode run info: invalid value file");
+			return -1;
+		}
+		file->id = mp_decode_uint(data);
+		file->size = mp_decode_uint(data);
+		file->ref_size = mp_decode_uint(data);
+		run_info->value_file_count++;
+	}
+	return 0;
+}
+
 /**
  * Decode the run metadata from xrow.
  *
@@ -683,9 +1075,27 @@ vy_run_info_decode(struct vy_run_info *run_info,
 			if (run_info->bloom == NULL)
 				return -1;
 			break;
+		case VY_RUN_INFO_BLOOM_HASHED:
+		case VY_RUN_INFO_BLOOM_BLOCKED: {
+			if (mp_decode_array(&pos) != 2)
+				goto invalid_bloom;
+			uint64_t hash_func = mp_decode_uint(&pos);
+			if (hash_func >= key_hash_func_MAX)
+				goto invalid_bloom;
+			run_info->bloom = tuple_bloom_decode(&pos);
+			if (run_info->bloom == NULL)
+				return -1;
+			run_info->bloom->hash_func = hash_func;
+			break;
+		}
 		case VY_RUN_INFO_STMT_STAT:
 			vy_stmt_stat_decode(&run_info->stmt_stat, &pos);
 			break;
+		case VY_RUN_INFO_VALUE_FILES:
+			if (vy_run_info_decode_value_files(run_info, &pos,
+							   filename) != 0)
+				return -1;
+			break;
 		default:
 			mp_next(&pos); /* unknown key, ignore */
 			break;
@@ -700,51 +1110,10 @@ vy_run_info_decode(struct vy_run_info *run_info,
 		return -1;
 	}
 	return 0;
-}
-
-static struct vy_page *
-vy_page_new(const struct vy_page_info *page_info)
-{
-	struct vy_page *page = malloc(sizeof(*page));
-	if (page == NULL) {
-		diag_set(OutOfMemory, sizeof(*page),
-			 "load_page", "page cache");
-		return NULL;
-	}
-	page->unpacked_size = page_info->unpacked_size;
-	page->row_count = page_info->row_count;
-	page->row_index = calloc(page_info->row_count, sizeof(uint32_t));
-	if (page->row_index == NULL) {
-		diag_set(OutOfMemory, page_info->row_count * sizeof(uint32_t),
-			 "malloc", "page->row_index");
-		free(page);
-		return NULL;
-	}
-
-	page->data = (char *)malloc(page_info->unpacked_size);
-	if (page->data == NULL) {
-		diag_set(OutOfMemory, page_info->unpacked_size,
-			 "malloc", "page->data");
-		free(page->row_index);
-		free(page);
-		return NULL;
-	}
-	return page;
-}
-
-static void
-vy_page_delete(struct vy_page *page)
-{
-	uint32_t *row_index = page->row_index;
-	char *data = page->data;
-#if !defined(NDEBUG)
-	memset(row_index, '#', sizeof(uint32_t) * page->row_count);
-	memset(data, '#', page->unpacked_size);
-	memset(page, '#', sizeof(*page));
-#endif /* !defined(NDEBUG) */
-	free(row_index);
-	free(data);
-	free(page);
+invalid_bloom:
+	diag_set(ClientError, ER_INVALID_INDEX_FILE, filename,
+		 "Can't decode run info: unknown bloom filter hash function");
+	return -1;
 }
 
 static int
@@ -833,9 +1202,9 @@ vy_run_iterator_stop(struct vy_run_iterator *itr)
 		itr->curr = vy_entry_none();
 	}
 	if (itr->curr_page != NULL) {
-		vy_page_delete(itr->curr_page);
+		vy_page_unref(itr->curr_page);
 		if (itr->prev_page != NULL)
-			vy_page_delete(itr->prev_page);
+			vy_page_unref(itr->prev_page);
 		itr->curr_page = itr->prev_page = NULL;
 	}
 }
@@ -995,46 +1364,237 @@ vy_page_read_cb(struct cbus_call_msg *base)
 	return 0;
 }
 
+static void
+vy_page_read_ahead_delete(struct vy_page_read_ahead *task)
+{
+	struct vy_run_env *env = task->run->env;
+	if (task->page != NULL)
+		vy_page_unref(task->page);
+	diag_destroy(&task->diag);
+	vy_run_unref(task->run);
+	mempool_free(&env->read_ahead_pool, task);
+}
+
+/** Read a page ahead, called in a reader thread. */
+static void
+vy_page_read_ahead_perform(struct cmsg *base)
+{
+	struct vy_page_read_ahead *task = (struct vy_page_read_ahead *)base;
+	struct vy_page_info *page_info = vy_run_page_info(task->run,
+							  task->page_no);
+	ZSTD_DStream *zdctx = vy_env_get_zdctx(task->run->env);
+	task->rc = -1;
+	if (zdctx != NULL)
+		task->rc = vy_page_read(task->page, page_info, task->run,
+					zdctx);
+	if (task->rc != 0)
+		diag_move(diag_get(), &task->diag);
+}
+
+/** Complete a page read ahead, called in tx. */
+static void
+vy_page_read_ahead_complete(struct cmsg *base)
+{
+	struct vy_page_read_ahead *task = (struct vy_page_read_ahead *)base;
+	task->is_complete = true;
+	if (task->is_cancelled)
+		vy_page_read_ahead_delete(task);
+	else if (task->waiter != NULL)
+		fiber_wakeup(task->waiter);
+}
+
 /**
- * Read a page from disk given its number.
- * The function caches two most recently read pages.
+ * Send a request to read a page ahead to a reader thread.
+ * Errors are ignored, because the page will be read on
+ * demand anyway.
+ */
+static void
+vy_run_iterator_start_read_ahead(struct vy_run_iterator *itr,
+				 uint32_t page_no)
+{
+	struct vy_run *run = itr->slice->run;
+	struct vy_run_env *env = run->env;
+	assert(env->reader_pool != NULL);
+	assert(itr->read_ahead_count < VY_RUN_READ_AHEAD_MAX);
+
+	struct vy_page_read_ahead *task = mempool_alloc(&env->read_ahead_pool);
+	if (task == NULL)
+		return;
+	task->page = vy_page_new(vy_run_page_info(run, page_no));
+	if (task->page == NULL) {
+		diag_clear(diag_get());
+		mempool_free(&env->read_ahead_pool, task);
+		return;
+	}
+	task->page->page_no = page_no;
+	vy_run_ref(run);
+	task->run = run;
+	task->page_no = page_no;
+	task->rc = 0;
+	diag_create(&task->diag);
+	task->is_complete = false;
+	task->is_cancelled = false;
+	task->waiter = NULL;
+
+	/* Pick a reader thread. */
+	struct vy_run_reader *reader;
+	reader = &env->reader_pool[env->next_reader++];
+	env->next_reader %= env->reader_pool_size;
+
+	task->route[0].f = vy_page_read_ahead_perform;
+	task->route[0].pipe = &reader->tx_pipe;
+	task->route[1].f = vy_page_read_ahead_complete;
+	task->route[1].pipe = NULL;
+	cmsg_init(&task->base, task->route);
+	cpipe_push(&reader->reader_pipe, &task->base);
+
+	itr->read_ahead[itr->read_ahead_count++] = task;
+}
+
+/**
+ * Cancel the given number of pages read ahead by an iterator,
+ * starting from the first one.
+ */
+static void
+vy_run_iterator_cancel_read_ahead(struct vy_run_iterator *itr, int count)
+{
+	assert(count <= itr->read_ahead_count);
+	for (int i = 0; i < count; i++) {
+		struct vy_page_read_ahead *task = itr->read_ahead[i];
+		if (task->is_complete)
+			vy_page_read_ahead_delete(task);
+		else
+			task->is_cancelled = true;
+	}
+	itr->read_ahead_count -= count;
+	memmove(itr->read_ahead, itr->read_ahead + count,
+		itr->read_ahead_count * sizeof(itr->read_ahead[0]));
+}
+
+/**
+ * Take a page from the pages read ahead by an iterator, waiting
+ * for the read to complete if necessary. If the page isn't being
+ * read ahead, set @a result to NULL.
  *
  * @retval 0 success
- * @retval -1 critical error
+ * @retval -1 read error
  */
-static NODISCARD int
-vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
-			  struct vy_entry key, enum iterator_type iterator_type,
-			  struct vy_page **result, uint32_t *pos_in_page,
-			  bool *equal_found)
+static int
+vy_run_iterator_take_read_ahead(struct vy_run_iterator *itr, uint32_t page_no,
+				struct vy_page **result)
 {
-	struct vy_slice *slice = itr->slice;
-	struct vy_run_env *env = slice->run->env;
-
-	/* Check cache */
-	struct vy_page *page = NULL;
-	if (itr->curr_page != NULL &&
-	    itr->curr_page->page_no == page_no) {
-		page = itr->curr_page;
-	} else if (itr->prev_page != NULL &&
-		   itr->prev_page->page_no == page_no) {
-		SWAP(itr->prev_page, itr->curr_page);
-		page = itr->curr_page;
+	*result = NULL;
+	int i;
+	for (i = 0; i < itr->read_ahead_count; i++) {
+		if (itr->read_ahead[i]->page_no == page_no)
+			break;
 	}
-	if (page != NULL) {
-		if (key.stmt != NULL)
-			*pos_in_page = vy_page_find_key(page, key, itr->cmp_def,
-							itr->format, iterator_type,
-							equal_found);
-		*result = page;
+	if (i == itr->read_ahead_count)
 		return 0;
+	struct vy_page_read_ahead *task = itr->read_ahead[i];
+	itr->read_ahead_count--;
+	memmove(itr->read_ahead + i, itr->read_ahead + i + 1,
+		(itr->read_ahead_count - i) * sizeof(itr->read_ahead[0]));
+	if (!task->is_complete) {
+		task->waiter = fiber();
+		bool cancellable = fiber_set_cancellable(false);
+		while (!task->is_complete)
+			fiber_yield();
+		fiber_set_cancellable(cancellable);
+		task->waiter = NULL;
+	}
+	int rc = task->rc;
+	if (rc != 0) {
+		diag_move(&task->diag, diag_get());
+	} else {
+		*result = task->page;
+		task->page = NULL;
 	}
+	vy_page_read_ahead_delete(task);
+	return rc;
+}
+
+/**
+ * Called when an iterator loads a page that isn't among the two
+ * last pages. If the page follows the one loaded before, read
+ * the next pages of the slice ahead in reader threads, doubling
+ * the number of pages read ahead each time. Otherwise, cancel
+ * pages read ahead, because the access pattern isn't sequential.
+ */
+static void
+vy_run_iterator_read_ahead(struct vy_run_iterator *itr, uint32_t page_no)
+{
+	struct vy_slice *slice = itr->slice;
+	int dir = iterator_direction(itr->iterator_type);
+	bool is_sequential = itr->last_loaded_page_no != UINT32_MAX &&
+			     page_no == itr->last_loaded_page_no + dir;
+	itr->last_loaded_page_no = page_no;
+	if (!is_sequential || slice->run->env->reader_pool == NULL) {
+		vy_run_iterator_cancel_read_ahead(itr, itr->read_ahead_count);
+		itr->read_ahead_window = 0;
+		return;
+	}
+	itr->read_ahead_window = MIN(MAX(itr->read_ahead_window * 2, 1),
+				     VY_RUN_READ_AHEAD_MAX);
+	/*
+	 * Cancel pages that have been skipped, e.g. because
+	 * they were found in the page cache.
+	 */
+	int skipped = 0;
+	while (skipped < itr->read_ahead_count &&
+	       dir * ((int64_t)itr->read_ahead[skipped]->page_no -
+		      page_no) <= 0)
+		skipped++;
+	vy_run_iterator_cancel_read_ahead(itr, skipped);
+	uint32_t next_page_no = page_no + dir;
+	if (itr->read_ahead_count > 0) {
+		next_page_no = itr->read_ahead[itr->read_ahead_count - 1]->
+				page_no + dir;
+	}
+	while (itr->read_ahead_count < itr->read_ahead_window &&
+	       next_page_no >= slice->first_page_no &&
+	       next_page_no <= slice->last_page_no) {
+		int count = itr->read_ahead_count;
+		vy_run_iterator_start_read_ahead(itr, next_page_no);
+		if (itr->read_ahead_count == count)
+			break;
+		next_page_no += dir;
+	}
+}
+
+/**
+ * Make a page the current page of an iterator. The iterator
+ * takes over the caller's reference to the page.
+ */
+static void
+vy_run_iterator_cache_page(struct vy_run_iterator *itr, struct vy_page *page)
+{
+	if (itr->prev_page != NULL)
+		vy_page_unref(itr->prev_page);
+	itr->prev_page = itr->curr_page;
+	itr->curr_page = page;
+}
+
+/**
+ * Read a page from disk in a reader thread and look up a key
+ * in it if given.
+ *
+ * @retval the page read on success
+ * @retval NULL on error
+ */
+static struct vy_page *
+vy_run_iterator_read_page(struct vy_run_iterator *itr, uint32_t page_no,
+			  struct vy_entry key, enum iterator_type iterator_type,
+			  uint32_t *pos_in_page, bool *equal_found)
+{
+	struct vy_slice *slice = itr->slice;
+	struct vy_run_env *env = slice->run->env;
 
 	/* Allocate buffers */
 	struct vy_page_info *page_info = vy_run_page_info(slice->run, page_no);
-	page = vy_page_new(page_info);
+	struct vy_page *page = vy_page_new(page_info);
 	if (page == NULL)
-		return -1;
+		return NULL;
 
 	/* Read page data from the disk */
 	struct vy_page_read_task *task = mempool_alloc(&env->read_task_pool);
@@ -1042,7 +1602,7 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 		diag_set(OutOfMemory, sizeof(*task),
 			 "mempool", "vy_page_read_task");
 		vy_page_delete(page);
-		return -1;
+		return NULL;
 	}
 	task->run = slice->run;
 	task->page_info = page_info;
@@ -1062,22 +1622,94 @@ vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
 	mempool_free(&env->read_task_pool, task);
 	if (rc != 0) {
 		vy_page_delete(page);
-		return -1;
+		return NULL;
 	}
-
-	/* Update cache */
-	if (itr->prev_page != NULL)
-		vy_page_delete(itr->prev_page);
-	itr->prev_page = itr->curr_page;
-	itr->curr_page = page;
 	page->page_no = page_no;
+	return page;
+}
+
+/**
+ * Read a page from disk given its number.
+ * The function caches two most recently read pages.
+ * Pages are looked up in the shared page cache and among
+ * pages read ahead before reading them from disk.
+ *
+ * @retval 0 success
+ * @retval -1 critical error
+ */
+static NODISCARD int
+vy_run_iterator_load_page(struct vy_run_iterator *itr, uint32_t page_no,
+			  struct vy_entry key, enum iterator_type iterator_type,
+			  struct vy_page **result, uint32_t *pos_in_page,
+			  bool *equal_found)
+{
+	struct vy_slice *slice = itr->slice;
+	struct vy_run_env *env = slice->run->env;
+	struct vy_page_cache *page_cache = &env->page_cache;
+
+	/* Check cache */
+	struct vy_page *page = NULL;
+	if (itr->curr_page != NULL &&
+	    itr->curr_page->page_no == page_no) {
+		page = itr->curr_page;
+	} else if (itr->prev_page != NULL &&
+		   itr->prev_page->page_no == page_no) {
+		SWAP(itr->prev_page, itr->curr_page);
+		page = itr->curr_page;
+	}
+	if (page != NULL) {
+		if (key.stmt != NULL)
+			*pos_in_page = vy_page_find_key(page, key, itr->cmp_def,
+							itr->format, iterator_type,
+							equal_found);
+		*result = page;
+		return 0;
+	}
+
+	/* Check the page cache shared by all runs. */
+	if (page_cache->quota > 0)
+		page = vy_page_cache_get(page_cache, slice->run->id, page_no);
+	if (page != NULL) {
+		vy_page_ref(page);
+		if (key.stmt != NULL)
+			*pos_in_page = vy_page_find_key(page, key, itr->cmp_def,
+							itr->format, iterator_type,
+							equal_found);
+		vy_run_iterator_read_ahead(itr, page_no);
+		vy_run_iterator_cache_page(itr, page);
+		*result = page;
+		return 0;
+	}
+
+	/*
+	 * Check pages read ahead. They aren't added to the page
+	 * cache, because they are needed only for this iterator.
+	 */
+	if (vy_run_iterator_take_read_ahead(itr, page_no, &page) != 0)
+		return -1;
+	if (page == NULL) {
+		page = vy_run_iterator_read_page(itr, page_no, key,
+						 iterator_type, pos_in_page,
+						 equal_found);
+		if (page == NULL)
+			return -1;
+		if (page_cache->quota > 0)
+			vy_page_cache_put(page_cache, slice->run, page);
+	} else if (key.stmt != NULL) {
+		*pos_in_page = vy_page_find_key(page, key, itr->cmp_def,
+						itr->format, iterator_type,
+						equal_found);
+	}
 
 	/* Update read statistics. */
+	struct vy_page_info *page_info = vy_run_page_info(slice->run, page_no);
 	itr->stat->read.rows += page_info->row_count;
 	itr->stat->read.bytes += page_info->unpacked_size;
 	itr->stat->read.bytes_compressed += page_info->size;
 	itr->stat->read.pages++;
 
+	vy_run_iterator_read_ahead(itr, page_no);
+	vy_run_iterator_cache_page(itr, page);
 	*result = page;
 	return 0;
 }
@@ -1483,6 +2115,9 @@ vy_run_iterator_open(struct vy_run_iterator *itr,
 	itr->curr_page = NULL;
 	itr->prev_page = NULL;
 	itr->search_started = false;
+	itr->read_ahead_count = 0;
+	itr->read_ahead_window = 0;
+	itr->last_loaded_page_no = UINT32_MAX;
 
 	/*
 	 * Make sure the format we use to create tuples won't
@@ -1635,12 +2270,163 @@ void
 vy_run_iterator_close(struct vy_run_iterator *itr)
 {
 	vy_run_iterator_stop(itr);
+	vy_run_iterator_cancel_read_ahead(itr, itr->read_ahead_count);
 	tuple_format_unref(itr->format);
 	TRASH(itr);
 }
 
 /* }}} vy_run_iterator API implementation */
 
+/* {{{ Value references */
+
+/** Cbus task for reading values referenced by a statement. */
+struct vy_value_read_task {
+	/** parent */
+	struct cbus_call_msg base;
+	/** Value file descriptors, -1 if the value needn't be read. */
+	const int *fds;
+	/** References to the values. */
+	const struct vy_value_ref *refs;
+	/** [out] Buffers for the values. */
+	char **bufs;
+	/** Number of values. */
+	uint32_t count;
+};
+
+/** Read values, called in a reader thread. */
+static int
+vy_value_read_cb(struct cbus_call_msg *base)
+{
+	struct vy_value_read_task *task = (struct vy_value_read_task *)base;
+	for (uint32_t i = 0; i < task->count; i++) {
+		if (task->fds[i] >= 0 &&
+		    vy_value_read(task->fds[i], &task->refs[i],
+				  task->bufs[i]) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+/**
+ * Return the descriptor of the value file with the given ID
+ * opened by one of the given runs or -1 if none of the runs
+ * refers to the file.
+ */
+static int
+vy_run_find_value_fd(struct vy_run **runs, uint32_t run_count, int64_t id)
+{
+	for (uint32_t i = 0; i < run_count; i++) {
+		struct vy_run *run = runs[i];
+		for (uint32_t k = 0; k < run->info.value_file_count; k++) {
+			if (run->info.value_files[k].id == id)
+				return run->value_fds[k];
+		}
+	}
+	diag_set(ClientError, ER_INVALID_RUN_FILE,
+		 tt_sprintf("Unknown value file %lld", (long long)id));
+	return -1;
+}
+
+int
+vy_run_resolve_values(struct vy_run **runs, uint32_t run_count,
+		      struct vy_history *history)
+{
+	if (rlist_empty(&history->stmts))
+		return 0;
+	struct vy_history_node *node = rlist_last_entry(&history->stmts,
+					struct vy_history_node, link);
+	struct tuple *stmt = node->entry.stmt;
+	if ((vy_stmt_flags(stmt) & VY_STMT_VALUE_REF) == 0)
+		return 0;
+	assert(node->is_refable);
+	assert(run_count > 0);
+	struct vy_run_env *env = runs[0]->env;
+	struct vy_value_cache *cache = &env->value_cache;
+	struct region *region = &fiber()->gc;
+	size_t region_svp = region_used(region);
+	uint32_t bsize;
+	const char *data = tuple_data_range(stmt, &bsize);
+	const char *data_end = data + bsize;
+	struct vy_value_ref *refs;
+	uint32_t count;
+	if (vy_value_decode_refs(data, data_end, &refs, &count) != 0)
+		goto fail;
+	size_t size;
+	char **values = region_alloc_array(region, typeof(values[0]),
+					   count, &size);
+	if (values == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "values");
+		goto fail;
+	}
+	int *fds = region_alloc_array(region, typeof(fds[0]), count, &size);
+	if (fds == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "fds");
+		goto fail;
+	}
+	/*
+	 * Look up the values in the cache and find the files
+	 * storing the rest before yielding: the caller pins the
+	 * runs only while the statement is being read.
+	 */
+	uint32_t read_count = 0;
+	for (uint32_t i = 0; i < count; i++) {
+		values[i] = region_alloc(region, refs[i].size);
+		if (values[i] == NULL) {
+			diag_set(OutOfMemory, refs[i].size, "region", "value");
+			goto fail;
+		}
+		fds[i] = -1;
+		const char *value = NULL;
+		if (cache->quota > 0)
+			value = vy_value_cache_get(cache, &refs[i]);
+		if (value != NULL) {
+			memcpy(values[i], value, refs[i].size);
+			continue;
+		}
+		fds[i] = vy_run_find_value_fd(runs, run_count, refs[i].id);
+		if (fds[i] < 0)
+			goto fail;
+		read_count++;
+	}
+	if (read_count > 0) {
+		struct vy_value_read_task task;
+		task.fds = fds;
+		task.refs = refs;
+		task.bufs = values;
+		task.count = count;
+		if (vy_run_env_coio_call(env, &task.base,
+					 vy_value_read_cb) != 0)
+			goto fail;
+		for (uint32_t i = 0; i < count; i++) {
+			if (fds[i] >= 0 && cache->quota > 0)
+				vy_value_cache_put(cache, &refs[i], values[i]);
+		}
+	}
+	const char *res, *res_end;
+	if (vy_value_resolve(data, data_end, (const char **)values,
+			     &res, &res_end) != 0)
+		goto fail;
+	struct tuple *resolved;
+	if (vy_stmt_type(stmt) == IPROTO_INSERT)
+		resolved = vy_stmt_new_insert(tuple_format(stmt), res, res_end);
+	else
+		resolved = vy_stmt_new_replace(tuple_format(stmt),
+					       res, res_end);
+	if (resolved == NULL)
+		goto fail;
+	region_truncate(region, region_svp);
+	vy_stmt_set_lsn(resolved, vy_stmt_lsn(stmt));
+	vy_stmt_set_flags(resolved, vy_stmt_flags(stmt) & ~VY_STMT_VALUE_REF);
+	node->entry.stmt = resolved;
+	tuple_unref(stmt);
+	return 0;
+fail:
+	region_truncate(region, region_svp);
+	return -1;
+}
+
+/* }}} Value references */
+
 /** Account a page to run statistics. */
 static void
 vy_run_acct_page(struct vy_run *run, struct vy_page_info *page)
@@ -1768,6 +2554,8 @@ vy_run_recover(struct vy_run *run, const char *dir,
 	}
 	run->fd = cursor.fd;
 	xlog_cursor_close(&cursor, true);
+	if (vy_run_open_value_files(run, dir, space_id, iid) != 0)
+		goto fail;
 	return 0;
 
 fail_close:
@@ -1783,14 +2571,28 @@ fail:
 static int
 vy_run_dump_stmt(struct vy_entry entry, struct xlog *data_xlog,
 		 struct vy_page_info *info, struct key_def *key_def,
-		 bool is_primary)
+		 bool is_primary, struct vy_value_writer *values)
 {
 	struct xrow_header xrow;
-	int rc = (is_primary ?
-		  vy_stmt_encode_primary(entry.stmt, key_def, 0, &xrow) :
-		  vy_stmt_encode_secondary(entry.stmt, key_def,
-					   vy_entry_multikey_idx(entry, key_def),
-					   &xrow));
+	const char *data = NULL, *data_end = NULL;
+	bool is_value_ref = false;
+	enum iproto_type type = vy_stmt_type(entry.stmt);
+	if (values != NULL &&
+	    (type == IPROTO_REPLACE || type == IPROTO_INSERT) &&
+	    vy_value_writer_process(values, entry.stmt, &data, &data_end,
+				    &is_value_ref) != 0)
+		return -1;
+	int rc;
+	if (data != NULL)
+		rc = vy_stmt_encode_primary_data(entry.stmt, data, data_end,
+						 is_value_ref, &xrow);
+	else if (is_primary)
+		rc = vy_stmt_encode_primary(entry.stmt, key_def, 0, &xrow);
+	else
+		rc = vy_stmt_encode_secondary(entry.stmt, key_def,
+					      vy_entry_multikey_idx(entry,
+								    key_def),
+					      &xrow);
 	if (rc != 0)
 		return -1;
 
@@ -1990,6 +2792,8 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 	uint32_t key_count = 6;
 	if (run_info->bloom != NULL)
 		key_count++;
+	if (run_info->value_file_count > 0)
+		key_count++;
 
 	size_t size = mp_sizeof_map(key_count);
 	size += mp_sizeof_uint(VY_RUN_INFO_MIN_KEY) + min_key_size;
@@ -2000,11 +2804,40 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 		mp_sizeof_uint(run_info->max_lsn);
 	size += mp_sizeof_uint(VY_RUN_INFO_PAGE_COUNT) +
 		mp_sizeof_uint(run_info->page_count);
-	if (run_info->bloom != NULL)
+	/*
+	 * Use the key of the oldest format that can store the bloom
+	 * filter so that older versions can use it if possible.
+	 */
+	enum vy_run_info_key bloom_key = VY_RUN_INFO_BLOOM;
+	if (run_info->bloom != NULL &&
+	    tuple_bloom_is_blocked(run_info->bloom))
+		bloom_key = VY_RUN_INFO_BLOOM_BLOCKED;
+	else if (run_info->bloom != NULL &&
+		 run_info->bloom->hash_func != KEY_HASH_MURMUR3)
+		bloom_key = VY_RUN_INFO_BLOOM_HASHED;
+	bool bloom_has_hash_func = bloom_key != VY_RUN_INFO_BLOOM;
+	if (bloom_has_hash_func)
+		size += mp_sizeof_uint(bloom_key) +
+			mp_sizeof_array(2) +
+			mp_sizeof_uint(run_info->bloom->hash_func) +
+			tuple_bloom_size(run_info->bloom);
+	else if (run_info->bloom != NULL)
 		size += mp_sizeof_uint(VY_RUN_INFO_BLOOM) +
 			tuple_bloom_size(run_info->bloom);
 	size += mp_sizeof_uint(VY_RUN_INFO_STMT_STAT) +
 		vy_stmt_stat_sizeof(&run_info->stmt_stat);
+	if (run_info->value_file_count > 0) {
+		size += mp_sizeof_uint(VY_RUN_INFO_VALUE_FILES) +
+			mp_sizeof_array(run_info->value_file_count);
+		for (uint32_t i = 0; i < run_info->value_file_count; i++) {
+			const struct vy_value_file_info *file =
+						&run_info->value_files[i];
+			size += mp_sizeof_array(3) +
+				mp_sizeof_uint(file->id) +
+				mp_sizeof_uint(file->size) +
+				mp_sizeof_uint(file->ref_size);
+		}
+	}
 
 	char *pos = region_alloc(&fiber()->gc, size);
 	if (pos == NULL) {
@@ -2027,12 +2860,29 @@ vy_run_info_encode(const struct vy_run_info *run_info,
 	pos = mp_encode_uint(pos, run_info->max_lsn);
 	pos = mp_encode_uint(pos, VY_RUN_INFO_PAGE_COUNT);
 	pos = mp_encode_uint(pos, run_info->page_count);
-	if (run_info->bloom != NULL) {
+	if (bloom_has_hash_func) {
+		pos = mp_encode_uint(pos, bloom_key);
+		pos = mp_encode_array(pos, 2);
+		pos = mp_encode_uint(pos, run_info->bloom->hash_func);
+		pos = tuple_bloom_encode(run_info->bloom, pos);
+	} else if (run_info->bloom != NULL) {
 		pos = mp_encode_uint(pos, VY_RUN_INFO_BLOOM);
 		pos = tuple_bloom_encode(run_info->bloom, pos);
 	}
 	pos = mp_encode_uint(pos, VY_RUN_INFO_STMT_STAT);
 	pos = vy_stmt_stat_encode(&run_info->stmt_stat, pos);
+	if (run_info->value_file_count > 0) {
+		pos = mp_encode_uint(pos, VY_RUN_INFO_VALUE_FILES);
+		pos = mp_encode_array(pos, run_info->value_file_count);
+		for (uint32_t i = 0; i < run_info->value_file_count; i++) {
+			const struct vy_value_file_info *file =
+						&run_info->value_files[i];
+			pos = mp_encode_array(pos, 3);
+			pos = mp_encode_uint(pos, file->id);
+			pos = mp_encode_uint(pos, file->size);
+			pos = mp_encode_uint(pos, file->ref_size);
+		}
+	}
 	xrow->body->iov_len = (void *)pos - xrow->body->iov_base;
 	xrow->bodycnt = 1;
 	xrow->type = VY_INDEX_RUN_INFO;
@@ -2125,7 +2975,8 @@ vy_run_writer_create(struct vy_run_writer *writer, struct vy_run *run,
 	writer->bloom_fpr = bloom_fpr;
 	writer->no_compression = no_compression;
 	if (bloom_fpr < 1) {
-		writer->bloom = tuple_bloom_builder_new(key_def->part_count);
+		writer->bloom = tuple_bloom_builder_new(key_def->part_count,
+							key_def->hash_func);
 		if (writer->bloom == NULL)
 			return -1;
 	}
@@ -2231,7 +3082,8 @@ vy_run_writer_write_to_page(struct vy_run_writer *writer, struct vy_entry entry)
 	}
 	*offset = page->unpacked_size;
 	if (vy_run_dump_stmt(entry, &writer->data_xlog, page,
-			     writer->cmp_def, writer->iid == 0) != 0)
+			     writer->cmp_def, writer->iid == 0,
+			     writer->values) != 0)
 		return -1;
 	int64_t lsn = vy_stmt_lsn(entry.stmt);
 	run->info.min_lsn = MIN(run->info.min_lsn, lsn);
@@ -2366,6 +3218,17 @@ vy_run_writer_commit(struct vy_run_writer *writer)
 		if (run->info.bloom == NULL)
 			goto out;
 	}
+	if (writer->values != NULL) {
+		/* Sync value files before referring to them. */
+		if (vy_value_writer_commit(writer->values,
+					   &run->info.value_files,
+					   &run->info.value_file_count) != 0)
+			goto out;
+		if (vy_run_open_value_files(run, writer->dirpath,
+					    writer->space_id,
+					    writer->iid) != 0)
+			goto out;
+	}
 	if (vy_run_write_index(run, writer->dirpath,
 			       writer->space_id, writer->iid) != 0)
 		goto out;
@@ -2415,7 +3278,8 @@ vy_run_rebuild_index(struct vy_run *run, const char *dir,
 
 	struct tuple_bloom_builder *bloom_builder = NULL;
 	if (opts->bloom_fpr < 1) {
-		bloom_builder = tuple_bloom_builder_new(key_def->part_count);
+		bloom_builder = tuple_bloom_builder_new(key_def->part_count,
+							key_def->hash_func);
 		if (bloom_builder == NULL)
 			goto close_err;
 	}
@@ -2517,6 +3381,14 @@ vy_run_rebuild_index(struct vy_run *run, const char *dir,
 		bloom_builder = NULL;
 	}
 
+	if (iid == 0 &&
+	    vy_value_files_scan(dir, space_id, iid, run->id,
+				&run->info.value_files,
+				&run->info.value_file_count) != 0)
+		goto close_err;
+	if (vy_run_open_value_files(run, dir, space_id, iid) != 0)
+		goto close_err;
+
 	/* New run index is ready for write, unlink old file if exists */
 	vy_run_snprint_path(path, sizeof(path), dir,
 			    space_id, iid, run->id, VY_FILE_INDEX);
@@ -2551,6 +3423,20 @@ vy_run_remove_files(const char *dir, uint32_t space_id,
 				(long long)run_id); return -1;});
 	int ret = 0;
 	char path[PATH_MAX];
+	/*
+	 * Remove value file links in the reverse order so that
+	 * the remaining links can be found if we fail midway.
+	 */
+	uint32_t link_no = vy_value_files_count(dir, space_id, iid, run_id);
+	while (link_no-- > 0) {
+		vy_run_snprint_value_path(path, sizeof(path), dir,
+					  space_id, iid, run_id, link_no);
+		if (coio_unlink(path) < 0) {
+			say_syserror("error while removing %s", path);
+			return -1;
+		}
+		say_info("removed %s", path);
+	}
 	for (int type = 0; type < vy_file_MAX; type++) {
 		vy_run_snprint_path(path, sizeof(path), dir,
 				    space_id, iid, run_id, type);
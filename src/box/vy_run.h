@@ -40,6 +40,7 @@
 #include "vy_stmt_stream.h"
 #include "vy_read_view.h"
 #include "vy_stat.h"
+#include "vy_value_log.h"
 #include "index_def.h"
 #include "xlog.h"
 
@@ -51,6 +52,46 @@ extern "C" {
 
 struct vy_history;
 struct vy_run_reader;
+struct mh_vy_page_cache_t;
+
+/** Page cache statistics. */
+struct vy_page_cache_stat {
+	/** Number of lookups that found the page in the cache. */
+	int64_t hit;
+	/** Number of lookups that had to read the page from disk. */
+	int64_t miss;
+	/** Number of pages evicted from the cache. */
+	int64_t evict;
+};
+
+/**
+ * Cache of decompressed run pages shared by all LSM trees.
+ *
+ * Pages are evicted according to the segmented LRU policy.
+ * A page read from disk is first put to the probationary
+ * segment and moves to the protected segment only when it is
+ * hit again, while eviction starts from the probationary
+ * segment. This way a long range scan touching each page once
+ * can't wash the hot pages out of the cache.
+ *
+ * The cache is only accessed from the tx thread.
+ */
+struct vy_page_cache {
+	/** (run id, page no) -> struct vy_page. */
+	struct mh_vy_page_cache_t *hash;
+	/** Probationary segment, most recently used page first. */
+	struct rlist probation;
+	/** Protected segment, most recently used page first. */
+	struct rlist protected;
+	/** Max size of memory that may be used by cached pages. */
+	size_t quota;
+	/** Size of memory used by cached pages. */
+	size_t mem_used;
+	/** Size of memory used by pages of the protected segment. */
+	size_t protected_mem_used;
+	/** Cache statistics. */
+	struct vy_page_cache_stat stat;
+};
 
 /** Part of vinyl environment for run read/write */
 struct vy_run_env {
@@ -58,6 +99,8 @@ struct vy_run_env {
 	uint64_t snap_io_rate_limit;
 	/** Mempool for struct vy_page_read_task */
 	struct mempool read_task_pool;
+	/** Mempool for struct vy_page_read_ahead */
+	struct mempool read_ahead_pool;
 	/** Key for thread-local ZSTD context */
 	pthread_key_t zdctx_key;
 	/** Pool of threads used for reading run files. */
@@ -69,6 +112,10 @@ struct vy_run_env {
 	 * processing the next read request.
 	 */
 	int next_reader;
+	/** Cache of decompressed pages shared by all runs. */
+	struct vy_page_cache page_cache;
+	/** Cache of values read from value files. */
+	struct vy_value_cache value_cache;
 };
 
 /**
@@ -89,6 +136,13 @@ struct vy_run_info {
 	struct tuple_bloom *bloom;
 	/** Statement statistics. */
 	struct vy_stmt_stat stmt_stat;
+	/**
+	 * Value files referenced by the run, see vy_value_log.h.
+	 * The array index is the number of the run link to a file.
+	 */
+	struct vy_value_file_info *value_files;
+	/** Number of entries in @value_files. */
+	uint32_t value_file_count;
 };
 
 /**
@@ -123,6 +177,11 @@ struct vy_run {
 	struct vy_page_info *page_info;
 	/** Run data file. */
 	int fd;
+	/**
+	 * Descriptors of value files referenced by the run,
+	 * in the same order as vy_run_info::value_files.
+	 */
+	int *value_fds;
 	/** Unique ID of this run. */
 	int64_t id;
 	/** Number of statements in this run. */
@@ -146,6 +205,14 @@ struct vy_run {
 	 * it last time.
 	 */
 	uint32_t dump_count;
+	/**
+	 * Range tombstones with LSN less than or equal to this
+	 * value were applied to all statements of the range the
+	 * run was created for by major compaction. Persisted in
+	 * vylog so that vy_range::applied_tombstone_lsn can be
+	 * restored on recovery.
+	 */
+	int64_t applied_tombstone_lsn;
 	/**
 	 * Run reference counter, the run is deleted once it hits 0.
 	 * A new run is created with the reference counter set to 1.
@@ -168,6 +235,8 @@ struct vy_run {
 	struct rlist in_unused;
 	/** Link in vy_lsm::runs list. */
 	struct rlist in_lsm;
+	/** List of pages of this run stored in the page cache. */
+	struct rlist cached_pages;
 };
 
 /**
@@ -225,6 +294,13 @@ struct vy_run_iterator_pos {
 	uint32_t pos_in_page;
 };
 
+enum {
+	/** Max number of pages a run iterator may read ahead. */
+	VY_RUN_READ_AHEAD_MAX = 8,
+};
+
+struct vy_page_read_ahead;
+
 /**
  * Return statements from vy_run based on initial search key,
  * iteration order and view lsn.
@@ -281,6 +357,20 @@ struct vy_run_iterator {
 	struct vy_page *prev_page;
 	/** Is false until first .._get or .._next_.. method is called */
 	bool search_started;
+	/**
+	 * Pages being read ahead, in the iteration order. Reading
+	 * ahead starts when the iterator loads pages sequentially.
+	 */
+	struct vy_page_read_ahead *read_ahead[VY_RUN_READ_AHEAD_MAX];
+	/** Number of pages being read ahead. */
+	int read_ahead_count;
+	/**
+	 * Max number of pages to read ahead. Doubled each time
+	 * the iterator loads the next page, reset on a jump.
+	 */
+	int read_ahead_window;
+	/** Number of the page loaded last or UINT32_MAX. */
+	uint32_t last_loaded_page_no;
 };
 
 /**
@@ -297,6 +387,21 @@ struct vy_page {
 	uint32_t *row_index;
 	/** Pointer to the page data. */
 	char *data;
+	/**
+	 * Reference counter. A page is referenced by each run
+	 * iterator that uses it and by the page cache.
+	 */
+	int refs;
+	/** ID of the run the page belongs to. */
+	int64_t run_id;
+	/** Link in vy_page_cache::probation or protected list. */
+	struct rlist in_lru;
+	/** Link in vy_run::cached_pages list. */
+	struct rlist in_run;
+	/** Set if the page is in the page cache. */
+	bool is_cached;
+	/** Set if the page is in the protected segment of the cache. */
+	bool is_protected;
 };
 
 /**
@@ -330,6 +435,14 @@ vy_run_env_destroy(struct vy_run_env *env);
 void
 vy_run_env_enable_coio(struct vy_run_env *env);
 
+/**
+ * Set the max size of memory that may be used by the page cache.
+ * Pages are evicted from the cache if the new quota is less than
+ * the size of memory used by the cache. Zero disables the cache.
+ */
+void
+vy_run_env_set_page_cache_quota(struct vy_run_env *env, size_t quota);
+
 /**
  * Return the size of a run bloom filter.
  */
@@ -442,8 +555,25 @@ vy_run_snprint_path(char *buf, int size, const char *dir,
 }
 
 /**
- * Remove all files (data, index) corresponding to a run
- * with the given id. Return 0 on success, -1 if unlink()
+ * Format the path of a link to a value file referenced by
+ * a run, see vy_value_log.h.
+ */
+static inline int
+vy_run_snprint_value_path(char *buf, int size, const char *dir,
+			  uint32_t space_id, uint32_t iid,
+			  int64_t run_id, uint32_t link_no)
+{
+	int total = 0;
+	SNPRINT(total, vy_lsm_snprint_path, buf, size,
+		dir, (unsigned)space_id, (unsigned)iid);
+	SNPRINT(total, snprintf, buf, size, "/%020lld.%u.vlog",
+		(long long)run_id, (unsigned)link_no);
+	return total;
+}
+
+/**
+ * Remove all files (data, index, value file links) corresponding
+ * to a run with the given id. Return 0 on success, -1 if unlink()
  * failed.
  */
 int
@@ -548,6 +678,21 @@ vy_run_iterator_skip(struct vy_run_iterator *itr, struct vy_entry last,
 void
 vy_run_iterator_close(struct vy_run_iterator *itr);
 
+/**
+ * If the oldest statement of a key history read from disk refers
+ * to values stored in value files (see vy_value_log.h), replace
+ * it with a statement storing the values. The value files are
+ * looked up among the files referred to by the given runs, which
+ * must include the run the statement was read from and must be
+ * pinned by the caller. Values are read from the value cache or
+ * from disk by a reader thread, so the function may yield.
+ *
+ * Returns 0 on success, -1 on memory allocation or IO error.
+ */
+NODISCARD int
+vy_run_resolve_values(struct vy_run **runs, uint32_t run_count,
+		      struct vy_history *history);
+
 /**
  * Simple stream over a slice. @see vy_stmt_stream.
  */
@@ -627,6 +772,12 @@ struct vy_run_writer {
 	 * of max key of a finished run.
 	 */
 	struct vy_entry last;
+	/**
+	 * Writer used to separate values of primary index
+	 * statements or NULL if key-value separation is off.
+	 * Set by the caller after vy_run_writer_create().
+	 */
+	struct vy_value_writer *values;
 };
 
 /** Create a run writer to fill a run with statements. */
@@ -31,6 +31,7 @@
 #include "vy_scheduler.h"
 
 #include <assert.h>
+#include <math.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stddef.h>
@@ -55,7 +56,9 @@
 #include "vy_log.h"
 #include "vy_mem.h"
 #include "vy_range.h"
+#include "vy_range_tombstone.h"
 #include "vy_run.h"
+#include "vy_value_log.h"
 #include "vy_write_iterator.h"
 #include "trivia/util.h"
 
@@ -152,6 +155,21 @@ struct vy_task_ops {
 	void (*abort)(struct vy_task *task);
 };
 
+/**
+ * Compaction filter that drops tuples of a space with
+ * the expire_field option that have expired by the time
+ * the task was created, see vy_task_set_expire_filter().
+ */
+struct vy_expire_filter {
+	struct vy_compaction_filter base;
+	/** Number of the field storing the expiration time. */
+	uint32_t fieldno;
+	/** Time of the task creation, in seconds since the Epoch. */
+	double now;
+	/** Number of tuples dropped by the filter. */
+	int64_t drop_count;
+};
+
 struct vy_task {
 	/**
 	 * CBus message used for sending the task to/from
@@ -204,6 +222,28 @@ struct vy_task {
 	 */
 	double bloom_fpr;
 	int64_t page_size;
+	/**
+	 * Writer used to separate values of primary index
+	 * statements, see vy_value_log.h. NULL if the LSM tree
+	 * doesn't use key-value separation.
+	 */
+	struct vy_value_writer *values;
+	/**
+	 * Range tombstones applied by primary index compaction,
+	 * sorted by LSN in descending order, see
+	 * vy_range_tombstone.h. The task holds a reference to
+	 * each of them.
+	 */
+	struct vy_range_tombstone **range_tombstones;
+	int range_tombstone_count;
+	/** Filter dropping expired tuples of the primary index. */
+	struct vy_expire_filter expire_filter;
+	/**
+	 * Range tombstones with LSN less than or equal to this
+	 * value are applied to all statements of the range by
+	 * this compaction task, see vy_range::applied_tombstone_lsn.
+	 */
+	int64_t applied_tombstone_lsn;
 	/**
 	 * Deferred DELETE handler passed to the write iterator.
 	 * It sends deferred DELETE statements generated during
@@ -270,6 +310,11 @@ vy_task_delete(struct vy_task *task)
 {
 	assert(task->deferred_delete_batch == NULL);
 	assert(task->deferred_delete_in_progress == 0);
+	if (task->values != NULL)
+		vy_value_writer_delete(task->values);
+	for (int i = 0; i < task->range_tombstone_count; i++)
+		vy_range_tombstone_unref(task->range_tombstones[i]);
+	free(task->range_tombstones);
 	key_def_delete(task->cmp_def);
 	key_def_delete(task->key_def);
 	vy_lsm_unref(task->lsm);
@@ -410,6 +455,19 @@ vy_worker_pool_get(struct vy_worker_pool *pool)
 	return worker;
 }
 
+/**
+ * Return the number of idle workers in a pool.
+ */
+static int
+vy_worker_pool_idle_count(struct vy_worker_pool *pool)
+{
+	int count = 0;
+	struct vy_worker *worker;
+	stailq_foreach_entry(worker, &pool->idle_workers, in_idle)
+		count++;
+	return count;
+}
+
 /**
  * Put a worker back to the pool it was allocated from once
  * it's done its job.
@@ -464,6 +522,7 @@ vy_scheduler_create(struct vy_scheduler *scheduler, int write_threads,
 
 	vy_dump_heap_create(&scheduler->dump_heap);
 	vy_compaction_heap_create(&scheduler->compaction_heap);
+	rlist_create(&scheduler->value_gc_queue);
 
 	diag_create(&scheduler->diag);
 	fiber_cond_create(&scheduler->dump_cond);
@@ -519,6 +578,7 @@ vy_scheduler_on_delete_lsm(struct trigger *trigger, void *event)
 	assert(! heap_node_is_stray(&lsm->in_compaction));
 	vy_dump_heap_delete(&scheduler->dump_heap, lsm);
 	vy_compaction_heap_delete(&scheduler->compaction_heap, lsm);
+	rlist_del_entry(lsm, in_value_gc);
 	trigger_clear(trigger);
 	free(trigger);
 	return 0;
@@ -546,6 +606,13 @@ vy_scheduler_add_lsm(struct vy_scheduler *scheduler, struct vy_lsm *lsm)
 	 */
 	vy_dump_heap_insert(&scheduler->dump_heap, lsm);
 	vy_compaction_heap_insert(&scheduler->compaction_heap, lsm);
+	/*
+	 * Value files recovered from disk may need to be
+	 * collected, see vy_scheduler_peek_value_gc().
+	 */
+	if (lsm->index_id == 0)
+		rlist_add_tail_entry(&scheduler->value_gc_queue,
+				     lsm, in_value_gc);
 	return 0;
 }
 
@@ -1049,6 +1116,91 @@ vy_task_deferred_delete_iface = {
 	.destroy = vy_task_deferred_delete_destroy,
 };
 
+static bool
+vy_expire_filter_f(struct vy_compaction_filter *base, struct tuple *stmt)
+{
+	struct vy_expire_filter *filter = (struct vy_expire_filter *)base;
+	const char *field = tuple_field(stmt, filter->fieldno);
+	if (field == NULL)
+		return false;
+	/*
+	 * Integer fields are compared with the number of whole
+	 * seconds, like in memtx (see expire.c). Anything else,
+	 * including null and references to separated values,
+	 * never expires.
+	 */
+	bool is_expired;
+	switch (mp_typeof(*field)) {
+	case MP_UINT:
+		is_expired = mp_decode_uint(&field) <=
+			     (uint64_t)floor(filter->now);
+		break;
+	case MP_INT:
+		is_expired = mp_decode_int(&field) <=
+			     (int64_t)floor(filter->now);
+		break;
+	case MP_FLOAT:
+		is_expired = mp_decode_float(&field) <= filter->now;
+		break;
+	case MP_DOUBLE:
+		is_expired = mp_decode_double(&field) <= filter->now;
+		break;
+	default:
+		is_expired = false;
+		break;
+	}
+	if (is_expired)
+		filter->drop_count++;
+	return is_expired;
+}
+
+/**
+ * Invalidate the primary index cache after the statements
+ * written by a task were published if the task dropped any
+ * expired tuples, because the cache may still store them.
+ * For compaction, only the compacted range is invalidated.
+ */
+static void
+vy_task_invalidate_expired(struct vy_task *task)
+{
+	if (task->expire_filter.drop_count == 0)
+		return;
+	struct vy_range *range = task->range;
+	vy_cache_on_range_delete(&task->lsm->cache,
+				 range != NULL ? range->begin : vy_entry_none(),
+				 range != NULL ? range->end : vy_entry_none());
+}
+
+/**
+ * Make the write iterator of a primary index task drop tuples
+ * that have expired according to the space expire_field option.
+ * Expired tuples are dropped without writing DELETE statements
+ * so expiration of vinyl spaces doesn't cost extra writes. If
+ * the space has secondary indexes, deferred DELETEs must be
+ * generated for them, which is only possible on compaction
+ * (@a has_deferred_delete_handler is set), so dump doesn't
+ * expire such spaces.
+ */
+static void
+vy_task_set_expire_filter(struct vy_task *task, struct vy_stmt_stream *wi,
+			  bool has_deferred_delete_handler)
+{
+	struct vy_lsm *lsm = task->lsm;
+	if (lsm->index_id != 0)
+		return;
+	struct space *space = space_by_id(lsm->space_id);
+	if (space == NULL || space->def->opts.expire_field == UINT32_MAX)
+		return;
+	bool gen_deferred_delete = space->index_count > 1;
+	if (gen_deferred_delete && !has_deferred_delete_handler)
+		return;
+	struct vy_expire_filter *filter = &task->expire_filter;
+	filter->base.func = vy_expire_filter_f;
+	filter->fieldno = space->def->opts.expire_field;
+	filter->now = fiber_time();
+	vy_write_iterator_set_filter(wi, &filter->base, gen_deferred_delete);
+}
+
 static int
 vy_task_write_run(struct vy_task *task, bool no_compression)
 {
@@ -1069,6 +1221,7 @@ vy_task_write_run(struct vy_task *task, bool no_compression)
 				 task->page_size, task->bloom_fpr,
 				 no_compression) != 0)
 		goto fail;
+	writer.values = task->values;
 
 	if (wi->iface->start(wi) != 0)
 		goto fail_abort_writer;
@@ -1120,6 +1273,27 @@ vy_task_dump_execute(struct vy_task *task)
 	return vy_task_write_run(task, true);
 }
 
+/**
+ * Log range tombstones stored in the in-memory trees that are
+ * being dumped. Must be called within a vylog transaction.
+ */
+static void
+vy_task_dump_log_range_tombstones(struct vy_scheduler *scheduler,
+				  struct vy_lsm *lsm)
+{
+	struct vy_range_tombstone *t;
+	/* Log older tombstones first. */
+	rlist_foreach_entry_reverse(t, &lsm->range_tombstones, in_lsm) {
+		if (t->mem == NULL ||
+		    t->mem->generation > scheduler->dump_generation)
+			continue;
+		assert(t->lsn < MAX_LSN);
+		vy_log_insert_range_tombstone(lsm->id, t->id,
+				tuple_data_or_null(t->begin.stmt),
+				tuple_data_or_null(t->end.stmt), t->lsn);
+	}
+}
+
 static int
 vy_task_dump_complete(struct vy_task *task)
 {
@@ -1133,6 +1307,7 @@ vy_task_dump_complete(struct vy_task *task)
 	struct vy_mem *mem, *next_mem;
 	struct vy_slice **new_slices, *slice;
 	struct vy_range *range, *begin_range, *end_range;
+	struct vy_range_tombstone *t;
 	int i;
 
 	assert(lsm->is_dumping);
@@ -1145,6 +1320,7 @@ vy_task_dump_complete(struct vy_task *task)
 		 * to log LSM tree dump anyway.
 		 */
 		vy_log_tx_begin();
+		vy_task_dump_log_range_tombstones(scheduler, lsm);
 		vy_log_dump_lsm(lsm->id, dump_lsn);
 		if (vy_log_tx_commit() < 0)
 			goto fail;
@@ -1186,7 +1362,8 @@ vy_task_dump_complete(struct vy_task *task)
 	 * Log change in metadata.
 	 */
 	vy_log_tx_begin();
-	vy_log_create_run(lsm->id, new_run->id, dump_lsn, new_run->dump_count);
+	vy_log_create_run(lsm->id, new_run->id, dump_lsn,
+			  new_run->dump_count, 0);
 	for (range = begin_range, i = 0; range != end_range;
 	     range = vy_range_tree_next(&lsm->range_tree, range), i++) {
 		assert(i < lsm->range_count);
@@ -1195,6 +1372,7 @@ vy_task_dump_complete(struct vy_task *task)
 				    tuple_data_or_null(slice->begin.stmt),
 				    tuple_data_or_null(slice->end.stmt));
 	}
+	vy_task_dump_log_range_tombstones(scheduler, lsm);
 	vy_log_dump_lsm(lsm->id, dump_lsn);
 	if (vy_log_tx_commit() < 0)
 		goto fail_free_slices;
@@ -1226,6 +1404,18 @@ vy_task_dump_complete(struct vy_task *task)
 	free(new_slices);
 
 delete_mems:
+	/*
+	 * Range tombstones written to the dumped in-memory trees
+	 * are now stored in vylog. Force compaction of ranges they
+	 * intersect to reclaim space occupied by deleted statements.
+	 */
+	rlist_foreach_entry(t, &lsm->range_tombstones, in_lsm) {
+		if (t->mem == NULL ||
+		    t->mem->generation > scheduler->dump_generation)
+			continue;
+		t->mem = NULL;
+		vy_lsm_force_compaction_range_tombstone(lsm, t);
+	}
 	/*
 	 * Delete dumped in-memory trees and account dump in
 	 * LSM tree statistics.
@@ -1237,6 +1427,7 @@ delete_mems:
 		vy_stmt_counter_add(&dump_input, &mem->count);
 		vy_lsm_delete_mem(lsm, mem);
 	}
+	vy_task_invalidate_expired(task);
 	lsm->dump_lsn = MAX(lsm->dump_lsn, dump_lsn);
 	vy_lsm_acct_dump(lsm, dump_time, &dump_input, &dump_output);
 	/*
@@ -1309,6 +1500,84 @@ vy_task_dump_abort(struct vy_task *task)
  * On success the task is supposed to dump all in-memory
  * trees created at @scheduler->dump_generation.
  */
+/**
+ * Create a value writer for a primary index dump or compaction
+ * task if the LSM tree separates values or the compacted runs
+ * refer to values, see vy_value_log.h.
+ *
+ * A value file referenced by the compacted runs is linked to
+ * the output run unless less than a half of it is referenced
+ * by the LSM tree, in which case the values that are still in
+ * use are moved to a new value file so that the old file can
+ * be deleted along with the compacted runs.
+ */
+static int
+vy_task_create_value_writer(struct vy_task *task, struct vy_stmt_stream *wi)
+{
+	struct vy_lsm *lsm = task->lsm;
+	if (lsm->index_id != 0)
+		return 0;
+	uint32_t threshold = lsm->opts.value_log_threshold;
+	uint32_t input_count = 0;
+	struct vy_slice *slice = task->first_slice;
+	while (slice != NULL) {
+		input_count += slice->run->info.value_file_count;
+		if (slice == task->last_slice)
+			break;
+		slice = rlist_next_entry(slice, in_range);
+	}
+	if (threshold == 0 && input_count == 0)
+		return 0;
+
+	struct vy_value_input *inputs = NULL;
+	if (input_count > 0) {
+		inputs = calloc(input_count, sizeof(*inputs));
+		if (inputs == NULL) {
+			diag_set(OutOfMemory, input_count * sizeof(*inputs),
+				 "calloc", "struct vy_value_input");
+			return -1;
+		}
+	}
+	uint32_t n = 0;
+	slice = task->first_slice;
+	while (slice != NULL) {
+		struct vy_run *run = slice->run;
+		for (uint32_t i = 0; i < run->info.value_file_count; i++) {
+			struct vy_value_file_info *file =
+						&run->info.value_files[i];
+			uint32_t j;
+			for (j = 0; j < n; j++) {
+				if (inputs[j].id == file->id)
+					break;
+			}
+			if (j < n)
+				continue;
+			struct vy_value_input *input = &inputs[n++];
+			input->id = file->id;
+			input->size = file->size;
+			input->fd = run->value_fds[i];
+			input->run_id = run->id;
+			input->link_no = i;
+			input->needs_rewrite = threshold == 0 ||
+				vy_lsm_value_file_is_garbage(lsm, file);
+		}
+		if (slice == task->last_slice)
+			break;
+		slice = rlist_next_entry(slice, in_range);
+	}
+	task->values = vy_value_writer_new(lsm->env->path, lsm->space_id,
+					   lsm->index_id, task->new_run->id,
+					   threshold,
+					   lsm->mem_format->index_field_count,
+					   inputs, n);
+	if (task->values == NULL) {
+		free(inputs);
+		return -1;
+	}
+	vy_write_iterator_set_value_writer(wi, task->values);
+	return 0;
+}
+
 static int
 vy_task_dump_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 		 struct vy_lsm *lsm, struct vy_task **p_task)
@@ -1345,10 +1614,14 @@ vy_task_dump_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 		if (mem->generation > scheduler->dump_generation)
 			continue;
 		vy_mem_wait_pinned(mem);
-		if (mem->tree.size == 0) {
+		if (mem->tree.size == 0 &&
+		    !vy_lsm_mem_has_range_tombstones(lsm, mem)) {
 			/*
 			 * The tree is empty so we can delete it
 			 * right away, without involving a worker.
+			 * Range tombstones are logged on dump
+			 * completion so we can't do that if there
+			 * are any.
 			 */
 			vy_lsm_delete_mem(lsm, mem);
 			continue;
@@ -1397,6 +1670,9 @@ vy_task_dump_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	task->wi = wi;
 	task->bloom_fpr = lsm->opts.bloom_fpr;
 	task->page_size = lsm->opts.page_size;
+	if (vy_task_create_value_writer(task, wi) != 0)
+		goto err_wi_sub;
+	vy_task_set_expire_filter(task, wi, false);
 
 	lsm->is_dumping = true;
 	vy_scheduler_update_lsm(scheduler, lsm);
@@ -1431,6 +1707,93 @@ err:
 	return -1;
 }
 
+/**
+ * Pass committed range tombstones intersecting the range
+ * being compacted to the write iterator.
+ */
+static int
+vy_task_compaction_set_range_tombstones(struct vy_task *task,
+					struct vy_stmt_stream *wi)
+{
+	struct vy_lsm *lsm = task->lsm;
+	struct vy_range *range = task->range;
+	struct vy_range_tombstone *t;
+	/*
+	 * Tombstones are dumped in LSN order. If major compaction
+	 * starts after a tombstone was dumped, all statements
+	 * covered by it are stored in the compacted runs, and
+	 * so the range won't need it once the compaction is over.
+	 */
+	if (range->compaction_priority == range->slice_count) {
+		rlist_foreach_entry(t, &lsm->range_tombstones, in_lsm) {
+			if (t->mem == NULL) {
+				task->applied_tombstone_lsn = t->lsn;
+				break;
+			}
+		}
+	}
+	int count = 0;
+	rlist_foreach_entry(t, &lsm->range_tombstones, in_lsm) {
+		if (t->lsn < MAX_LSN &&
+		    vy_range_tombstone_intersects(t, range->begin,
+						  range->end, lsm->cmp_def))
+			count++;
+	}
+	if (count == 0)
+		return 0;
+	size_t size = count * sizeof(*task->range_tombstones);
+	task->range_tombstones = malloc(size);
+	if (task->range_tombstones == NULL) {
+		diag_set(OutOfMemory, size, "malloc",
+			 "struct vy_range_tombstone *");
+		return -1;
+	}
+	rlist_foreach_entry(t, &lsm->range_tombstones, in_lsm) {
+		if (t->lsn < MAX_LSN &&
+		    vy_range_tombstone_intersects(t, range->begin,
+						  range->end, lsm->cmp_def)) {
+			vy_range_tombstone_ref(t);
+			task->range_tombstones[
+				task->range_tombstone_count++] = t;
+		}
+	}
+	assert(task->range_tombstone_count == count);
+	/*
+	 * Secondary indexes aren't updated on range deletion
+	 * so we need to generate deferred DELETEs for them.
+	 */
+	struct space *space = space_by_id(lsm->space_id);
+	bool gen_deferred_delete = space != NULL && space->index_count > 1;
+	vy_write_iterator_set_range_tombstones(wi, task->range_tombstones,
+					       count, gen_deferred_delete);
+	return 0;
+}
+
+/**
+ * Drop range tombstones applied by a compaction task if
+ * there are no more run slices that may store statements
+ * covered by them.
+ */
+static void
+vy_task_compaction_gc_range_tombstones(struct vy_task *task)
+{
+	struct vy_lsm *lsm = task->lsm;
+	for (int i = 0; i < task->range_tombstone_count; i++) {
+		struct vy_range_tombstone *t = task->range_tombstones[i];
+		if (rlist_empty(&t->in_lsm) ||
+		    !vy_lsm_range_tombstone_is_obsolete(lsm, t))
+			continue;
+		vy_log_tx_begin();
+		vy_log_delete_range_tombstone(t->id);
+		if (vy_log_tx_commit() != 0) {
+			/* Not critical, will retry on next compaction. */
+			diag_log();
+			continue;
+		}
+		vy_lsm_remove_range_tombstone(lsm, t);
+	}
+}
+
 static int
 vy_task_compaction_execute(struct vy_task *task)
 {
@@ -1499,8 +1862,10 @@ vy_task_compaction_complete(struct vy_task *task)
 	rlist_foreach_entry(run, &unused_runs, in_unused)
 		vy_log_drop_run(run->id, VY_LOG_GC_LSN_CURRENT);
 	if (new_slice != NULL) {
+		new_run->applied_tombstone_lsn = task->applied_tombstone_lsn;
 		vy_log_create_run(lsm->id, new_run->id, new_run->dump_lsn,
-				  new_run->dump_count);
+				  new_run->dump_count,
+				  new_run->applied_tombstone_lsn);
 		vy_log_insert_slice(range->id, new_run->id, new_slice->id,
 				    tuple_data_or_null(new_slice->begin.stmt),
 				    tuple_data_or_null(new_slice->end.stmt));
@@ -1561,6 +1926,8 @@ vy_task_compaction_complete(struct vy_task *task)
 			break;
 	}
 	range->n_compactions++;
+	range->applied_tombstone_lsn = MAX(range->applied_tombstone_lsn,
+					   task->applied_tombstone_lsn);
 	vy_range_update_compaction_priority(range, &lsm->opts);
 	vy_range_update_dumps_per_compaction(range);
 	vy_lsm_acct_range(lsm, range);
@@ -1580,6 +1947,7 @@ vy_task_compaction_complete(struct vy_task *task)
 		vy_slice_wait_pinned(slice);
 		vy_slice_delete(slice);
 	}
+	vy_task_invalidate_expired(task);
 
 	/* The iterator has been cleaned up in worker. */
 	task->wi->iface->close(task->wi);
@@ -1588,6 +1956,16 @@ vy_task_compaction_complete(struct vy_task *task)
 	vy_range_heap_insert(&lsm->range_heap, range);
 	vy_scheduler_update_lsm(scheduler, lsm);
 
+	vy_task_compaction_gc_range_tombstones(task);
+
+	/*
+	 * Compaction may have dropped references to values so
+	 * check if any value files need to be collected now.
+	 */
+	if (task->values != NULL && rlist_empty(&lsm->in_value_gc))
+		rlist_add_tail_entry(&scheduler->value_gc_queue,
+				     lsm, in_value_gc);
+
 	say_info("%s: completed compacting range %s",
 		 vy_lsm_name(lsm), vy_range_str(range));
 	return 0;
@@ -1627,13 +2005,24 @@ vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 
 	struct vy_range *range = vy_range_heap_top(&lsm->range_heap);
 	assert(range != NULL);
-	assert(range->compaction_priority > 1);
+	assert(range->compaction_priority > 1 ||
+	       vy_range_needs_rewrite(range));
 
 	if (vy_lsm_split_range(lsm, range) ||
 	    vy_lsm_coalesce_range(lsm, range)) {
 		vy_scheduler_update_lsm(scheduler, lsm);
 		return 0;
 	}
+	/*
+	 * If there are idle workers, split a big range so that
+	 * its parts are compacted by them in parallel rather
+	 * than one by one by this worker.
+	 */
+	int max_parts = vy_worker_pool_idle_count(worker->pool) + 1;
+	if (vy_lsm_split_range_for_compaction(lsm, range, max_parts)) {
+		vy_scheduler_update_lsm(scheduler, lsm);
+		return 0;
+	}
 
 	struct vy_task *task = vy_task_new(scheduler, worker, lsm,
 					   &compaction_ops);
@@ -1680,18 +2069,26 @@ vy_task_compaction_new(struct vy_scheduler *scheduler, struct vy_worker *worker,
 	 * was triggered manually to avoid unexpected side effects,
 	 * such as splitting/coalescing ranges for no good reason.
 	 */
-	if (range->needs_compaction)
+	if (range->needs_compaction || vy_range_needs_rewrite(range))
 		new_run->dump_count = slice->run->dump_count;
 	else
 		new_run->dump_count = dump_count;
 
-	range->needs_compaction = false;
-
 	task->range = range;
 	task->new_run = new_run;
 	task->wi = wi;
 	task->bloom_fpr = lsm->opts.bloom_fpr;
 	task->page_size = lsm->opts.page_size;
+	if (vy_task_create_value_writer(task, wi) != 0)
+		goto err_wi_sub;
+	if (lsm->index_id == 0 &&
+	    vy_task_compaction_set_range_tombstones(task, wi) != 0)
+		goto err_wi_sub;
+	vy_task_set_expire_filter(task, wi, true);
+
+	range->needs_compaction = false;
+	range->needs_value_gc = false;
+	range->needs_tombstone_gc = false;
 
 	/*
 	 * Remove the range we are going to compact from the heap
@@ -1879,9 +2276,10 @@ no_task:
  * workers are currently busy, @ptask is set to NULL.
  *
  * We compact ranges that have more runs in a level than specified
- * by run_count_per_level configuration option. Among those runs we
- * give preference to those ranges whose compaction will reduce
- * read amplification most.
+ * by run_count_per_level configuration option or, if the LSM tree
+ * uses the leveled compaction strategy, ranges that have a level
+ * grown too big. Among those runs we give preference to those ranges
+ * whose compaction will reduce read amplification most.
  *
  * Returns 0 on success, -1 on failure.
  */
@@ -1895,7 +2293,8 @@ retry:
 	struct vy_lsm *lsm = vy_compaction_heap_top(&scheduler->compaction_heap);
 	if (lsm == NULL)
 		goto no_task; /* nothing to do */
-	if (vy_lsm_compaction_priority(lsm) <= 1)
+	if (vy_lsm_compaction_priority(lsm) <= 1 &&
+	    !vy_range_needs_rewrite(vy_range_heap_top(&lsm->range_heap)))
 		goto no_task; /* nothing to do */
 	if (worker == NULL) {
 		worker = vy_worker_pool_get(&scheduler->compaction_pool);
@@ -1915,6 +2314,44 @@ no_task:
 	return 0;
 }
 
+/**
+ * Collect garbage in value files, see vy_value_log.h.
+ *
+ * Compaction moves values out of a value file only if the file
+ * is mostly garbage, otherwise it links the file to the output
+ * run. So after a range is compacted, a value file linked to it
+ * may turn into garbage, while other ranges referring to the
+ * file may be never compacted again. To reclaim disk space,
+ * after each compaction of a primary index we look for such
+ * files and force compaction of ranges referring to them, one
+ * range at a time, even if a range consists of a single run.
+ *
+ * Returns 0 on success, -1 on failure.
+ */
+static int
+vy_scheduler_peek_value_gc(struct vy_scheduler *scheduler,
+			   struct vy_task **ptask)
+{
+	*ptask = NULL;
+	while (!rlist_empty(&scheduler->value_gc_queue)) {
+		struct vy_lsm *lsm = rlist_first_entry(
+				&scheduler->value_gc_queue,
+				struct vy_lsm, in_value_gc);
+		rlist_del_entry(lsm, in_value_gc);
+		if (lsm->is_dropped || !vy_lsm_schedule_value_gc(lsm))
+			continue;
+		/*
+		 * There may be more ranges to collect. Check them
+		 * when this one is scheduled.
+		 */
+		rlist_add_tail_entry(&scheduler->value_gc_queue,
+				     lsm, in_value_gc);
+		vy_scheduler_update_lsm(scheduler, lsm);
+		return vy_scheduler_peek_compaction(scheduler, ptask);
+	}
+	return 0;
+}
+
 static int
 vy_schedule(struct vy_scheduler *scheduler, struct vy_task **ptask)
 {
@@ -1930,6 +2367,11 @@ vy_schedule(struct vy_scheduler *scheduler, struct vy_task **ptask)
 	if (*ptask != NULL)
 		goto found;
 
+	if (vy_scheduler_peek_value_gc(scheduler, ptask) != 0)
+		goto fail;
+	if (*ptask != NULL)
+		goto found;
+
 	/* no task to run */
 	return 0;
 found:
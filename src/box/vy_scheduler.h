@@ -89,6 +89,12 @@ struct vy_scheduler {
 	 * linked by vy_lsm::in_compaction.
 	 */
 	heap_t compaction_heap;
+	/**
+	 * Primary LSM trees that may refer to value files that
+	 * are mostly garbage, linked by vy_lsm::in_value_gc.
+	 * See vy_scheduler_peek_value_gc().
+	 */
+	struct rlist value_gc_queue;
 	/** Last error seen by the scheduler. */
 	struct diag diag;
 	/**
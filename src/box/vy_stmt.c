@@ -70,6 +70,12 @@ vy_stmt_persistent_flags(struct tuple *stmt, bool is_primary)
 	 */
 	mask &= ~VY_STMT_UPDATE;
 
+	/*
+	 * This flag is only set for statements that are written
+	 * with separated values, see vy_stmt_encode_primary_data().
+	 */
+	mask &= ~VY_STMT_VALUE_REF;
+
 	if (!is_primary) {
 		/*
 		 * Do not store VY_STMT_DEFERRED_DELETE flag in
@@ -141,7 +147,7 @@ vy_stmt_format_new(struct vy_stmt_env *env, struct key_def *const *keys,
 {
 	return tuple_format_new(&env->tuple_format_vtab, env, keys, key_count,
 				fields, field_count, exact_field_count, dict,
-				false, false);
+				false, false, false);
 }
 
 /**
@@ -583,14 +589,14 @@ vy_bloom_maybe_has(const struct tuple_bloom *bloom,
 }
 
 /**
- * Encode the given statement meta data in a request.
+ * Encode statement flags in the meta data of a request.
  * Returns 0 on success, -1 on memory allocation error.
  */
 static int
-vy_stmt_meta_encode(struct tuple *stmt, struct request *request,
-		    bool is_primary)
+vy_stmt_meta_encode_flags(uint8_t flags, struct request *request)
 {
-	uint8_t flags = vy_stmt_persistent_flags(stmt, is_primary);
+	request->tuple_meta = NULL;
+	request->tuple_meta_end = NULL;
 	if (flags == 0)
 		return 0; /* nothing to encode */
 
@@ -610,28 +616,49 @@ vy_stmt_meta_encode(struct tuple *stmt, struct request *request,
 }
 
 /**
- * Decode statement meta data from a request.
+ * Encode the given statement meta data in a request.
+ * Returns 0 on success, -1 on memory allocation error.
  */
-static void
-vy_stmt_meta_decode(struct request *request, struct tuple *stmt)
+static int
+vy_stmt_meta_encode(struct tuple *stmt, struct request *request,
+		    bool is_primary)
+{
+	uint8_t flags = vy_stmt_persistent_flags(stmt, is_primary);
+	return vy_stmt_meta_encode_flags(flags, request);
+}
+
+/** Decode statement flags from the meta data of a request. */
+static uint8_t
+vy_stmt_meta_decode_flags(const struct request *request)
 {
 	const char *data = request->tuple_meta;
 	if (data == NULL)
-		return; /* nothing to decode */
+		return 0; /* nothing to decode */
 
+	uint8_t flags = 0;
 	uint32_t size = mp_decode_map(&data);
 	for (uint32_t i = 0; i < size; i++) {
 		uint64_t key = mp_decode_uint(&data);
 		switch (key) {
-		case VY_STMT_FLAGS: {
-			uint64_t flags = mp_decode_uint(&data);
-			vy_stmt_set_flags(stmt, flags);
+		case VY_STMT_FLAGS:
+			flags = mp_decode_uint(&data);
 			break;
-		}
 		default:
 			mp_next(&data); /* unknown key, ignore */
 		}
 	}
+	return flags;
+}
+
+/**
+ * Decode statement meta data from a request.
+ */
+static void
+vy_stmt_meta_decode(struct request *request, struct tuple *stmt)
+{
+	if (request->tuple_meta == NULL)
+		return; /* nothing to decode */
+	vy_stmt_set_flags(stmt, vy_stmt_meta_decode_flags(request));
 }
 
 int
@@ -683,6 +710,33 @@ vy_stmt_encode_primary(struct tuple *value, struct key_def *key_def,
 	return 0;
 }
 
+int
+vy_stmt_encode_primary_data(struct tuple *value, const char *data,
+			    const char *data_end, bool is_value_ref,
+			    struct xrow_header *xrow)
+{
+	memset(xrow, 0, sizeof(*xrow));
+	enum iproto_type type = vy_stmt_type(value);
+	assert(type == IPROTO_REPLACE || type == IPROTO_INSERT);
+	xrow->type = type;
+	xrow->lsn = vy_stmt_lsn(value);
+
+	struct request request;
+	memset(&request, 0, sizeof(request));
+	request.type = type;
+	request.tuple = data;
+	request.tuple_end = data_end;
+	uint8_t flags = vy_stmt_persistent_flags(value, true);
+	if (is_value_ref)
+		flags |= VY_STMT_VALUE_REF;
+	if (vy_stmt_meta_encode_flags(flags, &request) != 0)
+		return -1;
+	xrow->bodycnt = xrow_encode_dml(&request, &fiber()->gc, xrow->body);
+	if (xrow->bodycnt < 0)
+		return -1;
+	return 0;
+}
+
 int
 vy_stmt_encode_secondary(struct tuple *value, struct key_def *cmp_def,
 			 int multikey_idx, struct xrow_header *xrow)
@@ -48,6 +48,7 @@ extern "C" {
 #endif /* defined(__cplusplus) */
 
 struct xrow_header;
+struct request;
 struct region;
 struct tuple_format;
 struct tuple_dictionary;
@@ -136,11 +137,19 @@ enum {
 	 * compaction. It is never written to disk.
 	 */
 	VY_STMT_UPDATE			= 1 << 2,
+	/**
+	 * This flag is set for primary index REPLACE and INSERT
+	 * statements that store references to values instead of
+	 * the values themselves, see vy_value_log.h. Statements
+	 * read from disk may have it until they are resolved by
+	 * vy_run_resolve_values().
+	 */
+	VY_STMT_VALUE_REF		= 1 << 3,
 	/**
 	 * Bit mask of all statement flags.
 	 */
 	VY_STMT_FLAGS_ALL = (VY_STMT_DEFERRED_DELETE | VY_STMT_SKIP_READ |
-			     VY_STMT_UPDATE),
+			     VY_STMT_UPDATE | VY_STMT_VALUE_REF),
 };
 
 /**
@@ -653,6 +662,26 @@ int
 vy_stmt_encode_primary(struct tuple *value, struct key_def *key_def,
 		       uint32_t space_id, struct xrow_header *xrow);
 
+/**
+ * Encode a primary key REPLACE or INSERT statement as xrow_header
+ * storing the given tuple data instead of the statement data.
+ * Used to write statements with separated values.
+ *
+ * @param value statement to encode
+ * @param data tuple data to store
+ * @param data_end end of @a data
+ * @param is_value_ref set if @a data refers to values, in which
+ * case the statement is marked with VY_STMT_VALUE_REF.
+ * @param xrow[out] xrow to fill
+ *
+ * @retval 0 if OK
+ * @retval -1 if error
+ */
+int
+vy_stmt_encode_primary_data(struct tuple *value, const char *data,
+			    const char *data_end, bool is_value_ref,
+			    struct xrow_header *xrow);
+
 /**
  * Encode vy_stmt for a secondary key as xrow_header
  *
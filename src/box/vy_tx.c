@@ -54,6 +54,7 @@
 #include "vy_cache.h"
 #include "vy_lsm.h"
 #include "vy_mem.h"
+#include "vy_range_tombstone.h"
 #include "vy_stat.h"
 #include "vy_stmt.h"
 #include "vy_upsert.h"
@@ -330,6 +331,8 @@ vy_tx_create(struct vy_tx_manager *xm, struct vy_tx *tx)
 	tx->read_view = (struct vy_read_view *)xm->p_global_read_view;
 	vy_tx_read_set_new(&tx->read_set);
 	tx->psn = 0;
+	tx->range_tombstone = NULL;
+	tx->range_tombstone_lsm = NULL;
 	rlist_create(&tx->on_destroy);
 	rlist_create(&tx->in_writers);
 }
@@ -348,6 +351,11 @@ vy_tx_destroy(struct vy_tx *tx)
 
 	vy_tx_read_set_iter(&tx->read_set, NULL, vy_tx_read_set_free_cb, NULL);
 	rlist_del_entry(tx, in_writers);
+
+	if (tx->range_tombstone != NULL) {
+		vy_range_tombstone_unref(tx->range_tombstone);
+		vy_lsm_unref(tx->range_tombstone_lsm);
+	}
 }
 
 /** Mark a transaction as aborted and account it in stats. */
@@ -363,7 +371,8 @@ vy_tx_abort(struct vy_tx *tx)
 static bool
 vy_tx_is_ro(struct vy_tx *tx)
 {
-	return write_set_empty(&tx->write_set);
+	return write_set_empty(&tx->write_set) &&
+	       tx->range_tombstone == NULL;
 }
 
 /** Return true if the transaction is in read view. */
@@ -401,6 +410,64 @@ vy_tx_send_to_read_view(struct vy_tx *tx, struct txv *v)
 	return 0;
 }
 
+/**
+ * Return true if a read interval may intersect the interval
+ * deleted by a range tombstone. Partial keys that are equal by
+ * prefix are considered intersecting.
+ */
+static bool
+vy_tx_range_tombstone_conflicts(struct vy_range_tombstone *t,
+				struct vy_read_interval *interval,
+				struct key_def *cmp_def)
+{
+	if (t->begin.stmt != NULL &&
+	    vy_entry_compare(interval->right, t->begin, cmp_def) < 0)
+		return false;
+	if (t->end.stmt != NULL &&
+	    vy_entry_compare(interval->left, t->end, cmp_def) > 0)
+		return false;
+	return true;
+}
+
+/**
+ * Send to read view all transactions that are reading keys
+ * deleted by the range tombstone written by transaction @tx.
+ * If @is_rollback is set, abort them instead.
+ */
+static int
+vy_tx_send_to_read_view_range(struct vy_tx *tx, bool is_rollback)
+{
+	struct vy_lsm *lsm = tx->range_tombstone_lsm;
+	struct vy_range_tombstone *t = tx->range_tombstone;
+	struct vy_read_interval *interval;
+	for (interval = vy_lsm_read_set_first(&lsm->read_set);
+	     interval != NULL;
+	     interval = vy_lsm_read_set_next(&lsm->read_set, interval)) {
+		struct vy_tx *abort = interval->tx;
+		/* Don't abort self. */
+		if (abort == tx)
+			continue;
+		/* Abort only active TXs */
+		if (abort->state != VINYL_TX_READY)
+			continue;
+		if (!vy_tx_range_tombstone_conflicts(t, interval,
+						     lsm->cmp_def))
+			continue;
+		if (is_rollback) {
+			vy_tx_abort(abort);
+			continue;
+		}
+		/* already in (earlier) read view */
+		if (vy_tx_is_in_read_view(abort))
+			continue;
+		struct vy_read_view *rv = vy_tx_manager_read_view(tx->xm);
+		if (rv == NULL)
+			return -1;
+		abort->read_view = rv;
+	}
+	return 0;
+}
+
 /**
  * Abort all transaction that are reading key @v modified
  * by transaction @tx.
@@ -443,11 +510,9 @@ vy_tx_begin(struct vy_tx_manager *xm)
  * Rotate the active in-memory tree if necessary and pin it to make
  * sure it is not dumped until the transaction is complete.
  */
-static int
-vy_tx_write_prepare(struct txv *v)
+static struct vy_mem *
+vy_tx_pin_mem(struct vy_lsm *lsm)
 {
-	struct vy_lsm *lsm = v->lsm;
-
 	/*
 	 * Allocate a new in-memory tree if either of the following
 	 * conditions is true:
@@ -463,10 +528,39 @@ vy_tx_write_prepare(struct txv *v)
 	if (unlikely(lsm->mem->space_cache_version != space_cache_version ||
 		     lsm->mem->generation != *lsm->env->p_generation)) {
 		if (vy_lsm_rotate_mem(lsm) != 0)
-			return -1;
+			return NULL;
 	}
 	vy_mem_pin(lsm->mem);
-	v->mem = lsm->mem;
+	return lsm->mem;
+}
+
+static int
+vy_tx_write_prepare(struct txv *v)
+{
+	v->mem = vy_tx_pin_mem(v->lsm);
+	return v->mem != NULL ? 0 : -1;
+}
+
+/**
+ * Add the range tombstone written by a transaction to the LSM
+ * tree and invalidate the cache. The tombstone is attached to
+ * the active in-memory tree, which is pinned until the
+ * transaction is complete.
+ */
+static int
+vy_tx_prepare_range_tombstone(struct vy_tx *tx)
+{
+	struct vy_lsm *lsm = tx->range_tombstone_lsm;
+	struct vy_range_tombstone *t = tx->range_tombstone;
+	if (vy_tx_send_to_read_view_range(tx, false) != 0)
+		return -1;
+	t->mem = vy_tx_pin_mem(lsm);
+	if (t->mem == NULL)
+		return -1;
+	t->lsn = MAX_LSN + tx->psn;
+	vy_range_tombstone_ref(t);
+	vy_lsm_add_range_tombstone(lsm, t);
+	vy_cache_on_range_delete(&lsm->cache, t->begin, t->end);
 	return 0;
 }
 
@@ -697,6 +791,10 @@ vy_tx_prepare(struct vy_tx *tx)
 			return -1;
 	}
 
+	if (tx->range_tombstone != NULL &&
+	    vy_tx_prepare_range_tombstone(tx) != 0)
+		return -1;
+
 	/*
 	 * Flush transactional changes to the LSM tree.
 	 * Sic: the loop below must not yield after recovery.
@@ -821,6 +919,13 @@ vy_tx_commit(struct vy_tx *tx, int64_t lsn)
 			vy_mem_unpin(v->mem);
 	}
 
+	struct vy_range_tombstone *t = tx->range_tombstone;
+	if (t != NULL && t->mem != NULL) {
+		t->lsn = lsn;
+		t->mem->dump_lsn = MAX(t->mem->dump_lsn, lsn);
+		vy_mem_unpin(t->mem);
+	}
+
 	/* Update read views of dependant transactions. */
 	if (tx->read_view != &xm->global_read_view)
 		tx->read_view->vlsn = lsn;
@@ -869,6 +974,17 @@ vy_tx_rollback_after_prepare(struct vy_tx *tx)
 			vy_mem_unpin(v->mem);
 	}
 
+	struct vy_range_tombstone *t = tx->range_tombstone;
+	if (t != NULL && t->mem != NULL) {
+		struct vy_lsm *lsm = tx->range_tombstone_lsm;
+		vy_mem_unpin(t->mem);
+		t->mem = NULL;
+		/* The cache may store statements read in between. */
+		vy_cache_on_range_delete(&lsm->cache, t->begin, t->end);
+		vy_lsm_remove_range_tombstone(lsm, t);
+		vy_tx_send_to_read_view_range(tx, true);
+	}
+
 	struct write_set_iterator it;
 	write_set_ifirst(&tx->write_set, &it);
 	while ((v = write_set_inext(&it)) != NULL) {
@@ -898,6 +1014,16 @@ vy_tx_begin_statement(struct vy_tx *tx, struct space *space, void **savepoint)
 		return -1;
 	}
 	assert(tx->state == VINYL_TX_READY);
+	if (tx->range_tombstone != NULL) {
+		/*
+		 * Readers of the transaction don't see the tombstone
+		 * until it's prepared so it must be the only statement
+		 * of the transaction.
+		 */
+		diag_set(ClientError, ER_MULTISTATEMENT_TRANSACTION,
+			 "index.delete_range");
+		return -1;
+	}
 	tx->last_stmt_space = space;
 	if (stailq_empty(&tx->log))
 		rlist_add_entry(&tx->xm->writers, tx, in_writers);
@@ -929,6 +1055,12 @@ vy_tx_rollback_statement(struct vy_tx *tx, void *svp)
 		tx->write_set_version++;
 		txv_delete(v);
 	}
+	if (tx->range_tombstone != NULL) {
+		vy_range_tombstone_unref(tx->range_tombstone);
+		vy_lsm_unref(tx->range_tombstone_lsm);
+		tx->range_tombstone = NULL;
+		tx->range_tombstone_lsm = NULL;
+	}
 	if (stailq_empty(&tx->log))
 		rlist_del_entry(tx, in_writers);
 	tx->last_stmt_space = NULL;
@@ -1140,6 +1272,18 @@ vy_tx_set(struct vy_tx *tx, struct vy_lsm *lsm, struct tuple *stmt)
 	return 0;
 }
 
+void
+vy_tx_delete_range(struct vy_tx *tx, struct vy_lsm *lsm,
+		   struct vy_range_tombstone *t)
+{
+	assert(tx->state == VINYL_TX_READY);
+	assert(tx->range_tombstone == NULL);
+	assert(lsm->index_id == 0);
+	vy_lsm_ref(lsm);
+	tx->range_tombstone = t;
+	tx->range_tombstone_lsm = lsm;
+}
+
 void
 vy_tx_manager_abort_writers_for_ddl(struct vy_tx_manager *xm,
 				    struct space *space, bool *need_wal_sync)
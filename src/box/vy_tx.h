@@ -58,6 +58,7 @@ struct vy_tx_manager;
 struct vy_mem;
 struct vy_tx;
 struct vy_history;
+struct vy_range_tombstone;
 
 /** Transaction state. */
 enum tx_state {
@@ -198,6 +199,14 @@ struct vy_tx {
 	 * is not prepared.
 	 */
 	int64_t psn;
+	/**
+	 * Range tombstone written by this transaction or NULL.
+	 * Range deletes are only allowed in single-statement
+	 * transactions so there may be at most one.
+	 */
+	struct vy_range_tombstone *range_tombstone;
+	/** LSM tree the range tombstone is written to. */
+	struct vy_lsm *range_tombstone_lsm;
 	/* List of triggers invoked when this transaction ends. */
 	struct rlist on_destroy;
 };
@@ -421,6 +430,18 @@ vy_tx_track_point(struct vy_tx *tx, struct vy_lsm *lsm, struct vy_entry entry);
 int
 vy_tx_set(struct vy_tx *tx, struct vy_lsm *lsm, struct tuple *stmt);
 
+/**
+ * Write a range tombstone to a transaction. The transaction
+ * takes the ownership of the tombstone. The tombstone is added
+ * to the LSM tree when the transaction is prepared.
+ * @param tx           Transaction.
+ * @param lsm          Primary index LSM tree.
+ * @param t            Range tombstone.
+ */
+void
+vy_tx_delete_range(struct vy_tx *tx, struct vy_lsm *lsm,
+		   struct vy_range_tombstone *t);
+
 /**
  * Iterator over the write set of a transaction.
  */
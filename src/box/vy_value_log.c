@@ -0,0 +1,908 @@
+/*
+ * Copyright 2010-2021, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+#include "vy_value_log.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <msgpuck.h>
+#include <small/region.h>
+
+#include "diag.h"
+#include "errcode.h"
+#include "error.h"
+#include "fiber.h"
+#include "fio.h"
+#include "say.h"
+#include "tt_static.h"
+#include "trivia/util.h"
+
+#include "vy_run.h"
+#include "vy_stmt.h"
+
+/** Magic string a value file starts with. */
+static const char vy_value_file_magic[] = "VYVALUES";
+
+enum {
+	/** Length of the magic string. */
+	VY_VALUE_FILE_MAGIC_LEN = sizeof(vy_value_file_magic) - 1,
+	/** Size of a value file header: magic and file ID. */
+	VY_VALUE_FILE_HEADER_SIZE = VY_VALUE_FILE_MAGIC_LEN + sizeof(uint64_t),
+	/** Length of a reference: file ID, offset, size. */
+	VY_VALUE_REF_LEN = 2 * sizeof(uint64_t) + sizeof(uint32_t),
+	/** Size of a buffer for values appended to a file. */
+	VY_VALUE_BUF_SIZE = 256 * 1024,
+};
+
+/** Return true if the given MsgPack field is a value reference. */
+static inline bool
+vy_value_is_ref(const char *field)
+{
+	if (mp_typeof(*field) != MP_EXT)
+		return false;
+	int8_t type;
+	mp_decode_extl(&field, &type);
+	return type == VY_VALUE_REF_EXT_TYPE;
+}
+
+/** Size of an encoded value reference. */
+static inline uint32_t
+vy_value_ref_sizeof(void)
+{
+	return mp_sizeof_ext(VY_VALUE_REF_LEN);
+}
+
+static char *
+vy_value_ref_encode(char *data, const struct vy_value_ref *ref)
+{
+	data = mp_encode_extl(data, VY_VALUE_REF_EXT_TYPE, VY_VALUE_REF_LEN);
+	data = mp_store_u64(data, ref->id);
+	data = mp_store_u64(data, ref->offset);
+	data = mp_store_u32(data, ref->size);
+	return data;
+}
+
+static int
+vy_value_ref_decode(const char *data, struct vy_value_ref *ref)
+{
+	int8_t type;
+	uint32_t len = mp_decode_extl(&data, &type);
+	assert(type == VY_VALUE_REF_EXT_TYPE);
+	if (len != VY_VALUE_REF_LEN) {
+		diag_set(ClientError, ER_INVALID_RUN_FILE,
+			 "Invalid value reference");
+		return -1;
+	}
+	ref->id = mp_load_u64(&data);
+	ref->offset = mp_load_u64(&data);
+	ref->size = mp_load_u32(&data);
+	return 0;
+}
+
+int
+vy_value_read(int fd, const struct vy_value_ref *ref, char *buf)
+{
+	ssize_t n = fio_pread(fd, buf, ref->size, ref->offset);
+	if (n < 0) {
+		diag_set(SystemError, "failed to read from value file");
+		return -1;
+	}
+	const char *pos = buf;
+	if (n != (ssize_t)ref->size || ref->size == 0 ||
+	    mp_check(&pos, buf + ref->size) != 0 || pos != buf + ref->size) {
+		diag_set(ClientError, ER_INVALID_RUN_FILE,
+			 "Invalid value reference");
+		return -1;
+	}
+	return 0;
+}
+
+/**
+ * Callback reading a value referenced by @a ref to @a buf.
+ * @a ref_no is the number of the reference in the tuple.
+ */
+typedef int
+(*vy_value_read_f)(const void *arg, const struct vy_value_ref *ref,
+		   uint32_t ref_no, char *buf);
+
+/**
+ * Replace references in the given tuple data with values.
+ * If @a field_limit is less than the number of fields, only
+ * references stored in the first @a field_limit fields are
+ * resolved.
+ */
+static int
+vy_value_resolve_impl(vy_value_read_f read, const void *arg,
+		      const char *data, const char *data_end,
+		      uint32_t field_limit,
+		      const char **res, const char **res_end)
+{
+	const char *pos = data;
+	uint32_t field_count = mp_decode_array(&pos);
+	size_t size = mp_sizeof_array(field_count);
+	for (uint32_t i = 0; i < field_count; i++) {
+		const char *field = pos;
+		mp_next(&pos);
+		struct vy_value_ref ref;
+		if (i < field_limit && vy_value_is_ref(field)) {
+			if (vy_value_ref_decode(field, &ref) != 0)
+				return -1;
+			size += ref.size;
+		} else {
+			size += pos - field;
+		}
+	}
+	assert(pos == data_end);
+	(void)data_end;
+
+	char *buf = region_alloc(&fiber()->gc, size);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, size, "region", "tuple");
+		return -1;
+	}
+	char *out = mp_encode_array(buf, field_count);
+	uint32_t ref_no = 0;
+	pos = data;
+	mp_decode_array(&pos);
+	for (uint32_t i = 0; i < field_count; i++) {
+		const char *field = pos;
+		mp_next(&pos);
+		struct vy_value_ref ref;
+		if (i < field_limit && vy_value_is_ref(field)) {
+			if (vy_value_ref_decode(field, &ref) != 0)
+				return -1;
+			if (read(arg, &ref, ref_no++, out) != 0)
+				return -1;
+			out += ref.size;
+		} else {
+			memcpy(out, field, pos - field);
+			out += pos - field;
+		}
+	}
+	assert(out == buf + size);
+	*res = buf;
+	*res_end = out;
+	return 0;
+}
+
+int
+vy_value_decode_refs(const char *data, const char *data_end,
+		     struct vy_value_ref **refs, uint32_t *ref_count)
+{
+	const char *pos = data;
+	uint32_t field_count = mp_decode_array(&pos);
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < field_count; i++) {
+		if (vy_value_is_ref(pos))
+			count++;
+		mp_next(&pos);
+	}
+	assert(pos == data_end);
+	(void)data_end;
+	size_t size;
+	struct vy_value_ref *array = region_alloc_array(&fiber()->gc,
+							typeof(array[0]),
+							count, &size);
+	if (array == NULL) {
+		diag_set(OutOfMemory, size, "region_alloc_array", "refs");
+		return -1;
+	}
+	uint32_t n = 0;
+	pos = data;
+	mp_decode_array(&pos);
+	for (uint32_t i = 0; i < field_count; i++) {
+		if (vy_value_is_ref(pos) &&
+		    vy_value_ref_decode(pos, &array[n++]) != 0)
+			return -1;
+		mp_next(&pos);
+	}
+	assert(n == count);
+	*refs = array;
+	*ref_count = count;
+	return 0;
+}
+
+static int
+vy_value_copy(const void *arg, const struct vy_value_ref *ref,
+	      uint32_t ref_no, char *buf)
+{
+	const char **values = (const char **)arg;
+	memcpy(buf, values[ref_no], ref->size);
+	return 0;
+}
+
+int
+vy_value_resolve(const char *data, const char *data_end,
+		 const char **values, const char **res,
+		 const char **res_end)
+{
+	return vy_value_resolve_impl(vy_value_copy, values, data, data_end,
+				     UINT32_MAX, res, res_end);
+}
+
+/* {{{ Value cache */
+
+/** A value stored in the value cache. */
+struct vy_value_cache_entry {
+	/** Reference to the value. */
+	struct vy_value_ref ref;
+	/** Link in vy_value_cache::lru. */
+	struct rlist in_lru;
+	/** The value. */
+	char data[0];
+};
+
+static inline uint32_t
+vy_value_cache_hash(int64_t id, uint64_t offset)
+{
+	uint64_t h = (uint64_t)id * 0x9e3779b97f4a7c15ULL + offset;
+	return (uint32_t)(h ^ (h >> 32));
+}
+
+#define mh_name _vy_value_cache
+#define mh_key_t const struct vy_value_ref *
+#define mh_node_t struct vy_value_cache_entry *
+#define mh_arg_t int
+#define mh_hash(a, arg) (vy_value_cache_hash((*(a))->ref.id, \
+					     (*(a))->ref.offset))
+#define mh_hash_key(a, arg) (vy_value_cache_hash((a)->id, (a)->offset))
+#define mh_cmp(a, b, arg) ((*(a))->ref.id != (*(b))->ref.id || \
+			   (*(a))->ref.offset != (*(b))->ref.offset)
+#define mh_cmp_key(a, b, arg) ((a)->id != (*(b))->ref.id || \
+			       (a)->offset != (*(b))->ref.offset)
+#define MH_SOURCE
+#include "salad/mhash.h"
+
+/** Size of memory used by a cached value. */
+static inline size_t
+vy_value_cache_entry_size(struct vy_value_cache_entry *entry)
+{
+	return sizeof(*entry) + entry->ref.size;
+}
+
+void
+vy_value_cache_create(struct vy_value_cache *cache)
+{
+	cache->hash = mh_vy_value_cache_new();
+	if (cache->hash == NULL)
+		panic("failed to allocate vinyl value cache");
+	rlist_create(&cache->lru);
+	cache->quota = 0;
+	cache->mem_used = 0;
+	memset(&cache->stat, 0, sizeof(cache->stat));
+}
+
+static void
+vy_value_cache_evict(struct vy_value_cache *cache,
+		     struct vy_value_cache_entry *entry)
+{
+	mh_int_t pos = mh_vy_value_cache_find(cache->hash, &entry->ref, 0);
+	assert(pos != mh_end(cache->hash));
+	mh_vy_value_cache_del(cache->hash, pos, 0);
+	size_t size = vy_value_cache_entry_size(entry);
+	assert(cache->mem_used >= size);
+	cache->mem_used -= size;
+	rlist_del(&entry->in_lru);
+	free(entry);
+}
+
+void
+vy_value_cache_destroy(struct vy_value_cache *cache)
+{
+	struct vy_value_cache_entry *entry, *tmp;
+	rlist_foreach_entry_safe(entry, &cache->lru, in_lru, tmp)
+		vy_value_cache_evict(cache, entry);
+	mh_vy_value_cache_delete(cache->hash);
+}
+
+/** Evict least recently used values until the cache fits in the quota. */
+static void
+vy_value_cache_trim(struct vy_value_cache *cache)
+{
+	while (cache->mem_used > cache->quota) {
+		assert(!rlist_empty(&cache->lru));
+		struct vy_value_cache_entry *entry;
+		entry = rlist_last_entry(&cache->lru,
+					 struct vy_value_cache_entry, in_lru);
+		vy_value_cache_evict(cache, entry);
+		cache->stat.evict++;
+	}
+}
+
+void
+vy_value_cache_set_quota(struct vy_value_cache *cache, size_t quota)
+{
+	cache->quota = quota;
+	vy_value_cache_trim(cache);
+}
+
+const char *
+vy_value_cache_get(struct vy_value_cache *cache,
+		   const struct vy_value_ref *ref)
+{
+	mh_int_t pos = mh_vy_value_cache_find(cache->hash, ref, 0);
+	if (pos == mh_end(cache->hash)) {
+		cache->stat.miss++;
+		return NULL;
+	}
+	cache->stat.hit++;
+	struct vy_value_cache_entry *entry;
+	entry = *mh_vy_value_cache_node(cache->hash, pos);
+	assert(entry->ref.size == ref->size);
+	rlist_move_entry(&cache->lru, entry, in_lru);
+	return entry->data;
+}
+
+void
+vy_value_cache_put(struct vy_value_cache *cache,
+		   const struct vy_value_ref *ref, const char *value)
+{
+	size_t size = sizeof(struct vy_value_cache_entry) + ref->size;
+	if (size > cache->quota)
+		return;
+	if (mh_vy_value_cache_find(cache->hash, ref, 0) !=
+	    mh_end(cache->hash))
+		return;
+	struct vy_value_cache_entry *entry = malloc(size);
+	if (entry == NULL)
+		return; /* Caching is an optimization, ignore OOM. */
+	entry->ref = *ref;
+	memcpy(entry->data, value, ref->size);
+	if (mh_vy_value_cache_put(cache->hash, &entry, NULL, 0) ==
+	    mh_end(cache->hash)) {
+		free(entry);
+		return;
+	}
+	rlist_add_entry(&cache->lru, entry, in_lru);
+	cache->mem_used += size;
+	vy_value_cache_trim(cache);
+}
+
+/* }}} Value cache */
+
+struct vy_value_writer *
+vy_value_writer_new(const char *dirpath, uint32_t space_id, uint32_t iid,
+		    int64_t run_id, uint32_t threshold,
+		    uint32_t index_field_count,
+		    struct vy_value_input *inputs, uint32_t input_count)
+{
+	assert(iid == 0);
+	struct vy_value_writer *writer = calloc(1, sizeof(*writer));
+	if (writer == NULL) {
+		diag_set(OutOfMemory, sizeof(*writer),
+			 "malloc", "struct vy_value_writer");
+		return NULL;
+	}
+	writer->dirpath = dirpath;
+	writer->space_id = space_id;
+	writer->iid = iid;
+	writer->run_id = run_id;
+	writer->threshold = threshold;
+	writer->index_field_count = index_field_count;
+	writer->inputs = inputs;
+	writer->input_count = input_count;
+	for (uint32_t i = 0; i < input_count; i++)
+		inputs[i].output_no = -1;
+	writer->fd = -1;
+	return writer;
+}
+
+void
+vy_value_writer_delete(struct vy_value_writer *writer)
+{
+	if (writer->fd >= 0 && close(writer->fd) < 0)
+		say_syserror("close failed");
+	free(writer->buf);
+	free(writer->files);
+	free(writer->inputs);
+	TRASH(writer);
+	free(writer);
+}
+
+static struct vy_value_input *
+vy_value_writer_find_input(struct vy_value_writer *writer, int64_t id)
+{
+	for (uint32_t i = 0; i < writer->input_count; i++) {
+		if (writer->inputs[i].id == id)
+			return &writer->inputs[i];
+	}
+	diag_set(ClientError, ER_INVALID_RUN_FILE,
+		 tt_sprintf("Unknown value file %lld", (long long)id));
+	return NULL;
+}
+
+static int
+vy_value_writer_read(const void *arg, const struct vy_value_ref *ref,
+		     uint32_t ref_no, char *buf)
+{
+	(void)ref_no;
+	const struct vy_value_writer *writer = arg;
+	for (uint32_t i = 0; i < writer->input_count; i++) {
+		if (writer->inputs[i].id == ref->id)
+			return vy_value_read(writer->inputs[i].fd, ref, buf);
+	}
+	diag_set(ClientError, ER_INVALID_RUN_FILE,
+		 tt_sprintf("Unknown value file %lld", (long long)ref->id));
+	return -1;
+}
+
+/**
+ * Return true if a field with the given number and size
+ * must be stored in a value file.
+ */
+static inline bool
+vy_value_writer_separates(struct vy_value_writer *writer,
+			  uint32_t field_no, uint32_t size)
+{
+	return writer->threshold > 0 && size >= writer->threshold &&
+	       field_no >= writer->index_field_count;
+}
+
+/**
+ * Add a value file to the list of files referenced by
+ * the output run. Returns the file number or -1 on error.
+ */
+static int
+vy_value_writer_add_file(struct vy_value_writer *writer,
+			 int64_t id, uint64_t size)
+{
+	if (writer->file_count == writer->file_capacity) {
+		uint32_t capacity = writer->file_capacity > 0 ?
+				    writer->file_capacity * 2 : 4;
+		struct vy_value_file_info *files = realloc(writer->files,
+					capacity * sizeof(*files));
+		if (files == NULL) {
+			diag_set(OutOfMemory, capacity * sizeof(*files),
+				 "realloc", "struct vy_value_file_info");
+			return -1;
+		}
+		writer->files = files;
+		writer->file_capacity = capacity;
+	}
+	struct vy_value_file_info *file = &writer->files[writer->file_count];
+	file->id = id;
+	file->size = size;
+	file->ref_size = 0;
+	return writer->file_count++;
+}
+
+/** Link a value file of a compacted run to the output run. */
+static int
+vy_value_writer_link(struct vy_value_writer *writer,
+		     struct vy_value_input *input)
+{
+	assert(input->output_no < 0);
+	int file_no = vy_value_writer_add_file(writer, input->id,
+					       input->size);
+	if (file_no < 0)
+		return -1;
+	char src[PATH_MAX];
+	char dst[PATH_MAX];
+	vy_run_snprint_value_path(src, sizeof(src), writer->dirpath,
+				  writer->space_id, writer->iid,
+				  input->run_id, input->link_no);
+	vy_run_snprint_value_path(dst, sizeof(dst), writer->dirpath,
+				  writer->space_id, writer->iid,
+				  writer->run_id, file_no);
+	if (link(src, dst) != 0) {
+		diag_set(SystemError, "failed to link value file '%s'", dst);
+		writer->file_count--;
+		return -1;
+	}
+	input->output_no = file_no;
+	return 0;
+}
+
+/** Create a value file to store values of the output run. */
+static int
+vy_value_writer_create_file(struct vy_value_writer *writer)
+{
+	assert(writer->fd < 0);
+	if (writer->buf == NULL) {
+		writer->buf = malloc(VY_VALUE_BUF_SIZE);
+		if (writer->buf == NULL) {
+			diag_set(OutOfMemory, VY_VALUE_BUF_SIZE,
+				 "malloc", "value buffer");
+			return -1;
+		}
+	}
+	int file_no = vy_value_writer_add_file(writer, writer->run_id,
+					       VY_VALUE_FILE_HEADER_SIZE);
+	if (file_no < 0)
+		return -1;
+	char path[PATH_MAX];
+	vy_run_snprint_value_path(path, sizeof(path), writer->dirpath,
+				  writer->space_id, writer->iid,
+				  writer->run_id, file_no);
+	say_info("writing `%s'", path);
+	writer->fd = open(path, O_WRONLY | O_CREAT | O_EXCL, 0644);
+	if (writer->fd < 0) {
+		diag_set(SystemError, "failed to create value file '%s'",
+			 path);
+		writer->file_count--;
+		return -1;
+	}
+	writer->fd_file_no = file_no;
+	char *pos = writer->buf;
+	memcpy(pos, vy_value_file_magic, VY_VALUE_FILE_MAGIC_LEN);
+	pos += VY_VALUE_FILE_MAGIC_LEN;
+	pos = mp_store_u64(pos, writer->run_id);
+	writer->buf_used = pos - writer->buf;
+	assert(writer->buf_used == VY_VALUE_FILE_HEADER_SIZE);
+	return 0;
+}
+
+/** Write buffered values to the created value file. */
+static int
+vy_value_writer_flush(struct vy_value_writer *writer)
+{
+	if (writer->buf_used == 0)
+		return 0;
+	if (fio_writen(writer->fd, writer->buf, writer->buf_used) < 0) {
+		diag_set(SystemError, "failed to write to value file");
+		return -1;
+	}
+	writer->buf_used = 0;
+	return 0;
+}
+
+/**
+ * Append a value to the value file of the output run
+ * and return a reference to it.
+ */
+static int
+vy_value_writer_append(struct vy_value_writer *writer, const char *value,
+		       uint32_t size, struct vy_value_ref *ref)
+{
+	if (writer->fd < 0 && vy_value_writer_create_file(writer) != 0)
+		return -1;
+	struct vy_value_file_info *file = &writer->files[writer->fd_file_no];
+	if (writer->buf_used + size > VY_VALUE_BUF_SIZE &&
+	    vy_value_writer_flush(writer) != 0)
+		return -1;
+	if (size > VY_VALUE_BUF_SIZE) {
+		if (fio_writen(writer->fd, value, size) < 0) {
+			diag_set(SystemError, "failed to write to value file");
+			return -1;
+		}
+	} else {
+		memcpy(writer->buf + writer->buf_used, value, size);
+		writer->buf_used += size;
+	}
+	ref->id = writer->run_id;
+	ref->offset = file->size;
+	ref->size = size;
+	file->size += size;
+	file->ref_size += size;
+	return 0;
+}
+
+int
+vy_value_writer_process(struct vy_value_writer *writer, struct tuple *stmt,
+			const char **data, const char **data_end,
+			bool *is_value_ref)
+{
+	*data = NULL;
+	*is_value_ref = false;
+	uint32_t bsize;
+	const char *tuple = tuple_data_range(stmt, &bsize);
+	bool has_refs = (vy_stmt_flags(stmt) & VY_STMT_VALUE_REF) != 0;
+	if (!has_refs && (writer->threshold == 0 || bsize < writer->threshold))
+		return 0;
+	/*
+	 * First, calculate the size of the result and check if
+	 * there's anything to do.
+	 */
+	const char *pos = tuple;
+	uint32_t field_count = mp_decode_array(&pos);
+	size_t size = mp_sizeof_array(field_count);
+	for (uint32_t i = 0; i < field_count; i++) {
+		const char *field = pos;
+		mp_next(&pos);
+		uint32_t field_size = pos - field;
+		if (vy_value_is_ref(field)) {
+			if (!has_refs) {
+				/*
+				 * User data that looks like a reference.
+				 * Store the tuple as is so as not to
+				 * confuse the reader.
+				 */
+				return 0;
+			}
+			struct vy_value_ref ref;
+			if (vy_value_ref_decode(field, &ref) != 0)
+				return -1;
+			struct vy_value_input *input;
+			input = vy_value_writer_find_input(writer, ref.id);
+			if (input == NULL)
+				return -1;
+			if (!input->needs_rewrite) {
+				size += field_size;
+				*is_value_ref = true;
+				continue;
+			}
+			field_size = ref.size;
+		}
+		if (vy_value_writer_separates(writer, i, field_size)) {
+			size += vy_value_ref_sizeof();
+			*is_value_ref = true;
+		} else {
+			size += field_size;
+		}
+	}
+	if (!has_refs && !*is_value_ref)
+		return 0;
+
+	char *buf = region_alloc(&fiber()->gc, size);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, size, "region", "tuple");
+		return -1;
+	}
+	char *out = mp_encode_array(buf, field_count);
+	pos = tuple;
+	mp_decode_array(&pos);
+	for (uint32_t i = 0; i < field_count; i++) {
+		const char *field = pos;
+		mp_next(&pos);
+		const char *value = field;
+		uint32_t value_size = pos - field;
+		struct vy_value_ref ref;
+		if (has_refs && vy_value_is_ref(field)) {
+			if (vy_value_ref_decode(field, &ref) != 0)
+				return -1;
+			struct vy_value_input *input;
+			input = vy_value_writer_find_input(writer, ref.id);
+			if (input == NULL)
+				return -1;
+			if (!input->needs_rewrite) {
+				/* Keep the reference, link the file. */
+				if (input->output_no < 0 &&
+				    vy_value_writer_link(writer, input) != 0)
+					return -1;
+				writer->files[input->output_no].ref_size +=
+								ref.size;
+				memcpy(out, field, value_size);
+				out += value_size;
+				continue;
+			}
+			/* Move the value to the new file. */
+			char *value_buf = region_alloc(&fiber()->gc, ref.size);
+			if (value_buf == NULL) {
+				diag_set(OutOfMemory, ref.size,
+					 "region", "value");
+				return -1;
+			}
+			if (vy_value_read(input->fd, &ref, value_buf) != 0)
+				return -1;
+			value = value_buf;
+			value_size = ref.size;
+		}
+		if (vy_value_writer_separates(writer, i, value_size)) {
+			if (vy_value_writer_append(writer, value,
+						   value_size, &ref) != 0)
+				return -1;
+			out = vy_value_ref_encode(out, &ref);
+		} else {
+			memcpy(out, value, value_size);
+			out += value_size;
+		}
+	}
+	assert(out == buf + size);
+	*data = buf;
+	*data_end = out;
+	return 0;
+}
+
+/**
+ * Return true if the given statement refers to a value in one
+ * of the first @a field_limit fields.
+ */
+static bool
+vy_value_stmt_has_refs(struct tuple *stmt, uint32_t field_limit)
+{
+	if ((vy_stmt_flags(stmt) & VY_STMT_VALUE_REF) == 0)
+		return false;
+	const char *pos = tuple_data(stmt);
+	uint32_t field_count = mp_decode_array(&pos);
+	field_count = MIN(field_count, field_limit);
+	for (uint32_t i = 0; i < field_count; i++) {
+		if (vy_value_is_ref(pos))
+			return true;
+		mp_next(&pos);
+	}
+	return false;
+}
+
+struct tuple *
+vy_value_writer_resolve(struct vy_value_writer *writer, struct tuple *stmt,
+			bool indexed_only)
+{
+	uint32_t field_limit = indexed_only ? writer->index_field_count :
+					      UINT32_MAX;
+	if (!vy_value_stmt_has_refs(stmt, field_limit)) {
+		vy_stmt_ref_if_possible(stmt);
+		return stmt;
+	}
+	size_t region_svp = region_used(&fiber()->gc);
+	uint32_t bsize;
+	const char *data = tuple_data_range(stmt, &bsize);
+	const char *res, *res_end;
+	if (vy_value_resolve_impl(vy_value_writer_read, writer,
+				  data, data + bsize, field_limit,
+				  &res, &res_end) != 0) {
+		region_truncate(&fiber()->gc, region_svp);
+		return NULL;
+	}
+	struct tuple *resolved;
+	if (vy_stmt_type(stmt) == IPROTO_INSERT)
+		resolved = vy_stmt_new_insert(tuple_format(stmt), res, res_end);
+	else
+		resolved = vy_stmt_new_replace(tuple_format(stmt),
+					       res, res_end);
+	region_truncate(&fiber()->gc, region_svp);
+	if (resolved == NULL)
+		return NULL;
+	vy_stmt_set_lsn(resolved, vy_stmt_lsn(stmt));
+	uint8_t flags = vy_stmt_flags(stmt);
+	if (!indexed_only)
+		flags &= ~VY_STMT_VALUE_REF;
+	vy_stmt_set_flags(resolved, flags);
+	return resolved;
+}
+
+/**
+ * Sync the directory storing value files so that the created
+ * file and links aren't lost after a crash. Must be done before
+ * the run referring to them is logged.
+ */
+static int
+vy_value_writer_sync_dir(struct vy_value_writer *writer)
+{
+	char path[PATH_MAX];
+	vy_lsm_snprint_path(path, sizeof(path), writer->dirpath,
+			    writer->space_id, writer->iid);
+	int fd = open(path, O_RDONLY | O_DIRECTORY);
+	if (fd < 0) {
+		diag_set(SystemError, "failed to open directory '%s'", path);
+		return -1;
+	}
+	int rc = fsync(fd);
+	if (rc != 0)
+		diag_set(SystemError, "failed to sync directory '%s'", path);
+	if (close(fd) != 0)
+		say_syserror("close failed");
+	return rc;
+}
+
+int
+vy_value_writer_commit(struct vy_value_writer *writer,
+		       struct vy_value_file_info **files,
+		       uint32_t *file_count)
+{
+	if (writer->fd >= 0) {
+		if (vy_value_writer_flush(writer) != 0)
+			return -1;
+		if (fsync(writer->fd) != 0) {
+			diag_set(SystemError, "failed to sync value file");
+			return -1;
+		}
+		if (close(writer->fd) != 0)
+			say_syserror("close failed");
+		writer->fd = -1;
+	}
+	if (writer->file_count > 0 && vy_value_writer_sync_dir(writer) != 0)
+		return -1;
+	*files = writer->files;
+	*file_count = writer->file_count;
+	writer->files = NULL;
+	writer->file_count = 0;
+	writer->file_capacity = 0;
+	return 0;
+}
+
+int
+vy_value_files_scan(const char *dir, uint32_t space_id, uint32_t iid,
+		    int64_t run_id, struct vy_value_file_info **files,
+		    uint32_t *file_count)
+{
+	uint32_t count = vy_value_files_count(dir, space_id, iid, run_id);
+	*files = NULL;
+	*file_count = 0;
+	if (count == 0)
+		return 0;
+	size_t size = count * sizeof(**files);
+	struct vy_value_file_info *info = malloc(size);
+	if (info == NULL) {
+		diag_set(OutOfMemory, size, "malloc",
+			 "struct vy_value_file_info");
+		return -1;
+	}
+	char path[PATH_MAX];
+	for (uint32_t i = 0; i < count; i++) {
+		vy_run_snprint_value_path(path, sizeof(path), dir, space_id,
+					  iid, run_id, i);
+		int fd = open(path, O_RDONLY);
+		if (fd < 0) {
+			diag_set(SystemError, "failed to open '%s' file",
+				 path);
+			goto fail;
+		}
+		char header[VY_VALUE_FILE_HEADER_SIZE];
+		struct stat st;
+		ssize_t n = fio_pread(fd, header, sizeof(header), 0);
+		int rc = fstat(fd, &st);
+		close(fd);
+		if (n < 0 || rc < 0) {
+			diag_set(SystemError, "failed to read '%s' file",
+				 path);
+			goto fail;
+		}
+		if (n != (ssize_t)sizeof(header) ||
+		    memcmp(header, vy_value_file_magic,
+			   VY_VALUE_FILE_MAGIC_LEN) != 0) {
+			diag_set(ClientError, ER_INVALID_RUN_FILE,
+				 tt_sprintf("Invalid value file header "
+					    "in '%s'", path));
+			goto fail;
+		}
+		const char *pos = header + VY_VALUE_FILE_MAGIC_LEN;
+		info[i].id = mp_load_u64(&pos);
+		info[i].size = st.st_size;
+		info[i].ref_size = st.st_size;
+	}
+	*files = info;
+	*file_count = count;
+	return 0;
+fail:
+	free(info);
+	return -1;
+}
+
+uint32_t
+vy_value_files_count(const char *dir, uint32_t space_id, uint32_t iid,
+		     int64_t run_id)
+{
+	char path[PATH_MAX];
+	uint32_t count = 0;
+	while (true) {
+		vy_run_snprint_value_path(path, sizeof(path), dir, space_id,
+					  iid, run_id, count);
+		if (access(path, F_OK) != 0)
+			break;
+		count++;
+	}
+	return count;
+}
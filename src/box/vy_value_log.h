@@ -0,0 +1,371 @@
+#ifndef INCLUDES_TARANTOOL_BOX_VY_VALUE_LOG_H
+#define INCLUDES_TARANTOOL_BOX_VY_VALUE_LOG_H
+/*
+ * Copyright 2010-2021, Tarantool AUTHORS, please see AUTHORS file.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above
+ *    copyright notice, this list of conditions and the
+ *    following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ *    copyright notice, this list of conditions and the following
+ *    disclaimer in the documentation and/or other materials
+ *    provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY AUTHORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * AUTHORS OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF
+ * THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ */
+
+/**
+ * Key-value separation for primary index runs.
+ *
+ * If the value_log_threshold index option is set, top-level
+ * fields of REPLACE and INSERT statements that are not indexed
+ * and take at least value_log_threshold bytes are not stored in
+ * run pages. Instead they are appended to a value file and the
+ * statement stores a reference to the value (MsgPack extension
+ * of type VY_VALUE_REF_EXT_TYPE) and has VY_STMT_VALUE_REF flag
+ * set. Compaction copies references rather than values so
+ * values are written to disk only once.
+ *
+ * A value file is created by the run that appends values to it
+ * and is identified by the id of the run. Every run that refers
+ * to a value file has its own hard link to it, named after the
+ * run id and the link number (see vy_run_snprint_value_path()),
+ * and lists the linked files in its info, so a value file is
+ * removed as soon as the last run referring to it is deleted.
+ *
+ * Values that are not referenced anymore are reclaimed by
+ * compaction: if less than half of a value file is referenced
+ * by the LSM tree, compaction moves the values it keeps to the
+ * value file of the output run instead of linking the old file.
+ * The scheduler looks for such files after each compaction and
+ * forces compaction of ranges referring to them, see
+ * vy_scheduler_peek_value_gc().
+ *
+ * Run pages, the page cache, and run iterators store references
+ * as is. A reference is resolved only when a statement read from
+ * disk is about to be returned to the user, see
+ * vy_run_resolve_values(). Values read from disk are kept in
+ * the value cache shared by all LSM trees.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <small/rlist.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+struct tuple;
+struct mh_vy_value_cache_t;
+
+/** MsgPack extension type used for references to values. */
+enum { VY_VALUE_REF_EXT_TYPE = 127 };
+
+/** Reference to a value stored in a value file. */
+struct vy_value_ref {
+	/** ID of the value file. */
+	int64_t id;
+	/** Offset of the value in the file. */
+	uint64_t offset;
+	/** Size of the value. */
+	uint32_t size;
+};
+
+/** Information about a value file referenced by a run. */
+struct vy_value_file_info {
+	/** ID of the value file, equals ID of the run created it. */
+	int64_t id;
+	/** Size of the value file, in bytes. */
+	uint64_t size;
+	/** Size of values referenced by the run, in bytes. */
+	uint64_t ref_size;
+};
+
+/** A value file referenced by a run being compacted. */
+struct vy_value_input {
+	/** ID of the value file. */
+	int64_t id;
+	/** Size of the value file, in bytes. */
+	uint64_t size;
+	/** File descriptor to read values, owned by the run. */
+	int fd;
+	/**
+	 * ID of the run and the number of its link to the file,
+	 * used to link the file to the output run.
+	 */
+	int64_t run_id;
+	uint32_t link_no;
+	/**
+	 * Set if the values referenced by the output run must
+	 * be moved to a new value file rather than the file be
+	 * linked to the output run.
+	 */
+	bool needs_rewrite;
+	/**
+	 * Number of the file in vy_value_writer::files if the
+	 * output run refers to it, -1 otherwise.
+	 */
+	int output_no;
+};
+
+/**
+ * Value writer separates values of statements written to
+ * a primary index run. It is created in tx and used by the
+ * worker thread executing a dump or compaction task.
+ */
+struct vy_value_writer {
+	/** Path to the vinyl directory. */
+	const char *dirpath;
+	/** Space and index IDs of the LSM tree. */
+	uint32_t space_id;
+	uint32_t iid;
+	/** ID of the run being written. */
+	int64_t run_id;
+	/**
+	 * Min size of a field to store it separately.
+	 * If 0, all values are stored in the run.
+	 */
+	uint32_t threshold;
+	/**
+	 * Number of leading tuple fields that are indexed
+	 * and so never stored separately.
+	 */
+	uint32_t index_field_count;
+	/** Value files of the runs being compacted. */
+	struct vy_value_input *inputs;
+	uint32_t input_count;
+	/** Value files referenced by the output run. */
+	struct vy_value_file_info *files;
+	uint32_t file_count;
+	uint32_t file_capacity;
+	/** Value file created by this writer or -1. */
+	int fd;
+	/** Number of the created file in @files. */
+	uint32_t fd_file_no;
+	/**
+	 * Buffer for values appended to the created file.
+	 * It is allocated by the worker thread on demand.
+	 */
+	char *buf;
+	/** Size of data stored in @buf. */
+	size_t buf_used;
+};
+
+/**
+ * Allocate a value writer.
+ * @param dirpath Path to the vinyl directory.
+ * @param space_id Space ID.
+ * @param iid Index ID, must be 0.
+ * @param run_id ID of the run to write.
+ * @param threshold value_log_threshold index option.
+ * @param index_field_count Number of indexed fields.
+ * @param inputs Value files of the compacted runs; the writer
+ *        takes the ownership of the array.
+ * @param input_count Length of @a inputs.
+ * @return the writer or NULL on memory error (diag is set).
+ */
+struct vy_value_writer *
+vy_value_writer_new(const char *dirpath, uint32_t space_id, uint32_t iid,
+		    int64_t run_id, uint32_t threshold,
+		    uint32_t index_field_count,
+		    struct vy_value_input *inputs, uint32_t input_count);
+
+/** Delete a value writer. */
+void
+vy_value_writer_delete(struct vy_value_writer *writer);
+
+/**
+ * Prepare the data of a REPLACE or INSERT statement for writing
+ * to a run: store values of big fields in a value file, move
+ * values that must be rewritten, and link value files of the
+ * compacted runs that the statement still refers to.
+ *
+ * On success @a data is set to the data to write, allocated
+ * on the fiber region, or to NULL if the statement should be
+ * written as is. @a is_value_ref is set if the data to write
+ * refers to values.
+ *
+ * @retval  0 Success.
+ * @retval -1 Memory or IO error.
+ */
+int
+vy_value_writer_process(struct vy_value_writer *writer, struct tuple *stmt,
+			const char **data, const char **data_end,
+			bool *is_value_ref);
+
+/**
+ * Replace references to values of a statement read from
+ * a compacted run with the values. If @a indexed_only is set,
+ * the statement is resolved only if an indexed field refers to
+ * a value (a secondary index may have been created after the
+ * statement was written).
+ *
+ * @return a new statement, the given statement if there is
+ *         nothing to resolve (referenced in both cases), or
+ *         NULL on error (diag is set).
+ */
+struct tuple *
+vy_value_writer_resolve(struct vy_value_writer *writer, struct tuple *stmt,
+			bool indexed_only);
+
+/**
+ * Complete writing values: flush and sync the created value
+ * file, sync the directory so that the created file and links
+ * survive a crash once the run is logged, and return the list
+ * of value files referenced by the written run. The caller
+ * takes the ownership of the list.
+ *
+ * @retval  0 Success.
+ * @retval -1 IO error.
+ */
+int
+vy_value_writer_commit(struct vy_value_writer *writer,
+		       struct vy_value_file_info **files,
+		       uint32_t *file_count);
+
+/**
+ * Read a value referenced by @a ref from the value file @a fd
+ * to @a buf and check that it is a valid MsgPack.
+ *
+ * @retval  0 Success.
+ * @retval -1 IO error or invalid reference.
+ */
+int
+vy_value_read(int fd, const struct vy_value_ref *ref, char *buf);
+
+/**
+ * Decode references to values stored in the given tuple data.
+ * The array of references is allocated on the fiber region.
+ * References are returned in the order of fields.
+ *
+ * @retval  0 Success.
+ * @retval -1 Memory error or invalid reference.
+ */
+int
+vy_value_decode_refs(const char *data, const char *data_end,
+		     struct vy_value_ref **refs, uint32_t *ref_count);
+
+/**
+ * Replace references to values in the given tuple data with
+ * the values. @a values must store the values in the order of
+ * references returned by vy_value_decode_refs(). The result is
+ * allocated on the fiber region.
+ *
+ * @retval  0 Success.
+ * @retval -1 Memory error or invalid reference.
+ */
+int
+vy_value_resolve(const char *data, const char *data_end,
+		 const char **values, const char **res,
+		 const char **res_end);
+
+/** Value cache statistics. */
+struct vy_value_cache_stat {
+	/** Number of lookups that found the value in the cache. */
+	int64_t hit;
+	/** Number of lookups that had to read the value from disk. */
+	int64_t miss;
+	/** Number of values evicted from the cache. */
+	int64_t evict;
+};
+
+/**
+ * Cache of values read from value files, shared by all LSM
+ * trees. Values are evicted in the LRU order. Values of deleted
+ * files are never looked up again and so age out eventually.
+ *
+ * The cache is only accessed from the tx thread.
+ */
+struct vy_value_cache {
+	/** (file id, offset) -> struct vy_value_cache_entry. */
+	struct mh_vy_value_cache_t *hash;
+	/** List of cached values, most recently used first. */
+	struct rlist lru;
+	/** Max size of memory that may be used by cached values. */
+	size_t quota;
+	/** Size of memory used by cached values. */
+	size_t mem_used;
+	/** Cache statistics. */
+	struct vy_value_cache_stat stat;
+};
+
+/** Initialize a value cache. The cache is disabled by default. */
+void
+vy_value_cache_create(struct vy_value_cache *cache);
+
+/** Destroy a value cache. */
+void
+vy_value_cache_destroy(struct vy_value_cache *cache);
+
+/**
+ * Set the max size of memory that may be used by the cache.
+ * Values are evicted if the new quota is less than the size of
+ * memory used by the cache. Zero disables the cache.
+ */
+void
+vy_value_cache_set_quota(struct vy_value_cache *cache, size_t quota);
+
+/**
+ * Look up a value in the cache. Returns a pointer to the value
+ * or NULL if it isn't cached. The pointer is only valid until
+ * the next modification of the cache.
+ */
+const char *
+vy_value_cache_get(struct vy_value_cache *cache,
+		   const struct vy_value_ref *ref);
+
+/**
+ * Add a value read from disk to the cache. Does nothing if the
+ * value is already cached or doesn't fit in the quota.
+ */
+void
+vy_value_cache_put(struct vy_value_cache *cache,
+		   const struct vy_value_ref *ref, const char *value);
+
+/**
+ * Find value file links of the run with the given ID and read
+ * value file IDs and sizes from their headers. Used when
+ * the run index is rebuilt and doesn't have the value files.
+ * The size of referenced values is set to the file size.
+ *
+ * @retval  0 Success.
+ * @retval -1 Memory or IO error.
+ */
+int
+vy_value_files_scan(const char *dir, uint32_t space_id, uint32_t iid,
+		    int64_t run_id, struct vy_value_file_info **files,
+		    uint32_t *file_count);
+
+/**
+ * Return the number of value file links of the run with the
+ * given ID. Links are created and removed in order so the
+ * first missing link terminates the list.
+ */
+uint32_t
+vy_value_files_count(const char *dir, uint32_t space_id, uint32_t iid,
+		     int64_t run_id);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* INCLUDES_TARANTOOL_BOX_VY_VALUE_LOG_H */
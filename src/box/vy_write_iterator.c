@@ -32,6 +32,8 @@
 #include "vy_mem.h"
 #include "vy_run.h"
 #include "vy_upsert.h"
+#include "vy_range_tombstone.h"
+#include "vy_value_log.h"
 #include "fiber.h"
 
 #define HEAP_FORWARD_DECLARATION
@@ -183,6 +185,29 @@ struct vy_write_iterator {
 	bool is_primary;
 	/** Deferred DELETE handler. */
 	struct vy_deferred_delete_handler *deferred_delete_handler;
+	/**
+	 * Value writer used to resolve references to values
+	 * or NULL if key-value separation is off.
+	 */
+	struct vy_value_writer *values;
+	/**
+	 * Range tombstones applied by compaction, sorted by LSN
+	 * in descending order. The array is owned by the caller.
+	 */
+	struct vy_range_tombstone **range_tombstones;
+	int range_tombstone_count;
+	/**
+	 * Set if deferred DELETEs must be generated for tuples
+	 * deleted by range tombstones.
+	 */
+	bool range_tombstone_deferred_delete;
+	/** Compaction filter or NULL, see optimization #6. */
+	struct vy_compaction_filter *filter;
+	/**
+	 * Set if deferred DELETEs must be generated for tuples
+	 * dropped by the compaction filter.
+	 */
+	bool filter_deferred_delete;
 	/**
 	 * Last scanned REPLACE or DELETE statement that was
 	 * inserted into the primary index without deletion
@@ -394,6 +419,39 @@ vy_write_iterator_new(struct key_def *cmp_def, bool is_primary,
 	return &stream->base;
 }
 
+void
+vy_write_iterator_set_value_writer(struct vy_stmt_stream *vstream,
+				   struct vy_value_writer *values)
+{
+	struct vy_write_iterator *stream = (struct vy_write_iterator *)vstream;
+	assert(stream->is_primary);
+	stream->values = values;
+}
+
+void
+vy_write_iterator_set_range_tombstones(struct vy_stmt_stream *vstream,
+				       struct vy_range_tombstone **tombstones,
+				       int count, bool gen_deferred_delete)
+{
+	struct vy_write_iterator *stream = (struct vy_write_iterator *)vstream;
+	assert(stream->is_primary);
+	stream->range_tombstones = tombstones;
+	stream->range_tombstone_count = count;
+	stream->range_tombstone_deferred_delete = gen_deferred_delete;
+}
+
+void
+vy_write_iterator_set_filter(struct vy_stmt_stream *vstream,
+			     struct vy_compaction_filter *filter,
+			     bool gen_deferred_delete)
+{
+	struct vy_write_iterator *stream = (struct vy_write_iterator *)vstream;
+	assert(stream->is_primary);
+	assert(!gen_deferred_delete || stream->deferred_delete_handler != NULL);
+	stream->filter = filter;
+	stream->filter_deferred_delete = gen_deferred_delete;
+}
+
 /**
  * Start the search. Must be called after *new* methods and
  * before *next* method.
@@ -598,6 +656,34 @@ vy_write_iterator_pop_read_view_stmt(struct vy_write_iterator *stream)
 	return stream->last;
 }
 
+/**
+ * Pass an overwritten tuple and the statement that overwrote
+ * it to the deferred DELETE handler. Indexed fields of the
+ * tuples may refer to values if the index was created after
+ * they had been written so resolve them first.
+ */
+static int
+vy_write_iterator_process_deferred_delete(struct vy_write_iterator *stream,
+					  struct tuple *old_stmt,
+					  struct tuple *new_stmt)
+{
+	struct vy_deferred_delete_handler *handler =
+			stream->deferred_delete_handler;
+	if (stream->values == NULL)
+		return handler->iface->process(handler, old_stmt, new_stmt);
+	int rc = -1;
+	old_stmt = vy_value_writer_resolve(stream->values, old_stmt, true);
+	if (old_stmt == NULL)
+		return -1;
+	new_stmt = vy_value_writer_resolve(stream->values, new_stmt, true);
+	if (new_stmt != NULL) {
+		rc = handler->iface->process(handler, old_stmt, new_stmt);
+		vy_stmt_unref_if_possible(new_stmt);
+	}
+	vy_stmt_unref_if_possible(old_stmt);
+	return rc;
+}
+
 /**
  * Generate a DELETE statement for the given tuple if its
  * deletion from secondary indexes was deferred.
@@ -626,11 +712,10 @@ vy_write_iterator_deferred_delete(struct vy_write_iterator *stream,
 	 * in case the current tuple was overwritten.
 	 */
 	if (stream->deferred_delete.stmt != NULL) {
-		struct vy_deferred_delete_handler *handler =
-				stream->deferred_delete_handler;
-		if (handler != NULL && vy_stmt_type(stmt) != IPROTO_DELETE &&
-		    handler->iface->process(handler, stmt,
-					    stream->deferred_delete.stmt) != 0)
+		if (stream->deferred_delete_handler != NULL &&
+		    vy_stmt_type(stmt) != IPROTO_DELETE &&
+		    vy_write_iterator_process_deferred_delete(stream, stmt,
+					stream->deferred_delete.stmt) != 0)
 			return -1;
 		vy_stmt_unref_if_possible(stream->deferred_delete.stmt);
 		stream->deferred_delete = vy_entry_none();
@@ -650,6 +735,76 @@ vy_write_iterator_deferred_delete(struct vy_write_iterator *stream,
 	return 0;
 }
 
+/**
+ * Return the next range tombstone that covers the given statement
+ * and is newer than it or NULL if there's no such tombstone.
+ * Tombstones are sorted by LSN in descending order, @a next is
+ * the index of the first tombstone that hasn't been checked for
+ * the current key yet.
+ */
+static struct vy_range_tombstone *
+vy_write_iterator_next_range_tombstone(struct vy_write_iterator *stream,
+				       struct vy_entry entry, int *next)
+{
+	int64_t lsn = vy_stmt_lsn(entry.stmt);
+	while (*next < stream->range_tombstone_count) {
+		struct vy_range_tombstone *t = stream->range_tombstones[*next];
+		if (t->lsn <= lsn)
+			break;
+		++*next;
+		if (vy_range_tombstone_covers(t, entry, stream->cmp_def))
+			return t;
+	}
+	return NULL;
+}
+
+/**
+ * Apply the compaction filter to the only version of the current
+ * key left in the output (optimization #6) and drop it if the
+ * filter rejects it.
+ *
+ * @retval  0 Success.
+ * @retval -1 Error.
+ */
+static int
+vy_write_iterator_apply_filter(struct vy_write_iterator *stream, int *count)
+{
+	struct vy_read_view_stmt *rv = &stream->read_views[0];
+	if (stream->filter == NULL || !stream->is_last_level ||
+	    stream->rv_used_count != 1 || rv->entry.stmt == NULL)
+		return 0;
+	struct tuple *stmt = rv->entry.stmt;
+	if (vy_stmt_type(stmt) != IPROTO_REPLACE &&
+	    vy_stmt_type(stmt) != IPROTO_INSERT)
+		return 0;
+	if (!stream->filter->func(stream->filter, stmt))
+		return 0;
+	if (stream->filter_deferred_delete) {
+		/*
+		 * A deferred DELETE must be newer than the dropped
+		 * tuple, otherwise it would be discarded in favor of
+		 * the tuple (see heap_less()). A newer statement for
+		 * the same key with the same LSN wins in this case,
+		 * which is fine, since it overwrites the tuple.
+		 */
+		struct tuple *delete = vy_stmt_new_surrogate_delete(
+					tuple_format(stmt), stmt);
+		if (delete == NULL)
+			return -1;
+		vy_stmt_set_lsn(delete, vy_stmt_lsn(stmt) + 1);
+		int rc = vy_write_iterator_process_deferred_delete(stream,
+								  stmt, delete);
+		vy_stmt_unref_if_possible(delete);
+		if (rc != 0)
+			return -1;
+	}
+	vy_stmt_unref_if_possible(stmt);
+	rv->entry = vy_entry_none();
+	stream->rv_used_count = 0;
+	*count = 0;
+	return 0;
+}
+
 /**
  * Build the history of the current key.
  * Apply optimizations 1 and 2 (@sa vy_write_iterator.h).
@@ -709,11 +864,35 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 	int64_t current_rv_lsn = vy_write_iterator_get_vlsn(stream, 0);
 	int64_t merge_until_lsn = vy_write_iterator_get_vlsn(stream, 1);
 
+	/*
+	 * Range tombstones are applied to the current key as
+	 * if they were DELETE statements: before processing a
+	 * statement, we process all tombstones covering it that
+	 * are newer than it and haven't been processed yet.
+	 */
+	int next_tombstone = 0;
+	struct vy_entry tombstone = vy_entry_none();
 	while (true) {
-		*is_first_insert = vy_stmt_type(src->entry.stmt) == IPROTO_INSERT;
+		struct vy_entry entry = src->entry;
+		struct vy_range_tombstone *t =
+			vy_write_iterator_next_range_tombstone(stream, entry,
+							       &next_tombstone);
+		if (t != NULL) {
+			tombstone.stmt = vy_stmt_new_surrogate_delete(
+					tuple_format(entry.stmt), entry.stmt);
+			if (tombstone.stmt == NULL) {
+				rc = -1;
+				break;
+			}
+			tombstone.hint = entry.hint;
+			vy_stmt_set_lsn(tombstone.stmt, t->lsn);
+			entry = tombstone;
+		}
+
+		*is_first_insert = vy_stmt_type(entry.stmt) == IPROTO_INSERT;
 
 		if (!stream->is_primary &&
-		    (vy_stmt_flags(src->entry.stmt) & VY_STMT_UPDATE) != 0) {
+		    (vy_stmt_flags(entry.stmt) & VY_STMT_UPDATE) != 0) {
 			/*
 			 * If a REPLACE stored in a secondary index was
 			 * generated by an update operation, it can be
@@ -734,12 +913,25 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 		 */
 		if (stream->is_primary) {
 			rc = vy_write_iterator_deferred_delete(stream,
-							       src->entry);
+							       entry);
 			if (rc != 0)
 				break;
 		}
+		/*
+		 * Range tombstones aren't applied to secondary
+		 * indexes so if there are any, we have to generate
+		 * a deferred DELETE for the tuple overwritten by
+		 * the tombstone.
+		 */
+		if (tombstone.stmt != NULL &&
+		    stream->range_tombstone_deferred_delete &&
+		    stream->deferred_delete_handler != NULL) {
+			assert(stream->deferred_delete.stmt == NULL);
+			vy_stmt_ref_if_possible(tombstone.stmt);
+			stream->deferred_delete = tombstone;
+		}
 
-		if (vy_stmt_lsn(src->entry.stmt) > current_rv_lsn) {
+		if (vy_stmt_lsn(entry.stmt) > current_rv_lsn) {
 			/*
 			 * Skip statements invisible to the current read
 			 * view but older than the previous read view,
@@ -747,10 +939,10 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 			 */
 			goto next_lsn;
 		}
-		while (vy_stmt_lsn(src->entry.stmt) <= merge_until_lsn) {
+		while (vy_stmt_lsn(entry.stmt) <= merge_until_lsn) {
 			/*
 			 * Skip read views which see the same
-			 * version of the key, until src->entry is
+			 * version of the key, until entry is
 			 * between merge_until_lsn and
 			 * current_rv_lsn.
 			 */
@@ -766,13 +958,23 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 		 * @sa vy_write_iterator for details about this
 		 * and other optimizations.
 		 */
-		if (vy_stmt_type(src->entry.stmt) == IPROTO_DELETE &&
+		if (vy_stmt_type(entry.stmt) == IPROTO_DELETE &&
 		    stream->is_last_level && merge_until_lsn < 0) {
 			current_rv_lsn = -1; /* Force skip */
 			goto next_lsn;
 		}
 
-		rc = vy_write_iterator_push_rv(stream, src->entry,
+		/*
+		 * A range tombstone doesn't need to be written if
+		 * there's no UPSERT to apply to it in the current
+		 * read view: older statements are hidden from
+		 * readers as long as the tombstone exists.
+		 */
+		if (tombstone.stmt != NULL &&
+		    stream->read_views[current_rv_i].history == NULL)
+			goto next_rv;
+
+		rc = vy_write_iterator_push_rv(stream, entry,
 					       current_rv_i);
 		if (rc != 0)
 			break;
@@ -782,9 +984,10 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 		 * Optimization 2: skip statements overwritten
 		 * by a REPLACE or DELETE.
 		 */
-		if (vy_stmt_type(src->entry.stmt) == IPROTO_REPLACE ||
-		    vy_stmt_type(src->entry.stmt) == IPROTO_INSERT ||
-		    vy_stmt_type(src->entry.stmt) == IPROTO_DELETE) {
+		if (vy_stmt_type(entry.stmt) == IPROTO_REPLACE ||
+		    vy_stmt_type(entry.stmt) == IPROTO_INSERT ||
+		    vy_stmt_type(entry.stmt) == IPROTO_DELETE) {
+next_rv:
 			current_rv_i++;
 			current_rv_lsn = merge_until_lsn;
 			merge_until_lsn =
@@ -792,6 +995,12 @@ vy_write_iterator_build_history(struct vy_write_iterator *stream,
 							   current_rv_i + 1);
 		}
 next_lsn:
+		if (tombstone.stmt != NULL) {
+			/* Proceed to the statement the tombstone covers. */
+			vy_stmt_unref_if_possible(tombstone.stmt);
+			tombstone = vy_entry_none();
+			continue;
+		}
 		rc = vy_write_iterator_merge_step(stream);
 		if (rc != 0)
 			break;
@@ -802,13 +1011,19 @@ next_lsn:
 			break;
 	}
 
+	if (tombstone.stmt != NULL)
+		vy_stmt_unref_if_possible(tombstone.stmt);
 	/*
 	 * No point in keeping the last VY_STMT_DEFERRED_DELETE
 	 * statement around if this is major compaction, because
-	 * there's no tuple it could overwrite.
+	 * there's no tuple it could overwrite. A DELETE generated
+	 * for a range tombstone isn't kept either, because the
+	 * tombstone will be applied again on the next compaction.
 	 */
-	if (rc == 0 && stream->is_last_level &&
-	    stream->deferred_delete.stmt != NULL) {
+	if (rc == 0 && stream->deferred_delete.stmt != NULL &&
+	    (stream->is_last_level ||
+	     (vy_stmt_flags(stream->deferred_delete.stmt) &
+	      VY_STMT_DEFERRED_DELETE) == 0)) {
 		vy_stmt_unref_if_possible(stream->deferred_delete.stmt);
 		stream->deferred_delete = vy_entry_none();
 	}
@@ -818,6 +1033,30 @@ next_lsn:
 	return rc;
 }
 
+/**
+ * Apply an UPSERT to a statement. If the statement was read
+ * from disk, it may refer to values, which must be resolved
+ * before the UPSERT operations can be applied.
+ */
+static struct vy_entry
+vy_write_iterator_apply_upsert(struct vy_write_iterator *stream,
+			       struct vy_entry upsert, struct vy_entry base)
+{
+	if (stream->values == NULL || base.stmt == NULL)
+		return vy_entry_apply_upsert(upsert, base, stream->cmp_def,
+					     false);
+	struct vy_entry resolved = base;
+	resolved.stmt = vy_value_writer_resolve(stream->values, base.stmt,
+						false);
+	if (resolved.stmt == NULL)
+		return vy_entry_none();
+	struct vy_entry applied = vy_entry_apply_upsert(upsert, resolved,
+							stream->cmp_def,
+							false);
+	vy_stmt_unref_if_possible(resolved.stmt);
+	return applied;
+}
+
 /**
  * Apply accumulated UPSERTs in the read view with a hint from
  * a previous read view. After merge, the read view must contain
@@ -876,8 +1115,8 @@ vy_read_view_merge(struct vy_write_iterator *stream, struct vy_entry prev,
 		assert(!stream->is_last_level || prev.stmt == NULL ||
 		       vy_stmt_type(prev.stmt) != IPROTO_UPSERT);
 		struct vy_entry applied;
-		applied = vy_entry_apply_upsert(h->entry, prev,
-						stream->cmp_def, false);
+		applied = vy_write_iterator_apply_upsert(stream, h->entry,
+							 prev);
 		if (applied.stmt == NULL)
 			return -1;
 		vy_stmt_unref_if_possible(h->entry.stmt);
@@ -891,8 +1130,8 @@ vy_read_view_merge(struct vy_write_iterator *stream, struct vy_entry prev,
 		       vy_stmt_type(h->entry.stmt) == IPROTO_UPSERT);
 		assert(result->entry.stmt != NULL);
 		struct vy_entry applied;
-		applied = vy_entry_apply_upsert(h->entry, result->entry,
-						stream->cmp_def, false);
+		applied = vy_write_iterator_apply_upsert(stream, h->entry,
+							 result->entry);
 		if (applied.stmt == NULL)
 			return -1;
 		vy_stmt_unref_if_possible(result->entry.stmt);
@@ -1045,6 +1284,7 @@ vy_write_iterator_build_read_views(struct vy_write_iterator *stream, int *count)
 		++*count;
 		prev = rv->entry;
 	}
+	rc = vy_write_iterator_apply_filter(stream, count);
 
 cleanup:
 	vy_write_iterator_history_destroy(stream, region, used);
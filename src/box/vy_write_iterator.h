@@ -190,6 +190,26 @@
  * also turn the first INSERT in the resulting key's history to a
  * REPLACE in case the oldest statement among all sources is not
  * an INSERT.
+ *
+ * ---------------------------------------------------------------
+ * Optimization #6: drop a tuple rejected by the compaction filter
+ * (e.g. an expired one) if it is the only version of the key left
+ * in the output. This is only done for the last level of the
+ * primary index and only if the tuple is newer than all read
+ * views, so no reader can tell that the key was dropped rather
+ * than deleted. No DELETE is written to the primary index. If
+ * the space has secondary indexes, a deferred DELETE is generated
+ * for the dropped tuple.
+ *
+ *                         --------
+ *                         SAME KEY
+ *                         --------
+ *
+ * 0                     VLSN1                        INT64_MAX
+ * |                       |                              |
+ * |                       | LSN1  ...  LSNi  REPLACE     |
+ * \_______________________/\__________/\________________/
+ *         nothing             skip      filter and drop
  */
 
 struct vy_write_iterator;
@@ -199,6 +219,8 @@ struct tuple_format;
 struct tuple;
 struct vy_mem;
 struct vy_slice;
+struct vy_value_writer;
+struct vy_range_tombstone;
 
 /**
  * Callback invoked by the write iterator for tuples that were
@@ -235,6 +257,27 @@ struct vy_deferred_delete_handler {
 	const struct vy_deferred_delete_handler_iface *iface;
 };
 
+struct vy_compaction_filter;
+
+/**
+ * Callback invoked by the write iterator for the only version
+ * of a key left in the output of primary index compaction
+ * (see optimization #6). It may be called from a worker thread.
+ *
+ * @param filter Compaction filter.
+ * @param stmt   REPLACE or INSERT statement.
+ *
+ * @retval true  Drop the statement.
+ * @retval false Keep the statement.
+ */
+typedef bool
+(*vy_compaction_filter_f)(struct vy_compaction_filter *filter,
+			  struct tuple *stmt);
+
+struct vy_compaction_filter {
+	vy_compaction_filter_f func;
+};
+
 /**
  * Open an empty write iterator. To add sources to the iterator
  * use vy_write_iterator_add_* functions.
@@ -252,6 +295,40 @@ vy_write_iterator_new(struct key_def *cmp_def, bool is_primary,
 		      bool is_last_level, struct rlist *read_views,
 		      struct vy_deferred_delete_handler *handler);
 
+/**
+ * Set the value writer used by primary index compaction to
+ * resolve references to values stored in statements read from
+ * disk (see vy_value_log.h) before applying UPSERTs to them or
+ * generating deferred DELETEs for them.
+ */
+void
+vy_write_iterator_set_value_writer(struct vy_stmt_stream *stream,
+				   struct vy_value_writer *values);
+
+/**
+ * Set range tombstones applied by primary index compaction
+ * (see vy_range_tombstone.h). The array must be sorted by LSN
+ * in descending order and stay valid until the iterator is
+ * closed. If @a gen_deferred_delete is set, deferred DELETEs
+ * are generated for tuples deleted by the tombstones.
+ */
+void
+vy_write_iterator_set_range_tombstones(struct vy_stmt_stream *stream,
+				       struct vy_range_tombstone **tombstones,
+				       int count, bool gen_deferred_delete);
+
+/**
+ * Set the filter applied to the last level of a primary index
+ * (see optimization #6). The filter must stay valid until the
+ * iterator is closed. If @a gen_deferred_delete is set, deferred
+ * DELETEs are generated for dropped tuples, in which case the
+ * deferred DELETE handler must be set.
+ */
+void
+vy_write_iterator_set_filter(struct vy_stmt_stream *stream,
+			     struct vy_compaction_filter *filter,
+			     bool gen_deferred_delete);
+
 /**
  * Add a mem as a source to the iterator.
  * @return 0 on success, -1 on error (diag is set).
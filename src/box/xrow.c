@@ -184,6 +184,7 @@ error:
 		case IPROTO_FLAGS:
 			flags = mp_decode_uint(pos);
 			header->is_commit = flags & IPROTO_FLAG_COMMIT;
+			header->is_stale_read = flags & IPROTO_FLAG_STALE_READ;
 			break;
 		default:
 			/* unknown header */
@@ -441,6 +442,43 @@ iproto_reply_vclock(struct obuf *out, const struct vclock *vclock,
 	return 0;
 }
 
+int
+iproto_reply_id(struct obuf *out, uint64_t sync, uint32_t schema_version)
+{
+	size_t max_size = IPROTO_HEADER_LEN + mp_sizeof_map(2) +
+		mp_sizeof_uint(IPROTO_VERSION) +
+		mp_sizeof_uint(IPROTO_CURRENT_VERSION) +
+		mp_sizeof_uint(IPROTO_FEATURES) +
+		mp_sizeof_array(iproto_feature_id_MAX) +
+		iproto_feature_id_MAX * mp_sizeof_uint(UINT32_MAX);
+
+	char *buf = obuf_reserve(out, max_size);
+	if (buf == NULL) {
+		diag_set(OutOfMemory, max_size,
+			 "obuf_alloc", "buf");
+		return -1;
+	}
+
+	char *data = buf + IPROTO_HEADER_LEN;
+	data = mp_encode_map(data, 2);
+	data = mp_encode_uint(data, IPROTO_VERSION);
+	data = mp_encode_uint(data, IPROTO_CURRENT_VERSION);
+	data = mp_encode_uint(data, IPROTO_FEATURES);
+	data = mp_encode_array(data, iproto_feature_id_MAX);
+	for (uint32_t id = 0; id < iproto_feature_id_MAX; id++)
+		data = mp_encode_uint(data, id);
+	size_t size = data - buf;
+	assert(size <= max_size);
+
+	iproto_header_encode(buf, IPROTO_OK, sync, schema_version,
+			     size - IPROTO_HEADER_LEN);
+
+	char *ptr = obuf_alloc(out, size);
+	(void) ptr;
+	assert(ptr == buf);
+	return 0;
+}
+
 int
 iproto_reply_vote(struct obuf *out, const struct ballot *ballot,
 		  uint64_t sync, uint32_t schema_version)
@@ -88,6 +88,11 @@ struct xrow_header {
 	 * tsn and is_commit flag to save space.
 	 */
 	bool is_commit;
+	/**
+	 * True if the client allows to serve the request from
+	 * a stale read view. Only makes sense for SELECT.
+	 */
+	bool is_stale_read;
 
 	int bodycnt;
 	uint32_t schema_version;
@@ -625,6 +630,19 @@ int
 iproto_reply_vclock(struct obuf *out, const struct vclock *vclock,
 		    uint64_t sync, uint32_t schema_version);
 
+/**
+ * Encode a reply to an IPROTO_ID request: the protocol version
+ * and the list of protocol features supported by the server.
+ * @param out Buffer to write to.
+ * @param sync Request sync.
+ * @param schema_version Actual schema version.
+ *
+ * @retval  0 Success.
+ * @retval -1 Memory error.
+ */
+int
+iproto_reply_id(struct obuf *out, uint64_t sync, uint32_t schema_version);
+
 /**
  * Encode a reply to an IPROTO_VOTE request.
  * @param out Buffer to write to.
@@ -1008,6 +1026,14 @@ iproto_reply_vclock_xc(struct obuf *out, const struct vclock *vclock,
 		diag_raise();
 }
 
+/** @copydoc iproto_reply_id. */
+static inline void
+iproto_reply_id_xc(struct obuf *out, uint64_t sync, uint32_t schema_version)
+{
+	if (iproto_reply_id(out, sync, schema_version) != 0)
+		diag_raise();
+}
+
 /** @copydoc iproto_reply_vote. */
 static inline void
 iproto_reply_vote_xc(struct obuf *out, const struct ballot *ballot,
@@ -393,6 +393,126 @@ xrow_update_execute(const char *expr,const char *expr_end,
 	return xrow_update_finish(&update, format, p_tuple_len);
 }
 
+/** Check if a MessagePack value is a fixed-size number. */
+static inline bool
+xrow_update_mp_is_fixed_number(const char *data)
+{
+	switch (mp_typeof(*data)) {
+	case MP_UINT:
+	case MP_INT:
+	case MP_FLOAT:
+	case MP_DOUBLE:
+		return true;
+	default:
+		return false;
+	}
+}
+
+int
+xrow_update_prepare_in_place(const char *expr, const char *expr_end,
+			     const char *data, const char *data_end,
+			     struct tuple_format *format, int index_base,
+			     struct xrow_update_patch *patches,
+			     uint32_t *patch_count)
+{
+	(void)expr_end;
+	(void)data_end;
+	if (mp_typeof(*expr) != MP_ARRAY)
+		return -1;
+	uint32_t op_count = mp_decode_array(&expr);
+	if (op_count == 0 || op_count > XROW_UPDATE_IN_PLACE_OP_MAX)
+		return -1;
+	const char *fields = data;
+	uint32_t field_count = mp_decode_array(&fields);
+	for (uint32_t i = 0; i < op_count; i++) {
+		struct xrow_update_op op;
+		if (xrow_update_op_decode(&op, i + 1, index_base, format->dict,
+					  &expr) != 0)
+			return -1;
+		/* Only top-level fields can be patched. */
+		if (!xrow_update_op_is_term(&op))
+			return -1;
+		int32_t field_no = op.field_no;
+		if (field_no < 0)
+			field_no += field_count;
+		if (field_no < 0 || (uint32_t)field_no >= field_count)
+			return -1;
+		/*
+		 * Indexed fields can't be changed without moving
+		 * the tuple in the indexes.
+		 */
+		struct tuple_field *field = NULL;
+		if ((uint32_t)field_no < tuple_format_field_count(format)) {
+			field = tuple_format_field(format, field_no);
+			if (field->is_key_part ||
+			    field->token.max_child_idx >= 0)
+				return -1;
+		}
+		const char *old = fields;
+		for (int32_t j = 0; j < field_no; j++)
+			mp_next(&old);
+		if (!xrow_update_mp_is_fixed_number(old))
+			return -1;
+		const char *old_end = old;
+		mp_next(&old_end);
+		switch (op.opcode) {
+		case '=':
+			if (!xrow_update_mp_is_fixed_number(op.arg.set.value))
+				return -1;
+			break;
+		case '+':
+		case '-':
+			if (xrow_update_op_do_arith(&op, old) != 0 ||
+			    op.arg.arith.type == XUPDATE_TYPE_DECIMAL)
+				return -1;
+			break;
+		case '&':
+		case '^':
+		case '|':
+			if (xrow_update_op_do_bit(&op, old) != 0)
+				return -1;
+			break;
+		default:
+			return -1;
+		}
+		struct xrow_update_patch *patch = &patches[i];
+		uint32_t size = op.meta->store(&op, &format->fields,
+					       field != NULL ?
+					       &field->token : NULL,
+					       old, patch->value);
+		assert(size <= XROW_UPDATE_PATCH_SIZE_MAX);
+		if (size != (uint32_t)(old_end - old))
+			return -1;
+		if (field != NULL &&
+		    !field_mp_type_is_compatible(field->type, patch->value,
+						 tuple_field_is_nullable(field)))
+			return -1;
+		patch->offset = old - data;
+		patch->size = size;
+		/* Double update of the same field is an error. */
+		for (uint32_t j = 0; j < i; j++) {
+			if (patches[j].offset == patch->offset)
+				return -1;
+		}
+	}
+	*patch_count = op_count;
+	return 0;
+}
+
+void
+xrow_update_swap_in_place(char *data, struct xrow_update_patch *patches,
+			  uint32_t patch_count)
+{
+	char tmp[XROW_UPDATE_PATCH_SIZE_MAX];
+	for (uint32_t i = 0; i < patch_count; i++) {
+		struct xrow_update_patch *patch = &patches[i];
+		char *field = data + patch->offset;
+		memcpy(tmp, field, patch->size);
+		memcpy(field, patch->value, patch->size);
+		memcpy(patch->value, tmp, patch->size);
+	}
+}
+
 const char *
 xrow_upsert_execute(const char *expr,const char *expr_end,
 		    const char *old_data, const char *old_data_end,
@@ -33,6 +33,7 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "trivia/util.h"
 
 #if defined(__cplusplus)
@@ -42,6 +43,26 @@ extern "C" {
 enum {
 	/** A limit on how many operations a single UPDATE can have. */
 	BOX_UPDATE_OP_CNT_MAX = 4000,
+	/**
+	 * A limit on how many operations an UPDATE applied in
+	 * place can have.
+	 */
+	XROW_UPDATE_IN_PLACE_OP_MAX = 8,
+	/** Max encoded size of a field patched in place. */
+	XROW_UPDATE_PATCH_SIZE_MAX = 9,
+};
+
+/**
+ * A single field change of an UPDATE applied in place. The
+ * field keeps its offset and encoded size, only bytes change.
+ */
+struct xrow_update_patch {
+	/** Offset of the field from the beginning of tuple data. */
+	uint32_t offset;
+	/** Encoded size of the field. */
+	uint32_t size;
+	/** Encoded field value. */
+	char value[XROW_UPDATE_PATCH_SIZE_MAX];
 };
 
 struct tuple_format;
@@ -56,6 +77,50 @@ xrow_update_execute(const char *expr,const char *expr_end,
 		    struct tuple_format *format, uint32_t *p_new_size,
 		    int index_base, uint64_t *column_mask);
 
+/**
+ * Check if UPDATE operations can be applied to a tuple in place
+ * and prepare the new field values. It is possible only when
+ * all the operations are SET, arithmetic or bitwise operations
+ * on distinct top-level numeric fields, which are not indexed,
+ * and the encoded size of each changed field stays the same.
+ *
+ * The function never fails: when the operations are malformed
+ * or can't be applied in place, it returns -1 and the caller is
+ * supposed to fall back to xrow_update_execute(), which will
+ * report the error if any. The diagnostics area may be altered.
+ *
+ * @param expr UPDATE operations.
+ * @param expr_end End of @a expr.
+ * @param data Tuple data.
+ * @param data_end End of @a data.
+ * @param format Tuple format.
+ * @param index_base Field numbers base: 0 or 1.
+ * @param[out] patches Array of XROW_UPDATE_IN_PLACE_OP_MAX
+ *             patches to fill.
+ * @param[out] patch_count Number of filled patches.
+ *
+ * @retval 0 The patches are ready to be applied with
+ *         xrow_update_swap_in_place().
+ * @retval -1 The update can't be done in place.
+ */
+int
+xrow_update_prepare_in_place(const char *expr, const char *expr_end,
+			     const char *data, const char *data_end,
+			     struct tuple_format *format, int index_base,
+			     struct xrow_update_patch *patches,
+			     uint32_t *patch_count);
+
+/**
+ * Exchange the tuple fields with the values stored in the
+ * patches. Being applied to the result of
+ * xrow_update_prepare_in_place() it updates the tuple and makes
+ * the patches store the old field values, so applying it once
+ * again rolls the update back.
+ */
+void
+xrow_update_swap_in_place(char *data, struct xrow_update_patch *patches,
+			  uint32_t patch_count);
+
 const char *
 xrow_upsert_execute(const char *expr, const char *expr_end,
 		    const char *old_data, const char *old_data_end,
@@ -80,7 +80,117 @@ tt_bitset_test(struct tt_bitset *bitset, size_t pos)
 
 	assert(page->first_pos <= pos && pos < page->first_pos +
 	       BITSET_PAGE_DATA_SIZE * CHAR_BIT);
-	return bit_test(tt_bitset_page_data(page), pos - page->first_pos);
+	return tt_bitset_page_test(page, pos - page->first_pos);
+}
+
+/**
+ * Reallocate a page. Since the page may move, it is reinserted
+ * into the pages tree.
+ * @retval NULL on memory error, the page is left intact
+ */
+static struct tt_bitset_page *
+tt_bitset_page_realloc(struct tt_bitset *bitset, struct tt_bitset_page *page,
+		       size_t size)
+{
+	tt_bitset_pages_remove(&bitset->pages, page);
+	struct tt_bitset_page *new_page = bitset->realloc(page, size);
+	tt_bitset_pages_insert(&bitset->pages,
+			       new_page != NULL ? new_page : page);
+	return new_page;
+}
+
+/**
+ * Set or clear bit @a offset of a page, which must change its
+ * value, and switch the page to the most compact container.
+ * @retval 0 on success
+ * @retval -1 on memory error, the page is left intact
+ */
+static int
+tt_bitset_page_change(struct tt_bitset *bitset, struct tt_bitset_page *page,
+		      size_t offset, bool value)
+{
+	/* Every bit set joins or splits runs of its neighbours. */
+	int neighbours = 0;
+	if (offset > 0 && tt_bitset_page_test(page, offset - 1))
+		neighbours++;
+	if (offset + 1 < BITSET_PAGE_DATA_SIZE * CHAR_BIT &&
+	    tt_bitset_page_test(page, offset + 1))
+		neighbours++;
+	size_t cardinality = page->cardinality;
+	size_t run_count = page->run_count;
+	if (value) {
+		cardinality++;
+		run_count = run_count + 1 - neighbours;
+	} else {
+		cardinality--;
+		run_count = run_count + neighbours - 1;
+	}
+
+	/* Don't switch containers unless it saves memory. */
+	enum tt_bitset_container type =
+		(enum tt_bitset_container) page->type;
+	enum tt_bitset_container best =
+		tt_bitset_page_best_container(cardinality, run_count);
+	if (tt_bitset_page_entry_count(best, cardinality, run_count) <
+	    tt_bitset_page_entry_count(type, cardinality, run_count))
+		type = best;
+
+	if (type == page->type && type == BITSET_CONTAINER_BITMAP) {
+		void *data = tt_bitset_page_data(page);
+		if (value)
+			bit_set(data, offset);
+		else
+			bit_clear(data, offset);
+	} else if (type == page->type) {
+		size_t count = tt_bitset_page_entry_count(type, cardinality,
+							  run_count);
+		size_t capacity = page->capacity;
+		if (count > capacity) {
+			capacity = MIN(capacity * 2,
+				       (size_t) BITSET_PAGE_MAX_ENTRIES);
+		} else if (count * 4 <= capacity &&
+			   capacity > BITSET_PAGE_MIN_ENTRIES) {
+			capacity /= 2;
+		}
+		if (capacity != page->capacity) {
+			size_t size =
+				tt_bitset_page_entries_alloc_size(capacity);
+			struct tt_bitset_page *new_page =
+				tt_bitset_page_realloc(bitset, page, size);
+			if (new_page != NULL) {
+				page = new_page;
+				page->capacity = capacity;
+			} else if (count > page->capacity) {
+				return -1;
+			}
+		}
+		tt_bitset_page_update(page, offset, value);
+	} else {
+		tt_bitset_word_t buf[BITSET_PAGE_DATA_SIZE /
+				     sizeof(tt_bitset_word_t)];
+		tt_bitset_page_unpack(page, buf);
+		if (value)
+			bit_set(buf, offset);
+		else
+			bit_clear(buf, offset);
+		size_t capacity = 0;
+		size_t size = tt_bitset_page_alloc_size(bitset->realloc);
+		if (type != BITSET_CONTAINER_BITMAP) {
+			capacity = tt_bitset_page_entry_count(type, cardinality,
+							      run_count);
+			capacity = MAX(capacity,
+				       (size_t) BITSET_PAGE_MIN_ENTRIES);
+			size = tt_bitset_page_entries_alloc_size(capacity);
+		}
+		page = tt_bitset_page_realloc(bitset, page, size);
+		if (page == NULL)
+			return -1;
+		page->capacity = capacity;
+		tt_bitset_page_pack(page, type, buf);
+	}
+	page->cardinality = cardinality;
+	page->run_count = run_count;
+	return 0;
 }
 
 int
@@ -93,29 +203,39 @@ tt_bitset_set(struct tt_bitset *bitset, size_t pos)
 	struct tt_bitset_page *page =
 		tt_bitset_pages_search(&bitset->pages, &key);
 	if (page == NULL) {
-		/* Allocate a new page */
-		size_t size = tt_bitset_page_alloc_size(bitset->realloc);
+		/* Allocate a new page with a single bit set */
+		size_t size = tt_bitset_page_entries_alloc_size(
+			BITSET_PAGE_MIN_ENTRIES);
 		page = bitset->realloc(NULL, size);
 		if (page == NULL)
 			return -1;
 
-		tt_bitset_page_create(page);
+		memset(page, 0, size);
 		page->first_pos = key.first_pos;
+		page->type = BITSET_CONTAINER_ARRAY;
+		page->capacity = BITSET_PAGE_MIN_ENTRIES;
+		page->cardinality = 1;
+		page->run_count = 1;
+		tt_bitset_page_entries(page)[0] = pos - page->first_pos;
 
 		/* Insert the page into pages tree */
 		tt_bitset_pages_insert(&bitset->pages, page);
+		bitset->cardinality++;
+		return 0;
 	}
 
 	assert(page->first_pos <= pos && pos < page->first_pos +
 	       BITSET_PAGE_DATA_SIZE * CHAR_BIT);
-	bool prev = bit_set(tt_bitset_page_data(page), pos - page->first_pos);
-	if (prev) {
+	size_t offset = pos - page->first_pos;
+	if (tt_bitset_page_test(page, offset)) {
 		/* Value has not changed */
 		return 1;
 	}
 
+	if (tt_bitset_page_change(bitset, page, offset, true) != 0)
+		return -1;
+
 	bitset->cardinality++;
-	page->cardinality++;
 
 	return 0;
 }
@@ -134,24 +254,26 @@ tt_bitset_clear(struct tt_bitset *bitset, size_t pos)
 
 	assert(page->first_pos <= pos && pos < page->first_pos +
 	       BITSET_PAGE_DATA_SIZE * CHAR_BIT);
-	bool prev = bit_clear(tt_bitset_page_data(page), pos - page->first_pos);
-	if (!prev) {
+	size_t offset = pos - page->first_pos;
+	if (!tt_bitset_page_test(page, offset)) {
 		return 0;
 	}
 
 	assert(bitset->cardinality > 0);
 	assert(page->cardinality > 0);
-	bitset->cardinality--;
-	page->cardinality--;
 
-	if (page->cardinality == 0) {
+	if (page->cardinality == 1) {
 		/* Remove the page from the pages tree */
 		tt_bitset_pages_remove(&bitset->pages, page);
 		/* Free the page */
 		tt_bitset_page_destroy(page);
 		bitset->realloc(page, 0);
+	} else if (tt_bitset_page_change(bitset, page, offset, false) != 0) {
+		return -1;
 	}
 
+	bitset->cardinality--;
+
 	return 1;
 }
 
@@ -170,6 +292,24 @@ tt_bitset_info(struct tt_bitset *bitset, struct tt_bitset_info *info)
 	struct tt_bitset_page *page = tt_bitset_pages_first(&bitset->pages);
 	while (page != NULL) {
 		info->pages++;
+		switch (page->type) {
+		case BITSET_CONTAINER_BITMAP:
+			info->bitmap_pages++;
+			info->mem_size += info->page_total_size;
+			break;
+		case BITSET_CONTAINER_ARRAY:
+			info->array_pages++;
+			info->mem_size +=
+				tt_bitset_page_entries_alloc_size(page->capacity);
+			break;
+		case BITSET_CONTAINER_RUN:
+			info->run_pages++;
+			info->mem_size +=
+				tt_bitset_page_entries_alloc_size(page->capacity);
+			break;
+		default:
+			unreachable();
+		}
 		cardinality_check += page->cardinality;
 		page = tt_bitset_pages_next(&bitset->pages, page);
 	}
@@ -40,6 +40,11 @@
  * by \a size_t position number.  Initially all bits are set to
  * false. You can use any values in range [0,SIZE_MAX).  The
  * container grows automatically.
+ *
+ * Bits are stored in pages of a fixed bit range. Similarly to
+ * roaring bitmaps, each page picks the most compact container
+ * for its content: a plain bitmap, a sorted array of set bits
+ * or a sorted array of runs of consecutive set bits.
  */
 
 #include "bit/bit.h"
@@ -68,7 +73,14 @@ extern "C" {
 struct tt_bitset_page {
 	size_t first_pos;
 	rb_node(struct tt_bitset_page) node;
-	size_t cardinality;
+	/** Number of bits set in the page */
+	uint16_t cardinality;
+	/** Number of runs of consecutive bits set in the page */
+	uint16_t run_count;
+	/** Container type, see enum tt_bitset_container */
+	uint16_t type;
+	/** Number of uint16_t entries allocated for array and run data */
+	uint16_t capacity;
 	uint8_t data[];
 };
 
@@ -151,9 +163,20 @@ tt_bitset_cardinality(const struct tt_bitset *bitset) {
 struct tt_bitset_info {
 	/** Number of allocated pages */
 	size_t pages;
-	/** Data (payload) size of one page (in bytes) */
+	/** Number of pages stored as plain bitmaps */
+	size_t bitmap_pages;
+	/** Number of pages stored as sorted arrays of set bits */
+	size_t array_pages;
+	/** Number of pages stored as runs of set bits */
+	size_t run_pages;
+	/** Total size of all allocated pages (in bytes) */
+	size_t mem_size;
+	/** Data (payload) size of one bitmap page (in bytes) */
 	size_t page_data_size;
-	/** Full size of one page (in bytes, including padding and tree data) */
+	/**
+	 * Full size of one bitmap page (in bytes, including padding
+	 * and tree data)
+	 */
 	size_t page_total_size;
 	/** A multiplier by which an address of page data is aligned **/
 	size_t page_data_alignment;
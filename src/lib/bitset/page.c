@@ -44,6 +44,22 @@ tt_bitset_page_create(struct tt_bitset_page *page);
 extern inline void
 tt_bitset_page_destroy(struct tt_bitset_page *page);
 
+extern inline uint16_t *
+tt_bitset_page_entries(struct tt_bitset_page *page);
+
+extern inline size_t
+tt_bitset_page_entries_alloc_size(size_t capacity);
+
+extern inline size_t
+tt_bitset_page_entry_count(enum tt_bitset_container type,
+			   size_t cardinality, size_t run_count);
+
+extern inline enum tt_bitset_container
+tt_bitset_page_best_container(size_t cardinality, size_t run_count);
+
+extern inline const tt_bitset_word_t *
+tt_bitset_page_bitmap(struct tt_bitset_page *page, tt_bitset_word_t *buf);
+
 extern inline size_t
 tt_bitset_page_first_pos(size_t pos);
 
@@ -62,6 +78,197 @@ tt_bitset_page_nand(struct tt_bitset_page *dst, struct tt_bitset_page *src);
 extern inline void
 tt_bitset_page_or(struct tt_bitset_page *dst, struct tt_bitset_page *src);
 
+/**
+ * Find the first entry greater than @a offset in a sorted array
+ * of @a count entries with the given @a step.
+ */
+static size_t
+tt_bitset_page_upper_bound(const uint16_t *entries, size_t count,
+			   size_t step, size_t offset)
+{
+	size_t begin = 0, end = count;
+	while (begin < end) {
+		size_t mid = begin + (end - begin) / 2;
+		if (entries[mid * step] <= offset)
+			begin = mid + 1;
+		else
+			end = mid;
+	}
+	return begin;
+}
+
+bool
+tt_bitset_page_test(struct tt_bitset_page *page, size_t offset)
+{
+	assert(offset < BITSET_PAGE_DATA_SIZE * CHAR_BIT);
+	if (page->type == BITSET_CONTAINER_BITMAP)
+		return bit_test(tt_bitset_page_data(page), offset);
+	uint16_t *entries = tt_bitset_page_entries(page);
+	if (page->type == BITSET_CONTAINER_ARRAY) {
+		size_t i = tt_bitset_page_upper_bound(entries,
+						      page->cardinality, 1,
+						      offset);
+		return i > 0 && entries[i - 1] == offset;
+	}
+	assert(page->type == BITSET_CONTAINER_RUN);
+	/* Find the last run starting at or before the offset. */
+	size_t i = tt_bitset_page_upper_bound(entries, page->run_count, 2,
+					      offset);
+	return i > 0 && entries[2 * (i - 1) + 1] >= offset;
+}
+
+static void
+tt_bitset_page_array_update(struct tt_bitset_page *page, size_t offset,
+			    bool value)
+{
+	uint16_t *entries = tt_bitset_page_entries(page);
+	size_t count = page->cardinality;
+	size_t i = tt_bitset_page_upper_bound(entries, count, 1, offset);
+	if (value) {
+		assert(i == 0 || entries[i - 1] != offset);
+		assert(count < page->capacity);
+		memmove(entries + i + 1, entries + i,
+			(count - i) * sizeof(*entries));
+		entries[i] = offset;
+	} else {
+		assert(i > 0 && entries[i - 1] == offset);
+		memmove(entries + i - 1, entries + i,
+			(count - i) * sizeof(*entries));
+	}
+}
+
+static void
+tt_bitset_page_run_update(struct tt_bitset_page *page, size_t offset,
+			  bool value)
+{
+	uint16_t *entries = tt_bitset_page_entries(page);
+	size_t count = page->run_count;
+	/* Runs [0, i) start at or before the offset. */
+	size_t i = tt_bitset_page_upper_bound(entries, count, 2, offset);
+	uint16_t *prev = i > 0 ? &entries[2 * (i - 1)] : NULL;
+	uint16_t *next = i < count ? &entries[2 * i] : NULL;
+	if (value) {
+		assert(prev == NULL || prev[1] < offset);
+		bool join_prev = prev != NULL && (size_t) prev[1] + 1 == offset;
+		bool join_next = next != NULL && next[0] == offset + 1;
+		if (join_prev && join_next) {
+			/* Merge the two runs. */
+			prev[1] = next[1];
+			memmove(next, next + 2,
+				(count - i - 1) * 2 * sizeof(*entries));
+		} else if (join_prev) {
+			prev[1] = offset;
+		} else if (join_next) {
+			next[0] = offset;
+		} else {
+			assert(2 * (count + 1) <= page->capacity);
+			memmove(entries + 2 * (i + 1), entries + 2 * i,
+				(count - i) * 2 * sizeof(*entries));
+			entries[2 * i] = offset;
+			entries[2 * i + 1] = offset;
+		}
+	} else {
+		assert(prev != NULL && prev[1] >= offset);
+		if (prev[0] == prev[1]) {
+			memmove(prev, prev + 2,
+				(count - i) * 2 * sizeof(*entries));
+		} else if (prev[0] == offset) {
+			prev[0]++;
+		} else if (prev[1] == offset) {
+			prev[1]--;
+		} else {
+			/* Split the run. */
+			assert(2 * (count + 1) <= page->capacity);
+			memmove(entries + 2 * (i + 1), entries + 2 * i,
+				(count - i) * 2 * sizeof(*entries));
+			entries[2 * i] = offset + 1;
+			entries[2 * i + 1] = prev[1];
+			prev[1] = offset - 1;
+		}
+	}
+}
+
+void
+tt_bitset_page_update(struct tt_bitset_page *page, size_t offset, bool value)
+{
+	assert(offset < BITSET_PAGE_DATA_SIZE * CHAR_BIT);
+	if (page->type == BITSET_CONTAINER_ARRAY) {
+		tt_bitset_page_array_update(page, offset, value);
+	} else {
+		assert(page->type == BITSET_CONTAINER_RUN);
+		tt_bitset_page_run_update(page, offset, value);
+	}
+}
+
+/** Set bits [first, last] of a plain bitmap */
+static void
+tt_bitset_bitmap_set_range(uint8_t *bitmap, size_t first, size_t last)
+{
+	size_t first_byte = first / CHAR_BIT;
+	size_t last_byte = last / CHAR_BIT;
+	uint8_t first_mask = (uint8_t) (0xff << (first % CHAR_BIT));
+	uint8_t last_mask = (uint8_t) (0xff >> (CHAR_BIT - 1 -
+						last % CHAR_BIT));
+	if (first_byte == last_byte) {
+		bitmap[first_byte] |= first_mask & last_mask;
+		return;
+	}
+	bitmap[first_byte] |= first_mask;
+	memset(bitmap + first_byte + 1, 0xff, last_byte - first_byte - 1);
+	bitmap[last_byte] |= last_mask;
+}
+
+void
+tt_bitset_page_unpack(struct tt_bitset_page *page, void *bitmap)
+{
+	if (page->type == BITSET_CONTAINER_BITMAP) {
+		memcpy(bitmap, tt_bitset_page_data(page),
+		       BITSET_PAGE_DATA_SIZE);
+		return;
+	}
+	memset(bitmap, 0, BITSET_PAGE_DATA_SIZE);
+	const uint16_t *entries = tt_bitset_page_entries(page);
+	if (page->type == BITSET_CONTAINER_ARRAY) {
+		for (size_t i = 0; i < page->cardinality; i++)
+			bit_set(bitmap, entries[i]);
+		return;
+	}
+	assert(page->type == BITSET_CONTAINER_RUN);
+	for (size_t i = 0; i < page->run_count; i++) {
+		tt_bitset_bitmap_set_range((uint8_t *) bitmap,
+					   entries[2 * i], entries[2 * i + 1]);
+	}
+}
+
+void
+tt_bitset_page_pack(struct tt_bitset_page *page,
+		    enum tt_bitset_container type, const void *bitmap)
+{
+	page->type = type;
+	if (type == BITSET_CONTAINER_BITMAP) {
+		memcpy(tt_bitset_page_data(page), bitmap,
+		       BITSET_PAGE_DATA_SIZE);
+		return;
+	}
+	uint16_t *entries = tt_bitset_page_entries(page);
+	struct bit_iterator it;
+	bit_iterator_init(&it, bitmap, BITSET_PAGE_DATA_SIZE, true);
+	size_t count = 0;
+	size_t pos;
+	while ((pos = bit_iterator_next(&it)) != SIZE_MAX) {
+		if (type == BITSET_CONTAINER_ARRAY) {
+			assert(count < page->capacity);
+			entries[count++] = pos;
+		} else if (count > 0 && (size_t) entries[count - 1] + 1 == pos) {
+			entries[count - 1] = pos;
+		} else {
+			assert(count + 2 <= page->capacity);
+			entries[count++] = pos;
+			entries[count++] = pos;
+		}
+	}
+}
+
 #if defined(DEBUG)
 void
 tt_bitset_page_dump(struct tt_bitset_page *page, FILE *stream)
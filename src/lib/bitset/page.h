@@ -48,6 +48,11 @@
 #include <string.h>
 #include <limits.h>
 #include <assert.h>
+#if defined(ENABLE_AVX)
+#include <immintrin.h>
+#elif defined(ENABLE_SSE2)
+#include <emmintrin.h>
+#endif
 
 #if defined(__cplusplus)
 extern "C" {
@@ -55,7 +60,21 @@ extern "C" {
 
 enum {
 	/** How many bytes to store in one page */
-	BITSET_PAGE_DATA_SIZE = 160
+	BITSET_PAGE_DATA_SIZE = 160,
+	/** Max number of uint16_t entries in array and run containers */
+	BITSET_PAGE_MAX_ENTRIES = BITSET_PAGE_DATA_SIZE / sizeof(uint16_t),
+	/** Number of uint16_t entries allocated for a new page */
+	BITSET_PAGE_MIN_ENTRIES = 4,
+};
+
+/** Page containers */
+enum tt_bitset_container {
+	/** BITSET_PAGE_DATA_SIZE bytes of plain bitmap */
+	BITSET_CONTAINER_BITMAP = 0,
+	/** Sorted array of offsets of bits set */
+	BITSET_CONTAINER_ARRAY = 1,
+	/** Sorted array of [first, last] offsets of runs of bits set */
+	BITSET_CONTAINER_RUN = 2,
 };
 
 #if defined(ENABLE_AVX)
@@ -114,12 +133,62 @@ tt_bitset_page_data(struct tt_bitset_page *page)
 	return (void *) (r & ~((uintptr_t) BITSET_PAGE_DATA_ALIGNMENT - 1));
 }
 
+/**
+ * Create an empty bitmap page. The page must be allocated with
+ * tt_bitset_page_alloc_size() bytes.
+ */
 inline void
 tt_bitset_page_create(struct tt_bitset_page *page)
 {
 	size_t size = ((char *) tt_bitset_page_data(page) - (char *) page)
 			+ BITSET_PAGE_DATA_SIZE;
 	memset(page, 0, size);
+	page->type = BITSET_CONTAINER_BITMAP;
+}
+
+/** Data of an array or a run container */
+inline uint16_t *
+tt_bitset_page_entries(struct tt_bitset_page *page)
+{
+	assert(page->type != BITSET_CONTAINER_BITMAP);
+	return (uint16_t *) page->data;
+}
+
+/** Allocation size of an array or a run page for @a capacity entries */
+inline size_t
+tt_bitset_page_entries_alloc_size(size_t capacity)
+{
+	return sizeof(struct tt_bitset_page) + capacity * sizeof(uint16_t);
+}
+
+/** Number of uint16_t entries used by the content of a page */
+inline size_t
+tt_bitset_page_entry_count(enum tt_bitset_container type,
+			   size_t cardinality, size_t run_count)
+{
+	switch (type) {
+	case BITSET_CONTAINER_ARRAY:
+		return cardinality;
+	case BITSET_CONTAINER_RUN:
+		return run_count * 2;
+	default:
+		return BITSET_PAGE_MAX_ENTRIES;
+	}
+}
+
+/**
+ * The most compact container to store a page content.
+ * Arrays are preferred to runs and runs are preferred to bitmaps.
+ */
+inline enum tt_bitset_container
+tt_bitset_page_best_container(size_t cardinality, size_t run_count)
+{
+	if (cardinality <= BITSET_PAGE_MAX_ENTRIES &&
+	    cardinality <= run_count * 2)
+		return BITSET_CONTAINER_ARRAY;
+	if (run_count * 2 < BITSET_PAGE_MAX_ENTRIES)
+		return BITSET_CONTAINER_RUN;
+	return BITSET_CONTAINER_BITMAP;
 }
 
 inline void
@@ -148,11 +217,54 @@ tt_bitset_page_set_ones(struct tt_bitset_page *page)
 	memset(data, -1, BITSET_PAGE_DATA_SIZE);
 }
 
+/**
+ * Test bit @a offset of a page of any container.
+ */
+bool
+tt_bitset_page_test(struct tt_bitset_page *page, size_t offset);
+
+/**
+ * Set or clear bit @a offset of an array or a run page in place.
+ * The page must have enough capacity for the new content.
+ */
+void
+tt_bitset_page_update(struct tt_bitset_page *page, size_t offset, bool value);
+
+/**
+ * Unpack a page of any container to BITSET_PAGE_DATA_SIZE bytes
+ * of plain bitmap.
+ */
+void
+tt_bitset_page_unpack(struct tt_bitset_page *page, void *bitmap);
+
+/**
+ * Pack a plain bitmap to a page of the given container. The page
+ * must have enough capacity for the content.
+ */
+void
+tt_bitset_page_pack(struct tt_bitset_page *page,
+		    enum tt_bitset_container type, const void *bitmap);
+
+/**
+ * Return the plain bitmap of a page: the page data for bitmap
+ * pages, otherwise the page is unpacked to @a buf.
+ */
+inline const tt_bitset_word_t *
+tt_bitset_page_bitmap(struct tt_bitset_page *page, tt_bitset_word_t *buf)
+{
+	if (page->type == BITSET_CONTAINER_BITMAP)
+		return (const tt_bitset_word_t *) tt_bitset_page_data(page);
+	tt_bitset_page_unpack(page, buf);
+	return buf;
+}
+
 inline void
 tt_bitset_page_and(struct tt_bitset_page *dst, struct tt_bitset_page *src)
 {
+	assert(dst->type == BITSET_CONTAINER_BITMAP);
+	tt_bitset_word_t buf[BITSET_PAGE_DATA_SIZE / sizeof(tt_bitset_word_t)];
 	tt_bitset_word_t *d = (tt_bitset_word_t *) tt_bitset_page_data(dst);
-	tt_bitset_word_t *s = (tt_bitset_word_t *) tt_bitset_page_data(src);
+	const tt_bitset_word_t *s = tt_bitset_page_bitmap(src, buf);
 
 	assert(BITSET_PAGE_DATA_SIZE % sizeof(tt_bitset_word_t) == 0);
 	int cnt = BITSET_PAGE_DATA_SIZE / sizeof(tt_bitset_word_t);
@@ -164,8 +276,10 @@ tt_bitset_page_and(struct tt_bitset_page *dst, struct tt_bitset_page *src)
 inline void
 tt_bitset_page_nand(struct tt_bitset_page *dst, struct tt_bitset_page *src)
 {
+	assert(dst->type == BITSET_CONTAINER_BITMAP);
+	tt_bitset_word_t buf[BITSET_PAGE_DATA_SIZE / sizeof(tt_bitset_word_t)];
 	tt_bitset_word_t *d = (tt_bitset_word_t *) tt_bitset_page_data(dst);
-	tt_bitset_word_t *s = (tt_bitset_word_t *) tt_bitset_page_data(src);
+	const tt_bitset_word_t *s = tt_bitset_page_bitmap(src, buf);
 
 	assert(BITSET_PAGE_DATA_SIZE % sizeof(tt_bitset_word_t) == 0);
 	int cnt = BITSET_PAGE_DATA_SIZE / sizeof(tt_bitset_word_t);
@@ -177,8 +291,10 @@ tt_bitset_page_nand(struct tt_bitset_page *dst, struct tt_bitset_page *src)
 inline void
 tt_bitset_page_or(struct tt_bitset_page *dst, struct tt_bitset_page *src)
 {
+	assert(dst->type == BITSET_CONTAINER_BITMAP);
+	tt_bitset_word_t buf[BITSET_PAGE_DATA_SIZE / sizeof(tt_bitset_word_t)];
 	tt_bitset_word_t *d = (tt_bitset_word_t *) tt_bitset_page_data(dst);
-	tt_bitset_word_t *s = (tt_bitset_word_t *) tt_bitset_page_data(src);
+	const tt_bitset_word_t *s = tt_bitset_page_bitmap(src, buf);
 
 	assert(BITSET_PAGE_DATA_SIZE % sizeof(tt_bitset_word_t) == 0);
 	int cnt = BITSET_PAGE_DATA_SIZE / sizeof(tt_bitset_word_t);
@@ -38,6 +38,63 @@
 #include <math.h>
 #include <assert.h>
 #include <string.h>
+#include "trivia/util.h"
+
+/**
+ * Return the false positive rate of a blocked filter given
+ * the average number of values stored in a bucket.
+ */
+static double
+bloom_blocked_fpr(double values_per_bucket)
+{
+	/*
+	 * The number of values in a bucket follows the Poisson
+	 * distribution. A bucket storing j values gives a false
+	 * positive if all words have the tested bits set.
+	 */
+	double lambda = values_per_bucket;
+	if (lambda <= 0)
+		return 0;
+	double spread = 10 * sqrt(lambda) + 10;
+	uint32_t j_min = lambda > spread ? floor(lambda - spread) : 0;
+	uint32_t j_max = ceil(lambda + spread);
+	const double word_bits = CHAR_BIT * sizeof(uint64_t);
+	double fpr = 0;
+	for (uint32_t j = j_min; j <= j_max; j++) {
+		double p = exp(-lambda + j * log(lambda) - lgamma(j + 1));
+		double word_fpr = 1 - pow(1 - 1 / word_bits, j);
+		fpr += p * pow(word_fpr, BLOOM_BUCKET_WORDS);
+	}
+	return MIN(fpr, 1.0);
+}
+
+/**
+ * Return the min number of blocks a blocked filter needs to store
+ * the given number of values with the given false positive rate
+ * or 0 if it needs more than @a max_block_count blocks.
+ */
+static uint32_t
+bloom_blocked_block_count(uint32_t number_of_values,
+			  double false_positive_rate,
+			  uint32_t max_block_count)
+{
+	double buckets_per_block = BLOOM_BLOCK_BUCKETS;
+	if (max_block_count == 0 ||
+	    bloom_blocked_fpr(number_of_values / buckets_per_block /
+			      max_block_count) > false_positive_rate)
+		return 0;
+	/* The false positive rate decreases with the block count */
+	uint32_t lo = 1, hi = max_block_count;
+	while (lo < hi) {
+		uint32_t mid = lo + (hi - lo) / 2;
+		if (bloom_blocked_fpr(number_of_values / buckets_per_block /
+				      mid) > false_positive_rate)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
 
 int
 bloom_create(struct bloom *bloom, uint32_t number_of_values,
@@ -48,6 +105,16 @@ bloom_create(struct bloom *bloom, uint32_t number_of_values,
 	uint64_t bit_count = ceil(number_of_values * hash_count / log(2));
 	uint32_t block_bits = CHAR_BIT * sizeof(struct bloom_block);
 	uint32_t block_count = (bit_count + block_bits - 1) / block_bits;
+	uint8_t type = BLOOM_CLASSIC;
+
+	/* Prefer a blocked filter unless it is bigger */
+	uint32_t blocked_block_count = bloom_blocked_block_count(
+		number_of_values, false_positive_rate, block_count);
+	if (blocked_block_count > 0) {
+		block_count = blocked_block_count;
+		hash_count = BLOOM_BUCKET_WORDS;
+		type = BLOOM_BLOCKED;
+	}
 
 	bloom->table = calloc(block_count, sizeof(*bloom->table));
 	if (bloom->table == NULL)
@@ -55,6 +122,7 @@ bloom_create(struct bloom *bloom, uint32_t number_of_values,
 
 	bloom->table_size = block_count;
 	bloom->hash_count = hash_count;
+	bloom->type = type;
 	return 0;
 }
 
@@ -67,6 +135,11 @@ bloom_destroy(struct bloom *bloom)
 double
 bloom_fpr(const struct bloom *bloom, uint32_t number_of_values)
 {
+	if (bloom->type == BLOOM_BLOCKED) {
+		double bucket_count = (double)bloom->table_size *
+				      BLOOM_BLOCK_BUCKETS;
+		return bloom_blocked_fpr(number_of_values / bucket_count);
+	}
 	/* Number of hash functions. */
 	uint16_t k = bloom->hash_count;
 	/* Number of bits. */
@@ -136,6 +136,7 @@
  *                      alloc_ctx);
  * void bps_tree_destroy(tree);
  * int bps_tree_build(tree, sorted_array, array_size);
+ * size_t bps_tree_build_extent_count(tree, array_size);
  * bps_tree_elem_t *bps_tree_find(tree, key);
  * int bps_tree_insert(tree, new_elem, replaced_elem);
  * int bps_tree_insert_get_iterator(tree, new_elem, replaced_elem,
@@ -158,11 +159,26 @@
  * struct bps_tree_iterator bps_tree_lower_bound_elem(tree, elem, exact);
  * struct bps_tree_iterator bps_tree_upper_bound_elem(tree, elem, exact);
  * size_t bps_tree_approxiamte_count(tree, key);
+ * // with BPS_INNER_CARD defined:
+ * struct bps_tree_iterator bps_tree_lower_bound_get_offset(tree, key, exact,
+ *							     offset);
+ * struct bps_tree_iterator bps_tree_upper_bound_get_offset(tree, key, exact,
+ *							     offset);
+ * struct bps_tree_iterator bps_tree_iterator_at(tree, offset);
  * bps_tree_elem_t *bps_tree_iterator_get_elem(tree, itr);
  * bool bps_tree_iterator_next(tree, itr);
  * bool bps_tree_iterator_prev(tree, itr);
  * void bps_tree_iterator_freeze(tree, itr);
  * void bps_tree_iterator_destroy(tree, itr);
+ *
+ * // frozen views:
+ * void bps_tree_view_create(tree, view, arg);
+ * void bps_tree_view_destroy(tree, view);
+ * struct bps_tree_iterator bps_tree_view_first(view);
+ * struct bps_tree_iterator bps_tree_view_lower_bound(tree, view, key, exact);
+ * struct bps_tree_iterator bps_tree_view_upper_bound(tree, view, key, exact);
+ * bps_tree_elem_t *bps_tree_view_iterator_get_elem(tree, view, itr);
+ * bool bps_tree_view_iterator_next(tree, view, itr);
  */
 /* }}} */
 
@@ -309,6 +325,17 @@
  * #define BPS_TREE_DEBUG_BRANCH_VISIT
  */
 
+/**
+ * A switch that makes every inner block store the number of
+ * elements in the subtree of each of its children. It costs
+ * a few bytes per child (thus inner blocks get a bit less
+ * children) and a walk up the path on each insertion and
+ * deletion, but allows to find the offset of an element and
+ * the element by its offset in logarithmic time, and makes
+ * bps_tree_random() uniform. To turn it on,
+ * #define BPS_INNER_CARD
+ */
+
 /* }}} */
 
 #ifdef BPS_TREE_NAMESPACE
@@ -370,6 +397,7 @@ typedef uint32_t bps_tree_block_id_t;
 
 #define bps_tree_create _api_name(create)
 #define bps_tree_build _api_name(build)
+#define bps_tree_build_extent_count _api_name(build_extent_count)
 #define bps_tree_destroy _api_name(destroy)
 #define bps_tree_find _api_name(find)
 #define bps_tree_insert _api_name(insert)
@@ -389,11 +417,22 @@ typedef uint32_t bps_tree_block_id_t;
 #define bps_tree_lower_bound_elem _api_name(lower_bound_elem)
 #define bps_tree_upper_bound_elem _api_name(upper_bound_elem)
 #define bps_tree_approximate_count _api_name(approximate_count)
+#define bps_tree_lower_bound_get_offset _api_name(lower_bound_get_offset)
+#define bps_tree_upper_bound_get_offset _api_name(upper_bound_get_offset)
+#define bps_tree_iterator_at _api_name(iterator_at)
 #define bps_tree_iterator_get_elem _api_name(iterator_get_elem)
 #define bps_tree_iterator_next _api_name(iterator_next)
 #define bps_tree_iterator_prev _api_name(iterator_prev)
 #define bps_tree_iterator_freeze _api_name(iterator_freeze)
 #define bps_tree_iterator_destroy _api_name(iterator_destroy)
+#define bps_tree_view _api_name(view)
+#define bps_tree_view_create _api_name(view_create)
+#define bps_tree_view_destroy _api_name(view_destroy)
+#define bps_tree_view_first _api_name(view_first)
+#define bps_tree_view_lower_bound _api_name(view_lower_bound)
+#define bps_tree_view_upper_bound _api_name(view_upper_bound)
+#define bps_tree_view_iterator_get_elem _api_name(view_iterator_get_elem)
+#define bps_tree_view_iterator_next _api_name(view_iterator_next)
 #define bps_tree_debug_check _api_name(debug_check)
 #define bps_tree_print _api_name(print)
 #define bps_tree_debug_check_internal_functions \
@@ -416,7 +455,16 @@ typedef uint32_t bps_tree_block_id_t;
 #define bps_tree_find_ins_point_elem _bps_tree(find_ins_point_elem)
 #define bps_tree_find_after_ins_point_key _bps_tree(find_after_ins_point_key)
 #define bps_tree_find_after_ins_point_elem _bps_tree(find_after_ins_point_elem)
+#define bps_tree_view_find_point_key _bps_tree(view_find_point_key)
+#define bps_tree_view_bound _bps_tree(view_bound)
 #define bps_tree_get_leaf_safe _bps_tree(get_leaf_safe)
+#define bps_tree_block_card _bps_tree(block_card)
+#define bps_tree_build_cards _bps_tree(build_cards)
+#define bps_tree_update_card _bps_tree(update_card)
+#define bps_tree_leaf_update_card _bps_tree(leaf_update_card)
+#define bps_tree_inner_update_card _bps_tree(inner_update_card)
+#define bps_tree_move_children _bps_tree(move_children)
+#define bps_tree_set_child _bps_tree(set_child)
 #define bps_tree_garbage_push _bps_tree(garbage_push)
 #define bps_tree_garbage_pop _bps_tree(garbage_pop)
 #define bps_tree_create_leaf _bps_tree(create_leaf)
@@ -567,6 +615,29 @@ struct bps_tree_iterator {
 	struct matras_view view;
 };
 
+/**
+ * Frozen tree state. Unlike a frozen iterator, a view supports
+ * lookups, so any number of iterators may be positioned in the
+ * tree as it was at the moment of the view creation. Reading
+ * functions of a view don't modify the tree and may be called
+ * from a thread other than the one that modifies the tree;
+ * a view must be created and destroyed in the latter.
+ * Iterators positioned in a view must only be used with the
+ * bps_tree_view_iterator_* functions.
+ */
+struct bps_tree_view {
+	/* Version of matras memory */
+	struct matras_view view;
+	/* Root and first leaf IDs at the moment of creation */
+	bps_tree_block_id_t root_id, first_id;
+	/* Depth of the tree at the moment of creation */
+	bps_tree_block_id_t depth;
+	/* Number of elements at the moment of creation */
+	size_t size;
+	/* Argument for comparator used for lookups in the view */
+	bps_tree_arg_t arg;
+};
+
 /**
  * Pointer to function that allocates extent of size BPS_TREE_EXTENT_SIZE
  * BPS-tree properly handles with NULL result but could leak memory
@@ -607,6 +678,17 @@ static inline int
 bps_tree_build(struct bps_tree *tree, bps_tree_elem_t *sorted_array,
 	       size_t array_size);
 
+/**
+ * @brief Get the max number of extents allocated by bps_tree_build()
+ *  for an array of the given size, including matras index extents.
+ *  Allows to reserve memory before building a tree.
+ * @param tree - pointer to a tree
+ * @param array_size - size of the array (count of elements)
+ * @return - number of extents
+ */
+static inline size_t
+bps_tree_build_extent_count(const struct bps_tree *tree, size_t array_size);
+
 /**
  * @brief Tree destruction. Frees allocated memory.
  * @param tree - pointer to a tree
@@ -804,6 +886,50 @@ bps_tree_upper_bound_elem(const struct bps_tree *tree, bps_tree_elem_t key,
 static inline size_t
 bps_tree_approximate_count(const struct bps_tree *tree, bps_tree_key_t key);
 
+#ifdef BPS_INNER_CARD
+/**
+ * @brief Same as bps_tree_lower_bound, but also returns the offset of
+ *  the found element, i.e. the number of elements that are less than key.
+ * @param tree - pointer to a tree
+ * @param key - key that will be compared with elements
+ * @param exact - see bps_tree_lower_bound
+ * @param[out] offset - offset of the found element, size of the tree
+ *  if the returned iterator is invalid.
+ * @return - Lower-bound iterator. Invalid if all elements are less than key.
+ */
+static inline struct bps_tree_iterator
+bps_tree_lower_bound_get_offset(const struct bps_tree *tree,
+				bps_tree_key_t key, bool *exact,
+				size_t *offset);
+
+/**
+ * @brief Same as bps_tree_upper_bound, but also returns the offset of
+ *  the found element, i.e. the number of elements that are less or equal
+ *  than key.
+ * @param tree - pointer to a tree
+ * @param key - key that will be compared with elements
+ * @param exact - see bps_tree_upper_bound
+ * @param[out] offset - offset of the found element, size of the tree
+ *  if the returned iterator is invalid.
+ * @return - Upper-bound iterator. Invalid if all elements are less or equal
+ *  than the key.
+ */
+static inline struct bps_tree_iterator
+bps_tree_upper_bound_get_offset(const struct bps_tree *tree,
+				bps_tree_key_t key, bool *exact,
+				size_t *offset);
+
+/**
+ * @brief Get an iterator to the element with the given offset,
+ *  i.e. to the element having exactly @a offset elements before it.
+ * @param tree - pointer to a tree
+ * @param offset - offset of the element
+ * @return - Iterator to the element. Invalid if offset >= tree size.
+ */
+static inline struct bps_tree_iterator
+bps_tree_iterator_at(const struct bps_tree *tree, size_t offset);
+#endif /* BPS_INNER_CARD */
+
 /**
  * @brief Get a pointer to the element pointed by iterator.
  *  If iterator is detected as broken, it is invalidated and NULL returned.
@@ -858,6 +984,73 @@ bps_tree_iterator_freeze(struct bps_tree *tree, struct bps_tree_iterator *itr);
 static inline void
 bps_tree_iterator_destroy(struct bps_tree *tree, struct bps_tree_iterator *itr);
 
+/**
+ * @brief Create a frozen view of the tree. All following tree
+ * modifications will not be visible through the view. The view
+ * must be destroyed with bps_tree_view_destroy after usage.
+ * @param tree - pointer to a tree
+ * @param view - pointer to a view to initialize
+ * @param arg - argument for comparator used for lookups in the
+ *  view, may differ from the tree one if the latter may be
+ *  freed while the view is in use
+ */
+static inline void
+bps_tree_view_create(struct bps_tree *tree, struct bps_tree_view *view,
+		     bps_tree_arg_t arg);
+
+/**
+ * @brief Destroy a frozen view.
+ * @param tree - pointer to a tree
+ * @param view - pointer to a view
+ */
+static inline void
+bps_tree_view_destroy(struct bps_tree *tree, struct bps_tree_view *view);
+
+/**
+ * @brief Get an iterator to the first element of a view.
+ * @param view - pointer to a view
+ * @return - First iterator. Invalid if the view is empty.
+ */
+static inline struct bps_tree_iterator
+bps_tree_view_first(struct bps_tree_view *view);
+
+/**
+ * @brief Like bps_tree_lower_bound, but in a frozen view.
+ */
+static inline struct bps_tree_iterator
+bps_tree_view_lower_bound(const struct bps_tree *tree,
+			  struct bps_tree_view *view, bps_tree_key_t key,
+			  bool *exact);
+
+/**
+ * @brief Like bps_tree_upper_bound, but in a frozen view.
+ */
+static inline struct bps_tree_iterator
+bps_tree_view_upper_bound(const struct bps_tree *tree,
+			  struct bps_tree_view *view, bps_tree_key_t key,
+			  bool *exact);
+
+/**
+ * @brief Get a pointer to the element pointed by an iterator
+ *  positioned in a view.
+ * @return - Pointer to the element. Null for invalid iterator
+ */
+static inline bps_tree_elem_t *
+bps_tree_view_iterator_get_elem(const struct bps_tree *tree,
+				struct bps_tree_view *view,
+				struct bps_tree_iterator *itr);
+
+/**
+ * @brief Make an iterator positioned in a view point to the next
+ *  element. If the iterator is to the last element, it will be
+ *  invalidated.
+ * @return - true on success, false if a resulted iterator is set to invalid
+ */
+static inline bool
+bps_tree_view_iterator_next(const struct bps_tree *tree,
+			    struct bps_tree_view *view,
+			    struct bps_tree_iterator *itr);
+
 #ifndef BPS_TREE_NO_DEBUG
 
 /**
@@ -936,9 +1129,18 @@ enum bps_tree_max_sizes {
 		(BPS_TREE_BLOCK_SIZE - sizeof(struct bps_block)
 		 - 2 * sizeof(bps_tree_block_id_t) )
 		/ sizeof(bps_tree_elem_t),
+#ifdef BPS_INNER_CARD
+	/* One more size_t is reserved for alignment of child_cards */
+	BPS_TREE_MAX_COUNT_IN_INNER =
+		(BPS_TREE_BLOCK_SIZE - sizeof(struct bps_block)
+		 - sizeof(size_t))
+		/ (sizeof(bps_tree_elem_t) + sizeof(bps_tree_block_id_t)
+		   + sizeof(size_t)),
+#else
 	BPS_TREE_MAX_COUNT_IN_INNER =
 		(BPS_TREE_BLOCK_SIZE - sizeof(struct bps_block))
 		/ (sizeof(bps_tree_elem_t) + sizeof(bps_tree_block_id_t)),
+#endif
 	BPS_TREE_MAX_DEPTH = 16
 };
 
@@ -984,6 +1186,10 @@ struct bps_inner {
 	bps_tree_elem_t elems[BPS_TREE_MAX_COUNT_IN_INNER - 1];
 	/* Corresponding child IDs */
 	bps_tree_block_id_t child_ids[BPS_TREE_MAX_COUNT_IN_INNER];
+#ifdef BPS_INNER_CARD
+	/* Number of elements in the subtrees of corresponding children */
+	size_t child_cards[BPS_TREE_MAX_COUNT_IN_INNER];
+#endif
 };
 
 /**
@@ -1105,6 +1311,42 @@ bps_tree_create(struct bps_tree *tree, bps_tree_arg_t arg,
 #endif
 }
 
+#ifdef BPS_INNER_CARD
+/**
+ * bps_tree_build_cards declaration. See definition for details.
+ */
+static inline size_t
+bps_tree_build_cards(const struct bps_tree *tree, struct bps_block *block);
+#endif
+
+/**
+ * @brief Get the max number of extents allocated by bps_tree_build()
+ *  for an array of the given size, including matras index extents.
+ */
+static inline size_t
+bps_tree_build_extent_count(const struct bps_tree *tree, size_t array_size)
+{
+	(void)tree;
+	if (array_size == 0)
+		return 0;
+	size_t blocks = 0;
+	size_t level_count = (array_size + BPS_TREE_MAX_COUNT_IN_LEAF - 1) /
+			     BPS_TREE_MAX_COUNT_IN_LEAF;
+	blocks += level_count;
+	while (level_count > 1) {
+		level_count = (level_count + BPS_TREE_MAX_COUNT_IN_INNER - 1) /
+			      BPS_TREE_MAX_COUNT_IN_INNER;
+		blocks += level_count;
+	}
+	size_t blocks_in_extent = BPS_TREE_EXTENT_SIZE / BPS_TREE_BLOCK_SIZE;
+	size_t ids_in_extent = BPS_TREE_EXTENT_SIZE / sizeof(void *);
+	/* Extents of blocks and two levels of matras index extents. */
+	size_t extents = (blocks + blocks_in_extent - 1) / blocks_in_extent;
+	size_t level2 = (extents + ids_in_extent - 1) / ids_in_extent;
+	size_t level1 = (level2 + ids_in_extent - 1) / ids_in_extent;
+	return extents + level2 + level1;
+}
+
 /**
  * @brief Fills a new (asserted) tree with values from sorted array.
  *  Elements are copied from the array. Array is not checked to be sorted!
@@ -1244,6 +1486,13 @@ bps_tree_build(struct bps_tree *tree, bps_tree_elem_t *sorted_array,
 	} else {
 		tree->root_id = root_if_inner_id;
 	}
+#ifdef BPS_INNER_CARD
+	struct bps_block *root = (struct bps_block *)
+		matras_get(&tree->matras, tree->root_id);
+	size_t card = bps_tree_build_cards(tree, root);
+	assert(card == array_size);
+	(void)card;
+#endif
 	return 0;
 }
 
@@ -1319,6 +1568,45 @@ bps_tree_touch_block(struct bps_tree *tree, bps_tree_block_id_t id)
 	return (struct bps_block *)matras_touch(&tree->matras, id);
 }
 
+#ifdef BPS_INNER_CARD
+/**
+ * @brief Get the number of elements in the subtree of a block.
+ */
+static inline size_t
+bps_tree_block_card(struct bps_block *block)
+{
+	if (block->type == BPS_TREE_BT_LEAF)
+		return block->size;
+	assert(block->type == BPS_TREE_BT_INNER);
+	struct bps_inner *inner = (struct bps_inner *)block;
+	size_t card = 0;
+	for (bps_tree_pos_t i = 0; i < inner->header.size; i++)
+		card += inner->child_cards[i];
+	return card;
+}
+
+/**
+ * @brief Fill child cardinalities of all inner blocks in a subtree
+ *  of a freshly built tree.
+ * @return - the number of elements in the subtree.
+ */
+static inline size_t
+bps_tree_build_cards(const struct bps_tree *tree, struct bps_block *block)
+{
+	if (block->type == BPS_TREE_BT_LEAF)
+		return block->size;
+	struct bps_inner *inner = (struct bps_inner *)block;
+	size_t card = 0;
+	for (bps_tree_pos_t i = 0; i < inner->header.size; i++) {
+		struct bps_block *child =
+			bps_tree_restore_block(tree, inner->child_ids[i]);
+		inner->child_cards[i] = bps_tree_build_cards(tree, child);
+		card += inner->child_cards[i];
+	}
+	return card;
+}
+#endif /* BPS_INNER_CARD */
+
 /**
  * @brief Get a random element in a tree.
  * @param tree - pointer to a tree
@@ -1333,6 +1621,22 @@ bps_tree_random(const struct bps_tree *tree, size_t rnd)
 
 	struct bps_block *block = bps_tree_root(tree);
 
+#ifdef BPS_INNER_CARD
+	/* Every element has the same chance to be chosen. */
+	size_t offset = rnd % tree->size;
+	for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
+		struct bps_inner *inner = (struct bps_inner *)block;
+		bps_tree_pos_t pos = 0;
+		while (offset >= inner->child_cards[pos])
+			offset -= inner->child_cards[pos++];
+		assert(pos < inner->header.size);
+		block = bps_tree_restore_block(tree, inner->child_ids[pos]);
+	}
+
+	struct bps_leaf *leaf = (struct bps_leaf *)block;
+	assert(offset < (size_t)leaf->header.size);
+	return leaf->elems + offset;
+#else
 	for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
 		struct bps_inner *inner = (struct bps_inner *)block;
 		bps_tree_pos_t pos = rnd % inner->header.size;
@@ -1343,6 +1647,7 @@ bps_tree_random(const struct bps_tree *tree, size_t rnd)
 	struct bps_leaf *leaf = (struct bps_leaf *)block;
 	bps_tree_pos_t pos = rnd % leaf->header.size;
 	return leaf->elems + pos;
+#endif
 }
 
 /**
@@ -1972,6 +2277,166 @@ bps_tree_approximate_count(const struct bps_tree *tree, bps_tree_key_t key)
 	return result;
 }
 
+#ifdef BPS_INNER_CARD
+/**
+ * @brief Get an iterator to the first element that is greater or
+ * equal than key and its offset.
+ * @param tree - pointer to a tree
+ * @param key - key that will be compared with elements
+ * @param exact - pointer to a bool value, that will be set to true if
+ *  and element pointed by the iterator is equal to the key, false otherwise
+ *  Pass NULL if you don't need that info.
+ * @param[out] offset - the number of elements that are less than key.
+ * @return - Lower-bound iterator. Invalid if all elements are less than key.
+ */
+static inline struct bps_tree_iterator
+bps_tree_lower_bound_get_offset(const struct bps_tree *tree,
+				bps_tree_key_t key, bool *exact,
+				size_t *offset)
+{
+	struct bps_tree_iterator res;
+	matras_head_read_view(&res.view);
+	bool local_result;
+	if (!exact)
+		exact = &local_result;
+	*exact = false;
+	*offset = 0;
+	if (tree->root_id == (bps_tree_block_id_t)(-1)) {
+		res.block_id = (bps_tree_block_id_t)(-1);
+		res.pos = 0;
+		return res;
+	}
+	struct bps_block *block = bps_tree_root(tree);
+	bps_tree_block_id_t block_id = tree->root_id;
+	for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
+		struct bps_inner *inner = (struct bps_inner *)block;
+		bps_tree_pos_t pos;
+		pos = bps_tree_find_ins_point_key(tree, inner->elems,
+						  inner->header.size - 1,
+						  key, exact);
+		for (bps_tree_pos_t j = 0; j < pos; j++)
+			*offset += inner->child_cards[j];
+		block_id = inner->child_ids[pos];
+		block = bps_tree_restore_block(tree, block_id);
+	}
+
+	struct bps_leaf *leaf = (struct bps_leaf *)block;
+	bps_tree_pos_t pos;
+	pos = bps_tree_find_ins_point_key(tree, leaf->elems, leaf->header.size,
+					  key, exact);
+	*offset += pos;
+	if (pos >= leaf->header.size) {
+		res.block_id = leaf->next_id;
+		res.pos = 0;
+	} else {
+		res.block_id = block_id;
+		res.pos = pos;
+	}
+	return res;
+}
+
+/**
+ * @brief Get an iterator to the first element that is greater than key
+ * and its offset.
+ * @param tree - pointer to a tree
+ * @param key - key that will be compared with elements
+ * @param exact - pointer to a bool value, that will be set to true if
+ *  and element pointed by the (!)previous iterator is equal to the key,
+ *  false otherwise. Pass NULL if you don't need that info.
+ * @param[out] offset - the number of elements that are less or equal
+ *  than key.
+ * @return - Upper-bound iterator. Invalid if all elements are less or equal
+ *  than the key.
+ */
+static inline struct bps_tree_iterator
+bps_tree_upper_bound_get_offset(const struct bps_tree *tree,
+				bps_tree_key_t key, bool *exact,
+				size_t *offset)
+{
+	struct bps_tree_iterator res;
+	matras_head_read_view(&res.view);
+	bool local_result;
+	if (!exact)
+		exact = &local_result;
+	*exact = false;
+	*offset = 0;
+	bool exact_test;
+	if (tree->root_id == (bps_tree_block_id_t)(-1)) {
+		res.block_id = (bps_tree_block_id_t)(-1);
+		res.pos = 0;
+		return res;
+	}
+	struct bps_block *block = bps_tree_root(tree);
+	bps_tree_block_id_t block_id = tree->root_id;
+	for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
+		struct bps_inner *inner = (struct bps_inner *)block;
+		bps_tree_pos_t pos;
+		pos = bps_tree_find_after_ins_point_key(tree, inner->elems,
+							inner->header.size - 1,
+							key, &exact_test);
+		if (exact_test)
+			*exact = true;
+		for (bps_tree_pos_t j = 0; j < pos; j++)
+			*offset += inner->child_cards[j];
+		block_id = inner->child_ids[pos];
+		block = bps_tree_restore_block(tree, block_id);
+	}
+
+	struct bps_leaf *leaf = (struct bps_leaf *)block;
+	bps_tree_pos_t pos;
+	pos = bps_tree_find_after_ins_point_key(tree, leaf->elems,
+						leaf->header.size,
+						key, &exact_test);
+	if (exact_test)
+		*exact = true;
+	*offset += pos;
+	if (pos >= leaf->header.size) {
+		res.block_id = leaf->next_id;
+		res.pos = 0;
+	} else {
+		res.block_id = block_id;
+		res.pos = pos;
+	}
+	return res;
+}
+
+/**
+ * @brief Get an iterator to the element with the given offset.
+ * @param tree - pointer to a tree
+ * @param offset - the number of elements before the requested one
+ * @return - Iterator to the element. Invalid if offset >= tree size.
+ */
+static inline struct bps_tree_iterator
+bps_tree_iterator_at(const struct bps_tree *tree, size_t offset)
+{
+	struct bps_tree_iterator res;
+	matras_head_read_view(&res.view);
+	if (offset >= tree->size) {
+		res.block_id = (bps_tree_block_id_t)(-1);
+		res.pos = 0;
+		return res;
+	}
+	struct bps_block *block = bps_tree_root(tree);
+	bps_tree_block_id_t block_id = tree->root_id;
+	for (bps_tree_block_id_t i = 0; i < tree->depth - 1; i++) {
+		struct bps_inner *inner = (struct bps_inner *)block;
+		bps_tree_pos_t pos = 0;
+		while (offset >= inner->child_cards[pos])
+			offset -= inner->child_cards[pos++];
+		assert(pos < inner->header.size);
+		block_id = inner->child_ids[pos];
+		block = bps_tree_restore_block(tree, block_id);
+	}
+
+	struct bps_leaf *leaf = (struct bps_leaf *)block;
+	assert(offset < (size_t)leaf->header.size);
+	(void)leaf;
+	res.block_id = block_id;
+	res.pos = (bps_tree_pos_t)offset;
+	return res;
+}
+#endif /* BPS_INNER_CARD */
+
 /**
  * @brief Get a pointer to the element pointed by iterator.
  *  If iterator is detected as broken, it is invalidated and NULL returned.
@@ -2078,6 +2543,157 @@ bps_tree_iterator_destroy(struct bps_tree *tree, struct bps_tree_iterator *itr)
 	matras_destroy_read_view(&tree->matras, &itr->view);
 }
 
+static inline void
+bps_tree_view_create(struct bps_tree *tree, struct bps_tree_view *view,
+		     bps_tree_arg_t arg)
+{
+	view->root_id = tree->root_id;
+	view->first_id = tree->first_id;
+	view->depth = tree->depth;
+	view->size = tree->size;
+	view->arg = arg;
+	matras_head_read_view(&view->view);
+	matras_create_read_view(&tree->matras, &view->view);
+}
+
+static inline void
+bps_tree_view_destroy(struct bps_tree *tree, struct bps_tree_view *view)
+{
+	matras_destroy_read_view(&tree->matras, &view->view);
+}
+
+static inline struct bps_tree_iterator
+bps_tree_view_first(struct bps_tree_view *view)
+{
+	struct bps_tree_iterator itr;
+	itr.block_id = view->first_id;
+	itr.pos = 0;
+	matras_head_read_view(&itr.view);
+	return itr;
+}
+
+/**
+ * @brief Find the lowest element in sorted array that is >= than
+ * the key (or > than the key if @a after is set), comparing with
+ * the view comparator argument.
+ */
+static inline bps_tree_pos_t
+bps_tree_view_find_point_key(const struct bps_tree_view *view,
+			     bps_tree_elem_t *arr, size_t size,
+			     bps_tree_key_t key, bool after, bool *exact)
+{
+	bps_tree_elem_t *begin = arr;
+	bps_tree_elem_t *end = arr + size;
+	while (begin != end) {
+		bps_tree_elem_t *mid = begin + (end - begin) / 2;
+		int res = BPS_TREE_COMPARE_KEY(*mid, key, view->arg);
+		if (res == 0)
+			*exact = true;
+		if (res > 0 || (res == 0 && !after))
+			end = mid;
+		else
+			begin = mid + 1;
+	}
+	return (bps_tree_pos_t)(end - arr);
+}
+
+/**
+ * @brief Descend a view to the leaf that contains the lower (or
+ * upper if @a after is set) bound of the key.
+ */
+static inline struct bps_tree_iterator
+bps_tree_view_bound(const struct bps_tree *tree, struct bps_tree_view *view,
+		    bps_tree_key_t key, bool after, bool *exact)
+{
+	struct bps_tree_iterator res;
+	matras_head_read_view(&res.view);
+	bool local_result;
+	if (!exact)
+		exact = &local_result;
+	*exact = false;
+	if (view->root_id == (bps_tree_block_id_t)(-1)) {
+		res.block_id = (bps_tree_block_id_t)(-1);
+		res.pos = 0;
+		return res;
+	}
+	bps_tree_block_id_t block_id = view->root_id;
+	struct bps_block *block =
+		bps_tree_restore_block_ver(tree, block_id, &view->view);
+	for (bps_tree_block_id_t i = 0; i < view->depth - 1; i++) {
+		struct bps_inner *inner = (struct bps_inner *)block;
+		bool exact_test = false;
+		bps_tree_pos_t pos;
+		pos = bps_tree_view_find_point_key(view, inner->elems,
+						   inner->header.size - 1,
+						   key, after, &exact_test);
+		if (after && exact_test)
+			*exact = true;
+		block_id = inner->child_ids[pos];
+		block = bps_tree_restore_block_ver(tree, block_id, &view->view);
+	}
+	struct bps_leaf *leaf = (struct bps_leaf *)block;
+	bps_tree_pos_t pos;
+	pos = bps_tree_view_find_point_key(view, leaf->elems,
+					   leaf->header.size, key, after,
+					   exact);
+	if (pos >= leaf->header.size) {
+		res.block_id = leaf->next_id;
+		res.pos = 0;
+	} else {
+		res.block_id = block_id;
+		res.pos = pos;
+	}
+	return res;
+}
+
+static inline struct bps_tree_iterator
+bps_tree_view_lower_bound(const struct bps_tree *tree,
+			  struct bps_tree_view *view, bps_tree_key_t key,
+			  bool *exact)
+{
+	return bps_tree_view_bound(tree, view, key, false, exact);
+}
+
+static inline struct bps_tree_iterator
+bps_tree_view_upper_bound(const struct bps_tree *tree,
+			  struct bps_tree_view *view, bps_tree_key_t key,
+			  bool *exact)
+{
+	return bps_tree_view_bound(tree, view, key, true, exact);
+}
+
+static inline bps_tree_elem_t *
+bps_tree_view_iterator_get_elem(const struct bps_tree *tree,
+				struct bps_tree_view *view,
+				struct bps_tree_iterator *itr)
+{
+	if (itr->block_id == (bps_tree_block_id_t)(-1))
+		return NULL;
+	struct bps_leaf *leaf = (struct bps_leaf *)
+		bps_tree_restore_block_ver(tree, itr->block_id, &view->view);
+	assert(leaf->header.type == BPS_TREE_BT_LEAF);
+	assert(itr->pos >= 0 && itr->pos < leaf->header.size);
+	return leaf->elems + itr->pos;
+}
+
+static inline bool
+bps_tree_view_iterator_next(const struct bps_tree *tree,
+			    struct bps_tree_view *view,
+			    struct bps_tree_iterator *itr)
+{
+	if (itr->block_id == (bps_tree_block_id_t)(-1))
+		return false;
+	struct bps_leaf *leaf = (struct bps_leaf *)
+		bps_tree_restore_block_ver(tree, itr->block_id, &view->view);
+	itr->pos++;
+	if (itr->pos >= leaf->header.size) {
+		itr->block_id = leaf->next_id;
+		itr->pos = 0;
+		return itr->block_id != (bps_tree_block_id_t)(-1);
+	}
+	return true;
+}
+
 /**
  * @brief Find the first element that is equal to the key (comparator returns 0)
  * @param tree - pointer to a tree
@@ -2471,6 +3087,115 @@ bps_tree_debug_memmove(void *dst_arg, void *src_arg, size_t num,
 }
 #endif
 
+/**
+ * @brief Update the number of elements stored in the parent of a block
+ *  and in all the ancestors of the parent.
+ *  Does nothing if the block is not linked to the parent yet.
+ */
+static inline void
+bps_tree_update_card(struct bps_tree *tree, struct bps_inner_path_elem *parent,
+		     bps_tree_pos_t pos_in_parent, bps_tree_block_id_t block_id,
+		     size_t card)
+{
+#ifdef BPS_INNER_CARD
+	/* exclusive behaviuor for debug checks */
+	if (tree->root_id == (bps_tree_block_id_t) -1 || parent == NULL)
+		return;
+	parent->block = (struct bps_inner *)
+		bps_tree_touch_block(tree, parent->block_id);
+	if (pos_in_parent >= parent->block->header.size ||
+	    parent->block->child_ids[pos_in_parent] != block_id)
+		return;
+	size_t delta = card - parent->block->child_cards[pos_in_parent];
+	if (delta == 0)
+		return;
+	for (struct bps_inner_path_elem *path = parent; path != NULL;
+	     path = path->parent) {
+		path->block = (struct bps_inner *)
+			bps_tree_touch_block(tree, path->block_id);
+		/* Wraps around on decrease, that's intended. */
+		path->block->child_cards[pos_in_parent] += delta;
+		pos_in_parent = path->pos_in_parent;
+	}
+#else
+	(void)tree;
+	(void)parent;
+	(void)pos_in_parent;
+	(void)block_id;
+	(void)card;
+#endif
+}
+
+/**
+ * @brief Propagate the size of a leaf to the ancestors.
+ */
+static inline void
+bps_tree_leaf_update_card(struct bps_tree *tree,
+			  struct bps_leaf_path_elem *leaf_path_elem)
+{
+	bps_tree_update_card(tree, leaf_path_elem->parent,
+			     leaf_path_elem->pos_in_parent,
+			     leaf_path_elem->block_id,
+			     leaf_path_elem->block->header.size);
+}
+
+/**
+ * @brief Propagate the number of elements in the subtree of an inner
+ *  block to the ancestors.
+ */
+static inline void
+bps_tree_inner_update_card(struct bps_tree *tree,
+			   struct bps_inner_path_elem *inner_path_elem)
+{
+#ifdef BPS_INNER_CARD
+	struct bps_block *block = &inner_path_elem->block->header;
+	bps_tree_update_card(tree, inner_path_elem->parent,
+			     inner_path_elem->pos_in_parent,
+			     inner_path_elem->block_id,
+			     bps_tree_block_card(block));
+#else
+	(void)tree;
+	(void)inner_path_elem;
+#endif
+}
+
+/**
+ * @brief Move a number of children (and their cardinalities) of
+ *  inner blocks.
+ */
+static inline void
+bps_tree_move_children(struct bps_inner *dst, bps_tree_pos_t dst_pos,
+		       struct bps_inner *src, bps_tree_pos_t src_pos,
+		       bps_tree_pos_t num)
+{
+	BPS_TREE_DATAMOVE(dst->child_ids + dst_pos, src->child_ids + src_pos,
+			  num, dst, src);
+#ifdef BPS_INNER_CARD
+	memmove(dst->child_cards + dst_pos, src->child_cards + src_pos,
+		num * sizeof(dst->child_cards[0]));
+#endif
+}
+
+/**
+ * @brief Set a child of an inner block.
+ */
+static inline void
+bps_tree_set_child(struct bps_tree *tree, struct bps_inner *inner,
+		   bps_tree_pos_t pos, bps_tree_block_id_t block_id)
+{
+	inner->child_ids[pos] = block_id;
+#ifdef BPS_INNER_CARD
+	/* exclusive behaviuor for debug checks */
+	if (tree->root_id == (bps_tree_block_id_t) -1)
+		inner->child_cards[pos] = 0;
+	else
+		inner->child_cards[pos] = bps_tree_block_card(
+			bps_tree_restore_block(tree, block_id));
+#else
+	(void)tree;
+#endif
+}
+
 /**
  * @breif Insert an element into leaf block. There must be enough space.
  */
@@ -2500,6 +3225,7 @@ bps_tree_insert_into_leaf(struct bps_tree *tree,
 	}
 	leaf->header.size++;
 	tree->size++;
+	bps_tree_leaf_update_card(tree, leaf_path_elem);
 }
 
 /**
@@ -2525,17 +3251,17 @@ bps_tree_insert_into_inner(struct bps_tree *tree,
 		BPS_TREE_DATAMOVE(inner->elems + pos + 1, inner->elems + pos,
 				  inner->header.size - pos - 1, inner, inner);
 		inner->elems[pos] = max_elem;
-		BPS_TREE_DATAMOVE(inner->child_ids + pos + 1,
-				  inner->child_ids + pos,
-				  inner->header.size - pos, inner, inner);
+		bps_tree_move_children(inner, pos + 1,
+				       inner, pos, inner->header.size - pos);
 	} else {
 		if (pos > 0)
 			inner->elems[pos - 1] = *inner_path_elem->max_elem_copy;
 		*inner_path_elem->max_elem_copy = max_elem;
 	}
-	inner->child_ids[pos] = block_id;
+	bps_tree_set_child(tree, inner, pos, block_id);
 
 	inner->header.size++;
+	bps_tree_inner_update_card(tree, inner_path_elem);
 }
 
 /**
@@ -2567,6 +3293,7 @@ bps_tree_delete_from_leaf(struct bps_tree *tree,
 	}
 
 	tree->size--;
+	bps_tree_leaf_update_card(tree, leaf_path_elem);
 }
 
 /**
@@ -2589,14 +3316,14 @@ bps_tree_delete_from_inner(struct bps_tree *tree,
 	if (pos < inner->header.size - 1) {
 		BPS_TREE_DATAMOVE(inner->elems + pos, inner->elems + pos + 1,
 				  inner->header.size - 2 - pos, inner, inner);
-		BPS_TREE_DATAMOVE(inner->child_ids + pos,
-				  inner->child_ids + pos + 1,
-				  inner->header.size - 1 - pos, inner, inner);
+		bps_tree_move_children(inner, pos, inner, pos + 1,
+				       inner->header.size - 1 - pos);
 	} else if (pos > 0) {
 		*inner_path_elem->max_elem_copy = inner->elems[pos - 1];
 	}
 
 	inner->header.size--;
+	bps_tree_inner_update_card(tree, inner_path_elem);
 }
 
 /**
@@ -2634,6 +3361,8 @@ bps_tree_move_elems_to_right_leaf(struct bps_tree *tree,
 		*a_leaf_path_elem->max_elem_copy =
 			a->elems[a->header.size - 1];
 	*b_leaf_path_elem->max_elem_copy = b->elems[b->header.size - 1];
+	bps_tree_leaf_update_card(tree, a_leaf_path_elem);
+	bps_tree_leaf_update_card(tree, b_leaf_path_elem);
 }
 
 /**
@@ -2661,10 +3390,8 @@ bps_tree_move_elems_to_right_inner(struct bps_tree *tree,
 	assert(a->header.size >= num);
 	assert(b->header.size + num <= BPS_TREE_MAX_COUNT_IN_INNER);
 
-	BPS_TREE_DATAMOVE(b->child_ids + num, b->child_ids,
-			  b->header.size, b, b);
-	BPS_TREE_DATAMOVE(b->child_ids, a->child_ids + a->header.size - num,
-			  num, b, a);
+	bps_tree_move_children(b, num, b, 0, b->header.size);
+	bps_tree_move_children(b, 0, a, a->header.size - num, num);
 
 	if (!move_to_empty)
 		BPS_TREE_DATAMOVE(b->elems + num, b->elems,
@@ -2682,6 +3409,8 @@ bps_tree_move_elems_to_right_inner(struct bps_tree *tree,
 
 	a->header.size -= num;
 	b->header.size += num;
+	bps_tree_inner_update_card(tree, a_inner_path_elem);
+	bps_tree_inner_update_card(tree, b_inner_path_elem);
 }
 
 /**
@@ -2714,6 +3443,8 @@ bps_tree_move_elems_to_left_leaf(struct bps_tree *tree,
 	a->header.size += num;
 	b->header.size -= num;
 	*a_leaf_path_elem->max_elem_copy = a->elems[a->header.size - 1];
+	bps_tree_leaf_update_card(tree, a_leaf_path_elem);
+	bps_tree_leaf_update_card(tree, b_leaf_path_elem);
 }
 
 /**
@@ -2741,10 +3472,8 @@ bps_tree_move_elems_to_left_inner(struct bps_tree *tree,
 	assert(b->header.size >= num);
 	assert(a->header.size + num <= BPS_TREE_MAX_COUNT_IN_INNER);
 
-	BPS_TREE_DATAMOVE(a->child_ids + a->header.size, b->child_ids,
-			  num, a, b);
-	BPS_TREE_DATAMOVE(b->child_ids, b->child_ids + num,
-			  b->header.size - num, b, b);
+	bps_tree_move_children(a, a->header.size, b, 0, num);
+	bps_tree_move_children(b, 0, b, num, b->header.size - num);
 
 	if (!move_to_empty)
 		a->elems[a->header.size - 1] =
@@ -2761,6 +3490,8 @@ bps_tree_move_elems_to_left_inner(struct bps_tree *tree,
 
 	a->header.size += num;
 	b->header.size -= num;
+	bps_tree_inner_update_card(tree, a_inner_path_elem);
+	bps_tree_inner_update_card(tree, b_inner_path_elem);
 }
 
 /**
@@ -2829,6 +3560,8 @@ bps_tree_insert_and_move_elems_to_right_leaf(struct bps_tree *tree,
 		*b_leaf_path_elem->max_elem_copy =
 			b->elems[b->header.size - 1];
 	tree->size++;
+	bps_tree_leaf_update_card(tree, a_leaf_path_elem);
+	bps_tree_leaf_update_card(tree, b_leaf_path_elem);
 	return ret;
 }
 
@@ -2865,8 +3598,7 @@ bps_tree_insert_and_move_elems_to_right_inner(struct bps_tree *tree,
 	assert(pos >= 0);
 
 	if (!move_to_empty) {
-		BPS_TREE_DATAMOVE(b->child_ids + num, b->child_ids,
-				  b->header.size, b, b);
+		bps_tree_move_children(b, num, b, 0, b->header.size);
 		BPS_TREE_DATAMOVE(b->elems + num, b->elems,
 				  b->header.size - 1, b, b);
 	}
@@ -2874,12 +3606,9 @@ bps_tree_insert_and_move_elems_to_right_inner(struct bps_tree *tree,
 	bps_tree_pos_t mid_part_size = a->header.size - pos;
 	if (mid_part_size > num) {
 		/* In fact insert to 'a' block, to the internal position */
-		BPS_TREE_DATAMOVE(b->child_ids,
-				  a->child_ids + a->header.size - num,
-				  num, b, a);
-		BPS_TREE_DATAMOVE(a->child_ids + pos + 1, a->child_ids + pos,
-				  mid_part_size - num, a, a);
-		a->child_ids[pos] = block_id;
+		bps_tree_move_children(b, 0, a, a->header.size - num, num);
+		bps_tree_move_children(a, pos + 1, a, pos, mid_part_size - num);
+		bps_tree_set_child(tree, a, pos, block_id);
 
 		BPS_TREE_DATAMOVE(b->elems, a->elems + (a->header.size - num),
 				  num - 1, b, a);
@@ -2896,12 +3625,9 @@ bps_tree_insert_and_move_elems_to_right_inner(struct bps_tree *tree,
 		a->elems[pos] = max_elem;
 	} else if (mid_part_size == num) {
 		/* In fact insert to 'a' block, to the last position */
-		BPS_TREE_DATAMOVE(b->child_ids,
-				  a->child_ids + a->header.size - num,
-				  num, b, a);
-		BPS_TREE_DATAMOVE(a->child_ids + pos + 1, a->child_ids + pos,
-				  mid_part_size - num, a, a);
-		a->child_ids[pos] = block_id;
+		bps_tree_move_children(b, 0, a, a->header.size - num, num);
+		bps_tree_move_children(a, pos + 1, a, pos, mid_part_size - num);
+		bps_tree_set_child(tree, a, pos, block_id);
 
 		BPS_TREE_DATAMOVE(b->elems, a->elems + (a->header.size - num),
 				  num - 1, b, a);
@@ -2915,12 +3641,10 @@ bps_tree_insert_and_move_elems_to_right_inner(struct bps_tree *tree,
 	} else {
 		/* In fact insert to 'b' block */
 		bps_tree_pos_t new_pos = num - mid_part_size - 1;/* Can be 0 */
-		BPS_TREE_DATAMOVE(b->child_ids,
-				  a->child_ids + a->header.size - num + 1,
-				  new_pos, b, a);
-		b->child_ids[new_pos] = block_id;
-		BPS_TREE_DATAMOVE(b->child_ids + new_pos + 1,
-				  a->child_ids + pos, mid_part_size, b, a);
+		bps_tree_move_children(b, 0,
+				       a, a->header.size - num + 1, new_pos);
+		bps_tree_set_child(tree, b, new_pos, block_id);
+		bps_tree_move_children(b, new_pos + 1, a, pos, mid_part_size);
 
 		if (pos == a->header.size) {
 			/* +1 */
@@ -2965,6 +3689,8 @@ bps_tree_insert_and_move_elems_to_right_inner(struct bps_tree *tree,
 
 	a->header.size -= (num - 1);
 	b->header.size += num;
+	bps_tree_inner_update_card(tree, a_inner_path_elem);
+	bps_tree_inner_update_card(tree, b_inner_path_elem);
 }
 
 /**
@@ -3032,6 +3758,8 @@ bps_tree_insert_and_move_elems_to_left_leaf(struct bps_tree *tree,
 		*b_leaf_path_elem->max_elem_copy =
 			b->elems[b->header.size - 1];
 	tree->size++;
+	bps_tree_leaf_update_card(tree, a_leaf_path_elem);
+	bps_tree_leaf_update_card(tree, b_leaf_path_elem);
 	return ret;
 }
 
@@ -3070,14 +3798,11 @@ bps_tree_insert_and_move_elems_to_left_inner(struct bps_tree *tree,
 	if (pos >= num) {
 		/* In fact insert to 'b' block */
 		bps_tree_pos_t new_pos = pos - num; /* Can be 0 */
-		BPS_TREE_DATAMOVE(a->child_ids + a->header.size, b->child_ids,
-				  num, a, b);
-		BPS_TREE_DATAMOVE(b->child_ids, b->child_ids + num,
-				  new_pos, b, b);
-		b->child_ids[new_pos] = block_id;
-		BPS_TREE_DATAMOVE(b->child_ids + new_pos + 1,
-				  b->child_ids + pos,
-				  b->header.size - pos, b, b);
+		bps_tree_move_children(a, a->header.size, b, 0, num);
+		bps_tree_move_children(b, 0, b, num, new_pos);
+		bps_tree_set_child(tree, b, new_pos, block_id);
+		bps_tree_move_children(b, new_pos + 1,
+				       b, pos, b->header.size - pos);
 
 		if (!move_to_empty)
 			a->elems[a->header.size - 1] =
@@ -3111,14 +3836,12 @@ bps_tree_insert_and_move_elems_to_left_inner(struct bps_tree *tree,
 	} else {
 		/* In fact insert to 'a' block */
 		bps_tree_pos_t new_pos = a->header.size + pos; /* Can be 0 */
-		BPS_TREE_DATAMOVE(a->child_ids + a->header.size,
-				  b->child_ids, pos, a, b);
-		a->child_ids[new_pos] = block_id;
-		BPS_TREE_DATAMOVE(a->child_ids + new_pos + 1,
-				  b->child_ids + pos, num - 1 - pos, a, b);
+		bps_tree_move_children(a, a->header.size, b, 0, pos);
+		bps_tree_set_child(tree, a, new_pos, block_id);
+		bps_tree_move_children(a, new_pos + 1, b, pos, num - 1 - pos);
 		if (!move_all)
-			BPS_TREE_DATAMOVE(b->child_ids, b->child_ids + num - 1,
-					  b->header.size - num + 1, b, b);
+			bps_tree_move_children(b, 0, b, num - 1,
+					       b->header.size - num + 1);
 
 		if (!move_to_empty)
 			a->elems[a->header.size - 1] =
@@ -3163,6 +3886,8 @@ bps_tree_insert_and_move_elems_to_left_inner(struct bps_tree *tree,
 
 	a->header.size += num;
 	b->header.size -= (num - 1);
+	bps_tree_inner_update_card(tree, a_inner_path_elem);
+	bps_tree_inner_update_card(tree, b_inner_path_elem);
 }
 
 /**
@@ -3726,8 +4451,8 @@ bps_tree_process_insert_leaf(struct bps_tree *tree,
 		struct bps_inner *new_root = bps_tree_create_inner(tree,
 				&new_root_id);
 		new_root->header.size = 2;
-		new_root->child_ids[0] = tree->root_id;
-		new_root->child_ids[1] = new_block_id;
+		bps_tree_set_child(tree, new_root, 0, tree->root_id);
+		bps_tree_set_child(tree, new_root, 1, new_block_id);
 		new_root->elems[0] = tree->max_elem;
 		tree->root_id = new_root_id;
 		tree->max_elem = new_max_elem;
@@ -4046,8 +4771,8 @@ bps_tree_process_insert_inner(struct bps_tree *tree,
 		struct bps_inner *new_root =
 			bps_tree_create_inner(tree, &new_root_id);
 		new_root->header.size = 2;
-		new_root->child_ids[0] = tree->root_id;
-		new_root->child_ids[1] = new_block_id;
+		bps_tree_set_child(tree, new_root, 0, tree->root_id);
+		bps_tree_set_child(tree, new_root, 1, new_block_id);
 		new_root->elems[0] = tree->max_elem;
 		tree->root_id = new_root_id;
 		tree->max_elem = new_max_elem;
@@ -4676,13 +5401,21 @@ bps_tree_debug_check_block(const struct bps_tree *tree, struct bps_block *block,
 				result |= 0x4000000;
 		}
 
-		for (bps_tree_pos_t i = 0; i < block->size; i++)
+		for (bps_tree_pos_t i = 0; i < block->size; i++) {
+			size_t prev_count = *calc_count;
 			result |= bps_tree_debug_check_block(tree,
 				bps_tree_restore_block(tree,
 						       inner->child_ids[i]),
 				inner->child_ids[i], level - 1, calc_count,
 				expected_prev_id, expected_this_id,
 				check_fullness_next);
+#ifdef BPS_INNER_CARD
+			if (inner->child_cards[i] != *calc_count - prev_count)
+				result |= 0x8000000;
+#else
+			(void)prev_count;
+#endif
+		}
 		return result;
 	}
 }
@@ -6095,6 +6828,7 @@ bps_tree_debug_check_internal_functions(bool assertme)
 
 #undef bps_tree_create
 #undef bps_tree_build
+#undef bps_tree_build_extent_count
 #undef bps_tree_destroy
 #undef bps_tree_find
 #undef bps_tree_insert
@@ -6113,11 +6847,22 @@ bps_tree_debug_check_internal_functions(bool assertme)
 #undef bps_tree_lower_bound_elem
 #undef bps_tree_upper_bound_elem
 #undef bps_tree_approximate_count
+#undef bps_tree_lower_bound_get_offset
+#undef bps_tree_upper_bound_get_offset
+#undef bps_tree_iterator_at
 #undef bps_tree_iterator_get_elem
 #undef bps_tree_iterator_next
 #undef bps_tree_iterator_prev
 #undef bps_tree_iterator_freeze
 #undef bps_tree_iterator_destroy
+#undef bps_tree_view
+#undef bps_tree_view_create
+#undef bps_tree_view_destroy
+#undef bps_tree_view_first
+#undef bps_tree_view_lower_bound
+#undef bps_tree_view_upper_bound
+#undef bps_tree_view_iterator_get_elem
+#undef bps_tree_view_iterator_next
 #undef bps_tree_debug_check
 #undef bps_tree_print
 #undef bps_tree_debug_check_internal_functions
@@ -6133,6 +6878,8 @@ bps_tree_debug_check_internal_functions(bool assertme)
 
 #undef bps_tree_restore_block
 #undef bps_tree_restore_block_ver
+#undef bps_tree_view_find_point_key
+#undef bps_tree_view_bound
 #undef bps_tree_root
 #undef bps_tree_touch_block
 #undef bps_tree_find_ins_point_key
@@ -6140,6 +6887,13 @@ bps_tree_debug_check_internal_functions(bool assertme)
 #undef bps_tree_find_after_ins_point_key
 #undef bps_tree_find_after_ins_point_elem
 #undef bps_tree_get_leaf_safe
+#undef bps_tree_block_card
+#undef bps_tree_build_cards
+#undef bps_tree_update_card
+#undef bps_tree_leaf_update_card
+#undef bps_tree_inner_update_card
+#undef bps_tree_move_children
+#undef bps_tree_set_child
 #undef bps_tree_garbage_push
 #undef bps_tree_garbage_pop
 #undef bps_tree_create_leaf
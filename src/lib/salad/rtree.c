@@ -33,7 +33,9 @@
 #include <assert.h>
 #include <limits.h>
 #include <stddef.h>
+#include <stdlib.h>
 #include <sys/types.h>
+#include "third_party/qsort_arg.h"
 
 /*------------------------------------------------------------------------- */
 /* R-tree internal structures definition */
@@ -951,6 +953,10 @@ rtree_init(struct rtree *tree, unsigned dimension, uint32_t extent_size,
 	tree->version = 0;
 	tree->n_pages = 0;
 	tree->free_pages = 0;
+	tree->extent_size = extent_size;
+	tree->bulk_branches = NULL;
+	tree->bulk_count = 0;
+	tree->bulk_capacity = 0;
 
 	tree->dimension = dimension;
 	tree->distance_type = distance_type;
@@ -978,6 +984,7 @@ void
 rtree_destroy(struct rtree *tree)
 {
 	rtree_purge(tree);
+	free(tree->bulk_branches);
 	matras_destroy(&tree->mtab);
 }
 
@@ -1138,6 +1145,193 @@ rtree_purge(struct rtree *tree)
 	}
 }
 
+/*------------------------------------------------------------------------- */
+/* R-tree bulk loading */
+/*------------------------------------------------------------------------- */
+
+int
+rtree_bulk_load_add(struct rtree *tree, const struct rtree_rect *rect,
+		    record_t obj)
+{
+	if (tree->bulk_count == tree->bulk_capacity) {
+		size_t capacity = tree->bulk_capacity > 0 ?
+				  tree->bulk_capacity * 2 : 1024;
+		char *branches = (char *)realloc(tree->bulk_branches,
+					capacity * tree->page_branch_size);
+		if (branches == NULL)
+			return -1;
+		tree->bulk_branches = branches;
+		tree->bulk_capacity = capacity;
+	}
+	struct rtree_page_branch *b = (struct rtree_page_branch *)
+		(tree->bulk_branches +
+		 tree->bulk_count * tree->page_branch_size);
+	b->data.record = obj;
+	rtree_rect_copy(&b->rect, rect, tree->dimension);
+	tree->bulk_count++;
+	return 0;
+}
+
+/* The least s such that pow(s, k) >= n */
+static size_t
+rtree_bulk_slab_count(size_t n, unsigned k)
+{
+	size_t s = 1;
+	while (true) {
+		size_t p = 1;
+		for (unsigned i = 0; i < k && p < n; i++)
+			p *= s;
+		if (p >= n)
+			return s;
+		s++;
+	}
+}
+
+/*
+ * Number of pages rtree_bulk_pack() creates for n branches.
+ * Follows the same slab and page cuts but doesn't sort anything.
+ */
+static size_t
+rtree_bulk_pack_page_count(const struct rtree *tree, size_t n,
+			   unsigned axis)
+{
+	size_t page_count = (n + tree->page_max_fill - 1) / tree->page_max_fill;
+	if (axis + 1 >= tree->dimension || page_count <= 1)
+		return page_count;
+	size_t slab_count = rtree_bulk_slab_count(page_count,
+						  tree->dimension - axis);
+	size_t count = 0;
+	for (size_t i = 0; i < slab_count; i++) {
+		size_t slab_begin = n * i / slab_count;
+		size_t slab_end = n * (i + 1) / slab_count;
+		count += rtree_bulk_pack_page_count(tree, slab_end - slab_begin,
+						    axis + 1);
+	}
+	return count;
+}
+
+size_t
+rtree_bulk_load_extent_count(const struct rtree *tree, size_t n_records)
+{
+	if (n_records == 0)
+		return 0;
+	size_t pages = 0;
+	size_t n = n_records;
+	do {
+		n = rtree_bulk_pack_page_count(tree, n, 0);
+		pages += n;
+	} while (n > 1);
+	size_t pages_in_extent = tree->extent_size / tree->page_size;
+	size_t ids_in_extent = tree->extent_size / sizeof(void *);
+	/* Extents of pages and two levels of matras index extents. */
+	size_t extents = (pages + pages_in_extent - 1) / pages_in_extent;
+	size_t level2 = (extents + ids_in_extent - 1) / ids_in_extent;
+	size_t level1 = (level2 + ids_in_extent - 1) / ids_in_extent;
+	return extents + level2 + level1;
+}
+
+static int
+rtree_branch_center_cmp(const void *a, const void *b, void *arg)
+{
+	unsigned axis = *(unsigned *)arg;
+	const coord_t *coords_a =
+		&((const struct rtree_page_branch *)a)->rect.coords[2 * axis];
+	const coord_t *coords_b =
+		&((const struct rtree_page_branch *)b)->rect.coords[2 * axis];
+	/* Compare doubled centers to avoid division. */
+	coord_t center_a = coords_a[0] + coords_a[1];
+	coord_t center_b = coords_b[0] + coords_b[1];
+	return center_a < center_b ? -1 : center_a > center_b ? 1 : 0;
+}
+
+/* Sort n branches starting from the given one by centers along the axis */
+static void
+rtree_bulk_sort(const struct rtree *tree, char *branches, size_t n,
+		unsigned axis)
+{
+	qsort_arg(branches, n, tree->page_branch_size,
+		  rtree_branch_center_cmp, &axis);
+}
+
+/*
+ * Sort-Tile-Recursive packing of n branches of one level of a tree
+ * starting from index begin of the bulk buffer. The branches are
+ * sorted along the axis and cut into slabs, every slab is packed
+ * recursively along the next axis, and along the last axis the
+ * branches are cut into pages. Every created page is stored as a
+ * branch of the next level to the bulk buffer at index *out. It is
+ * safe to do it in place since every page consumes at least one
+ * branch of the current level.
+ * Slabs and pages are cut evenly, so every page gets at least half
+ * of page_max_fill branches unless the level fits into one page.
+ */
+static void
+rtree_bulk_pack(struct rtree *tree, size_t begin, size_t n,
+		unsigned axis, size_t *out)
+{
+	size_t branch_size = tree->page_branch_size;
+	char *branches = tree->bulk_branches + begin * branch_size;
+	size_t page_count = (n + tree->page_max_fill - 1) / tree->page_max_fill;
+	if (page_count > 1)
+		rtree_bulk_sort(tree, branches, n, axis);
+	if (axis + 1 < tree->dimension && page_count > 1) {
+		size_t slab_count = rtree_bulk_slab_count(page_count,
+						tree->dimension - axis);
+		for (size_t i = 0; i < slab_count; i++) {
+			size_t slab_begin = n * i / slab_count;
+			size_t slab_end = n * (i + 1) / slab_count;
+			rtree_bulk_pack(tree, begin + slab_begin,
+					slab_end - slab_begin, axis + 1, out);
+		}
+		return;
+	}
+	for (size_t i = 0; i < page_count; i++) {
+		size_t page_begin = n * i / page_count;
+		size_t page_end = n * (i + 1) / page_count;
+		struct rtree_page *page = rtree_page_alloc(tree);
+		tree->n_pages++;
+		page->n = page_end - page_begin;
+		for (unsigned j = 0; j < page->n; j++) {
+			const struct rtree_page_branch *from =
+				(const struct rtree_page_branch *)
+				(branches + (page_begin + j) * branch_size);
+			rtree_branch_copy(rtree_branch_get(tree, page, j),
+					  from, tree->dimension);
+		}
+		struct rtree_page_branch *b = (struct rtree_page_branch *)
+			(tree->bulk_branches + *out * branch_size);
+		assert(*out < begin + page_end);
+		rtree_page_cover(tree, page, &b->rect);
+		b->data.page = page;
+		(*out)++;
+	}
+}
+
+void
+rtree_bulk_load_end(struct rtree *tree)
+{
+	size_t n = tree->bulk_count;
+	assert(tree->root == NULL);
+	if (n > 0) {
+		tree->n_records = n;
+		do {
+			size_t out = 0;
+			rtree_bulk_pack(tree, 0, n, 0, &out);
+			n = out;
+			tree->height++;
+		} while (n > 1);
+		assert(tree->height <= RTREE_MAX_HEIGHT);
+		struct rtree_page_branch *b =
+			(struct rtree_page_branch *)tree->bulk_branches;
+		tree->root = b->data.page;
+		tree->version++;
+	}
+	free(tree->bulk_branches);
+	tree->bulk_branches = NULL;
+	tree->bulk_count = 0;
+	tree->bulk_capacity = 0;
+}
+
 size_t
 rtree_used_size(const struct rtree *tree)
 {
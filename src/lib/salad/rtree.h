@@ -148,10 +148,18 @@ struct rtree
 	unsigned n_pages;
 	/* Matras for allocating new page */
 	struct matras mtab;
+	/* Size of extents allocated by matras */
+	uint32_t extent_size;
 	/* List of free pages */
 	void *free_pages;
 	/* Distance type */
 	enum rtree_distance_type distance_type;
+	/* Branches collected for bulk loading, see rtree_bulk_load_add() */
+	char *bulk_branches;
+	/* Number of collected branches */
+	size_t bulk_count;
+	/* Number of branches that fit into allocated bulk_branches */
+	size_t bulk_capacity;
 };
 
 /* Struct for iteration and retrieving rtree values */
@@ -285,6 +293,38 @@ rtree_insert(struct rtree *tree, struct rtree_rect *rect, record_t obj);
 bool
 rtree_remove(struct rtree *tree, const struct rtree_rect *rect, record_t obj);
 
+/**
+ * @brief Add a record for bulk loading into a tree. The record is not
+ * visible in the tree until rtree_bulk_load_end() is called.
+ * @param tree - pointer to a tree
+ * @param rect - rectangle to insert
+ * @param obj - record to insert
+ * @return 0 on success, -1 on memory allocation error
+ */
+int
+rtree_bulk_load_add(struct rtree *tree, const struct rtree_rect *rect,
+		    record_t obj);
+
+/**
+ * @brief Number of extents rtree_bulk_load_end() would allocate
+ * to build an empty tree of the given number of records.
+ * @param tree - pointer to a tree
+ * @param n_records - number of records
+ */
+size_t
+rtree_bulk_load_extent_count(const struct rtree *tree, size_t n_records);
+
+/**
+ * @brief Build a tree from all records added by rtree_bulk_load_add()
+ * using Sort-Tile-Recursive packing. The tree must be empty.
+ * STR packing produces a tree with almost full pages that have
+ * little overlap, so it is both faster than inserting the records
+ * one by one and gives a tree that is faster to search.
+ * @param tree - pointer to a tree
+ */
+void
+rtree_bulk_load_end(struct rtree *tree);
+
 /**
  * @brief Size of memory used by tree
  * @param tree - pointer to a tree
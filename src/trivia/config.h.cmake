@@ -52,6 +52,11 @@
  */
  #cmakedefine HAVE_STRLCPY 1
 
+/*
+ * Defined if SSE2 and AVX instructions are enabled at compile time.
+ */
+#cmakedefine ENABLE_SSE2 1
+#cmakedefine ENABLE_AVX 1
 /*
  * Defined if gcov instrumentation should be enabled.
  */
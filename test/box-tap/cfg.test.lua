@@ -6,7 +6,7 @@ local socket = require('socket')
 local fio = require('fio')
 local uuid = require('uuid')
 local msgpack = require('msgpack')
-test:plan(108)
+test:plan(113)
 
 --------------------------------------------------------------------------------
 -- Invalid values
@@ -25,6 +25,11 @@ invalid('memtx_min_tuple_size', 0)
 invalid('memtx_min_tuple_size', -1)
 invalid('memtx_min_tuple_size', 1048281)
 invalid('memtx_min_tuple_size', 1000000000)
+invalid('memtx_read_threads', -1)
+invalid('memtx_read_threads', 33)
+invalid('memtx_read_view_refresh_interval', 0)
+invalid('memtx_tx_gc_batch_size', 0)
+invalid('memtx_tx_story_memory_limit', -1)
 invalid('replication', '//guest@localhost:3301')
 invalid('replication_timeout', -1)
 invalid('replication_timeout', 0)
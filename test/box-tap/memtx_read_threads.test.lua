@@ -0,0 +1,127 @@
+#!/usr/bin/env tarantool
+
+local tap = require('tap')
+local fiber = require('fiber')
+local net_box = require('net.box')
+local ffi = require('ffi')
+local test = tap.test('memtx_read_threads')
+
+box.cfg{
+    listen = os.getenv('LISTEN'),
+    log = 'tarantool.log',
+    memtx_read_threads = 2,
+    memtx_read_view_refresh_interval = 0.01,
+}
+
+box.schema.user.grant('guest', 'read,write,execute', 'universe')
+
+local s = box.schema.space.create('test')
+s:create_index('pk')
+s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+s:create_index('hash', {type = 'hash', parts = {3, 'unsigned'}})
+for i = 1, 100 do
+    s:insert{i, i % 10, i}
+end
+
+local t = box.schema.space.create('tmp', {temporary = true})
+t:create_index('pk')
+t:insert{1}
+
+test:plan(17)
+
+local ok, err = pcall(box.cfg, {memtx_read_threads = 4})
+test:ok(not ok and err:match("Can't set option"), 'read threads are static')
+
+local function wait_refresh()
+    fiber.sleep(box.cfg.memtx_read_view_refresh_interval * 5)
+end
+wait_refresh()
+
+local c = net_box.connect(box.cfg.listen)
+local opts = {stale_read = true}
+test:ok(c.peer_features.stale_read, 'server reports stale read support')
+
+local function totable(tuples)
+    local res = {}
+    for _, tuple in ipairs(tuples) do
+        table.insert(res, tuple:totable())
+    end
+    return res
+end
+
+local function read_thread_requests()
+    return box.stat.memtx.read_threads().requests
+end
+
+local requests = read_thread_requests()
+local sk = c.space.test.index.sk
+test:is(#c.space.test:select({}, opts), 100, 'full scan')
+test:is_deeply(totable(c.space.test:select({5}, opts)), {{5, 5, 5}},
+               'EQ by pk')
+test:is_deeply(totable(c.space.test:select({98}, {stale_read = true,
+                                                 iterator = 'GT'})),
+               {{99, 9, 99}, {100, 0, 100}}, 'GT by pk')
+test:is_deeply(totable(sk:select({3}, {stale_read = true,
+                                       limit = 2, offset = 1})),
+               {{13, 3, 13}, {23, 3, 23}}, 'EQ by sk with offset and limit')
+-- The view may be being refreshed when a request arrives, in which
+-- case it is served in tx, so don't expect all of them to be counted.
+test:ok(read_thread_requests() > requests, 'requests are served by threads')
+test:is_deeply(totable(sk:select({9}, {stale_read = true,
+                                       iterator = 'LE', limit = 1})),
+               {{99, 9, 99}}, 'LE falls back to tx')
+requests = read_thread_requests()
+test:is_deeply(totable(c.space.test.index.hash:select({7}, opts)),
+               {{7, 7, 7}}, 'HASH falls back to tx')
+test:is(read_thread_requests(), requests, 'fallback is not counted')
+test:is_deeply(totable(c.space.tmp:select({}, opts)), {{1}},
+               'temporary space falls back to tx')
+
+ok, err = pcall(c.space.test.select, c.space.test, {'a'}, opts)
+test:ok(not ok and err.message:match('Supplied key type'),
+        'invalid key is reported')
+
+-- Changes become visible once the view is refreshed.
+s:replace{1, 1, 1000}
+wait_refresh()
+test:is_deeply(totable(c.space.test:select({1}, opts)), {{1, 1, 1000}},
+               'view is refreshed')
+
+-- Tuples pinned by the view are copied on update, tuples created
+-- after the last refresh are updated in place.
+local u = box.schema.space.create('update')
+u:create_index('pk')
+u:insert{1, 0}
+local function address(key)
+    collectgarbage('collect')
+    local addr = tonumber(ffi.cast('uintptr_t',
+                                   ffi.cast('void *', u:get(key))))
+    collectgarbage('collect')
+    return addr
+end
+-- Make sure the view is refreshed after the tuple was inserted
+-- and not refreshed again until the end of the test case.
+box.cfg{memtx_read_view_refresh_interval = 1000}
+fiber.sleep(0.1)
+local addr = address(1)
+u:update(1, {{'+', 2, 1}})
+local new_addr = address(1)
+test:isnt(new_addr, addr, 'tuple in the view is copied on update')
+u:update(1, {{'+', 2, 1}})
+test:is(address(1), new_addr,
+        'tuple created after the view is updated in place')
+u:drop()
+
+s:drop()
+ok, err = pcall(c.space.test.select, c.space.test, {1}, opts)
+test:ok(not ok, 'dropped space is reported')
+
+box.cfg{memtx_read_view_refresh_interval = 0.02}
+test:is(box.cfg.memtx_read_view_refresh_interval, 0.02,
+        'refresh interval is dynamic')
+
+c:close()
+t:drop()
+box.schema.user.revoke('guest', 'read,write,execute', 'universe')
+
+os.exit(test:check() and 0 or 1)
@@ -653,4 +653,20 @@ s.index.test1:bsize() < s.index.test2:bsize()
 s.index.test1:bsize() == s.index.test33:bsize()
 s.index.test1:bsize() < s.index.test4:bsize()
 
-s:drop()
\ No newline at end of file
+s:drop()
+
+--
+-- Space format change checks only the fields which the old
+-- format doesn't guarantee to be valid.
+--
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+s:replace{1, 'a'}
+s:replace{2, 'b', 3}
+s:format({{'id', 'unsigned'}, {'name', 'string'}, {'val', 'unsigned', is_nullable = true}})
+s:format({{'id', 'unsigned'}, {'name', 'string'}, {'val', 'string', is_nullable = true}})
+s:format({{'id', 'unsigned'}, {'name', 'string'}, {'val', 'unsigned'}})
+s:delete{1}
+s:format({{'id', 'unsigned'}, {'name', 'string'}, {'val', 'unsigned'}})
+s:replace{3, 'c'}
+s:drop()
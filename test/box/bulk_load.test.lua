@@ -0,0 +1,55 @@
+test_run = require('test_run').new()
+fiber = require('fiber')
+fun = require('fun')
+
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+_ = s:create_index('sk', {parts = {2, 'string'}, unique = false})
+_ = s:create_index('uk', {parts = {3, 'unsigned'}})
+
+s:bulk_load({{3, 'c', 30}, {1, 'a', 10}, {2, 'b', 20}})
+s:select()
+s.index.sk:select{'b'}
+s.index.uk:select{30}
+s:bsize() > 0
+
+-- Only empty spaces can be loaded.
+s:bulk_load({{4, 'd', 40}})
+s:truncate()
+
+-- Unique constraints and the format are checked.
+s:bulk_load({{1, 'a', 10}, {1, 'b', 20}})
+s:bulk_load({{1, 'a', 10}, {2, 'b', 10}})
+s:bulk_load({{1, 'a', 'x'}})
+s:count()
+s.index.sk:count()
+s:bsize()
+
+-- The space can't be changed while the tuples are written to WAL.
+err = nil
+_ = fiber.new(function() err = select(2, pcall(s.replace, s, {0, '0', 0})) end) s:bulk_load({{1, 'a', 10}})
+tostring(err)
+s:select()
+s:truncate()
+
+-- A checkpoint started during the load waits for it to complete.
+s2 = box.schema.space.create('test2')
+_ = s2:create_index('pk')
+ok = nil
+_ = fiber.new(function() ok = pcall(box.snapshot) end) s2:bulk_load(fun.range(25000):map(function(i) return {i} end))
+test_run:wait_cond(function() return ok ~= nil end)
+ok
+
+-- Loaded tuples are written to WAL.
+s:bulk_load(fun.range(3000):map(function(i) return {i, tostring(i), i * 10} end))
+s:count()
+test_run:cmd('restart server default')
+fun = require('fun')
+s = box.space.test
+s:count()
+s.index.sk:count()
+s.index.uk:get{30000}
+fun.range(3000):all(function(i) return s:get{i} ~= nil end)
+s:drop()
+box.space.test2:count()
+box.space.test2:drop()
@@ -123,4 +123,50 @@ for i = 5001,5010 do table.insert(res, (s:get{i})) end
 res
 s:drop()
 
+-- A big space is indexed in a thread, the changes made meanwhile
+-- are applied to the new index when the thread is done.
+fiber = require('fiber')
+errinj.set('ERRINJ_MEMTX_DDL_THREAD_MIN_TUPLES', 1000)
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+box.begin() for i = 1, 2000 do s:replace{i, i} end box.commit()
+ch = fiber.channel(1)
+errinj.set('ERRINJ_BUILD_INDEX_DELAY', true)
+_ = fiber.new(function() s:replace{1, 5000} s:delete{2} s:replace{3000, 3000} errinj.set('ERRINJ_BUILD_INDEX_DELAY', false) ch:put(true) end) sk = s:create_index('sk', {parts = {2, 'unsigned'}})
+ch:get()
+sk:count()
+sk:get{5000}
+sk:get{1}
+sk:get{2}
+sk:get{3000}
+sk:drop()
+-- Duplicates are found both in the read view and in the changes.
+s:replace{4, 5}
+s:create_index('sk', {parts = {2, 'unsigned'}})
+s:replace{4, 4}
+errinj.set('ERRINJ_BUILD_INDEX_DELAY', true)
+_ = fiber.new(function() s:replace{5, 6} errinj.set('ERRINJ_BUILD_INDEX_DELAY', false) ch:put(true) end) s:create_index('sk', {parts = {2, 'unsigned'}})
+ch:get()
+s.index.sk == nil
+-- Format is checked both in the read view and in the changes.
+s:replace{5, 5}
+errinj.set('ERRINJ_BUILD_INDEX_DELAY', true)
+_ = fiber.new(function() s:replace{6, 'x'} errinj.set('ERRINJ_BUILD_INDEX_DELAY', false) ch:put(true) end) s:create_index('sk', {parts = {2, 'unsigned'}})
+ch:get()
+s:create_index('sk', {parts = {2, 'unsigned'}})
+s.index.sk == nil
+s:drop()
+errinj.set('ERRINJ_MEMTX_DDL_THREAD_MIN_TUPLES', -1)
+
+-- Bulk load fails if there's no memory to build a tree.
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+errinj.set('ERRINJ_INDEX_ALLOC', true)
+s:bulk_load({{1}, {2}, {3}})
+errinj.set('ERRINJ_INDEX_ALLOC', false)
+s:count()
+s:bulk_load({{1}, {2}, {3}})
+s:count()
+s:drop()
+
 errinj = nil
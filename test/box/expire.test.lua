@@ -0,0 +1,40 @@
+test_run = require('test_run').new()
+fiber = require('fiber')
+
+--
+-- Tuples of a space with expire_field are deleted when the time
+-- stored in the field comes.
+--
+format = {{'id', 'unsigned'}, {'exp', 'number', is_nullable = true}}
+s = box.schema.space.create('test', {expire_field = 'exp', format = format})
+s.expire_field
+_ = s:create_index('pk')
+_ = s:create_index('exp', {parts = {'exp'}, unique = false})
+now = fiber.time()
+for i = 1, 10 do s:insert{i, now - i} end
+for i = 11, 20 do s:insert{i, now + 1000} end
+_ = s:insert{21, box.NULL}
+test_run:wait_cond(function() return s:count() == 11 end)
+s.index.pk:min()[1]
+s.index.pk:max()[1]
+
+-- Expiration is disabled with expire_field = false.
+s:alter{expire_field = false}
+s.expire_field
+_ = s:insert{1, now - 1}
+fiber.sleep(1.5)
+s:count()
+
+-- A field can be given by number.
+s:alter{expire_field = 2}
+s.expire_field
+test_run:wait_cond(function() return s:get{1} == nil end)
+s:count()
+s:drop()
+
+-- Errors.
+ok, err = pcall(box.schema.space.create, 'test', {expire_field = 'foo'})
+ok, err.message:match('was not found in the space format') ~= nil
+ok, err = pcall(box.schema.space.create, 'test', {expire_field = 0})
+ok, err.message:match('should be a positive integer') ~= nil
+box.space.test
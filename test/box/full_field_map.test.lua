@@ -0,0 +1,48 @@
+--
+-- The full_field_map space option stores offsets of all fields
+-- defined in the space format in the tuple field map.
+--
+format = {}
+for i = 1, 200 do format[i] = {name = 'f' .. i, type = 'any', is_nullable = true} end
+s = box.schema.space.create('test', {format = format, full_field_map = true})
+s.full_field_map
+_ = s:create_index('pk')
+t = {}
+for i = 1, 200 do t[i] = i * 1000 end
+t[150] = 'abc'
+_ = s:insert(t)
+tuple = s:get{1000}
+tuple[150]
+tuple.f199
+tuple[200]
+tuple['[150]']
+_ = s:insert{1, 2, 3}
+s:get{1}[3]
+s:get{1}[150] == nil
+
+-- Tuples created before the option was disabled are still readable.
+s:alter{full_field_map = false}
+s.full_field_map
+s:get{1000}[150]
+t[1] = 2000
+t[199] = 'def'
+_ = s:replace(t)
+s:get{2000}.f199
+s:drop()
+
+-- Fields following runs of small integers are found without a field map.
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+t = {}
+for i = 1, 100 do t[i] = i % 50 - 25 end
+t[1] = 100
+t[30] = 'abc'
+t[61] = 1000
+t[100] = {1, 2}
+_ = s:insert(t)
+tuple = s:get{100}
+tuple[30], tuple[31], tuple[60], tuple[61], tuple[62], tuple[99], tuple[100]
+s:drop()
+
+ok, err = pcall(box.schema.space.create, 'test', {engine = 'vinyl', full_field_map = true})
+ok, err.message:match('engine does not support full_field_map') ~= nil
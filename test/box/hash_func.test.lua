@@ -0,0 +1,42 @@
+test_run = require('test_run').new()
+ffi = require('ffi')
+
+--
+-- Hash indexes hashing keys with wyhash instead of MurmurHash3.
+--
+s = box.schema.space.create('test')
+_ = s:create_index('pk', {type = 'hash', hash_func = 'wyhash'})
+_ = s:create_index('sk', {type = 'hash', parts = {2, 'string', 3, 'number'}, hash_func = 'wyhash'})
+for i = 1, 1000 do s:insert{i, tostring(i % 10), i / 2} end
+s:count()
+cnt = 0
+for i = 1, 1000 do if s:get{i} ~= nil then cnt = cnt + 1 end end
+cnt
+s:get{1001}
+s.index.sk:get{'3', 1.5}
+-- Integer and floating point keys having the same value match.
+s.index.sk:get{'4', 2}
+s.index.sk:get{'4', ffi.cast('double', 2)}
+s.index.sk:get{'4', 2.5}
+
+-- Changing the hash function rebuilds the index.
+s.index.pk:alter{hash_func = 'murmur3'}
+cnt = 0
+for i = 1, 1000 do if s:get{i} ~= nil then cnt = cnt + 1 end end
+cnt
+s.index.sk:alter{hash_func = 'WYHASH'}
+s.index.sk:get{'7', 3.5}
+
+-- Collations are honored.
+s2 = box.schema.space.create('test2')
+_ = s2:create_index('pk', {type = 'hash', parts = {{1, 'string', collation = 'unicode_ci'}}, hash_func = 'wyhash'})
+_ = s2:insert{'Abc'}
+s2:get{'aBC'}
+s2:get{'abd'}
+s2:drop()
+
+-- Invalid options.
+s:create_index('tree', {hash_func = 'wyhash'})
+s:create_index('bad', {type = 'hash', hash_func = 'crc32'})
+s:create_index('bad', {type = 'hash', hash_func = 1})
+s:drop()
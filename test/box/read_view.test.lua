@@ -0,0 +1,74 @@
+test_run = require('test_run').new()
+fiber = require('fiber')
+
+s = box.schema.space.create('test')
+_ = s:create_index('pk')
+for i = 1, 10 do s:insert{i, i} end
+s2 = box.schema.space.create('test2')
+_ = s2:create_index('pk', {type = 'hash'})
+for i = 1, 3 do s2:insert{i} end
+
+-- Only persistent memtx spaces are supported.
+t = box.schema.space.create('temp', {temporary = true})
+_ = t:create_index('pk')
+box.read_view.open({'temp'})
+t:drop()
+v = box.schema.space.create('vinyl', {engine = 'vinyl'})
+_ = v:create_index('pk')
+box.read_view.open({'vinyl'})
+v:drop()
+box.read_view.open({'no_such_space'})
+box.read_view.open('test')
+
+rv = box.read_view.open({'test', s2.id}, {name = 'report'})
+tostring(rv)
+box.info.memory().read_view
+
+-- Changes made after the read view was opened are invisible.
+for i = 1, 5 do s:delete{i} end
+s:replace{6, 60}
+s:insert{11, 11}
+box.info.memory().read_view > 0
+res = {}
+for _, tuple in rv:pairs('test') do table.insert(res, tuple) fiber.yield() end
+res
+s:count()
+
+-- A space can be iterated only once.
+rv:pairs('test')
+rv:pairs('no_such_space')
+info = rv:info()
+info.name, info.spaces.test.rows, info.spaces.test.done
+#box.read_view.list()
+
+-- A dropped space can still be read.
+s2:drop()
+res = {}
+for _, tuple in rv:pairs('test2') do table.insert(res, tuple[1]) end
+table.sort(res)
+res
+
+rv:close()
+rv:close()
+box.info.memory().read_view
+#box.read_view.list()
+tostring(rv)
+rv:pairs('test')
+
+-- A read view is closed when garbage collected.
+rv = box.read_view.open({'test'})
+#box.read_view.list()
+rv = nil
+collectgarbage('collect')
+#box.read_view.list()
+
+-- Index pages copied on write are pinned by a read view too,
+-- even if no tuple is freed.
+rv = box.read_view.open({'test'})
+box.info.memory().read_view
+s:insert{100, 100}
+box.info.memory().read_view > 0
+rv:close()
+box.info.memory().read_view
+
+s:drop()
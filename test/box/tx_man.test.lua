@@ -288,6 +288,70 @@ s:replace{1}
 collectgarbage('collect')
 s:drop()
 
+-- Phantom insert into a range read by another transaction.
+s = box.schema.space.create('test')
+i = s:create_index('pk', {parts={{1, 'uint'}}})
+s:replace{1}
+s:replace{5}
+stat = box.stat.memtx.tx()
+tx1:begin()
+tx2:begin()
+tx1('s:select({3}, {iterator = "GE"})')
+tx1('s:replace{10}')
+tx2('s:replace{2}')
+tx2:commit()
+tx1:commit()
+tx1:begin()
+tx2:begin()
+tx1('s:select({3}, {iterator = "GE"})')
+tx1('s:replace{11}')
+tx2('s:replace{4}')
+tx2:commit()
+tx1:commit()
+s:select{}
+box.stat.memtx.tx().conflicts - stat.conflicts
+
+-- A key missing in the index is a gap too.
+tx1:begin()
+tx2:begin()
+tx1('s:get{7} == nil')
+tx2('s:replace{7}')
+tx2:commit()
+tx1('s:get{7} == nil')
+tx1:commit()
+box.stat.memtx.tx().read_views - stat.read_views
+box.stat.memtx.tx().ranges
+s:drop()
+
+-- Stories are collected by a background fiber.
+test_run = require('test_run').new()
+s = box.schema.space.create('test')
+i = s:create_index('pk')
+stat = box.stat.memtx.tx()
+for i = 1, 100 do s:replace{i} end
+test_run:wait_cond(function() return box.stat.memtx.tx().stories <= 1 end)
+
+-- New transactions are throttled while stories use too much memory.
+tx1:begin()
+tx1('s:replace{1000}')
+box.cfg{memtx_tx_story_memory_limit = 1}
+s:replace{1001}
+box.stat.memtx.tx().throttled - stat.throttled
+box.cfg{memtx_tx_story_memory_limit = 0}
+tx1:commit()
+s:drop()
+
+-- Reads of system spaces aren't tracked, user space reads of
+-- the same transaction are.
+s = box.schema.space.create('test')
+i = s:create_index('pk')
+tx1:begin()
+tx1('box.space._space:get{0} == nil')
+tx1('s:get{1} == nil')
+box.stat.memtx.tx().ranges
+tx1:commit()
+s:drop()
+
 test_run:cmd("switch default")
 test_run:cmd("stop server tx_man")
 test_run:cmd("cleanup server tx_man")
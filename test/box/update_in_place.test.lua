@@ -0,0 +1,89 @@
+ffi = require('ffi')
+test_run = require('test_run').new()
+
+--
+-- An UPDATE changing only not indexed numeric fields without
+-- changing their size is applied to the tuple in place, if the
+-- tuple is not referenced by anyone except the space.
+--
+format = {{'id', 'unsigned'}, {'key', 'unsigned'}, \
+          {'counter', 'unsigned'}, {'value', 'double'}}
+s = box.schema.space.create('test', {format = format})
+_ = s:create_index('pk')
+_ = s:create_index('sk', {parts = {'key'}})
+_ = s:replace{1, 10, 0, 0.5}
+
+test_run:cmd("setopt delimiter ';'")
+function address(key)
+    collectgarbage('collect')
+    local t = s:get(key)
+    local addr = tonumber(ffi.cast('uintptr_t', ffi.cast('void *', t)))
+    t = nil
+    collectgarbage('collect')
+    return addr
+end;
+function update(key, ops)
+    collectgarbage('collect')
+    s:update(key, ops)
+    collectgarbage('collect')
+end;
+test_run:cmd("setopt delimiter ''");
+
+addr = address(1)
+update(1, {{'+', 3, 1}})
+address(1) == addr
+s:get(1)
+update(1, {{'+', 'counter', 5}, {'-', 4, 0.25}})
+address(1) == addr
+s:get(1)
+update(1, {{'=', -2, 126}})
+update(1, {{'^', 3, 1}})
+address(1) == addr
+s:get(1)
+
+-- The tuple is not changed if it is referenced.
+t = s:get(1)
+update(1, {{'-', 3, 1}})
+t
+s:get(1)
+address(1) == addr
+t = nil
+addr = address(1)
+
+-- The tuple size changes.
+update(1, {{'+', 3, 1000}})
+address(1) == addr
+s:get(1)
+addr = address(1)
+
+-- An indexed field changes.
+update(1, {{'+', 2, 1}})
+address(1) == addr
+s.index.sk:get{11}
+addr = address(1)
+
+-- Validation errors are not bypassed.
+(pcall(s.update, s, 1, {{'-', 3, 2000}}))
+(pcall(s.update, s, 1, {{'+', 3, 1}, {'+', 3, 1}}))
+(pcall(s.update, s, 1, {{'=', 4, 1}}))
+address(1) == addr
+s:get(1)
+
+-- The change is undone on rollback.
+test_run:cmd("setopt delimiter ';'")
+box.begin()
+update(1, {{'+', 3, 1}})
+in_place = address(1) == addr
+box.rollback();
+test_run:cmd("setopt delimiter ''");
+in_place
+address(1) == addr
+s:get(1)
+
+-- Triggers need both the old and the new tuple.
+_ = s:on_replace(function() end)
+update(1, {{'+', 3, 1}})
+address(1) == addr
+s:get(1)
+
+s:drop()
@@ -0,0 +1,52 @@
+test_run = require('test_run').new()
+engine = test_run:get_cfg('engine')
+
+--
+-- index:get_many() looks up a batch of keys.
+--
+s = box.schema.space.create('test', {engine = engine})
+pk = s:create_index('pk')
+sk = s:create_index('sk', {parts = {2, 'string'}})
+for i = 1, 100 do s:replace{i, tostring(i)} end
+box.snapshot()
+for i = 101, 200 do s:replace{i, tostring(i)} end
+
+pk:get_many({})
+pk:get_many({3, 1, 150, {2}})
+s:get_many({7})
+
+-- Missing and duplicate keys.
+r = pk:get_many({5, 300, 5, 300})
+r[1], r[2], r[3], r[4]
+r = sk:get_many({'10', 'x', '190'})
+r[1], r[2], r[3]
+
+-- The result matches index:get() for each key.
+keys = {}
+for i = 1, 250 do table.insert(keys, i * 37 % 250 + 1) end
+r = pk:get_many(keys)
+test_run:cmd("setopt delimiter ';'")
+function check(r, keys)
+    for i, k in ipairs(keys) do
+        local t = pk:get(k)
+        if (t == nil) ~= (r[i] == nil) or (t ~= nil and t[1] ~= r[i][1]) then
+            return false
+        end
+    end
+    return true
+end;
+test_run:cmd("setopt delimiter ''");
+check(r, keys)
+
+-- Transaction changes are visible.
+box.begin() s:replace{1, 'x'} s:delete{2} r = pk:get_many({1, 2}) box.rollback()
+r[1], r[2]
+
+-- Errors.
+pk:get_many(1)
+pk:get_many({'abc'})
+pk:get_many({{}})
+nu = s:create_index('nu', {parts = {2, 'string'}, unique = false})
+nu:get_many({'1'})
+
+s:drop()
@@ -194,12 +194,94 @@ void test_get_set()
 	footer();
 }
 
+static
+void check_bits(struct tt_bitset *bm, const bool *bits, size_t size)
+{
+	size_t cnt = 0;
+	for (size_t i = 0; i < size; i++) {
+		fail_unless(tt_bitset_test(bm, i) == bits[i]);
+		cnt += bits[i];
+	}
+	fail_unless(tt_bitset_cardinality(bm) == cnt);
+}
+
+static
+void test_containers()
+{
+	header();
+
+	struct tt_bitset bm;
+	tt_bitset_create(&bm, realloc);
+	struct tt_bitset_info info;
+
+	const size_t NUM_SIZE = (size_t) 1 << 15;
+	bool *bits = calloc(NUM_SIZE, sizeof(bool));
+
+	printf("Setting sparse bits... ");
+	for (size_t i = 0; i < NUM_SIZE; i += 1000) {
+		fail_if(tt_bitset_set(&bm, i) < 0);
+		bits[i] = true;
+	}
+	check_bits(&bm, bits, NUM_SIZE);
+	tt_bitset_info(&bm, &info);
+	fail_unless(info.array_pages == info.pages);
+	fail_unless(info.mem_size < info.pages * info.page_total_size);
+	printf("ok\n");
+
+	printf("Setting ranges of bits... ");
+	for (size_t i = 0; i < NUM_SIZE; i++) {
+		if (i % 5000 >= 3000)
+			continue;
+		fail_if(tt_bitset_set(&bm, i) < 0);
+		bits[i] = true;
+	}
+	check_bits(&bm, bits, NUM_SIZE);
+	tt_bitset_info(&bm, &info);
+	fail_unless(info.bitmap_pages == 0 && info.run_pages > 0);
+	fail_unless(info.mem_size < info.pages * info.page_total_size);
+	printf("ok\n");
+
+	printf("Setting and clearing random bits... ");
+	for (size_t k = 0; k < NUM_SIZE * 4; k++) {
+		size_t i = rand() % NUM_SIZE;
+		if (rand() % 2 == 0) {
+			fail_if(tt_bitset_set(&bm, i) < 0);
+			bits[i] = true;
+		} else {
+			fail_if(tt_bitset_clear(&bm, i) < 0);
+			bits[i] = false;
+		}
+	}
+	check_bits(&bm, bits, NUM_SIZE);
+	tt_bitset_info(&bm, &info);
+	fail_unless(info.bitmap_pages == info.pages);
+	printf("ok\n");
+
+	printf("Clearing bits... ");
+	for (size_t i = 0; i < NUM_SIZE; i++) {
+		if (i % 100 == 0)
+			continue;
+		fail_if(tt_bitset_clear(&bm, i) < 0);
+		bits[i] = false;
+	}
+	check_bits(&bm, bits, NUM_SIZE);
+	tt_bitset_info(&bm, &info);
+	fail_unless(info.bitmap_pages == 0);
+	printf("ok\n");
+
+	free(bits);
+	tt_bitset_destroy(&bm);
+
+	footer();
+}
+
 int main(int argc, char *argv[])
 {
 	setbuf(stdout, NULL);
 	srand(time(NULL));
 	test_cardinality();
 	test_get_set();
+	test_containers();
 
 	return 0;
 }
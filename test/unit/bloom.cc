@@ -2,6 +2,7 @@
 #include <unordered_set>
 #include <vector>
 #include <iostream>
+#include <math.h>
 
 using namespace std;
 
@@ -96,9 +97,42 @@ store_load_test()
 	cout << "fp_rate_too_big = " << fp_rate_too_big << endl;
 }
 
+void
+blocked_test()
+{
+	cout << "*** " << __func__ << " ***" << endl;
+	uint32_t count = 10000;
+	double p = 0.05;
+	struct bloom bloom;
+	bloom_create(&bloom, count, p);
+	/* Classic filter would need 5 hash functions per value */
+	uint32_t classic_size = ceil(count * 5 / log(2) / CHAR_BIT);
+	cout << "type = " << (int)bloom.type << endl;
+	cout << "size is less than classic = " <<
+		(bloom_store_size(&bloom) < classic_size) << endl;
+	for (uint32_t i = 0; i < count; i++)
+		bloom_add(&bloom, h(i));
+	uint32_t error_count = 0;
+	uint32_t false_positive = 0;
+	for (uint32_t i = 0; i < count * 10; i++) {
+		bool bloom_possible = bloom_maybe_has(&bloom, h(i));
+		if (i < count && !bloom_possible)
+			error_count++;
+		if (i >= count && bloom_possible)
+			false_positive++;
+	}
+	double fp_rate = (double)false_positive / (count * 9);
+	cout << "error_count = " << error_count << endl;
+	cout << "fp_rate_too_big = " << (fp_rate > p + 0.005) << endl;
+	cout << "fpr estimate is accurate = " <<
+		(fabs(bloom_fpr(&bloom, count) - p) < 0.005) << endl;
+	bloom_destroy(&bloom);
+}
+
 int
 main(void)
 {
 	simple_test();
 	store_load_test();
+	blocked_test();
 }
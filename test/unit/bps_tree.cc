@@ -115,6 +115,29 @@ static int compare_key(const elem_t &a, long b)
 #define bps_tree_key_t uint32_t
 #define bps_tree_arg_t int
 #include "salad/bps_tree.h"
+#undef BPS_TREE_NAME
+#undef BPS_TREE_BLOCK_SIZE
+#undef BPS_TREE_EXTENT_SIZE
+#undef BPS_TREE_IS_IDENTICAL
+#undef BPS_TREE_COMPARE
+#undef BPS_TREE_COMPARE_KEY
+#undef bps_tree_elem_t
+#undef bps_tree_key_t
+#undef bps_tree_arg_t
+
+/* tree with subtree cardinalities for offset test */
+#define BPS_TREE_NAME card
+#define BPS_TREE_BLOCK_SIZE 128 /* value is to low specially for tests */
+#define BPS_TREE_EXTENT_SIZE 2048 /* value is to low specially for tests */
+#define BPS_TREE_IS_IDENTICAL(a, b) (a == b)
+#define BPS_TREE_COMPARE(a, b, arg) compare(a, b)
+#define BPS_TREE_COMPARE_KEY(a, b, arg) compare(a, b)
+#define bps_tree_elem_t type_t
+#define bps_tree_key_t type_t
+#define bps_tree_arg_t int
+#define BPS_INNER_CARD
+#include "salad/bps_tree.h"
+#undef BPS_INNER_CARD
 
 #define bps_insert_and_check(tree_name, tree, elem, replaced) \
 {\
@@ -858,6 +881,86 @@ delete_value_check()
 	footer();
 }
 
+static void
+offset_check_tree(card *tree, const bool *present, type_t range)
+{
+	if (card_debug_check(tree)) {
+		card_print(tree, TYPE_F);
+		fail("debug check nonzero", "true");
+	}
+	size_t less = 0;
+	for (type_t i = 0; i < range; i++) {
+		size_t offset;
+		bool exact;
+		card_iterator itr = card_lower_bound_get_offset(tree, i, &exact,
+								&offset);
+		if (offset != less || exact != present[i])
+			fail("lower bound offset", "false");
+		if (present[i]) {
+			type_t *elem = card_iterator_get_elem(tree, &itr);
+			if (elem == NULL || *elem != i)
+				fail("lower bound elem", "false");
+			card_iterator at = card_iterator_at(tree, offset);
+			elem = card_iterator_get_elem(tree, &at);
+			if (elem == NULL || *elem != i)
+				fail("iterator at offset", "false");
+			less++;
+		}
+		card_upper_bound_get_offset(tree, i, &exact, &offset);
+		if (offset != less || exact != present[i])
+			fail("upper bound offset", "false");
+	}
+	if (less != card_size(tree))
+		fail("tree size", "false");
+	card_iterator at = card_iterator_at(tree, less);
+	if (!card_iterator_is_invalid(&at))
+		fail("iterator at offset past the end", "false");
+}
+
+static void
+offset_check()
+{
+	header();
+	srand(0);
+
+	const type_t range = 3000;
+	bool present[range];
+	type_t arr[range];
+	size_t arr_size = 0;
+	for (type_t i = 0; i < range; i++) {
+		present[i] = i % 3 == 0;
+		if (present[i])
+			arr[arr_size++] = i;
+	}
+
+	card tree;
+	card_create(&tree, 0, extent_alloc, extent_free, &extents_count);
+	card_build(&tree, arr, arr_size);
+	offset_check_tree(&tree, present, range);
+
+	for (int round = 0; round < 10; round++) {
+		for (int i = 0; i < 1000; i++) {
+			type_t v = rand() % range;
+			if (present[v])
+				card_delete(&tree, v);
+			else
+				card_insert(&tree, v, NULL);
+			present[v] = !present[v];
+		}
+		offset_check_tree(&tree, present, range);
+	}
+	for (type_t i = 0; i < range; i++) {
+		if (present[i])
+			card_delete(&tree, i);
+		present[i] = false;
+	}
+	offset_check_tree(&tree, present, range);
+
+	card_destroy(&tree);
+
+	footer();
+}
+
 int
 main(void)
 {
@@ -873,4 +976,5 @@ main(void)
 		fail("memory leak!", "true");
 	insert_get_iterator();
 	delete_value_check();
+	offset_check();
 }
@@ -275,12 +275,100 @@ neighbor_test()
 	footer();
 }
 
+static void
+bulk_load_check(unsigned dimension, size_t count)
+{
+	struct rtree_rect *arr =
+		(struct rtree_rect *)calloc(count + 1, sizeof(*arr));
+	for (size_t i = 0; i < count; i++) {
+		for (unsigned j = 0; j < dimension; j++) {
+			coord_t lo = rand() % 1000;
+			arr[i].coords[2 * j] = lo;
+			arr[i].coords[2 * j + 1] = lo + rand() % 10;
+		}
+	}
+
+	struct rtree tree;
+	rtree_init(&tree, dimension, extent_size,
+		   extent_alloc, extent_free, &page_count,
+		   RTREE_EUCLID);
+	int page_count_before = page_count;
+	size_t extents = rtree_bulk_load_extent_count(&tree, count);
+	for (size_t i = 0; i < count; i++) {
+		if (rtree_bulk_load_add(&tree, &arr[i],
+					(record_t)(i + 1)) != 0)
+			fail("bulk load add", "false");
+	}
+	rtree_bulk_load_end(&tree);
+	if ((size_t)(page_count - page_count_before) > extents)
+		fail("bulk load extent count", "false");
+	if (rtree_number_of_records(&tree) != count)
+		fail("bulk load count mismatch", "true");
+
+	struct rtree_iterator iterator;
+	rtree_iterator_init(&iterator);
+	for (size_t k = 0; k < 100; k++) {
+		struct rtree_rect rect;
+		for (unsigned j = 0; j < dimension; j++) {
+			coord_t lo = rand() % 1000;
+			rect.coords[2 * j] = lo;
+			rect.coords[2 * j + 1] = lo + rand() % 100;
+		}
+		size_t expected = 0;
+		for (size_t i = 0; i < count; i++) {
+			bool overlaps = true;
+			for (unsigned j = 0; j < dimension; j++) {
+				if (arr[i].coords[2 * j] >
+				    rect.coords[2 * j + 1] ||
+				    arr[i].coords[2 * j + 1] <
+				    rect.coords[2 * j])
+					overlaps = false;
+			}
+			if (overlaps)
+				expected++;
+		}
+		size_t found = 0;
+		rtree_search(&tree, &rect, SOP_OVERLAPS, &iterator);
+		while (rtree_iterator_next(&iterator) != NULL)
+			found++;
+		if (found != expected)
+			fail("bulk load search result", "false");
+	}
+	rtree_iterator_destroy(&iterator);
+
+	/* Check that the loaded tree is updated properly. */
+	for (size_t i = 0; i < count; i++) {
+		if (!rtree_remove(&tree, &arr[i], (record_t)(i + 1)))
+			fail("delete bulk loaded element", "false");
+	}
+	if (rtree_number_of_records(&tree) != 0)
+		fail("bulk load count mismatch", "true");
+
+	rtree_purge(&tree);
+	rtree_destroy(&tree);
+	free(arr);
+}
+
+static void
+bulk_load_test()
+{
+	header();
+
+	const size_t counts[] = {0, 1, 7, 100, 1000, 10000};
+	for (unsigned dimension = 1; dimension <= 4; dimension++) {
+		for (size_t i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+			bulk_load_check(dimension, counts[i]);
+	}
+
+	footer();
+}
 
 int
 main(void)
 {
 	simple_check();
 	neighbor_test();
+	bulk_load_test();
 	if (page_count != 0) {
 		fail("memory leak!", "true");
 	}
@@ -42,7 +42,10 @@ box.snapshot()
 -- we use 5, 4, 3, and 1 hash functions for each sub key respectively.
 -- This leaves us only (100*5 + 500*4 + 1000*3 + 1000*1) / ln(2) bits
 -- or 1172 bytes, and after rounding up to the block size (128 byte)
--- we have 1280 bytes plus the header overhead.
+-- we have 1280 bytes plus the header overhead. Bloom filters of the
+-- first three sub keys are register-blocked, because a blocked filter
+-- takes less memory for the given fpr, so the total size is a bit
+-- smaller than that.
 --
 s.index.pk:stat().disk.bloom_size
 
@@ -0,0 +1,41 @@
+test_run = require('test_run').new()
+
+--
+-- Bloom filters are built with the hash function of the index
+-- and remember it, so that runs created before the hash function
+-- was changed can still be checked.
+--
+vinyl_cache = box.cfg.vinyl_cache
+box.cfg{vinyl_cache = 0}
+
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk', {parts = {1, 'unsigned', 2, 'string'}, hash_func = 'wyhash'})
+for i = 1, 100 do s:replace{i, tostring(i)} end
+box.snapshot()
+s.index.pk:stat().disk.bloom_size > 0
+
+cnt = 0
+for i = 1, 100 do if s:get{i, tostring(i)} ~= nil then cnt = cnt + 1 end end
+cnt
+for i = 101, 200 do s:get{i, tostring(i)} end
+s.index.pk:stat().disk.iterator.bloom.hit > 80
+
+test_run:cmd('restart server default')
+box.cfg{vinyl_cache = 0}
+s = box.space.test
+
+cnt = 0
+for i = 1, 100 do if s:get{i, tostring(i)} ~= nil then cnt = cnt + 1 end end
+cnt
+for i = 101, 200 do s:get{i, tostring(i)} end
+s.index.pk:stat().disk.iterator.bloom.hit > 80
+
+s.index.pk:alter{hash_func = 'murmur3'}
+for i = 201, 300 do s:replace{i, tostring(i)} end
+box.snapshot()
+cnt = 0
+for i = 1, 300 do if s:get{i, tostring(i)} ~= nil then cnt = cnt + 1 end end
+cnt
+
+s:drop()
+box.cfg{vinyl_cache = vinyl_cache}
@@ -0,0 +1,62 @@
+test_run = require('test_run').new()
+digest = require('digest')
+
+--
+-- Leveled compaction strategy.
+--
+s = box.schema.space.create('test', {engine = 'vinyl'})
+s:create_index('pk', {compaction_strategy = 'foo'})
+s:create_index('pk', {compaction_strategy = 1})
+i = s:create_index('pk', {compaction_strategy = 'leveled', run_count_per_level = 2, run_size_ratio = 4, page_size = 128})
+i.options.compaction_strategy
+
+test_run:cmd("setopt delimiter ';'")
+function dump(first, last)
+    for k = first, last do
+        s:replace{k, digest.urandom(100)}
+    end
+    box.snapshot()
+end;
+function wait_compaction()
+    test_run:wait_cond(function()
+        local st = box.stat.vinyl().scheduler
+        return st.tasks_inprogress == 0 and st.compaction_queue == 0
+    end, 10)
+end;
+test_run:cmd("setopt delimiter ''");
+
+-- The first run is big so it forms the last level. Level 0
+-- stores up to run_count_per_level (+1, see vy_range.c) runs.
+-- When it overflows, it's compacted into a new level 1 run,
+-- which is 16 times smaller than the last level, and then merged
+-- into level 1, so 8 small dumps take exactly 2 compactions and
+-- the last level is never rewritten.
+dump(1, 640)
+for k = 0, 7 do dump(641 + k * 10, 650 + k * 10) wait_compaction() end
+st = i:stat()
+st.range_count -- 1
+st.run_count >= 2 and st.run_count <= 5
+st.disk.compaction.count -- 2
+st.disk.compaction.input.rows < 640
+s:count() -- 720
+
+-- Amplification statistics.
+for k = 1, 720 do s:get(k) end
+st = i:stat().amplification
+st.write > 1
+st.read >= 1
+st.space >= 1
+
+-- The strategy can be changed on the fly.
+i:alter{compaction_strategy = 'tiered'}
+i.options.compaction_strategy -- tiered
+i:alter{compaction_strategy = 'LEVELED'}
+i.options.compaction_strategy -- leveled
+
+-- Forcing compaction still works.
+i:compact()
+wait_compaction()
+i:stat().run_count -- 1
+s:count() -- 720
+
+s:drop()
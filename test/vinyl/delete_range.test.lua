@@ -0,0 +1,91 @@
+test_run = require('test_run').new()
+xlog = require('xlog')
+
+-- Number of records of the given type stored in the metadata
+-- log (5 is create run, 18 and 19 are insert and delete range
+-- tombstone), optionally only those that have the given key.
+test_run:cmd("setopt delimiter ';'")
+function vylog_record_count(type, key)
+    local count = 0
+    for _, path in ipairs(box.backup.start()) do
+        if path:match('%.vylog$') then
+            for _, row in xlog.pairs(path) do
+                local t = row.BODY.tuple
+                if t[1] == type and (key == nil or t[2][key] ~= nil) then
+                    count = count + 1
+                end
+            end
+        end
+    end
+    box.backup.stop()
+    return count
+end;
+test_run:cmd("setopt delimiter ''");
+
+--
+-- Range deletion.
+--
+s = box.schema.space.create('test', {engine = 'memtx'})
+_ = s:create_index('pk')
+s:delete_range({1}, {10})
+s:drop()
+
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk')
+_ = s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+for i = 1, 10 do s:insert{i, i * 10} end
+
+-- Only the primary index supports range deletion.
+s.index.sk:delete_range({10}, {20})
+s:delete_range({'a'}, {10})
+
+-- Range deletion must be the only statement of a transaction.
+box.begin() s:replace{11, 110} s:delete_range({1}, {2})
+box.rollback()
+box.begin() s:delete_range({1}, {2}) s:replace{11, 110}
+box.rollback()
+s:select()
+
+-- The end of the range is exclusive.
+s:delete_range({3}, {7})
+s:select()
+s.index.sk:select()
+s:get(3)
+s:get(7)
+s:count()
+
+-- Keys written after the range deletion are visible.
+s:insert{4, 40}
+s:select()
+
+-- Dump logs the tombstone and forces compaction of ranges
+-- intersecting it, even if they have only one run.
+box.snapshot()
+vylog_record_count(18)
+s:select()
+s.index.sk:select()
+
+-- The tombstone is dropped once all ranges it intersects
+-- have applied it.
+test_run:wait_cond(function() return vylog_record_count(19) == 1 end, 10)
+s.index.pk:stat().disk.rows
+s.index.sk:select()
+
+-- The LSN of the tombstone applied by compaction is stored
+-- in the create_run record (key 18) so that it's restored on
+-- recovery.
+vylog_record_count(5, 18)
+
+-- Empty keys stand for infinity.
+s:delete_range({}, {2})
+s:delete_range({9})
+s:select()
+
+-- Range tombstones are recovered from the metadata log and WAL.
+box.snapshot()
+s:delete_range({7}, {8})
+test_run:cmd('restart server default')
+s = box.space.test
+s:select()
+s.index.sk:select()
+s:drop()
@@ -0,0 +1,54 @@
+test_run = require('test_run').new()
+
+--
+-- Expired tuples of a vinyl space are dropped by dump and
+-- compaction of the primary index.
+--
+format = {{'id', 'unsigned'}, {'exp', 'number', is_nullable = true}}
+s = box.schema.space.create('test', {engine = 'vinyl', expire_field = 'exp', format = format})
+s.expire_field
+_ = s:create_index('pk')
+for i = 1, 3 do s:insert{i, 1} end
+for i = 4, 6 do s:insert{i, 1.5} end
+for i = 7, 9 do s:insert{i, 4000000000} end
+_ = s:insert{10, box.NULL}
+
+-- Expired tuples are visible until dumped. Reading them
+-- fills the cache, which must be invalidated on dump.
+s:count()
+box.snapshot()
+s.index.pk:stat().disk.rows
+s:select()
+
+-- Dump keeps expired tuples if there are older runs,
+-- compaction drops them.
+s:insert{1, 1}
+s:update(7, {{'=', 2, 1}})
+box.snapshot()
+s.index.pk:stat().disk.rows
+s:count()
+s.index.pk:compact()
+test_run:wait_cond(function() return box.stat.vinyl().scheduler.tasks_inprogress == 0 and box.stat.vinyl().scheduler.compaction_queue == 0 end, 10)
+s.index.pk:stat().disk.rows
+s:select()
+s:drop()
+
+-- Secondary indexes are updated with deferred DELETEs
+-- generated by primary index compaction.
+s = box.schema.space.create('test', {engine = 'vinyl', expire_field = 'exp', format = format})
+_ = s:create_index('pk')
+_ = s:create_index('sk', {parts = {'exp', 'number', is_nullable = true}, unique = false})
+for i = 1, 3 do s:insert{i, 1} end
+for i = 4, 6 do s:insert{i, 4000000000} end
+box.snapshot()
+s.index.pk:stat().disk.rows
+s.index.pk:compact()
+test_run:wait_cond(function() return box.stat.vinyl().scheduler.tasks_inprogress == 0 and box.stat.vinyl().scheduler.compaction_queue == 0 end, 10)
+s.index.pk:stat().disk.rows
+s:select()
+s.index.sk:select()
+box.snapshot()
+s.index.sk:compact()
+test_run:wait_cond(function() return box.stat.vinyl().scheduler.tasks_inprogress == 0 and box.stat.vinyl().scheduler.compaction_queue == 0 end, 10)
+s.index.sk:stat().disk.rows
+s:drop()
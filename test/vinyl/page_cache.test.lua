@@ -0,0 +1,75 @@
+test_run = require('test_run').new()
+
+--
+-- Shared cache of decompressed run pages.
+--
+box.cfg.vinyl_page_cache
+box.stat.vinyl().page_cache.bytes
+
+-- Disable the tuple cache so that all reads go to disk.
+vinyl_cache = box.cfg.vinyl_cache
+box.cfg{vinyl_cache = 0}
+box.cfg{vinyl_page_cache = 16 * 1024}
+
+s = box.schema.space.create('test', {engine = 'vinyl'})
+pk = s:create_index('pk', {page_size = 1024, run_count_per_level = 10})
+pad = string.rep('x', 100)
+for i = 1, 500 do s:replace{i, pad} end
+box.snapshot()
+
+test_run:cmd("setopt delimiter ';'")
+function cache_stat()
+    local st = box.stat.vinyl().page_cache
+    st.read = pk:stat().disk.iterator.read.pages
+    return st
+end;
+function cache_diff(old)
+    local new = cache_stat()
+    return {hit = new.hit - old.hit, miss = new.miss - old.miss,
+            evict = new.evict - old.evict, read = new.read - old.read}
+end;
+test_run:cmd("setopt delimiter ''");
+
+-- A page read from disk is added to the cache.
+st = cache_stat()
+s:get{1}[1]
+d = cache_diff(st)
+d.hit == 0, d.miss > 0, d.read == d.miss
+box.stat.vinyl().page_cache.bytes > 0
+
+-- The next lookup in the same page doesn't read the disk.
+st = cache_stat()
+s:get{2}[1]
+d = cache_diff(st)
+d.hit > 0, d.miss == 0, d.read == 0
+
+-- A full scan doesn't fit in the cache, but it doesn't evict
+-- the page that was hit before.
+st = cache_stat()
+#s:select{}
+d = cache_diff(st)
+d.evict > 0
+box.stat.vinyl().page_cache.bytes <= 16 * 1024
+st = cache_stat()
+s:get{3}[1]
+d = cache_diff(st)
+d.hit > 0, d.miss == 0, d.read == 0
+
+-- Statistics are reset by box.stat.reset().
+box.stat.reset()
+st = box.stat.vinyl().page_cache
+st.hit, st.miss, st.evict
+
+-- Shrinking the cache evicts pages.
+box.cfg{vinyl_page_cache = 0}
+box.stat.vinyl().page_cache.bytes
+box.cfg{vinyl_page_cache = 16 * 1024}
+s:get{1}[1]
+box.stat.vinyl().page_cache.bytes > 0
+
+-- Pages are evicted when the run is deleted.
+s:drop()
+test_run:wait_cond(function() return box.stat.vinyl().page_cache.bytes == 0 end)
+
+box.cfg{vinyl_page_cache = 0}
+box.cfg{vinyl_cache = vinyl_cache}
@@ -0,0 +1,52 @@
+test_run = require('test_run').new()
+digest = require('digest')
+
+--
+-- A range that outgrew range_size is split before major
+-- compaction if there are idle compaction workers so that
+-- its parts are compacted in parallel.
+--
+box.cfg.vinyl_write_threads >= 3
+
+s = box.schema.space.create('test', {engine = 'vinyl'})
+i = s:create_index('pk', {page_size = 128, range_size = 8192, run_count_per_level = 1})
+
+test_run:cmd("setopt delimiter ';'")
+function dump()
+    for k = 1, 75 do
+        s:replace{k, digest.urandom(100)}
+    end
+    box.snapshot()
+end;
+function wait_compaction(count)
+    test_run:wait_cond(function()
+        return i:stat().disk.compaction.count == count
+    end, 10)
+end;
+test_run:cmd("setopt delimiter ''");
+
+dump()
+dump() -- compaction
+wait_compaction(1)
+i:stat().range_count -- 1
+-- The run is bigger than range_size, but not big enough
+-- to be split in the usual way.
+i:stat().disk.bytes >= i:stat().range_size
+i:stat().disk.bytes < i:stat().range_size * 4 / 3
+
+dump()
+i:compact()
+wait_compaction(3)
+i:stat().range_count -- 2
+i:stat().run_count -- 2
+s:count() -- 75
+i:select({}, {limit = 1})[1][1] -- 1
+i:select({}, {limit = 1, iterator = 'LE'})[1][1] -- 75
+
+-- Parts of a range that was just split aren't split again.
+dump()
+i:compact()
+wait_compaction(5)
+i:stat().range_count -- 2
+
+s:drop()
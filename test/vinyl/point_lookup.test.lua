@@ -0,0 +1,60 @@
+test_run = require('test_run').new()
+
+--
+-- A point lookup reads all runs that may store the key in
+-- parallel and merges the results, the newest run winning.
+--
+s = box.schema.space.create('test', {engine = 'vinyl'})
+_ = s:create_index('pk', {run_count_per_level = 10})
+m = box.schema.space.create('test_memtx', {engine = 'memtx'})
+_ = m:create_index('pk')
+
+test_run:cmd("setopt delimiter ';'")
+function apply(op, ...)
+    s[op](s, ...)
+    m[op](m, ...)
+end;
+for i = 1, 100 do apply('replace', {i, 1}) end;
+box.snapshot();
+for i = 2, 100, 2 do apply('replace', {i, 2}) end;
+box.snapshot();
+for i = 3, 100, 3 do apply('delete', {i}) end;
+box.snapshot();
+for i = 5, 100, 5 do apply('upsert', {i, 4}, {{'+', 2, 1}}) end;
+box.snapshot();
+function check()
+    for i = 0, 101 do
+        local v1, v2 = s:get{i}, m:get{i}
+        if (v1 == nil) ~= (v2 == nil) or
+           (v1 ~= nil and v1[2] ~= v2[2]) then
+            return false, i, v1, v2
+        end
+    end
+    return true
+end;
+test_run:cmd("setopt delimiter ''");
+
+s.index.pk:stat().run_count
+check()
+
+-- Check lookups done concurrently with dumps.
+fiber = require('fiber')
+test_run:cmd("setopt delimiter ';'")
+for i = 1, 100, 7 do apply('replace', {i, 5}) end;
+ch = fiber.channel(4);
+for _ = 1, 4 do
+    fiber.create(function()
+        local ok = true
+        for _ = 1, 10 do
+            ok = ok and check()
+        end
+        ch:put(ok)
+    end)
+end;
+box.snapshot();
+test_run:cmd("setopt delimiter ''");
+ch:get(), ch:get(), ch:get(), ch:get()
+check()
+
+s:drop()
+m:drop()
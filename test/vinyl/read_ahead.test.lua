@@ -0,0 +1,83 @@
+test_run = require('test_run').new()
+
+--
+-- Run iterators read pages ahead on sequential access.
+--
+vinyl_cache = box.cfg.vinyl_cache
+box.cfg{vinyl_cache = 0}
+
+s = box.schema.space.create('test', {engine = 'vinyl'})
+pk = s:create_index('pk', {page_size = 256, run_count_per_level = 10})
+pad = string.rep('x', 100)
+for i = 1, 500 do s:replace{i, pad} end
+box.snapshot()
+
+st = pk:stat()
+st.disk.pages > 100
+
+test_run:cmd("setopt delimiter ';'")
+function check(iterator, key)
+    local prev = nil
+    local count = 0
+    for _, t in s:pairs(key, {iterator = iterator}) do
+        if prev ~= nil and (prev < t[1]) ~= (iterator == 'GE' or
+                                             iterator == 'GT') then
+            return false
+        end
+        prev = t[1]
+        count = count + 1
+    end
+    return count
+end;
+function pages_read()
+    return pk:stat().disk.iterator.read.pages
+end;
+test_run:cmd("setopt delimiter ''");
+
+-- Every page is read exactly once during a full scan.
+p = pages_read()
+check('GE')
+pages_read() - p == st.disk.pages
+p = pages_read()
+check('LE')
+pages_read() - p == st.disk.pages
+
+check('GT', 100)
+check('LT', 400)
+
+-- Pages read ahead, but not used, are released.
+for _, t in s:pairs() do if t[1] > 200 then break end end
+gen, param, state = s:pairs({}, {iterator = 'LE'})
+_, t = gen(param, state)
+_, t = gen(param, state)
+t[1]
+gen = nil param = nil state = nil
+collectgarbage()
+
+-- Check scans that merge several runs.
+for i = 1, 500, 3 do s:replace{i, i} end
+box.snapshot()
+check('GE')
+check('LE')
+
+-- Check scans that are interleaved with dumps and compaction.
+fiber = require('fiber')
+test_run:cmd("setopt delimiter ';'")
+ch = fiber.channel(4);
+for _ = 1, 4 do
+    fiber.create(function()
+        local ok = true
+        for _ = 1, 5 do
+            ok = ok and check('GE') == 500 and check('LE') == 500
+        end
+        ch:put(ok)
+    end)
+end;
+for i = 1, 500, 7 do s:replace{i, pad} end;
+box.snapshot();
+pk:compact();
+test_run:cmd("setopt delimiter ''");
+ch:get(), ch:get(), ch:get(), ch:get()
+
+s:drop()
+box.cfg{vinyl_cache = vinyl_cache}
@@ -72,9 +72,13 @@ end;
 --
 -- Filter dump/compaction time as we need error injection to
 -- test them properly.
+--
+-- Amplification is derived from other statistics and is checked
+-- by vinyl/compaction_strategy.test.lua.
 function istat()
     local st = box.space.test.index.pk:stat()
     st.latency = nil
+    st.amplification = nil
     st.disk.dump.time = nil
     st.disk.compaction.time = nil
     return st
@@ -87,9 +91,14 @@ end;
 --
 -- Filter dump/compaction time as we need error injection to
 -- test them properly.
+--
+-- The page and value caches are disabled by default and
+-- checked by vinyl/page_cache.test.lua and vinyl/value_log.test.lua.
 function gstat()
     local st = box.stat.vinyl()
     st.regulator = nil
+    st.page_cache = nil
+    st.value_cache = nil
     st.scheduler.dump_time = nil
     st.scheduler.compaction_time = nil
     return st
@@ -0,0 +1,145 @@
+test_run = require('test_run').new()
+digest = require('digest')
+fio = require('fio')
+
+--
+-- Key-value separation.
+--
+s = box.schema.space.create('test', {engine = 'vinyl'})
+s:create_index('pk', {value_log_threshold = 'foo'})
+i = s:create_index('pk', {value_log_threshold = 100, page_size = 1024})
+i.options.value_log_threshold
+_ = s:create_index('sk', {parts = {2, 'unsigned'}, unique = false})
+
+test_run:cmd("setopt delimiter ';'")
+function value_files()
+    local dir = fio.pathjoin(box.cfg.vinyl_dir, tostring(s.id), '0')
+    return #fio.glob(fio.pathjoin(dir, '*.vlog'))
+end;
+function wait_compaction()
+    test_run:wait_cond(function()
+        local st = box.stat.vinyl().scheduler
+        return st.tasks_inprogress == 0 and st.compaction_queue == 0
+    end, 10)
+end;
+function check()
+    local errors = {}
+    for k = 1, 100 do
+        local t = s:get(k)
+        if t == nil or t[3] ~= values[k] or t[4] ~= k then
+            table.insert(errors, k)
+        end
+    end
+    if s.index.sk:count() ~= s:count() then
+        table.insert(errors, 'sk')
+    end
+    return errors
+end;
+test_run:cmd("setopt delimiter ''");
+
+-- Big non-indexed fields are stored in value files, so runs
+-- stay small.
+values = {}
+for k = 1, 100 do values[k] = digest.urandom(1000) s:replace{k, k % 10, values[k], k} end
+box.snapshot()
+value_files() -- 1
+i:stat().disk.bytes < 100 * 1000
+check()
+s:select({5}, {iterator = 'ge', limit = 1})[1][3] == values[5]
+s.index.sk:select({3}, {limit = 1})[1][3] == values[3]
+
+-- Updates and upserts of separated tuples.
+for k = 1, 100, 2 do s:update(k, {{'=', 4, k * 2}}) end
+for k = 1, 100, 2 do s:upsert({k, 0, '', 0}, {{'-', 4, k}}) end
+for k = 2, 100, 2 do values[k] = digest.urandom(1000) s:replace{k, k % 10, values[k], k} end
+box.snapshot()
+check()
+
+-- Compaction copies references rather than values.
+i:compact()
+wait_compaction()
+i:stat().run_count -- 1
+i:stat().disk.bytes < 100 * 1000
+check()
+
+-- Secondary index built after values were separated.
+_ = s:create_index('sk2', {parts = {4, 'unsigned'}})
+s.index.sk2:count() -- 100
+s.index.sk2:get(50)[3] == values[50]
+
+test_run:cmd('restart server default')
+test_run = require('test_run').new()
+digest = require('digest')
+fio = require('fio')
+s = box.space.test
+i = s.index.pk
+
+test_run:cmd("setopt delimiter ';'")
+function value_files()
+    local dir = fio.pathjoin(box.cfg.vinyl_dir, tostring(s.id), '0')
+    return #fio.glob(fio.pathjoin(dir, '*.vlog'))
+end;
+function wait_compaction()
+    test_run:wait_cond(function()
+        local st = box.stat.vinyl().scheduler
+        return st.tasks_inprogress == 0 and st.compaction_queue == 0
+    end, 10)
+end;
+test_run:cmd("setopt delimiter ''");
+
+s:count() -- 100
+value_files() > 0
+#s:get(42)[3] -- 1000
+s.index.sk2:get(42)[1] -- 42
+
+-- Key-value separation can be disabled on the fly, in which
+-- case values are moved back to runs by compaction.
+i:alter{value_log_threshold = 0}
+i.options.value_log_threshold -- nil
+vals = {}
+for k = 1, 100 do vals[k] = s:get(k)[3] end
+i:compact()
+wait_compaction()
+i:stat().disk.bytes > 100 * 1000
+bad = 0
+for k = 1, 100 do if s:get(k)[3] ~= vals[k] then bad = bad + 1 end end
+bad -- 0
+
+s:drop()
+
+-- Value files that are mostly garbage are rewritten by the
+-- scheduler even if the index doesn't need compaction.
+s = box.schema.space.create('test', {engine = 'vinyl'})
+i = s:create_index('pk', {value_log_threshold = 100, run_count_per_level = 10})
+values = {}
+for k = 1, 100 do values[k] = digest.urandom(1000) s:replace{k, values[k]} end
+box.snapshot()
+for k = 1, 70 do values[k] = digest.urandom(1000) s:replace{k, values[k]} end
+box.snapshot()
+i:compact()
+test_run:wait_cond(function() return i:stat().disk.compaction.count == 2 end, 10)
+i:stat().run_count -- 1
+test_run:grep_log('default', 'scheduled value log GC') ~= nil
+bad = 0
+for k = 1, 100 do if s:get(k)[2] ~= values[k] then bad = bad + 1 end end
+bad -- 0
+
+-- Values are read from disk only for statements returned to
+-- the user and are kept in the value cache.
+vinyl_cache = box.cfg.vinyl_cache
+box.cfg{vinyl_cache = 0, vinyl_value_cache = 1024 * 1024}
+st1 = box.stat.vinyl().value_cache
+s:get(42)[2] == values[42]
+s:get(42)[2] == values[42]
+st2 = box.stat.vinyl().value_cache
+st2.miss - st1.miss -- 1
+st2.hit - st1.hit -- 1
+st2.bytes >= 1000
+#s:select({42}, {iterator = 'ge', limit = 3}) -- 3
+st3 = box.stat.vinyl().value_cache
+st3.miss - st2.miss -- 2
+st3.hit - st2.hit -- 1
+box.cfg{vinyl_cache = vinyl_cache, vinyl_value_cache = 0}
+box.stat.vinyl().value_cache.bytes -- 0
+
+s:drop()
@@ -0,0 +1,150 @@
+/*
+ * A compact 64-bit hash function built on the wyhash construction
+ * by Wang Yi <godspeed_china@yeah.net>, which is released into the
+ * public domain (The Unlicense).
+ *
+ * Input is consumed in 8- and 16-byte words, each pair of words is
+ * folded with a single 64x64->128 bit multiplication, so short keys
+ * (the common case for index keys) are hashed in a handful of
+ * instructions. Words are always read in little-endian order, so the
+ * result does not depend on the host byte order and may be persisted.
+ */
+#ifndef TARANTOOL_THIRD_PARTY_WYHASH_H_INCLUDED
+#define TARANTOOL_THIRD_PARTY_WYHASH_H_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* defined(__cplusplus) */
+
+/** Default secret: odd 64-bit constants with 32 bits set each. */
+#define WYHASH_P0 0xa0761d6478bd642fULL
+#define WYHASH_P1 0xe7037ed1a0b428dbULL
+#define WYHASH_P2 0x8ebc6af09c88c6e3ULL
+#define WYHASH_P3 0x589965cc75374cc3ULL
+
+/** 64x64->128 multiplication, returns low and high halves. */
+static inline void
+wyhash_mum(uint64_t *a, uint64_t *b)
+{
+#if defined(__SIZEOF_INT128__)
+	__uint128_t r = *a;
+	r *= *b;
+	*a = (uint64_t)r;
+	*b = (uint64_t)(r >> 64);
+#else
+	uint64_t ha = *a >> 32, hb = *b >> 32;
+	uint64_t la = (uint32_t)*a, lb = (uint32_t)*b;
+	uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+	uint64_t t = rl + (rm0 << 32);
+	uint64_t c = t < rl;
+	uint64_t lo = t + (rm1 << 32);
+	c += lo < t;
+	uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+	*a = lo;
+	*b = hi;
+#endif
+}
+
+/** Multiply and fold the 128-bit product back to 64 bits. */
+static inline uint64_t
+wyhash_mix(uint64_t a, uint64_t b)
+{
+	wyhash_mum(&a, &b);
+	return a ^ b;
+}
+
+static inline uint64_t
+wyhash_read8(const uint8_t *p)
+{
+	uint64_t v;
+	memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	v = __builtin_bswap64(v);
+#endif
+	return v;
+}
+
+static inline uint64_t
+wyhash_read4(const uint8_t *p)
+{
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	v = __builtin_bswap32(v);
+#endif
+	return v;
+}
+
+/** Read 1..3 bytes: the first, the middle and the last one. */
+static inline uint64_t
+wyhash_read3(const uint8_t *p, size_t len)
+{
+	return ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) |
+	       p[len - 1];
+}
+
+/**
+ * Hash @a len bytes at @a key. The seed may be the result of
+ * a previous call, which allows to hash a sequence of
+ * non-contiguous chunks.
+ */
+static inline uint64_t
+wyhash(const void *key, size_t len, uint64_t seed)
+{
+	const uint8_t *p = (const uint8_t *)key;
+	uint64_t a, b;
+	seed ^= wyhash_mix(seed ^ WYHASH_P0, WYHASH_P1);
+	if (len <= 16) {
+		if (len >= 4) {
+			size_t off = (len >> 3) << 2;
+			a = (wyhash_read4(p) << 32) | wyhash_read4(p + off);
+			b = (wyhash_read4(p + len - 4) << 32) |
+			    wyhash_read4(p + len - 4 - off);
+		} else if (len > 0) {
+			a = wyhash_read3(p, len);
+			b = 0;
+		} else {
+			a = b = 0;
+		}
+	} else {
+		size_t i = len;
+		if (i > 48) {
+			uint64_t see1 = seed, see2 = seed;
+			do {
+				seed = wyhash_mix(wyhash_read8(p) ^ WYHASH_P1,
+						  wyhash_read8(p + 8) ^ seed);
+				see1 = wyhash_mix(wyhash_read8(p + 16) ^
+						  WYHASH_P2,
+						  wyhash_read8(p + 24) ^ see1);
+				see2 = wyhash_mix(wyhash_read8(p + 32) ^
+						  WYHASH_P3,
+						  wyhash_read8(p + 40) ^ see2);
+				p += 48;
+				i -= 48;
+			} while (i > 48);
+			seed ^= see1 ^ see2;
+		}
+		while (i > 16) {
+			seed = wyhash_mix(wyhash_read8(p) ^ WYHASH_P1,
+					  wyhash_read8(p + 8) ^ seed);
+			i -= 16;
+			p += 16;
+		}
+		a = wyhash_read8(p + i - 16);
+		b = wyhash_read8(p + i - 8);
+	}
+	a ^= WYHASH_P1;
+	b ^= seed;
+	wyhash_mum(&a, &b);
+	return wyhash_mix(a ^ WYHASH_P0 ^ len, b ^ WYHASH_P1);
+}
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* defined(__cplusplus) */
+
+#endif /* TARANTOOL_THIRD_PARTY_WYHASH_H_INCLUDED */